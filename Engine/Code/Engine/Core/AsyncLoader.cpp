@@ -0,0 +1,293 @@
+#include "Engine/Core/AsyncLoader.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Time/Time.hpp"
+#include <atomic>
+
+AsyncLoader* AsyncLoader::instance = nullptr;
+
+//-----------------------------------------------------------------------------------
+struct LoadRequest
+{
+	LoadRequest(const std::string& name) : name(name), result(nullptr), state((int)LoadState::LOADING), pendingDependencies(0), hasFailedDependency(false) {};
+
+	std::string name;
+	AsyncLoader::LoadStep backgroundStep;
+	AsyncLoader::LoadStep mainThreadStep;
+	void* result;
+	std::atomic<int> state;
+	//Everything below is only touched with the loader's mutex held.
+	unsigned int pendingDependencies;
+	bool hasFailedDependency;
+	std::vector<std::shared_ptr<LoadRequest>> dependents;
+};
+
+//-----------------------------------------------------------------------------------
+LoadState LoadHandle::GetState() const
+{
+	return m_request ? (LoadState)m_request->state.load() : LoadState::FAILED;
+}
+
+//-----------------------------------------------------------------------------------
+const std::string& LoadHandle::GetName() const
+{
+	static const std::string NO_NAME;
+	return m_request ? m_request->name : NO_NAME;
+}
+
+//-----------------------------------------------------------------------------------
+void* LoadHandle::GetResult() const
+{
+	return IsReady() ? m_request->result : nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+AsyncLoader::AsyncLoader(unsigned int numWorkers, bool isHeadless)
+	: m_pendingCount(0)
+	, m_isHeadless(isHeadless)
+	, m_isStopping(false)
+{
+	if (numWorkers == 0)
+	{
+		//Leave a core for the main thread.
+		unsigned int numCores = std::thread::hardware_concurrency();
+		numWorkers = numCores > 1 ? numCores - 1 : 1;
+	}
+	m_workers.reserve(numWorkers);
+	for (unsigned int i = 0; i < numWorkers; ++i)
+	{
+		m_workers.emplace_back(&AsyncLoader::WorkerMain, this);
+	}
+}
+
+//-----------------------------------------------------------------------------------
+//Background steps already running are finished, anything still queued is dropped and stays LOADING.
+AsyncLoader::~AsyncLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStopping = true;
+	}
+	m_workAvailable.notify_all();
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+//-----------------------------------------------------------------------------------
+LoadHandle AsyncLoader::Enqueue(const std::string& name, const LoadStep& backgroundStep, const LoadStep& mainThreadStep, const std::vector<LoadHandle>& dependencies)
+{
+	LoadHandle handle;
+	handle.m_request = std::make_shared<LoadRequest>(name);
+	handle.m_request->backgroundStep = backgroundStep;
+	handle.m_request->mainThreadStep = mainThreadStep;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	++m_pendingCount;
+	for (const LoadHandle& dependency : dependencies)
+	{
+		ASSERT_OR_DIE(dependency.IsValid(), "Async load of " + name + " depends on an empty handle");
+		//States only change with the mutex held, so this can't race with the dependency finishing.
+		LoadState dependencyState = dependency.GetState();
+		if (dependencyState == LoadState::LOADING)
+		{
+			dependency.m_request->dependents.push_back(handle.m_request);
+			++handle.m_request->pendingDependencies;
+		}
+		else if (dependencyState == LoadState::FAILED)
+		{
+			handle.m_request->hasFailedDependency = true;
+		}
+	}
+	Schedule(handle.m_request);
+	return handle;
+}
+
+//-----------------------------------------------------------------------------------
+LoadHandle AsyncLoader::AddReady(const std::string& name, void* result)
+{
+	LoadHandle handle;
+	handle.m_request = std::make_shared<LoadRequest>(name);
+	handle.m_request->result = result;
+	handle.m_request->state = (int)LoadState::READY;
+	return handle;
+}
+
+//-----------------------------------------------------------------------------------
+LoadHandle AsyncLoader::FindInFlight(const std::string& name)
+{
+	auto found = m_inFlight.find(name);
+	if (found == m_inFlight.end())
+	{
+		return LoadHandle();
+	}
+	if (!found->second.IsDone())
+	{
+		return found->second;
+	}
+	m_inFlight.erase(found);
+	return LoadHandle();
+}
+
+//-----------------------------------------------------------------------------------
+void AsyncLoader::TrackInFlight(const std::string& name, const LoadHandle& handle)
+{
+	m_inFlight[name] = handle;
+}
+
+//-----------------------------------------------------------------------------------
+//Called with the mutex held.
+void AsyncLoader::Schedule(const std::shared_ptr<LoadRequest>& request)
+{
+	if (request->pendingDependencies > 0)
+	{
+		return;
+	}
+	if (request->hasFailedDependency)
+	{
+		Complete(request, LoadState::FAILED);
+	}
+	else if (request->backgroundStep)
+	{
+		m_workQueue.push_back(request);
+		m_workAvailable.notify_one();
+	}
+	else if (request->mainThreadStep && !m_isHeadless)
+	{
+		m_mainThreadQueue.push_back(request);
+		m_requestFinished.notify_all();
+	}
+	else
+	{
+		Complete(request, LoadState::READY);
+	}
+}
+
+//-----------------------------------------------------------------------------------
+//Called with the mutex held.
+void AsyncLoader::Complete(const std::shared_ptr<LoadRequest>& request, LoadState state)
+{
+	request->state = (int)state;
+	request->backgroundStep = nullptr;
+	request->mainThreadStep = nullptr;
+	--m_pendingCount;
+	std::vector<std::shared_ptr<LoadRequest>> dependents;
+	dependents.swap(request->dependents);
+	for (const std::shared_ptr<LoadRequest>& dependent : dependents)
+	{
+		dependent->hasFailedDependency = dependent->hasFailedDependency || state == LoadState::FAILED;
+		--dependent->pendingDependencies;
+		Schedule(dependent);
+	}
+	m_requestFinished.notify_all();
+}
+
+//-----------------------------------------------------------------------------------
+void AsyncLoader::WorkerMain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		m_workAvailable.wait(lock, [this]() { return m_isStopping || !m_workQueue.empty(); });
+		if (m_isStopping)
+		{
+			return;
+		}
+		std::shared_ptr<LoadRequest> request = m_workQueue.front();
+		m_workQueue.pop_front();
+
+		lock.unlock();
+		bool succeeded = request->backgroundStep(request->result);
+		lock.lock();
+
+		if (!succeeded)
+		{
+			Complete(request, LoadState::FAILED);
+		}
+		else if (request->mainThreadStep && !m_isHeadless)
+		{
+			m_mainThreadQueue.push_back(request);
+			m_requestFinished.notify_all();
+		}
+		else
+		{
+			Complete(request, LoadState::READY);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------
+bool AsyncLoader::RunOneMainThreadStep()
+{
+	std::shared_ptr<LoadRequest> request;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_mainThreadQueue.empty())
+		{
+			return false;
+		}
+		request = m_mainThreadQueue.front();
+		m_mainThreadQueue.pop_front();
+	}
+	bool succeeded = request->mainThreadStep(request->result);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Complete(request, succeeded ? LoadState::READY : LoadState::FAILED);
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int AsyncLoader::Update(double budgetSeconds)
+{
+	double startTime = GetCurrentTimeSeconds();
+	unsigned int numStepsRun = 0;
+	while (RunOneMainThreadStep())
+	{
+		++numStepsRun;
+		if (GetCurrentTimeSeconds() - startTime >= budgetSeconds)
+		{
+			break;
+		}
+	}
+	return numStepsRun;
+}
+
+//-----------------------------------------------------------------------------------
+void AsyncLoader::WaitUntil(const std::function<bool()>& isDone)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!isDone())
+	{
+		if (!m_mainThreadQueue.empty())
+		{
+			lock.unlock();
+			RunOneMainThreadStep();
+			lock.lock();
+		}
+		else
+		{
+			m_requestFinished.wait(lock);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------
+void AsyncLoader::Wait(const LoadHandle& handle)
+{
+	if (handle.IsValid())
+	{
+		WaitUntil([&handle]() { return handle.IsDone(); });
+	}
+}
+
+//-----------------------------------------------------------------------------------
+void AsyncLoader::Flush()
+{
+	WaitUntil([this]() { return m_pendingCount == 0; });
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int AsyncLoader::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pendingCount;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct LoadRequest;
+
+//-----------------------------------------------------------------------------------
+enum class LoadState
+{
+	LOADING,
+	READY,
+	FAILED
+};
+
+//-----------------------------------------------------------------------------------
+//Shared handle to one request, cheap to copy and safe to poll from the main thread every frame.
+class LoadHandle
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	LoadHandle() {};
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	LoadState GetState() const;
+	const std::string& GetName() const;
+	inline bool IsValid() const { return m_request != nullptr; };
+	inline bool IsReady() const { return GetState() == LoadState::READY; };
+	inline bool IsFailed() const { return GetState() == LoadState::FAILED; };
+	inline bool IsDone() const { return GetState() != LoadState::LOADING; };
+
+protected:
+	void* GetResult() const;
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	std::shared_ptr<LoadRequest> m_request;
+
+	friend class AsyncLoader;
+};
+
+//-----------------------------------------------------------------------------------
+//Typed view of a handle, Get is null until the asset is ready (and always in headless mode for anything that lives on the GPU).
+template<typename T>
+class AssetHandle : public LoadHandle
+{
+public:
+	AssetHandle() {};
+	AssetHandle(const LoadHandle& handle) : LoadHandle(handle) {};
+	inline T* Get() const { return static_cast<T*>(GetResult()); };
+};
+
+//-----------------------------------------------------------------------------------
+//Loads assets in two steps. The background step (file I/O, decoding, parsing) runs on a pool of worker threads, then
+//the main thread step (anything that touches GL) is queued up and run from Update under a per-frame time budget.
+//A request can depend on other handles, it isn't started until they're all ready and fails if any of them fail.
+//
+//In headless mode main thread steps are never run, so tools and tests can load everything without a GL context.
+//Background steps can't touch GL, the Console or anything else the main thread owns.
+class AsyncLoader
+{
+public:
+	//TYPEDEFS//////////////////////////////////////////////////////////////////////////
+	//Either step returns false to fail the request. outResult is what the handle hands back once it's ready.
+	typedef std::function<bool(void*& outResult)> LoadStep;
+
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	AsyncLoader(unsigned int numWorkers = 0, bool isHeadless = false);
+	~AsyncLoader();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	LoadHandle Enqueue(const std::string& name, const LoadStep& backgroundStep, const LoadStep& mainThreadStep, const std::vector<LoadHandle>& dependencies = std::vector<LoadHandle>());
+	LoadHandle AddReady(const std::string& name, void* result);
+	//Requests still loading under a name, so asking for the same asset twice hands back the same handle. Main thread only.
+	//FindInFlight returns an invalid handle once the request is done, since the asset can be found wherever it was loaded to.
+	LoadHandle FindInFlight(const std::string& name);
+	void TrackInFlight(const std::string& name, const LoadHandle& handle);
+	//Runs main thread steps until the budget's spent (always at least one if any are waiting). Returns how many ran.
+	unsigned int Update(double budgetSeconds = DEFAULT_FRAME_BUDGET_SECONDS);
+	//Block until the handle (or everything) is done, running main thread steps as they become ready.
+	void Wait(const LoadHandle& handle);
+	void Flush();
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	inline bool IsHeadless() const { return m_isHeadless; };
+	inline unsigned int GetWorkerCount() const { return m_workers.size(); };
+	unsigned int GetPendingCount();
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static constexpr double DEFAULT_FRAME_BUDGET_SECONDS = 0.002;
+
+	//STATIC VARIABLES//////////////////////////////////////////////////////////////////////////
+	static AsyncLoader* instance;
+
+private:
+	AsyncLoader(const AsyncLoader&);
+	void WorkerMain();
+	void Schedule(const std::shared_ptr<LoadRequest>& request);
+	void Complete(const std::shared_ptr<LoadRequest>& request, LoadState state);
+	bool RunOneMainThreadStep();
+	void WaitUntil(const std::function<bool()>& isDone);
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	std::vector<std::thread> m_workers;
+	std::deque<std::shared_ptr<LoadRequest>> m_workQueue;
+	std::deque<std::shared_ptr<LoadRequest>> m_mainThreadQueue;
+	std::map<std::string, LoadHandle> m_inFlight;
+	std::mutex m_mutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_requestFinished;
+	unsigned int m_pendingCount;
+	bool m_isHeadless;
+	bool m_isStopping;
+};
@@ -14,6 +14,9 @@
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <iostream>
 
 
@@ -49,7 +52,7 @@ void DebuggerPrintf( const char* messageFormat, ... )
 	char messageLiteral[ MESSAGE_MAX_LENGTH ];
 	va_list variableArgumentList;
 	va_start( variableArgumentList, messageFormat );
-	vsnprintf_s( messageLiteral, MESSAGE_MAX_LENGTH, _TRUNCATE, messageFormat, variableArgumentList );
+	vsnprintf( messageLiteral, MESSAGE_MAX_LENGTH, messageFormat, variableArgumentList );
 	va_end( variableArgumentList );
 	messageLiteral[ MESSAGE_MAX_LENGTH - 1 ] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
@@ -183,7 +186,7 @@ int SystemDialogue_YesNoCancel( const std::string& messageTitle, const std::stri
 
 
 //-----------------------------------------------------------------------------------------------
-__declspec( noreturn ) void FatalError( const char* filePath, const char* functionName, int lineNum, const std::string& reasonForError, const char* conditionText )
+[[noreturn]] void FatalError( const char* filePath, const char* functionName, int lineNum, const std::string& reasonForError, const char* conditionText )
 {
 	std::string errorMessage = reasonForError;
 	if( reasonForError.empty() )
@@ -200,7 +203,7 @@ __declspec( noreturn ) void FatalError( const char* filePath, const char* functi
 	std::string fullMessageTitle = appName + " :: Error";
 	std::string fullMessageText = errorMessage;
 	fullMessageText += "\n\nThe application will now close.\n";
-	bool isDebuggerPresent = (IsDebuggerPresent() == TRUE);
+	bool isDebuggerPresent = IsDebuggerAvailable();
 	if( isDebuggerPresent )
 	{
 		fullMessageText += "\nDEBUGGER DETECTED!\nWould you like to break and debug?\n  (Yes=debug, No=quit)\n";
@@ -226,16 +229,22 @@ __declspec( noreturn ) void FatalError( const char* filePath, const char* functi
 	if( isDebuggerPresent )
 	{
 		bool isAnswerYes = SystemDialogue_YesNo( fullMessageTitle, fullMessageText, SEVERITY_FATAL );
+		#if defined( PLATFORM_WINDOWS )
 		ShowCursor( TRUE );
 		if( isAnswerYes )
 		{
 			__debugbreak();
 		}
+		#else
+		UNUSED( isAnswerYes );
+		#endif
 	}
 	else
 	{
 		SystemDialogue_Okay( fullMessageTitle, fullMessageText, SEVERITY_FATAL );
+		#if defined( PLATFORM_WINDOWS )
 		ShowCursor( TRUE );
+		#endif
 	}
 
 	exit( 0 );
@@ -260,7 +269,7 @@ void RecoverableWarning( const char* filePath, const char* functionName, int lin
 	std::string fullMessageTitle = appName + " :: Warning";
 	std::string fullMessageText = errorMessage;
 
-	bool isDebuggerPresent = (IsDebuggerPresent() == TRUE);
+	bool isDebuggerPresent = IsDebuggerAvailable();
 	if( isDebuggerPresent )
 	{
 		fullMessageText += "\n\nDEBUGGER DETECTED!\nWould you like to continue running?\n  (Yes=continue, No=quit, Cancel=debug)\n";
@@ -290,20 +299,26 @@ void RecoverableWarning( const char* filePath, const char* functionName, int lin
 	if( isDebuggerPresent )
 	{
 		int answerCode = SystemDialogue_YesNoCancel( fullMessageTitle, fullMessageText, SEVERITY_WARNING );
+		#if defined( PLATFORM_WINDOWS )
 		ShowCursor( TRUE );
+		#endif
 		if( answerCode == 0 ) // "NO"
 		{
 			exit( 0 );
 		}
+		#if defined( PLATFORM_WINDOWS )
 		else if( answerCode == -1 ) // "CANCEL"
 		{
 			__debugbreak();
 		}
+		#endif
 	}
 	else
 	{
 		bool isAnswerYes = SystemDialogue_YesNo( fullMessageTitle, fullMessageText, SEVERITY_WARNING );
+		#if defined( PLATFORM_WINDOWS )
 		ShowCursor( TRUE );
+		#endif
 		if( !isAnswerYes )
 		{
 			exit( 0 );
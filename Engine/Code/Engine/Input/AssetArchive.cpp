@@ -0,0 +1,340 @@
+#include "Engine/Input/AssetArchive.hpp"
+#include "Engine/Input/BinaryReader.hpp"
+#include "Engine/Input/BinaryWriter.hpp"
+#include "Engine/Input/FileSystem.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <string.h>
+
+std::vector<AssetArchive*> AssetArchive::s_mountedArchives;
+
+//-----------------------------------------------------------------------------------
+static inline char NormalizePathCharacter(char character)
+{
+	if (character == '\\')
+	{
+		return '/';
+	}
+	return (character >= 'A' && character <= 'Z') ? character + ('a' - 'A') : character;
+}
+
+//-----------------------------------------------------------------------------------
+//Leading "./" doesn't change which file a path means, so it's skipped for both hashing and comparing.
+static inline const char* SkipCurrentDirectory(const char* path, size_t& length)
+{
+	while (length >= 2 && path[0] == '.' && (path[1] == '/' || path[1] == '\\'))
+	{
+		path += 2;
+		length -= 2;
+	}
+	return path;
+}
+
+//-----------------------------------------------------------------------------------
+//FNV-1a over the normalized characters, so no normalized copy of the path ever has to be made.
+uint64_t AssetArchive::HashPath(const char* path, size_t length)
+{
+	path = SkipCurrentDirectory(path, length);
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= (uint64_t)(unsigned char)NormalizePathCharacter(path[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+//-----------------------------------------------------------------------------------
+//Written so that no sum can wrap around, since every value here comes straight out of the file.
+static inline bool IsRangeInside(uint64_t offset, uint64_t size, uint64_t containerSize)
+{
+	return offset <= containerSize && size <= containerSize - offset;
+}
+
+//-----------------------------------------------------------------------------------
+AssetArchive::AssetArchive()
+	: m_header(nullptr)
+	, m_table(nullptr)
+	, m_paths(nullptr)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetArchive::Open(const char* archivePath)
+{
+	Close();
+	if (!m_file.OpenFromDisk(archivePath) || m_file.GetSize() < sizeof(AssetArchiveHeader))
+	{
+		m_file.Close();
+		return false;
+	}
+	const AssetArchiveHeader* header = reinterpret_cast<const AssetArchiveHeader*>(m_file.GetData());
+	if (header->magic != MAGIC)
+	{
+		m_file.Close();
+		return false;
+	}
+	ASSERT_OR_DIE(header->version <= FILE_VERSION, "Asset archive is from a newer version of the engine");
+	ASSERT_OR_DIE(header->tableCapacity > 0 && (header->tableCapacity & (header->tableCapacity - 1)) == 0, "Asset archive table size isn't a power of two");
+	ASSERT_OR_DIE(header->entryCount < header->tableCapacity, "Asset archive table has no empty slots");
+	ASSERT_OR_DIE(header->tableOffset % sizeof(uint64_t) == 0 && IsRangeInside(header->tableOffset, (uint64_t)header->tableCapacity * sizeof(AssetArchiveEntry), m_file.GetSize()), "Asset archive table runs off the end of the file");
+	ASSERT_OR_DIE(IsRangeInside(header->pathsOffset, header->pathsSize, m_file.GetSize()), "Asset archive paths run off the end of the file");
+	m_header = header;
+	m_table = reinterpret_cast<const AssetArchiveEntry*>(m_file.GetData() + header->tableOffset);
+	m_paths = reinterpret_cast<const char*>(m_file.GetData() + header->pathsOffset);
+
+	//Find trusts every slot after this, so check each entry's path and data once up front.
+	uint32_t emptySlots = 0;
+	for (uint32_t slot = 0; slot < header->tableCapacity; ++slot)
+	{
+		const AssetArchiveEntry& entry = m_table[slot];
+		if (entry.pathLength == 0)
+		{
+			++emptySlots;
+			continue;
+		}
+		ASSERT_OR_DIE(IsRangeInside(entry.pathOffset, entry.pathLength, header->pathsSize), "Asset archive entry's path runs off the end of the paths");
+		ASSERT_OR_DIE(IsRangeInside(entry.dataOffset, entry.size, m_file.GetSize()), "Asset archive entry runs off the end of the file");
+	}
+	ASSERT_OR_DIE(emptySlots > 0, "Asset archive table has no empty slots");
+	m_filePath = archivePath;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+void AssetArchive::Close()
+{
+	m_file.Close();
+	m_header = nullptr;
+	m_table = nullptr;
+	m_paths = nullptr;
+	m_filePath.clear();
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetArchive::Find(const char* path, ByteSpan& outData) const
+{
+	if (!m_header)
+	{
+		return false;
+	}
+	size_t length = strlen(path);
+	uint64_t hash = HashPath(path, length);
+	path = SkipCurrentDirectory(path, length);
+	const uint32_t mask = m_header->tableCapacity - 1;
+	uint32_t slot = (uint32_t)hash & mask;
+	for (uint32_t probeCount = 0; probeCount < m_header->tableCapacity; ++probeCount, slot = (slot + 1) & mask)
+	{
+		const AssetArchiveEntry& entry = m_table[slot];
+		if (entry.pathLength == 0)
+		{
+			return false;
+		}
+		if (entry.pathHash != hash || entry.pathLength != length)
+		{
+			continue;
+		}
+		//Stored paths are already normalized, make sure this isn't just a hash collision.
+		const char* storedPath = m_paths + entry.pathOffset;
+		size_t i = 0;
+		while (i < length && NormalizePathCharacter(path[i]) == storedPath[i])
+		{
+			++i;
+		}
+		if (i == length)
+		{
+			outData = ByteSpan(m_file.GetData() + entry.dataOffset, (size_t)entry.size);
+			return true;
+		}
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetArchive::Mount(const char* archivePath)
+{
+	AssetArchive* archive = new AssetArchive();
+	if (!archive->Open(archivePath))
+	{
+		delete archive;
+		return false;
+	}
+	s_mountedArchives.push_back(archive);
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Anything still viewing into an archive has to be closed first.
+void AssetArchive::UnmountAll()
+{
+	for (AssetArchive* archive : s_mountedArchives)
+	{
+		delete archive;
+	}
+	s_mountedArchives.clear();
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetArchive::FindInMounted(const char* path, ByteSpan& outData)
+{
+	for (auto iter = s_mountedArchives.rbegin(); iter != s_mountedArchives.rend(); ++iter)
+	{
+		if ((*iter)->Find(path, outData))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------------
+struct ArchiveSourceFile
+{
+	std::string diskPath;
+	std::string archivePath;
+	uint64_t size;
+};
+
+//-----------------------------------------------------------------------------------
+static std::string NormalizePath(const std::string& path)
+{
+	size_t length = path.size();
+	const char* trimmedPath = SkipCurrentDirectory(path.c_str(), length);
+	while (length > 0 && (trimmedPath[length - 1] == '/' || trimmedPath[length - 1] == '\\'))
+	{
+		--length;
+	}
+	std::string normalizedPath(length, '\0');
+	for (size_t i = 0; i < length; ++i)
+	{
+		normalizedPath[i] = NormalizePathCharacter(trimmedPath[i]);
+	}
+	return normalizedPath;
+}
+
+//-----------------------------------------------------------------------------------
+static inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+//-----------------------------------------------------------------------------------
+//Paths are stored relative to the working directory the same way loaders ask for them (ie: packing "Data" stores "data/fonts/arial.fnt").
+//Packing a copy of the tree that lives somewhere else takes a rootDirectory to store paths relative to instead
+//(ie: packing "Cooked/Data" with a root of "Cooked" stores the same "data/fonts/arial.fnt").
+//HEADER
+//path table
+//normalized paths
+//file data, each file starting on a DATA_ALIGNMENT boundary
+bool AssetArchive::Build(const char* directory, const char* archivePath, const char* rootDirectory /*= nullptr*/)
+{
+	std::vector<FileListing> listings;
+	ListFilesRecursive(directory, listings);
+
+	//The archive being built could be inside the directory being packed, don't pack it into itself.
+	std::string normalizedArchivePath = NormalizePath(archivePath);
+	std::string rootPrefix = rootDirectory ? NormalizePath(rootDirectory) : std::string();
+	rootPrefix += rootPrefix.empty() ? "" : "/";
+	std::vector<ArchiveSourceFile> files;
+	files.reserve(listings.size());
+	for (const FileListing& listing : listings)
+	{
+		ArchiveSourceFile file;
+		file.diskPath = listing.path;
+		file.archivePath = NormalizePath(listing.path);
+		file.size = listing.size;
+		if (file.archivePath == normalizedArchivePath)
+		{
+			continue;
+		}
+		if (file.archivePath.compare(0, rootPrefix.size(), rootPrefix) == 0)
+		{
+			file.archivePath.erase(0, rootPrefix.size());
+		}
+		files.push_back(file);
+	}
+
+	uint32_t tableCapacity = 16;
+	while (tableCapacity < files.size() * 2)
+	{
+		tableCapacity *= 2;
+	}
+	std::vector<AssetArchiveEntry> table(tableCapacity);
+	memset(table.data(), 0, sizeof(AssetArchiveEntry) * tableCapacity);
+	std::string paths;
+
+	AssetArchiveHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = MAGIC;
+	header.version = FILE_VERSION;
+	header.entryCount = files.size();
+	header.tableCapacity = tableCapacity;
+	header.tableOffset = sizeof(AssetArchiveHeader);
+	header.pathsOffset = header.tableOffset + (sizeof(AssetArchiveEntry) * tableCapacity);
+	header.dataAlignment = DATA_ALIGNMENT;
+	for (const ArchiveSourceFile& file : files)
+	{
+		paths += file.archivePath;
+		paths += '\0';
+	}
+	header.pathsSize = paths.size();
+
+	uint64_t dataOffset = AlignUp(header.pathsOffset + header.pathsSize, DATA_ALIGNMENT);
+	uint32_t pathOffset = 0;
+	const uint32_t mask = tableCapacity - 1;
+	for (const ArchiveSourceFile& file : files)
+	{
+		uint64_t hash = HashPath(file.archivePath.c_str(), file.archivePath.size());
+		uint32_t slot = (uint32_t)hash & mask;
+		while (table[slot].pathLength != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+		AssetArchiveEntry& entry = table[slot];
+		entry.pathHash = hash;
+		entry.pathOffset = pathOffset;
+		entry.pathLength = file.archivePath.size();
+		entry.dataOffset = dataOffset;
+		entry.size = file.size;
+		pathOffset += file.archivePath.size() + 1;
+		dataOffset = AlignUp(dataOffset + file.size, DATA_ALIGNMENT);
+	}
+
+	BinaryFileWriter writer;
+	if (!writer.Open(archivePath))
+	{
+		return false;
+	}
+	static const byte ZEROES[DATA_ALIGNMENT] = { 0 };
+	uint64_t bytesWritten = writer.WriteBytes(&header, sizeof(header));
+	bytesWritten += writer.WriteBytes(table.data(), sizeof(AssetArchiveEntry) * tableCapacity);
+	bytesWritten += writer.WriteBytes(paths.data(), paths.size());
+	bool succeeded = true;
+	std::vector<byte> copyBuffer(BinaryFileReader::DEFAULT_BLOCK_SIZE);
+	for (const ArchiveSourceFile& file : files)
+	{
+		bytesWritten += writer.WriteBytes(ZEROES, (size_t)(AlignUp(bytesWritten, DATA_ALIGNMENT) - bytesWritten));
+		//Copied straight off the disk as it is, an already compressed asset stays compressed in the archive.
+		BinaryFileReader reader;
+		if (!reader.Open(file.diskPath.c_str()))
+		{
+			succeeded = false;
+			break;
+		}
+		uint64_t fileBytesCopied = 0;
+		size_t bytesRead;
+		while ((bytesRead = reader.ReadBytes(copyBuffer.data(), copyBuffer.size())) > 0)
+		{
+			bytesWritten += writer.WriteBytes(copyBuffer.data(), bytesRead);
+			fileBytesCopied += bytesRead;
+		}
+		reader.Close();
+		if (fileBytesCopied != file.size)
+		{
+			succeeded = false;
+			break;
+		}
+	}
+	writer.Close();
+	return succeeded;
+}
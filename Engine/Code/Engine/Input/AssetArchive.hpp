@@ -0,0 +1,73 @@
+#pragma once
+#include "Engine/Input/FileView.hpp"
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------------
+struct AssetArchiveHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t tableCapacity; //Always a power of two, at least twice the entry count.
+	uint64_t tableOffset;
+	uint64_t pathsOffset;
+	uint64_t pathsSize;
+	uint32_t dataAlignment;
+	uint32_t padding;
+};
+
+//-----------------------------------------------------------------------------------
+//One slot of the open addressed path table. Empty slots have a pathLength of 0.
+struct AssetArchiveEntry
+{
+	uint64_t pathHash;
+	uint32_t pathOffset;
+	uint32_t pathLength;
+	uint64_t dataOffset;
+	uint64_t size;
+};
+
+//-----------------------------------------------------------------------------------
+//A directory tree packed into one file. Lookups hash the path and probe the table, so finding and opening an asset
+//is a few memory reads into the archive's view with no calls into the OS. Paths are matched case-insensitively, with
+//either kind of slash (ie: "Data\Fonts\Arial.fnt" and "data/fonts/arial.fnt" are the same asset).
+class AssetArchive
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	AssetArchive();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	bool Open(const char* archivePath);
+	void Close();
+	bool Find(const char* path, ByteSpan& outData) const;
+	static bool Build(const char* directory, const char* archivePath, const char* rootDirectory = nullptr);
+	static uint64_t HashPath(const char* path, size_t length);
+
+	//Mounted archives are searched (most recently mounted first) by FileView before it goes to the disk.
+	static bool Mount(const char* archivePath);
+	static void UnmountAll();
+	static bool FindInMounted(const char* path, ByteSpan& outData);
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	inline uint32_t GetEntryCount() const { return m_header ? m_header->entryCount : 0; };
+	inline const char* GetFilePath() const { return m_filePath.c_str(); };
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const uint32_t MAGIC = 0x4B415050; //"PPAK"
+	static const uint32_t FILE_VERSION = 1;
+	static const uint32_t DATA_ALIGNMENT = 64;
+
+private:
+	AssetArchive(const AssetArchive&);
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	FileView m_file;
+	std::string m_filePath;
+	const AssetArchiveHeader* m_header;
+	const AssetArchiveEntry* m_table;
+	const char* m_paths;
+
+	static std::vector<AssetArchive*> s_mountedArchives;
+};
@@ -0,0 +1,42 @@
+#include "Engine/Input/AssetArchive.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+//The console side of AssetArchive, kept out of AssetArchive.cpp so the cooker can pack archives without linking the console.
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(buildArchive)
+{
+	if (!args.HasArgs(2))
+	{
+		Console::instance->PrintLine("buildArchive <directory> <archive filename>", RGBA::RED);
+		return;
+	}
+	std::string directory = args.GetStringArgument(0);
+	std::string archivePath = args.GetStringArgument(1);
+	if (!AssetArchive::Build(directory.c_str(), archivePath.c_str()))
+	{
+		Console::instance->PrintLine(Stringf("Error: Couldn't pack %s into %s.", directory.c_str(), archivePath.c_str()), RGBA::RED);
+		return;
+	}
+	AssetArchive archive;
+	archive.Open(archivePath.c_str());
+	Console::instance->PrintLine(Stringf("Packed %i files from %s into %s.", archive.GetEntryCount(), directory.c_str(), archivePath.c_str()));
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(mountArchive)
+{
+	if (!args.HasArgs(1))
+	{
+		Console::instance->PrintLine("mountArchive <archive filename>", RGBA::RED);
+		return;
+	}
+	std::string archivePath = args.GetStringArgument(0);
+	if (!AssetArchive::Mount(archivePath.c_str()))
+	{
+		Console::instance->PrintLine(Stringf("Error: %s isn't an asset archive.", archivePath.c_str()), RGBA::RED);
+		return;
+	}
+	Console::instance->PrintLine(Stringf("Mounted %s.", archivePath.c_str()));
+}
@@ -1,18 +1,40 @@
 #include "Engine/Input/BinaryReader.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include <string.h>
 
+//-----------------------------------------------------------------------------------
+BinaryFileReader::BinaryFileReader(size_t blockSize)
+	: fileHandle(nullptr)
+	, m_block(new byte[blockSize])
+	, m_blockSize(blockSize)
+	, m_blockPosition(0)
+	, m_blockEnd(0)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+BinaryFileReader::~BinaryFileReader()
+{
+	Close();
+	delete[] m_block;
+}
+
+//-----------------------------------------------------------------------------------
 bool BinaryFileReader::Open(const char* filePath)
 {
 	const char* mode = "rb";
 
-	errno_t error = fopen_s(&fileHandle, filePath, mode);
-	if (error != 0)
-	{
-		return false;
-	}
-	return true;
+	Close();
+#if defined(_WIN32)
+	fopen_s(&fileHandle, filePath, mode);
+#else
+	fileHandle = fopen(filePath, mode);
+#endif
+	return fileHandle != nullptr;
 }
 
+//-----------------------------------------------------------------------------------
 void BinaryFileReader::Close()
 {
 	if (fileHandle != nullptr)
@@ -20,15 +42,72 @@ void BinaryFileReader::Close()
 		fclose(fileHandle);
 		fileHandle = nullptr;
 	}
+	m_blockPosition = 0;
+	m_blockEnd = 0;
 }
 
-void* BinaryFileReader::ReadBytes(const size_t numBytes)
+//-----------------------------------------------------------------------------------
+size_t BinaryFileReader::ReadBytes(void* destination, const size_t numBytes)
 {
-	void* buffer = new byte[numBytes];
-	fread(buffer, sizeof(byte), numBytes, fileHandle);
-	return buffer;
+	byte* output = static_cast<byte*>(destination);
+	size_t bytesRead = 0;
+	while (bytesRead < numBytes)
+	{
+		if (m_blockPosition == m_blockEnd)
+		{
+			size_t bytesLeft = numBytes - bytesRead;
+			if (bytesLeft >= m_blockSize)
+			{
+				//Big reads go straight into the destination instead of through the block.
+				return bytesRead + fread(output + bytesRead, sizeof(byte), bytesLeft, fileHandle);
+			}
+			m_blockPosition = 0;
+			m_blockEnd = fread(m_block, sizeof(byte), m_blockSize, fileHandle);
+			if (m_blockEnd == 0)
+			{
+				break;
+			}
+		}
+		size_t bytesToCopy = m_blockEnd - m_blockPosition;
+		bytesToCopy = bytesToCopy < (numBytes - bytesRead) ? bytesToCopy : (numBytes - bytesRead);
+		memcpy(output + bytesRead, m_block + m_blockPosition, bytesToCopy);
+		m_blockPosition += bytesToCopy;
+		bytesRead += bytesToCopy;
+	}
+	return bytesRead;
+}
+
+//-----------------------------------------------------------------------------------
+BinaryMemoryReader::BinaryMemoryReader(const void* data, size_t size)
+	: m_data(static_cast<const byte*>(data))
+	, m_size(size)
+	, m_position(0)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+size_t BinaryMemoryReader::ReadBytes(void* destination, const size_t numBytes)
+{
+	size_t bytesToCopy = numBytes < GetRemainingSize() ? numBytes : GetRemainingSize();
+	memcpy(destination, m_data + m_position, bytesToCopy);
+	m_position += bytesToCopy;
+	return bytesToCopy;
+}
+
+//-----------------------------------------------------------------------------------
+const byte* BinaryMemoryReader::ReadInPlace(const size_t numBytes)
+{
+	if (numBytes > GetRemainingSize())
+	{
+		return nullptr;
+	}
+	const byte* data = m_data + m_position;
+	m_position += numBytes;
+	return data;
 }
 
+//-----------------------------------------------------------------------------------
 IBinaryReader::EndianMode IBinaryReader::GetLocalEndianess()
 {
 	union {
@@ -40,17 +119,18 @@ IBinaryReader::EndianMode IBinaryReader::GetLocalEndianess()
 	return(data.byteData[0] == 0x01) ? LITTLE_ENDIAN : BIG_ENDIAN;
 }
 
-size_t IBinaryReader::ReadString(const char*& stringBuffer, size_t bufferSize)
+//-----------------------------------------------------------------------------------
+size_t IBinaryReader::ReadString(std::string& outString)
 {
-    UNUSED(bufferSize);
-	size_t bufferLength;
-	Read<uint32_t>(bufferLength);
-	if (bufferLength == 0U)
+	uint32_t bufferLength = 0;
+	if (!Read<uint32_t>(bufferLength) || bufferLength == 0U)
 	{
-		stringBuffer = nullptr;
-		return bufferLength;
+		outString.clear();
+		return 0;
 	}
-	void* readData = ReadBytes(bufferLength);
-	stringBuffer = static_cast<const char*>(readData);
+	//The stored length counts the terminator, read it in with the rest and then drop it.
+	outString.resize(bufferLength);
+	size_t bytesRead = ReadBytes(&outString[0], bufferLength);
+	outString.resize(bytesRead == bufferLength ? bufferLength - 1 : bytesRead);
 	return bufferLength;
 }
@@ -1,6 +1,14 @@
 #pragma once
 #include <stdio.h>
 #include <stdint.h>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include "Engine/Input/ByteSwap.hpp"
+
+//glibc's <endian.h> defines these as macros, which would stomp on the EndianMode enums below.
+#undef LITTLE_ENDIAN
+#undef BIG_ENDIAN
 
 typedef unsigned char byte;
 
@@ -23,10 +31,11 @@ public:
 	inline void SetEndianess(EndianMode mode) { m_endianMode = mode; };
 
 	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
-	size_t ReadString(const char*& stringBuffer, size_t bufferSize);
-	//Returns the number of bytes written. This is the core implementation that subclasses
-	//need to support. Writes to the appropriate buffer the bytes.
-	virtual void* ReadBytes(const size_t numBytes) = 0;
+	//Returns the stored length, including the terminator. 0 means a nullptr was written, and the string comes back empty.
+	size_t ReadString(std::string& outString);
+	//Returns the number of bytes read. This is the core implementation that subclasses
+	//need to support. Reads the bytes into the destination, which the caller owns.
+	virtual size_t ReadBytes(void* destination, const size_t numBytes) = 0;
 
 	//-----------------------------------------------------------------------------------
 	template<typename T>
@@ -52,27 +61,99 @@ public:
 	template<typename T>
 	bool Read(T& data)
 	{
-		void* readData = ReadBytes(sizeof(T));
-		data = *static_cast<T*>(readData);
+		if (ReadBytes(&data, sizeof(T)) != sizeof(T))
+		{
+			return false;
+		}
 		if (GetLocalEndianess() != m_endianMode)
 		{
 			ByteSwap(&data, sizeof(T));
 		}
 		return true;
 	}
-	
+
+	//-----------------------------------------------------------------------------------
+	//Reads count values in one go and swaps them all at once if needed. Structs of floats (matrices, vectors, keyframes) are read through their float arrays.
+	template<typename T>
+	bool ReadArray(T* data, size_t count)
+	{
+		static_assert(std::is_arithmetic<T>::value, "ReadArray swaps each element as one value, pass structs as an array of their members");
+		const size_t numBytes = sizeof(T) * count;
+		if (ReadBytes(data, numBytes) != numBytes)
+		{
+			return false;
+		}
+		if (sizeof(T) > 1 && GetLocalEndianess() != m_endianMode)
+		{
+			ByteSwapArray(data, sizeof(T), count);
+		}
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------------
+	//Fills the whole vector, size it first.
+	template<typename T>
+	bool ReadArray(std::vector<T>& data)
+	{
+		return data.empty() || ReadArray(data.data(), data.size());
+	}
+
 private:
 	EndianMode m_endianMode;
 };
 
+//-----------------------------------------------------------------------------------
+//Reads the file a block at a time, so each Read<T> is a copy out of the block instead of its own fread.
 class BinaryFileReader : public IBinaryReader
 {
 public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	BinaryFileReader(size_t blockSize = DEFAULT_BLOCK_SIZE);
+	~BinaryFileReader();
+
 	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
 	bool Open(const char* filePath);
 	void Close();
-	virtual void* ReadBytes(const size_t numBytes) override;
+	virtual size_t ReadBytes(void* destination, const size_t numBytes) override;
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
 
 	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
 	FILE* fileHandle;
-};
\ No newline at end of file
+
+private:
+	BinaryFileReader(const BinaryFileReader&);
+
+	byte* m_block;
+	size_t m_blockSize;
+	size_t m_blockPosition;
+	size_t m_blockEnd;
+};
+
+//-----------------------------------------------------------------------------------
+//Reads out of a buffer somebody else owns (ie: a whole file loaded or mapped up front). Nothing is allocated while reading.
+//Paired with a FileView this is the usual way to read an asset: the file comes in at once and gets parsed out of memory.
+class BinaryMemoryReader : public IBinaryReader
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	BinaryMemoryReader(const void* data, size_t size);
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	virtual size_t ReadBytes(void* destination, const size_t numBytes) override;
+	//Skips the copy entirely, the pointer is into the buffer. Returns nullptr if there aren't enough bytes left.
+	const byte* ReadInPlace(const size_t numBytes);
+	inline void Seek(size_t position) { m_position = position < m_size ? position : m_size; };
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	inline size_t GetPosition() const { return m_position; };
+	inline size_t GetSize() const { return m_size; };
+	inline size_t GetRemainingSize() const { return m_size - m_position; };
+
+private:
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	const byte* m_data;
+	size_t m_size;
+	size_t m_position;
+};
@@ -1,4 +1,5 @@
 #include "Engine/Input/BinaryWriter.hpp"
+#include "Engine/Input/Compression.hpp"
 #include <string.h>
 
 //-----------------------------------------------------------------------------------
@@ -32,8 +33,27 @@ bool IBinaryWriter::WriteString(const char* string)
 	return Write<uint32_t>(bufferLength) && (WriteBytes(string, bufferLength) == bufferLength);
 }
 
+//-----------------------------------------------------------------------------------
+BinaryFileWriter::BinaryFileWriter(size_t blockSize)
+	: fileHandle(nullptr)
+	, m_block(new byte[blockSize])
+	, m_blockSize(blockSize)
+	, m_blockUsed(0)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+BinaryFileWriter::~BinaryFileWriter()
+{
+	Close();
+	delete[] m_block;
+}
+
+//-----------------------------------------------------------------------------------
 bool BinaryFileWriter::Open(const char* filename, bool append /*= false*/)
 {
+	Close();
 	const char* mode;
 	if (append)
 	{
@@ -44,24 +64,186 @@ bool BinaryFileWriter::Open(const char* filename, bool append /*= false*/)
 		mode = "wb";
 	}
 
-	errno_t error = fopen_s(&fileHandle, filename, mode);
-	if (error != 0)
-	{
-		return false;
-	}
-	return true;
+#if defined(_WIN32)
+	fopen_s(&fileHandle, filename, mode);
+#else
+	fileHandle = fopen(filename, mode);
+#endif
+	return fileHandle != nullptr;
 }
 
+//-----------------------------------------------------------------------------------
 void BinaryFileWriter::Close()
 {
 	if (fileHandle != nullptr)
 	{
+		Flush();
 		fclose(fileHandle);
 		fileHandle = nullptr;
 	}
+	m_blockUsed = 0;
 }
 
+//-----------------------------------------------------------------------------------
+bool BinaryFileWriter::Flush()
+{
+	size_t bytesWritten = fwrite(m_block, sizeof(byte), m_blockUsed, fileHandle);
+	bool wasFlushed = bytesWritten == m_blockUsed;
+	m_blockUsed = 0;
+	return wasFlushed;
+}
+
+//-----------------------------------------------------------------------------------
 size_t BinaryFileWriter::WriteBytes(const void* src, const size_t numBytes)
 {
-	return fwrite(src, sizeof(byte), numBytes, fileHandle);
+	if (m_blockUsed + numBytes <= m_blockSize)
+	{
+		memcpy(m_block + m_blockUsed, src, numBytes);
+		m_blockUsed += numBytes;
+		return numBytes;
+	}
+	if (!Flush())
+	{
+		return 0;
+	}
+	if (numBytes >= m_blockSize)
+	{
+		//Too big to be worth copying, write it straight out.
+		return fwrite(src, sizeof(byte), numBytes, fileHandle);
+	}
+	memcpy(m_block, src, numBytes);
+	m_blockUsed = numBytes;
+	return numBytes;
+}
+
+//-----------------------------------------------------------------------------------
+BinaryMemoryWriter::BinaryMemoryWriter(size_t initialCapacity)
+	: m_arena(initialCapacity)
+	, m_buffer(m_arena.data())
+	, m_capacity(initialCapacity)
+	, m_size(0)
+	, m_isGrowable(true)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+BinaryMemoryWriter::BinaryMemoryWriter(void* buffer, size_t capacity)
+	: m_buffer(static_cast<byte*>(buffer))
+	, m_capacity(capacity)
+	, m_size(0)
+	, m_isGrowable(false)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+size_t BinaryMemoryWriter::WriteBytes(const void* src, const size_t numBytes)
+{
+	size_t bytesToCopy = numBytes;
+	if (m_size + numBytes > m_capacity)
+	{
+		if (m_isGrowable)
+		{
+			size_t newCapacity = m_capacity * 2 > m_size + numBytes ? m_capacity * 2 : m_size + numBytes;
+			m_arena.resize(newCapacity);
+			m_buffer = m_arena.data();
+			m_capacity = newCapacity;
+		}
+		else
+		{
+			bytesToCopy = m_capacity - m_size;
+		}
+	}
+	memcpy(m_buffer + m_size, src, bytesToCopy);
+	m_size += bytesToCopy;
+	return bytesToCopy;
+}
+
+//-----------------------------------------------------------------------------------
+CompressedBinaryWriter::CompressedBinaryWriter(IBinaryWriter& target, size_t blockSize)
+	: m_target(target)
+	, m_block(blockSize)
+	, m_blockUsed(0)
+	, m_uncompressedSize(0)
+	, m_isFinished(false)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+CompressedBinaryWriter::~CompressedBinaryWriter()
+{
+	Finish();
+}
+
+//-----------------------------------------------------------------------------------
+size_t CompressedBinaryWriter::WriteBytes(const void* src, const size_t numBytes)
+{
+	if (m_isFinished)
+	{
+		return 0;
+	}
+	const byte* source = static_cast<const byte*>(src);
+	size_t bytesLeft = numBytes;
+	while (bytesLeft > 0)
+	{
+		size_t bytesToCopy = m_block.size() - m_blockUsed < bytesLeft ? m_block.size() - m_blockUsed : bytesLeft;
+		memcpy(m_block.data() + m_blockUsed, source, bytesToCopy);
+		m_blockUsed += bytesToCopy;
+		source += bytesToCopy;
+		bytesLeft -= bytesToCopy;
+		if (m_blockUsed == m_block.size())
+		{
+			CompressBlock();
+		}
+	}
+	m_uncompressedSize += numBytes;
+	return numBytes;
 }
+
+//-----------------------------------------------------------------------------------
+void CompressedBinaryWriter::CompressBlock()
+{
+	size_t offset = m_compressed.size();
+	m_compressed.resize(offset + Compression::GetMaxCompressedBlockSize(m_blockUsed));
+	size_t compressedSize = Compression::CompressBlock(m_block.data(), m_blockUsed, m_compressed.data() + offset, m_compressed.size() - offset);
+	if (compressedSize < m_blockUsed)
+	{
+		m_blockSizes.push_back((uint32_t)compressedSize);
+	}
+	else
+	{
+		//Incompressible, store it so loading it back is just a copy.
+		memcpy(m_compressed.data() + offset, m_block.data(), m_blockUsed);
+		compressedSize = m_blockUsed;
+		m_blockSizes.push_back((uint32_t)compressedSize | Compression::STORED_BLOCK_FLAG);
+	}
+	m_compressed.resize(offset + compressedSize);
+	m_blockUsed = 0;
+}
+
+//-----------------------------------------------------------------------------------
+bool CompressedBinaryWriter::Finish()
+{
+	if (m_isFinished)
+	{
+		return true;
+	}
+	m_isFinished = true;
+	if (m_blockUsed > 0)
+	{
+		CompressBlock();
+	}
+	CompressedStreamHeader header;
+	header.magic = Compression::STREAM_MAGIC;
+	header.version = Compression::STREAM_VERSION;
+	header.uncompressedSize = m_uncompressedSize;
+	header.blockSize = (uint32_t)m_block.size();
+	header.blockCount = (uint32_t)m_blockSizes.size();
+	size_t blockTableSize = m_blockSizes.size() * sizeof(uint32_t);
+	return m_target.WriteBytes(&header, sizeof(header)) == sizeof(header)
+		&& m_target.WriteBytes(m_blockSizes.data(), blockTableSize) == blockTableSize
+		&& m_target.WriteBytes(m_compressed.data(), m_compressed.size()) == m_compressed.size();
+}
+
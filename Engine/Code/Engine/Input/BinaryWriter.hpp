@@ -1,6 +1,14 @@
 #pragma once
 #include <stdio.h>
 #include <stdint.h>
+#include <vector>
+#include <type_traits>
+#include <string.h>
+#include "Engine/Input/ByteSwap.hpp"
+
+//glibc's <endian.h> defines these as macros, which would stomp on the EndianMode enums below.
+#undef LITTLE_ENDIAN
+#undef BIG_ENDIAN
 
 typedef unsigned char byte;
 
@@ -60,18 +68,133 @@ public:
 		return WriteBytes(&copy, sizeof(T)) == sizeof(T);
 	}
 
+	//-----------------------------------------------------------------------------------
+	//Writes count values in one call. Matching endianness goes straight through, otherwise the values are swapped a chunk at a time on the stack.
+	template<typename T>
+	bool WriteArray(const T* data, size_t count)
+	{
+		static_assert(std::is_arithmetic<T>::value, "WriteArray swaps each element as one value, pass structs as an array of their members");
+		if (sizeof(T) == 1 || GetLocalEndianess() == m_endianMode)
+		{
+			return WriteBytes(data, sizeof(T) * count) == sizeof(T) * count;
+		}
+		const size_t CHUNK_COUNT = 1024 / sizeof(T);
+		T chunk[CHUNK_COUNT];
+		for (size_t first = 0; first < count; first += CHUNK_COUNT)
+		{
+			size_t chunkCount = (count - first) < CHUNK_COUNT ? (count - first) : CHUNK_COUNT;
+			memcpy(chunk, data + first, sizeof(T) * chunkCount);
+			ByteSwapArray(chunk, sizeof(T), chunkCount);
+			if (WriteBytes(chunk, sizeof(T) * chunkCount) != sizeof(T) * chunkCount)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------------
+	template<typename T>
+	bool WriteArray(const std::vector<T>& data)
+	{
+		return data.empty() || WriteArray(data.data(), data.size());
+	}
+
 private:
 	EndianMode m_endianMode;
 };
 
+//-----------------------------------------------------------------------------------
+//Collects writes into a block and only hands full blocks to fwrite.
 class BinaryFileWriter : public IBinaryWriter
 {
 public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	BinaryFileWriter(size_t blockSize = DEFAULT_BLOCK_SIZE);
+	~BinaryFileWriter();
+
 	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
 	bool Open(const char* filename, bool append = false);
 	void Close();
+	bool Flush();
 	virtual size_t WriteBytes(const void* src, const size_t numBytes) override;
 
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
 	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
 	FILE* fileHandle;
-};
\ No newline at end of file
+
+private:
+	BinaryFileWriter(const BinaryFileWriter&);
+
+	byte* m_block;
+	size_t m_blockSize;
+	size_t m_blockUsed;
+};
+
+//-----------------------------------------------------------------------------------
+//Writes into memory instead of a file. Either into a fixed buffer the caller owns, where writes past the end come back short,
+//or into an arena that grows as needed and keeps its capacity across Reset, so reused writers stop allocating.
+class BinaryMemoryWriter : public IBinaryWriter
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	BinaryMemoryWriter(size_t initialCapacity = 0);
+	BinaryMemoryWriter(void* buffer, size_t capacity);
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	virtual size_t WriteBytes(const void* src, const size_t numBytes) override;
+	inline void Reset() { m_size = 0; };
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	inline const byte* GetData() const { return m_buffer; };
+	inline size_t GetSize() const { return m_size; };
+	inline size_t GetCapacity() const { return m_capacity; };
+
+private:
+	BinaryMemoryWriter(const BinaryMemoryWriter&);
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	std::vector<byte> m_arena;
+	byte* m_buffer;
+	size_t m_capacity;
+	size_t m_size;
+	bool m_isGrowable;
+};
+
+//-----------------------------------------------------------------------------------
+//Compresses everything written through it into a stream that FileView decompresses transparently on load (see Compression.hpp).
+//Blocks are compressed as they fill, so only the compressed output is held until Finish writes the stream out to the target.
+class CompressedBinaryWriter : public IBinaryWriter
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	CompressedBinaryWriter(IBinaryWriter& target, size_t blockSize = DEFAULT_BLOCK_SIZE);
+	~CompressedBinaryWriter();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	virtual size_t WriteBytes(const void* src, const size_t numBytes) override;
+	//Has to be called before the target is closed. The destructor calls it if nobody did.
+	bool Finish();
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	inline uint64_t GetUncompressedSize() const { return m_uncompressedSize; };
+	inline size_t GetCompressedSize() const { return m_compressed.size(); };
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+private:
+	CompressedBinaryWriter(const CompressedBinaryWriter&);
+	void CompressBlock();
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	IBinaryWriter& m_target;
+	std::vector<byte> m_block;
+	size_t m_blockUsed;
+	std::vector<uint32_t> m_blockSizes;
+	std::vector<byte> m_compressed;
+	uint64_t m_uncompressedSize;
+	bool m_isFinished;
+};
@@ -0,0 +1,77 @@
+#include "Engine/Input/ByteSwap.hpp"
+#include <stdint.h>
+
+//Every x86 target we build for has SSE2, anything else gets the scalar path.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define BYTESWAP_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------------
+static void ByteSwapScalar(unsigned char* data, size_t elementSize, size_t count)
+{
+	for (size_t element = 0; element < count; ++element)
+	{
+		unsigned char* start = data + (element * elementSize);
+		unsigned char* end = start + elementSize - 1;
+		while (start < end)
+		{
+			unsigned char temp = *start;
+			*start = *end;
+			*end = temp;
+			++start;
+			--end;
+		}
+	}
+}
+
+#ifdef BYTESWAP_USE_SSE2
+//-----------------------------------------------------------------------------------
+//SSE2 has no byte shuffle, so swap the bytes inside each 16 bit word with shifts, then shuffle the words around for the wider sizes.
+static inline __m128i SwapBytesInWords(__m128i value)
+{
+	return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+}
+
+//-----------------------------------------------------------------------------------
+static inline __m128i ByteSwapBlock(__m128i value, size_t elementSize)
+{
+	if (elementSize == 4)
+	{
+		value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+		value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+	}
+	else if (elementSize == 8)
+	{
+		value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+		value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+	}
+	return SwapBytesInWords(value);
+}
+#endif
+
+//-----------------------------------------------------------------------------------
+void ByteSwapArray(void* data, size_t elementSize, size_t count)
+{
+	unsigned char* bytes = static_cast<unsigned char*>(data);
+	if (elementSize <= 1)
+	{
+		return;
+	}
+#ifdef BYTESWAP_USE_SSE2
+	if (elementSize == 2 || elementSize == 4 || elementSize == 8)
+	{
+		const size_t numBytes = elementSize * count;
+		size_t offset = 0;
+		for (; offset + 16 <= numBytes; offset += 16)
+		{
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + offset));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + offset), ByteSwapBlock(block, elementSize));
+		}
+		//Blocks are a whole number of elements, so the tail is too.
+		ByteSwapScalar(bytes + offset, elementSize, (numBytes - offset) / elementSize);
+		return;
+	}
+#endif
+	ByteSwapScalar(bytes, elementSize, count);
+}
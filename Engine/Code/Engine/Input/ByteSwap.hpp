@@ -0,0 +1,6 @@
+#pragma once
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------------
+//Reverses the bytes of every element in place. Elements of 2, 4 and 8 bytes go through SSE2 16 bytes at a time, anything else is swapped one element at a time.
+void ByteSwapArray(void* data, size_t elementSize, size_t count);
@@ -0,0 +1,448 @@
+#include "Engine/Input/Compression.hpp"
+#include <string.h>
+#include <atomic>
+#include <thread>
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+//Format limits, these match LZ4's so its block tools can read our blocks.
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5; //The last 5 bytes are always literals.
+static const size_t MATCH_FIND_LIMIT = 12; //No match can start within 12 bytes of the end.
+static const size_t MAX_OFFSET = 65535;
+static const int HASH_LOG = 12;
+static const int SKIP_TRIGGER = 6; //After 2^6 misses in a row start skipping ahead faster through incompressible data.
+static const uint64_t MAX_EXPANSION = 255; //No encoded byte can turn into more than 255 decoded ones.
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t Read32(const byte* pointer)
+{
+	uint32_t value;
+	memcpy(&value, pointer, sizeof(value));
+	return value;
+}
+
+//-----------------------------------------------------------------------------------
+static inline uint64_t Read64(const byte* pointer)
+{
+	uint64_t value;
+	memcpy(&value, pointer, sizeof(value));
+	return value;
+}
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t HashSequence(uint32_t sequence)
+{
+	return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+//-----------------------------------------------------------------------------------
+static inline unsigned int CountTrailingZeroBytes(uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index >> 3;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, (uint32_t)value))
+	{
+		return index >> 3;
+	}
+	_BitScanForward(&index, (uint32_t)(value >> 32));
+	return (index >> 3) + 4;
+#else
+	return __builtin_ctzll(value) >> 3;
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+//Compares 8 bytes at a time, so long matches cost a few instructions per 8 bytes instead of a branch per byte.
+static inline size_t CountMatchingBytes(const byte* current, const byte* match, const byte* limit)
+{
+	const byte* start = current;
+	while (current + sizeof(uint64_t) <= limit)
+	{
+		uint64_t difference = Read64(current) ^ Read64(match);
+		if (difference != 0)
+		{
+			return (current - start) + CountTrailingZeroBytes(difference);
+		}
+		current += sizeof(uint64_t);
+		match += sizeof(uint64_t);
+	}
+	while (current < limit && *current == *match)
+	{
+		++current;
+		++match;
+	}
+	return current - start;
+}
+
+//-----------------------------------------------------------------------------------
+static inline byte* WriteExtraLength(byte* output, size_t length)
+{
+	while (length >= 255)
+	{
+		*output++ = 255;
+		length -= 255;
+	}
+	*output++ = (byte)length;
+	return output;
+}
+
+//-----------------------------------------------------------------------------------
+static inline bool ReadExtraLength(const byte*& input, const byte* inputEnd, size_t& length)
+{
+	byte value;
+	do
+	{
+		if (input >= inputEnd)
+		{
+			return false;
+		}
+		value = *input++;
+		length += value;
+	} while (value == 255);
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+static inline byte* WriteLiterals(byte* output, byte* token, const byte* literals, size_t literalLength)
+{
+	if (literalLength >= 15)
+	{
+		*token = 15 << 4;
+		output = WriteExtraLength(output, literalLength - 15);
+	}
+	else
+	{
+		*token = (byte)(literalLength << 4);
+	}
+	memcpy(output, literals, literalLength);
+	return output + literalLength;
+}
+
+//-----------------------------------------------------------------------------------
+size_t Compression::GetMaxCompressedBlockSize(size_t uncompressedSize)
+{
+	return uncompressedSize + (uncompressedSize / 255) + 16;
+}
+
+//-----------------------------------------------------------------------------------
+size_t Compression::CompressBlock(const byte* src, size_t srcSize, byte* dst, size_t dstCapacity)
+{
+	if (dstCapacity < GetMaxCompressedBlockSize(srcSize))
+	{
+		return 0;
+	}
+	const byte* const end = src + srcSize;
+	const byte* anchor = src;
+	byte* output = dst;
+
+	if (srcSize > MATCH_FIND_LIMIT)
+	{
+		const byte* const matchLimit = end - LAST_LITERALS;
+		const byte* const lastMatchStart = end - MATCH_FIND_LIMIT;
+		//Positions are relative to src, a stale or zeroed entry just fails the compare below.
+		uint32_t hashTable[1 << HASH_LOG];
+		memset(hashTable, 0, sizeof(hashTable));
+		const byte* current = src + 1;
+
+		while (current <= lastMatchStart)
+		{
+			const byte* match = nullptr;
+			unsigned int misses = 0;
+			while (current <= lastMatchStart)
+			{
+				uint32_t sequence = Read32(current);
+				uint32_t hash = HashSequence(sequence);
+				const byte* candidate = src + hashTable[hash];
+				hashTable[hash] = (uint32_t)(current - src);
+				if (candidate < current && (size_t)(current - candidate) <= MAX_OFFSET && Read32(candidate) == sequence)
+				{
+					match = candidate;
+					break;
+				}
+				current += 1 + (misses++ >> SKIP_TRIGGER);
+			}
+			if (!match)
+			{
+				break;
+			}
+
+			//Pull the match start back over any literals that also match.
+			while (current > anchor && match > src && current[-1] == match[-1])
+			{
+				--current;
+				--match;
+			}
+			size_t matchLength = MIN_MATCH + CountMatchingBytes(current + MIN_MATCH, match + MIN_MATCH, matchLimit);
+
+			byte* token = output++;
+			output = WriteLiterals(output, token, anchor, current - anchor);
+			size_t offset = current - match;
+			*output++ = (byte)(offset & 0xFF);
+			*output++ = (byte)(offset >> 8);
+			size_t extraMatchLength = matchLength - MIN_MATCH;
+			if (extraMatchLength >= 15)
+			{
+				*token |= 15;
+				output = WriteExtraLength(output, extraMatchLength - 15);
+			}
+			else
+			{
+				*token |= (byte)extraMatchLength;
+			}
+
+			current += matchLength;
+			anchor = current;
+			if (current <= lastMatchStart)
+			{
+				//Index a position inside the match we skipped over, repeats often pick up right where the last one ended.
+				hashTable[HashSequence(Read32(current - 2))] = (uint32_t)(current - 2 - src);
+			}
+		}
+	}
+
+	byte* token = output++;
+	output = WriteLiterals(output, token, anchor, end - anchor);
+	return output - dst;
+}
+
+//-----------------------------------------------------------------------------------
+bool Compression::DecompressBlock(const byte* src, size_t srcSize, byte* dst, size_t dstSize)
+{
+	const byte* input = src;
+	const byte* const inputEnd = src + srcSize;
+	byte* output = dst;
+	byte* const outputEnd = dst + dstSize;
+
+	while (input < inputEnd)
+	{
+		unsigned int token = *input++;
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !ReadExtraLength(input, inputEnd, literalLength))
+		{
+			return false;
+		}
+		//Short literal runs are the common case, copy a fixed 16 bytes while there's room to overshoot on both sides.
+		if (literalLength <= 16 && inputEnd - input >= 16 && outputEnd - output >= 16)
+		{
+			memcpy(output, input, 16);
+		}
+		else
+		{
+			if (literalLength > (size_t)(inputEnd - input) || literalLength > (size_t)(outputEnd - output))
+			{
+				return false;
+			}
+			memcpy(output, input, literalLength);
+		}
+		input += literalLength;
+		output += literalLength;
+		if (input == inputEnd)
+		{
+			//The last sequence is literals only.
+			break;
+		}
+
+		if (inputEnd - input < 2)
+		{
+			return false;
+		}
+		size_t offset = input[0] | (input[1] << 8);
+		input += 2;
+		if (offset == 0 || offset > (size_t)(output - dst))
+		{
+			return false;
+		}
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !ReadExtraLength(input, inputEnd, matchLength))
+		{
+			return false;
+		}
+		matchLength += MIN_MATCH;
+		if (matchLength > (size_t)(outputEnd - output))
+		{
+			return false;
+		}
+
+		const byte* match = output - offset;
+		byte* const matchEnd = output + matchLength;
+		if (offset >= sizeof(uint64_t) && (size_t)(outputEnd - output) >= matchLength + sizeof(uint64_t))
+		{
+			//Far enough back that 8 byte chunks never read bytes this copy hasn't written yet.
+			do
+			{
+				memcpy(output, match, sizeof(uint64_t));
+				output += sizeof(uint64_t);
+				match += sizeof(uint64_t);
+			} while (output < matchEnd);
+		}
+		else
+		{
+			//Overlapping matches repeat the last few bytes, which has to go a byte at a time.
+			while (output < matchEnd)
+			{
+				*output++ = *match++;
+			}
+		}
+		output = matchEnd;
+	}
+	return output == outputEnd;
+}
+
+//-----------------------------------------------------------------------------------
+bool Compression::IsCompressedStream(const void* data, size_t size)
+{
+	if (size < sizeof(CompressedStreamHeader))
+	{
+		return false;
+	}
+	uint32_t magic;
+	memcpy(&magic, data, sizeof(magic));
+	return magic == STREAM_MAGIC;
+}
+
+//-----------------------------------------------------------------------------------
+uint64_t Compression::GetDecompressedSize(const void* data, size_t size)
+{
+	if (!IsCompressedStream(data, size))
+	{
+		return 0;
+	}
+	CompressedStreamHeader header;
+	memcpy(&header, data, sizeof(header));
+	return header.uncompressedSize;
+}
+
+//-----------------------------------------------------------------------------------
+//Checks the header and the whole block table against the size of the data before anything gets allocated or decoded,
+//since the sizes all come straight out of a file. Fills in where every block starts, plus one past the end of the last.
+static bool ReadBlockTable(const void* data, size_t size, CompressedStreamHeader& outHeader, std::vector<uint64_t>& outBlockOffsets)
+{
+	if (!Compression::IsCompressedStream(data, size))
+	{
+		return false;
+	}
+	memcpy(&outHeader, data, sizeof(outHeader));
+	if (outHeader.version > Compression::STREAM_VERSION || outHeader.blockSize == 0)
+	{
+		return false;
+	}
+	uint64_t blockCount = (outHeader.uncompressedSize / outHeader.blockSize) + ((outHeader.uncompressedSize % outHeader.blockSize) != 0 ? 1 : 0);
+	uint64_t blockTableEnd = sizeof(outHeader) + ((uint64_t)outHeader.blockCount * sizeof(uint32_t));
+	if (outHeader.blockCount != blockCount || blockTableEnd > size)
+	{
+		return false;
+	}
+
+	//Every block has to fit in the data, and has to be able to decode to its share of uncompressedSize.
+	const byte* bytes = static_cast<const byte*>(data);
+	outBlockOffsets.resize(outHeader.blockCount + 1);
+	outBlockOffsets[0] = blockTableEnd;
+	uint64_t remainingSize = outHeader.uncompressedSize;
+	for (uint32_t i = 0; i < outHeader.blockCount; ++i)
+	{
+		uint32_t blockSize = Read32(bytes + sizeof(outHeader) + (i * sizeof(uint32_t)));
+		uint64_t compressedSize = blockSize & ~Compression::STORED_BLOCK_FLAG;
+		uint64_t uncompressedSize = remainingSize < outHeader.blockSize ? remainingSize : outHeader.blockSize;
+		bool isStored = (blockSize & Compression::STORED_BLOCK_FLAG) != 0;
+		if ((isStored && compressedSize != uncompressedSize) || (!isStored && uncompressedSize > compressedSize * MAX_EXPANSION))
+		{
+			return false;
+		}
+		outBlockOffsets[i + 1] = outBlockOffsets[i] + compressedSize;
+		if (outBlockOffsets[i + 1] > size)
+		{
+			return false;
+		}
+		remainingSize -= uncompressedSize;
+	}
+	return remainingSize == 0;
+}
+
+//-----------------------------------------------------------------------------------
+bool Compression::DecompressStream(const void* data, size_t size, byte* outData, size_t outSize)
+{
+	//Work out where every block starts up front, so the threads don't depend on each other at all.
+	CompressedStreamHeader header;
+	std::vector<uint64_t> blockOffsets;
+	if (!ReadBlockTable(data, size, header, blockOffsets) || header.uncompressedSize != outSize)
+	{
+		return false;
+	}
+	const byte* bytes = static_cast<const byte*>(data);
+
+	std::atomic<uint32_t> nextBlock(0);
+	std::atomic<bool> failed(false);
+	auto decodeBlocks = [&]()
+	{
+		for (uint32_t i = nextBlock++; i < header.blockCount && !failed; i = nextBlock++)
+		{
+			uint32_t blockSize;
+			memcpy(&blockSize, bytes + sizeof(header) + (i * sizeof(uint32_t)), sizeof(blockSize));
+			const byte* blockData = bytes + blockOffsets[i];
+			size_t compressedSize = (size_t)(blockOffsets[i + 1] - blockOffsets[i]);
+			size_t uncompressedOffset = (size_t)i * header.blockSize;
+			size_t uncompressedSize = (size_t)(outSize - uncompressedOffset) < header.blockSize ? (size_t)(outSize - uncompressedOffset) : header.blockSize;
+			if ((blockSize & STORED_BLOCK_FLAG) != 0)
+			{
+				//ReadBlockTable already made sure stored blocks are exactly the right size.
+				memcpy(outData + uncompressedOffset, blockData, uncompressedSize);
+			}
+			else if (!DecompressBlock(blockData, compressedSize, outData + uncompressedOffset, uncompressedSize))
+			{
+				failed = true;
+				return;
+			}
+		}
+	};
+
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	if (header.blockCount >= MIN_BLOCKS_FOR_PARALLEL_DECODE && threadCount > 1)
+	{
+		if (threadCount > header.blockCount / 2)
+		{
+			threadCount = header.blockCount / 2;
+		}
+		//This thread decodes too, so it only needs threadCount - 1 helpers.
+		std::vector<std::thread> helpers;
+		helpers.reserve(threadCount - 1);
+		for (unsigned int i = 1; i < threadCount; ++i)
+		{
+			helpers.emplace_back(decodeBlocks);
+		}
+		decodeBlocks();
+		for (std::thread& helper : helpers)
+		{
+			helper.join();
+		}
+	}
+	else
+	{
+		decodeBlocks();
+	}
+	return !failed;
+}
+
+//-----------------------------------------------------------------------------------
+bool Compression::DecompressStream(const void* data, size_t size, std::vector<byte>& outData)
+{
+	//Don't trust the header's size with an allocation until the block table backs it up.
+	CompressedStreamHeader header;
+	std::vector<uint64_t> blockOffsets;
+	if (!ReadBlockTable(data, size, header, blockOffsets) || header.uncompressedSize > (uint64_t)SIZE_MAX)
+	{
+		return false;
+	}
+	outData.resize((size_t)header.uncompressedSize);
+	if (!DecompressStream(data, size, outData.data(), outData.size()))
+	{
+		outData.clear();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+typedef unsigned char byte;
+
+//-----------------------------------------------------------------------------------
+//A compressed stream is this header, a table with the compressed size of every block, then the blocks back to back.
+//Blocks don't reference each other, so they can be decoded in any order on any thread.
+struct CompressedStreamHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t uncompressedSize;
+	uint32_t blockSize;
+	uint32_t blockCount;
+};
+
+//-----------------------------------------------------------------------------------
+//Greedy LZ77 with a single hash probe per position, in the LZ4 block format: a token with literal and match lengths,
+//the literals, then a 16 bit offset back into what's been decoded so far. It only wins on data that repeats itself
+//(constant bone tracks, runs of the same bone indices, zeroed padding), which is what our cooked assets are full of.
+namespace Compression
+{
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	size_t GetMaxCompressedBlockSize(size_t uncompressedSize);
+	//Returns the compressed size, dst needs room for GetMaxCompressedBlockSize(srcSize) bytes.
+	size_t CompressBlock(const byte* src, size_t srcSize, byte* dst, size_t dstCapacity);
+	//Fails on corrupt data instead of reading or writing out of bounds. dstSize has to be exactly the uncompressed size.
+	bool DecompressBlock(const byte* src, size_t srcSize, byte* dst, size_t dstSize);
+
+	bool IsCompressedStream(const void* data, size_t size);
+	uint64_t GetDecompressedSize(const void* data, size_t size);
+	//Big streams are decoded across every core, each thread taking the next block until they're gone.
+	bool DecompressStream(const void* data, size_t size, byte* outData, size_t outSize);
+	bool DecompressStream(const void* data, size_t size, std::vector<byte>& outData);
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const uint32_t STREAM_MAGIC = 0x5A4C5050; //"PPLZ"
+	static const uint32_t STREAM_VERSION = 1;
+	static const uint32_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+	//Set on a block table entry when the block didn't get any smaller and was stored as is.
+	static const uint32_t STORED_BLOCK_FLAG = 0x80000000;
+	//Below this many blocks, starting threads costs more than decoding on this one.
+	static const uint32_t MIN_BLOCKS_FOR_PARALLEL_DECODE = 8;
+}
@@ -2,7 +2,7 @@
 #include <vector>
 #include <map>
 #include <string>
-#include "Engine\Renderer\RGBA.hpp"
+#include "Engine/Renderer/RGBA.hpp"
 //-----------------------------------------------------------------------------------------------
 #define UNUSED(x) (void)(x);
 
@@ -74,6 +74,7 @@ public:
 	Command(std::string fullCommandStr); //Split name and args into two buffers
 	inline std::string GetCommandName() const { return m_commandName; };
 	inline bool HasArgs(int argNumber) const { return m_argsList.size() == (unsigned int)argNumber; };
+	inline unsigned int GetNumArgs() const { return m_argsList.size(); };
 	inline std::string GetStringArgument(int argNumber) const { return m_argsList[argNumber]; };
 	inline int GetIntArgument(int argNumber) const { return std::stoi(m_argsList[argNumber]); };
 	float GetFloatArgument(int argNumber) const { return std::stof(m_argsList[argNumber]); };
@@ -98,6 +99,6 @@ public:
 };
 
 //Macro that allows us to define a console command from anywhere
-#define CONSOLE_COMMAND(name) void ConsoleCommand_ ## name ## ( Command & args ); \
-	static RegisterCommandHelper RegistrationHelper_ ## name ##( #name, ConsoleCommand_ ## name ## ); \
-	void ConsoleCommand_ ## name ##(Command &args)
+#define CONSOLE_COMMAND(name) void ConsoleCommand_ ## name ( Command & args ); \
+	static RegisterCommandHelper RegistrationHelper_ ## name ( #name, ConsoleCommand_ ## name ); \
+	void ConsoleCommand_ ## name (Command &args)
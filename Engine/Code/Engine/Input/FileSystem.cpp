@@ -0,0 +1,143 @@
+#include "Engine/Input/FileSystem.hpp"
+#include <algorithm>
+#include <errno.h>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#include <direct.h>
+#else
+	#include <sys/stat.h>
+	#include <sys/types.h>
+	#include <dirent.h>
+#endif
+
+#if defined(_WIN32)
+//-----------------------------------------------------------------------------------
+static void ListFilesInto(const std::string& directory, std::vector<FileListing>& outFiles)
+{
+	WIN32_FIND_DATAA findData;
+	HANDLE findHandle = FindFirstFileA((directory + "/*").c_str(), &findData);
+	if (findHandle == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	do
+	{
+		std::string name = findData.cFileName;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		std::string path = directory + "/" + name;
+		if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+		{
+			ListFilesInto(path, outFiles);
+		}
+		else
+		{
+			FileListing file;
+			file.path = path;
+			file.size = ((uint64_t)findData.nFileSizeHigh << 32) | findData.nFileSizeLow;
+			outFiles.push_back(file);
+		}
+	} while (FindNextFileA(findHandle, &findData) != 0);
+	FindClose(findHandle);
+}
+
+//-----------------------------------------------------------------------------------
+static bool MakeDirectory(const std::string& directoryPath)
+{
+	return _mkdir(directoryPath.c_str()) == 0 || errno == EEXIST;
+}
+
+//-----------------------------------------------------------------------------------
+bool IsFileOnDisk(const std::string& filePath)
+{
+	DWORD attributes = GetFileAttributesA(filePath.c_str());
+	return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+}
+
+#else
+//-----------------------------------------------------------------------------------
+static void ListFilesInto(const std::string& directory, std::vector<FileListing>& outFiles)
+{
+	DIR* directoryHandle = opendir(directory.c_str());
+	if (directoryHandle == nullptr)
+	{
+		return;
+	}
+	while (dirent* entry = readdir(directoryHandle))
+	{
+		std::string name = entry->d_name;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		std::string path = directory + "/" + name;
+		struct stat fileStatus;
+		if (stat(path.c_str(), &fileStatus) != 0)
+		{
+			continue;
+		}
+		if (S_ISDIR(fileStatus.st_mode))
+		{
+			ListFilesInto(path, outFiles);
+		}
+		else if (S_ISREG(fileStatus.st_mode))
+		{
+			FileListing file;
+			file.path = path;
+			file.size = (uint64_t)fileStatus.st_size;
+			outFiles.push_back(file);
+		}
+	}
+	closedir(directoryHandle);
+}
+
+//-----------------------------------------------------------------------------------
+static bool MakeDirectory(const std::string& directoryPath)
+{
+	return mkdir(directoryPath.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+//-----------------------------------------------------------------------------------
+bool IsFileOnDisk(const std::string& filePath)
+{
+	struct stat fileStatus;
+	return stat(filePath.c_str(), &fileStatus) == 0 && S_ISREG(fileStatus.st_mode);
+}
+#endif
+
+//-----------------------------------------------------------------------------------
+void ListFilesRecursive(const std::string& directory, std::vector<FileListing>& outFiles)
+{
+	size_t firstNewFile = outFiles.size();
+	ListFilesInto(directory, outFiles);
+	std::sort(outFiles.begin() + firstNewFile, outFiles.end(), [](const FileListing& first, const FileListing& second)
+	{
+		return first.path < second.path;
+	});
+}
+
+//-----------------------------------------------------------------------------------
+//Made one level at a time from the front, another thread making the same directory first isn't an error.
+bool CreateDirectories(const std::string& directoryPath)
+{
+	for (size_t i = 1; i <= directoryPath.size(); ++i)
+	{
+		if (i == directoryPath.size() || directoryPath[i] == '/' || directoryPath[i] == '\\')
+		{
+			std::string parentPath = directoryPath.substr(0, i);
+			if (parentPath == "." || parentPath == ".." || (parentPath.size() == 2 && parentPath[1] == ':'))
+			{
+				continue;
+			}
+			if (!MakeDirectory(parentPath))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------
+struct FileListing
+{
+	std::string path;
+	uint64_t size;
+};
+
+//-----------------------------------------------------------------------------------
+//The few directory operations the tools need, on Windows and POSIX. Paths are used relative to the working directory
+//exactly as they're passed in, and come back with forward slashes.
+
+//Every file under the directory and its subdirectories, sorted by path so builds come out the same on every machine.
+void ListFilesRecursive(const std::string& directory, std::vector<FileListing>& outFiles);
+//Creates the directory and any of its parents that don't exist yet. True if it exists afterwards.
+bool CreateDirectories(const std::string& directoryPath);
+//Only checks the disk, unlike FileExists which also looks in the mounted archives.
+bool IsFileOnDisk(const std::string& filePath);
@@ -0,0 +1,139 @@
+#include "Engine/Input/FileView.hpp"
+#include "Engine/Input/BinaryReader.hpp"
+#include "Engine/Input/AssetArchive.hpp"
+#include "Engine/Input/Compression.hpp"
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+bool StringView::StartsWith(const char* prefix) const
+{
+	size_t prefixLength = strlen(prefix);
+	return prefixLength <= length && memcmp(data, prefix, prefixLength) == 0;
+}
+
+//-----------------------------------------------------------------------------------
+FileView::FileView()
+	: m_data(nullptr)
+	, m_size(0)
+	, m_isOpen(false)
+	, m_isInArchive(false)
+	, m_wasCompressed(false)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+FileView::FileView(const char* filePath)
+	: m_data(nullptr)
+	, m_size(0)
+	, m_isOpen(false)
+	, m_isInArchive(false)
+	, m_wasCompressed(false)
+{
+	Open(filePath);
+}
+
+//-----------------------------------------------------------------------------------
+bool FileView::Open(const char* filePath, bool allowMapping)
+{
+	Close();
+	ByteSpan archivedFile;
+	if (AssetArchive::FindInMounted(filePath, archivedFile))
+	{
+		m_data = archivedFile.data;
+		m_size = archivedFile.size;
+		m_isOpen = true;
+		m_isInArchive = true;
+		return DecompressIfNeeded();
+	}
+	return OpenFromDisk(filePath, allowMapping);
+}
+
+//-----------------------------------------------------------------------------------
+bool FileView::OpenFromDisk(const char* filePath, bool allowMapping)
+{
+	Close();
+	if (allowMapping && m_mapping.Open(filePath))
+	{
+		m_data = m_mapping.GetData();
+		m_size = m_mapping.GetSize();
+		m_isOpen = true;
+		return DecompressIfNeeded();
+	}
+
+	//Couldn't (or weren't allowed to) map it, so fall back to reading the whole thing in one block.
+	BinaryFileReader reader;
+	if (!reader.Open(filePath))
+	{
+		return false;
+	}
+	fseek(reader.fileHandle, 0, SEEK_END);
+	long fileSize = ftell(reader.fileHandle);
+	rewind(reader.fileHandle);
+	m_buffer.resize(fileSize > 0 ? (size_t)fileSize : 0);
+	size_t bytesRead = m_buffer.empty() ? 0 : reader.ReadBytes(m_buffer.data(), m_buffer.size());
+	reader.Close();
+	if (bytesRead != m_buffer.size())
+	{
+		m_buffer.clear();
+		return false;
+	}
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+	m_isOpen = true;
+	return DecompressIfNeeded();
+}
+
+//-----------------------------------------------------------------------------------
+bool FileView::DecompressIfNeeded()
+{
+	if (!Compression::IsCompressedStream(m_data, m_size))
+	{
+		return true;
+	}
+	//The compressed bytes might live in m_buffer, so decompress somewhere else and swap it in.
+	std::vector<byte> decompressed;
+	bool succeeded = Compression::DecompressStream(m_data, m_size, decompressed);
+	Close();
+	if (!succeeded)
+	{
+		return false;
+	}
+	m_buffer.swap(decompressed);
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+	m_isOpen = true;
+	m_wasCompressed = true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+void FileView::Close()
+{
+	m_mapping.Close();
+	std::vector<byte>().swap(m_buffer);
+	m_data = nullptr;
+	m_size = 0;
+	m_isOpen = false;
+	m_isInArchive = false;
+	m_wasCompressed = false;
+}
+
+//-----------------------------------------------------------------------------------
+bool LineIterator::GetNextLine(StringView& outLine)
+{
+	if (m_current >= m_end)
+	{
+		return false;
+	}
+	const char* lineStart = m_current;
+	const char* newline = static_cast<const char*>(memchr(m_current, '\n', m_end - m_current));
+	const char* lineEnd = newline ? newline : m_end;
+	m_current = newline ? newline + 1 : m_end;
+	if (lineEnd > lineStart && *(lineEnd - 1) == '\r')
+	{
+		--lineEnd;
+	}
+	outLine = StringView(lineStart, lineEnd - lineStart);
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "Engine/Input/MappedFile.hpp"
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------
+//A run of bytes owned by something else (ie: a FileView), only valid as long as its owner is.
+struct ByteSpan
+{
+	ByteSpan() : data(nullptr), size(0) {};
+	ByteSpan(const byte* data, size_t size) : data(data), size(size) {};
+	inline const byte* begin() const { return data; };
+	inline const byte* end() const { return data + size; };
+	inline bool IsEmpty() const { return size == 0; };
+
+	const byte* data;
+	size_t size;
+};
+
+//-----------------------------------------------------------------------------------
+//Non-owning, not null terminated, piece of text.
+struct StringView
+{
+	StringView() : data(nullptr), length(0) {};
+	StringView(const char* data, size_t length) : data(data), length(length) {};
+	inline bool IsEmpty() const { return length == 0; };
+	inline std::string ToString() const { return std::string(data, length); };
+	bool StartsWith(const char* prefix) const;
+
+	const char* data;
+	size_t length;
+};
+
+//-----------------------------------------------------------------------------------
+//Read-only view of a whole file. Maps the file when it can, and otherwise reads it into a buffer the view owns,
+//so either way loaders get the file's bytes without copying them themselves. The FileView is the lifetime handle:
+//every span, view and pointer it hands out is good until it's closed or destroyed.
+//Open looks in the mounted AssetArchives first, a file found there is a view straight into the archive (good until it's unmounted).
+//Files written through a CompressedBinaryWriter are decompressed into the view's own buffer, loaders only ever see the original bytes.
+class FileView
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	FileView();
+	FileView(const char* filePath);
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	bool Open(const char* filePath, bool allowMapping = true);
+	bool OpenFromDisk(const char* filePath, bool allowMapping = true);
+	void Close();
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	inline ByteSpan GetSpan() const { return ByteSpan(m_data, m_size); };
+	inline const byte* GetData() const { return m_data; };
+	inline size_t GetSize() const { return m_size; };
+	inline StringView GetText() const { return StringView(reinterpret_cast<const char*>(m_data), m_size); };
+	inline bool IsOpen() const { return m_isOpen; };
+	inline bool IsMapped() const { return m_mapping.IsOpen(); };
+	inline bool IsInArchive() const { return m_isInArchive; };
+	inline bool WasCompressed() const { return m_wasCompressed; };
+
+private:
+	FileView(const FileView&);
+	FileView& operator=(const FileView&);
+	bool DecompressIfNeeded();
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	MappedFile m_mapping;
+	std::vector<byte> m_buffer;
+	const byte* m_data;
+	size_t m_size;
+	bool m_isOpen;
+	bool m_isInArchive;
+	bool m_wasCompressed;
+};
+
+//-----------------------------------------------------------------------------------
+//Walks text a line at a time without copying it. Handles \n and \r\n endings, neither is included in the lines it hands out.
+class LineIterator
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	LineIterator(const StringView& text) : m_current(text.data), m_end(text.data + text.length) {};
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	bool GetNextLine(StringView& outLine);
+
+private:
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	const char* m_current;
+	const char* m_end;
+};
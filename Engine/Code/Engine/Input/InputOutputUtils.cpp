@@ -1,5 +1,6 @@
 #include "Engine/Input/InputOutputUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Input/AssetArchive.hpp"
 #include <windows.h>
 #include <strsafe.h>
 #include <fstream>
@@ -113,6 +114,11 @@ std::vector<std::string>* GetFileNamesInFolder(const std::string& filePathSearch
 //Modified from http://www.cplusplus.com/forum/general/1796/
 bool FileExists(const std::string& filename)
 {
+	ByteSpan archivedFile;
+	if (AssetArchive::FindInMounted(filename.c_str(), archivedFile))
+	{
+		return true;
+	}
 	std::ifstream ifile(filename);
 	return (bool)ifile;
 }
\ No newline at end of file
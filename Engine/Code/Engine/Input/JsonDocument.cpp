@@ -0,0 +1,459 @@
+#include "Engine/Input/JsonDocument.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+const JsonValue JsonValue::NULL_VALUE;
+
+//-----------------------------------------------------------------------------------
+//Recursive descent over the whole text. Stops at the first error, which is reported with its byte offset.
+class JsonParser
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	JsonParser(const char* text, size_t length) : m_start(text), m_current(text), m_end(text + length), m_errorOffset(0) {};
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	bool ParseDocument(JsonValue& outRoot)
+	{
+		SkipWhitespace();
+		if (!ParseValue(outRoot, 0))
+		{
+			return false;
+		}
+		SkipWhitespace();
+		return m_current == m_end || Fail("Unexpected characters after the document");
+	}
+
+	//-----------------------------------------------------------------------------------
+	std::string GetError() const
+	{
+		return m_error + " at byte " + std::to_string(m_errorOffset);
+	}
+
+private:
+	//HELPER FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	bool Fail(const char* message)
+	{
+		m_error = message;
+		m_errorOffset = m_current - m_start;
+		return false;
+	}
+
+	//-----------------------------------------------------------------------------------
+	void SkipWhitespace()
+	{
+		while (m_current < m_end && (*m_current == ' ' || *m_current == '\t' || *m_current == '\n' || *m_current == '\r'))
+		{
+			++m_current;
+		}
+	}
+
+	//-----------------------------------------------------------------------------------
+	bool ConsumeLiteral(const char* literal)
+	{
+		size_t length = strlen(literal);
+		if ((size_t)(m_end - m_current) < length || memcmp(m_current, literal, length) != 0)
+		{
+			return Fail("Unknown literal");
+		}
+		m_current += length;
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------------
+	bool ParseValue(JsonValue& outValue, unsigned int depth)
+	{
+		if (depth >= JsonValue::MAX_DEPTH)
+		{
+			return Fail("Nested too deeply");
+		}
+		if (m_current >= m_end)
+		{
+			return Fail("Expected a value");
+		}
+		switch (*m_current)
+		{
+		case '{':
+			return ParseObject(outValue, depth);
+		case '[':
+			return ParseArray(outValue, depth);
+		case '"':
+			outValue.m_type = JsonValue::JSON_STRING;
+			return ParseString(outValue.m_string);
+		case 't':
+			outValue.m_type = JsonValue::JSON_BOOL;
+			outValue.m_number = 1.0;
+			return ConsumeLiteral("true");
+		case 'f':
+			outValue.m_type = JsonValue::JSON_BOOL;
+			outValue.m_number = 0.0;
+			return ConsumeLiteral("false");
+		case 'n':
+			outValue.m_type = JsonValue::JSON_NULL;
+			return ConsumeLiteral("null");
+		default:
+			return ParseNumber(outValue);
+		}
+	}
+
+	//-----------------------------------------------------------------------------------
+	bool ParseObject(JsonValue& outValue, unsigned int depth)
+	{
+		outValue.m_type = JsonValue::JSON_OBJECT;
+		++m_current;
+		SkipWhitespace();
+		if (m_current < m_end && *m_current == '}')
+		{
+			++m_current;
+			return true;
+		}
+		while (true)
+		{
+			SkipWhitespace();
+			if (m_current >= m_end || *m_current != '"')
+			{
+				return Fail("Expected a member name");
+			}
+			outValue.m_keys.emplace_back();
+			if (!ParseString(outValue.m_keys.back()))
+			{
+				return false;
+			}
+			SkipWhitespace();
+			if (m_current >= m_end || *m_current != ':')
+			{
+				return Fail("Expected ':' after a member name");
+			}
+			++m_current;
+			SkipWhitespace();
+			outValue.m_elements.emplace_back();
+			if (!ParseValue(outValue.m_elements.back(), depth + 1))
+			{
+				return false;
+			}
+			SkipWhitespace();
+			if (m_current < m_end && *m_current == ',')
+			{
+				++m_current;
+				continue;
+			}
+			if (m_current < m_end && *m_current == '}')
+			{
+				++m_current;
+				return true;
+			}
+			return Fail("Expected ',' or '}' in an object");
+		}
+	}
+
+	//-----------------------------------------------------------------------------------
+	bool ParseArray(JsonValue& outValue, unsigned int depth)
+	{
+		outValue.m_type = JsonValue::JSON_ARRAY;
+		++m_current;
+		SkipWhitespace();
+		if (m_current < m_end && *m_current == ']')
+		{
+			++m_current;
+			return true;
+		}
+		while (true)
+		{
+			SkipWhitespace();
+			outValue.m_elements.emplace_back();
+			if (!ParseValue(outValue.m_elements.back(), depth + 1))
+			{
+				return false;
+			}
+			SkipWhitespace();
+			if (m_current < m_end && *m_current == ',')
+			{
+				++m_current;
+				continue;
+			}
+			if (m_current < m_end && *m_current == ']')
+			{
+				++m_current;
+				return true;
+			}
+			return Fail("Expected ',' or ']' in an array");
+		}
+	}
+
+	//-----------------------------------------------------------------------------------
+	bool ParseHex4(unsigned int& outCodePoint)
+	{
+		if (m_end - m_current < 4)
+		{
+			return Fail("Truncated \\u escape");
+		}
+		outCodePoint = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			char c = *m_current++;
+			outCodePoint <<= 4;
+			if (c >= '0' && c <= '9')
+			{
+				outCodePoint |= c - '0';
+			}
+			else if (c >= 'a' && c <= 'f')
+			{
+				outCodePoint |= c - 'a' + 10;
+			}
+			else if (c >= 'A' && c <= 'F')
+			{
+				outCodePoint |= c - 'A' + 10;
+			}
+			else
+			{
+				return Fail("Bad hex digit in a \\u escape");
+			}
+		}
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------------
+	static void AppendUtf8(std::string& outString, unsigned int codePoint)
+	{
+		if (codePoint < 0x80)
+		{
+			outString += (char)codePoint;
+		}
+		else if (codePoint < 0x800)
+		{
+			outString += (char)(0xC0 | (codePoint >> 6));
+			outString += (char)(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000)
+		{
+			outString += (char)(0xE0 | (codePoint >> 12));
+			outString += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+			outString += (char)(0x80 | (codePoint & 0x3F));
+		}
+		else
+		{
+			outString += (char)(0xF0 | (codePoint >> 18));
+			outString += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+			outString += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+			outString += (char)(0x80 | (codePoint & 0x3F));
+		}
+	}
+
+	//-----------------------------------------------------------------------------------
+	//Escapes are decoded to UTF-8, everything else is copied through a run at a time.
+	bool ParseString(std::string& outString)
+	{
+		++m_current;
+		while (true)
+		{
+			const char* runStart = m_current;
+			while (m_current < m_end && *m_current != '"' && *m_current != '\\' && (unsigned char)*m_current >= 0x20)
+			{
+				++m_current;
+			}
+			outString.append(runStart, m_current - runStart);
+			if (m_current >= m_end)
+			{
+				return Fail("Unterminated string");
+			}
+			char c = *m_current++;
+			if (c == '"')
+			{
+				return true;
+			}
+			if (c != '\\')
+			{
+				--m_current;
+				return Fail("Control character in a string");
+			}
+			if (m_current >= m_end)
+			{
+				return Fail("Unterminated string");
+			}
+			c = *m_current++;
+			switch (c)
+			{
+			case '"': outString += '"'; break;
+			case '\\': outString += '\\'; break;
+			case '/': outString += '/'; break;
+			case 'b': outString += '\b'; break;
+			case 'f': outString += '\f'; break;
+			case 'n': outString += '\n'; break;
+			case 'r': outString += '\r'; break;
+			case 't': outString += '\t'; break;
+			case 'u':
+			{
+				unsigned int codePoint = 0;
+				if (!ParseHex4(codePoint))
+				{
+					return false;
+				}
+				//Characters outside the BMP come as a surrogate pair, a lone surrogate is passed through as is.
+				if (codePoint >= 0xD800 && codePoint <= 0xDBFF && m_end - m_current >= 6 && m_current[0] == '\\' && m_current[1] == 'u')
+				{
+					const char* pairStart = m_current;
+					m_current += 2;
+					unsigned int lowSurrogate = 0;
+					if (!ParseHex4(lowSurrogate))
+					{
+						return false;
+					}
+					if (lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF)
+					{
+						codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+					}
+					else
+					{
+						m_current = pairStart;
+					}
+				}
+				AppendUtf8(outString, codePoint);
+				break;
+			}
+			default:
+				--m_current;
+				return Fail("Unknown escape in a string");
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------------------
+	//Checks the grammar itself since strtod accepts more than JSON does (ie: hex, inf, leading '+').
+	bool ParseNumber(JsonValue& outValue)
+	{
+		const char* numberStart = m_current;
+		if (m_current < m_end && *m_current == '-')
+		{
+			++m_current;
+		}
+		if (m_current >= m_end || *m_current < '0' || *m_current > '9')
+		{
+			return Fail("Expected a value");
+		}
+		if (*m_current == '0')
+		{
+			++m_current;
+		}
+		else
+		{
+			SkipDigits();
+		}
+		if (m_current < m_end && *m_current == '.')
+		{
+			++m_current;
+			if (!SkipDigits())
+			{
+				return Fail("Expected digits after '.'");
+			}
+		}
+		if (m_current < m_end && (*m_current == 'e' || *m_current == 'E'))
+		{
+			++m_current;
+			if (m_current < m_end && (*m_current == '+' || *m_current == '-'))
+			{
+				++m_current;
+			}
+			if (!SkipDigits())
+			{
+				return Fail("Expected digits in an exponent");
+			}
+		}
+
+		//The text isn't null terminated, so strtod gets a copy. Anything longer than this has more digits than a double holds anyway.
+		char buffer[64];
+		size_t length = m_current - numberStart;
+		if (length >= sizeof(buffer))
+		{
+			return Fail("Number is too long");
+		}
+		memcpy(buffer, numberStart, length);
+		buffer[length] = '\0';
+		outValue.m_type = JsonValue::JSON_NUMBER;
+		outValue.m_number = strtod(buffer, nullptr);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------------
+	bool SkipDigits()
+	{
+		const char* digitsStart = m_current;
+		while (m_current < m_end && *m_current >= '0' && *m_current <= '9')
+		{
+			++m_current;
+		}
+		return m_current != digitsStart;
+	}
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	const char* m_start;
+	const char* m_current;
+	const char* m_end;
+	std::string m_error;
+	size_t m_errorOffset;
+};
+
+//-----------------------------------------------------------------------------------
+bool JsonValue::Parse(const char* text, size_t length, JsonValue& outRoot, std::string* outError)
+{
+	outRoot = JsonValue();
+	JsonParser parser(text, length);
+	if (parser.ParseDocument(outRoot))
+	{
+		return true;
+	}
+	if (outError)
+	{
+		*outError = parser.GetError();
+	}
+	outRoot = JsonValue();
+	return false;
+}
+
+//-----------------------------------------------------------------------------------
+const JsonValue* JsonValue::Find(const char* key) const
+{
+	if (m_type != JSON_OBJECT)
+	{
+		return nullptr;
+	}
+	for (size_t i = 0; i < m_keys.size(); ++i)
+	{
+		if (m_keys[i] == key)
+		{
+			return &m_elements[i];
+		}
+	}
+	return nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+const JsonValue& JsonValue::operator[](const char* key) const
+{
+	const JsonValue* member = Find(key);
+	return member ? *member : NULL_VALUE;
+}
+
+//-----------------------------------------------------------------------------------
+const JsonValue& JsonValue::operator[](size_t index) const
+{
+	return (m_type == JSON_ARRAY && index < m_elements.size()) ? m_elements[index] : NULL_VALUE;
+}
+
+//-----------------------------------------------------------------------------------
+bool JsonValue::AsBool(bool defaultValue) const
+{
+	return m_type == JSON_BOOL ? m_number != 0.0 : defaultValue;
+}
+
+//-----------------------------------------------------------------------------------
+double JsonValue::AsDouble(double defaultValue) const
+{
+	return m_type == JSON_NUMBER ? m_number : defaultValue;
+}
+
+//-----------------------------------------------------------------------------------
+//Empty for anything that isn't a string.
+const std::string& JsonValue::AsString() const
+{
+	return m_string;
+}
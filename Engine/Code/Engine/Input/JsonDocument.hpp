@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------
+//One node of a parsed JSON document. Lookups never fail: a missing member or element comes back as a null value,
+//and the As functions hand back their default when the value isn't that type, so optional fields read in one line.
+class JsonValue
+{
+public:
+	//ENUMS//////////////////////////////////////////////////////////////////////////
+	enum Type
+	{
+		JSON_NULL,
+		JSON_BOOL,
+		JSON_NUMBER,
+		JSON_STRING,
+		JSON_ARRAY,
+		JSON_OBJECT,
+		NUM_JSON_TYPES
+	};
+
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	JsonValue() : m_type(JSON_NULL), m_number(0.0) {};
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	//Strict RFC 8259, except that nesting is capped at MAX_DEPTH. The text doesn't need to be null terminated.
+	static bool Parse(const char* text, size_t length, JsonValue& outRoot, std::string* outError = nullptr);
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	inline Type GetType() const { return m_type; };
+	inline bool IsNull() const { return m_type == JSON_NULL; };
+	inline bool IsNumber() const { return m_type == JSON_NUMBER; };
+	inline bool IsString() const { return m_type == JSON_STRING; };
+	inline bool IsArray() const { return m_type == JSON_ARRAY; };
+	inline bool IsObject() const { return m_type == JSON_OBJECT; };
+	//Number of elements in an array or members in an object, 0 for anything else.
+	inline size_t GetSize() const { return m_elements.size(); };
+	inline const std::string& GetKey(size_t memberIndex) const { return m_keys[memberIndex]; };
+	//Null if this isn't an object or the member isn't there.
+	const JsonValue* Find(const char* key) const;
+	const JsonValue& operator[](const char* key) const;
+	const JsonValue& operator[](size_t index) const;
+	inline bool HasMember(const char* key) const { return Find(key) != nullptr; };
+
+	bool AsBool(bool defaultValue = false) const;
+	double AsDouble(double defaultValue = 0.0) const;
+	inline float AsFloat(float defaultValue = 0.0f) const { return (float)AsDouble(defaultValue); };
+	inline int AsInt(int defaultValue = 0) const { return (int)AsDouble(defaultValue); };
+	const std::string& AsString() const;
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int MAX_DEPTH = 256;
+	static const JsonValue NULL_VALUE;
+
+private:
+	friend class JsonParser;
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	Type m_type;
+	double m_number;
+	std::string m_string;
+	//Array elements, or object member values in the order they were written.
+	std::vector<JsonValue> m_elements;
+	//Object member names, parallel to m_elements.
+	std::vector<std::string> m_keys;
+};
@@ -0,0 +1,138 @@
+#include "Engine/Input/MappedFile.hpp"
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------------
+MappedFile::MappedFile()
+	: m_fileHandle(nullptr)
+	, m_mappingHandle(nullptr)
+	, m_data(nullptr)
+	, m_size(0)
+	, m_isOpen(false)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#if defined(_WIN32)
+//-----------------------------------------------------------------------------------
+bool MappedFile::Open(const char* filePath)
+{
+	Close();
+	HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	m_fileHandle = file;
+	m_isOpen = true;
+	m_size = (size_t)fileSize.QuadPart;
+	if (m_size == 0)
+	{
+		//Windows won't map an empty file, but it's still a valid (empty) view.
+		return true;
+	}
+
+	m_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+	m_data = static_cast<const byte*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+	}
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+	if (m_fileHandle != nullptr)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = nullptr;
+	}
+	m_size = 0;
+	m_isOpen = false;
+}
+
+#else
+//-----------------------------------------------------------------------------------
+//The mapping keeps its own reference to the file, so the descriptor is closed as soon as the view exists.
+bool MappedFile::Open(const char* filePath)
+{
+	Close();
+	int file = open(filePath, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+	{
+		close(file);
+		return false;
+	}
+	m_size = (size_t)fileStatus.st_size;
+	if (m_size > 0)
+	{
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data == MAP_FAILED)
+		{
+			close(file);
+			m_size = 0;
+			return false;
+		}
+		madvise(data, m_size, MADV_SEQUENTIAL);
+		m_data = static_cast<const byte*>(data);
+	}
+	close(file);
+	m_isOpen = true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		munmap(const_cast<byte*>(m_data), m_size);
+		m_data = nullptr;
+	}
+	m_size = 0;
+	m_isOpen = false;
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+#include <stddef.h>
+
+typedef unsigned char byte;
+
+//-----------------------------------------------------------------------------------
+//Read-only memory mapping of a whole file. The pages are only read in as they're touched, and nothing is copied onto the heap.
+class MappedFile
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	MappedFile();
+	~MappedFile();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	bool Open(const char* filePath);
+	void Close();
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	inline const byte* GetData() const { return m_data; };
+	inline size_t GetSize() const { return m_size; };
+	inline bool IsOpen() const { return m_isOpen; };
+
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	//Only used on Windows, POSIX doesn't need the file or the mapping once the view is mapped.
+	void* m_fileHandle;
+	void* m_mappingHandle;
+	const byte* m_data;
+	size_t m_size;
+	bool m_isOpen;
+};
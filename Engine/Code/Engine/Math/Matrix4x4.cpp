@@ -1,6 +1,13 @@
 #include "Engine/Math/Matrix4x4.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include <math.h>
+
+//Every x86 target we build for has SSE, anything else gets the scalar paths.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define MATRIX4X4_USE_SSE
+#include <xmmintrin.h>
+#endif
 
 //-----------------------------------------------------------------------------------
 //Based off of Code by Christopher Forseth
@@ -115,7 +122,36 @@ Vector4 Matrix4x4::MatrixGetRow(Matrix4x4 const *matrix, int row)
 }
 
 //------------------------------------------------------------------------
+//Each column of the result is the left matrix's columns weighted by one column of the right matrix.
 void Matrix4x4::MatrixMultiply(Matrix4x4 *outResult, Matrix4x4 const *leftMatrix, Matrix4x4 const *rightMatrix)
+{
+#ifdef MATRIX4X4_USE_SSE
+	const float* right = rightMatrix->data;
+	__m128 left0 = _mm_loadu_ps(&leftMatrix->data[0]);
+	__m128 left1 = _mm_loadu_ps(&leftMatrix->data[4]);
+	__m128 left2 = _mm_loadu_ps(&leftMatrix->data[8]);
+	__m128 left3 = _mm_loadu_ps(&leftMatrix->data[12]);
+	__m128 results[4];
+	for (int c = 0; c < 4; ++c)
+	{
+		__m128 sum = _mm_mul_ps(left0, _mm_set1_ps(right[(c * 4) + 0]));
+		sum = _mm_add_ps(sum, _mm_mul_ps(left1, _mm_set1_ps(right[(c * 4) + 1])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(left2, _mm_set1_ps(right[(c * 4) + 2])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(left3, _mm_set1_ps(right[(c * 4) + 3])));
+		results[c] = sum;
+	}
+	//Only store once everything is read, outResult can alias either input.
+	_mm_storeu_ps(&outResult->data[0], results[0]);
+	_mm_storeu_ps(&outResult->data[4], results[1]);
+	_mm_storeu_ps(&outResult->data[8], results[2]);
+	_mm_storeu_ps(&outResult->data[12], results[3]);
+#else
+	MatrixMultiplyScalar(outResult, leftMatrix, rightMatrix);
+#endif
+}
+
+//------------------------------------------------------------------------
+void Matrix4x4::MatrixMultiplyScalar(Matrix4x4 *outResult, Matrix4x4 const *leftMatrix, Matrix4x4 const *rightMatrix)
 {
 	float values[16];
 	Vector4 column, row;
@@ -130,6 +166,269 @@ void Matrix4x4::MatrixMultiply(Matrix4x4 *outResult, Matrix4x4 const *leftMatrix
 	memcpy(outResult->data, values, sizeof(values));
 }
 
+//------------------------------------------------------------------------
+Vector4 Matrix4x4::MatrixTransformVector4(Matrix4x4 const *matrix, const Vector4& vector)
+{
+#ifdef MATRIX4X4_USE_SSE
+	//Loaded as columns, transposed in registers into rows.
+	__m128 row0 = _mm_loadu_ps(&matrix->data[0]);
+	__m128 row1 = _mm_loadu_ps(&matrix->data[4]);
+	__m128 row2 = _mm_loadu_ps(&matrix->data[8]);
+	__m128 row3 = _mm_loadu_ps(&matrix->data[12]);
+	_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+	__m128 sum = _mm_mul_ps(row0, _mm_set1_ps(vector.x));
+	sum = _mm_add_ps(sum, _mm_mul_ps(row1, _mm_set1_ps(vector.y)));
+	sum = _mm_add_ps(sum, _mm_mul_ps(row2, _mm_set1_ps(vector.z)));
+	sum = _mm_add_ps(sum, _mm_mul_ps(row3, _mm_set1_ps(vector.w)));
+	Vector4 result;
+	_mm_storeu_ps(result.data, sum);
+	return result;
+#else
+	return Vector4(
+		Vector4::Dot(vector, matrix->column[0]),
+		Vector4::Dot(vector, matrix->column[1]),
+		Vector4::Dot(vector, matrix->column[2]),
+		Vector4::Dot(vector, matrix->column[3]));
+#endif
+}
+
+//------------------------------------------------------------------------
+//Treats the point as w = 1 and skips the projective divide, so only use it with affine matrices.
+Vector3 Matrix4x4::MatrixTransformPoint(Matrix4x4 const *matrix, const Vector3& point)
+{
+	const float* m = matrix->data;
+	return Vector3(
+		(point.x * m[0]) + (point.y * m[1]) + (point.z * m[2]) + m[3],
+		(point.x * m[4]) + (point.y * m[5]) + (point.z * m[6]) + m[7],
+		(point.x * m[8]) + (point.y * m[9]) + (point.z * m[10]) + m[11]);
+}
+
+//------------------------------------------------------------------------
+Vector3 Matrix4x4::MatrixTransformDirection(Matrix4x4 const *matrix, const Vector3& direction)
+{
+	const float* m = matrix->data;
+	return Vector3(
+		(direction.x * m[0]) + (direction.y * m[1]) + (direction.z * m[2]),
+		(direction.x * m[4]) + (direction.y * m[5]) + (direction.z * m[6]),
+		(direction.x * m[8]) + (direction.y * m[9]) + (direction.z * m[10]));
+}
+
+#ifdef MATRIX4X4_USE_SSE
+//-----------------------------------------------------------------------------------
+//Splats the upper 3x4 of the matrix so four points can be transformed at once in SoA form.
+struct SplatMatrix
+{
+	SplatMatrix(Matrix4x4 const *matrix)
+	{
+		const float* m = matrix->data;
+		for (int c = 0; c < 3; ++c)
+		{
+			x[c] = _mm_set1_ps(m[(c * 4) + 0]);
+			y[c] = _mm_set1_ps(m[(c * 4) + 1]);
+			z[c] = _mm_set1_ps(m[(c * 4) + 2]);
+			w[c] = _mm_set1_ps(m[(c * 4) + 3]);
+		}
+	}
+
+	__m128 x[3];
+	__m128 y[3];
+	__m128 z[3];
+	__m128 w[3];
+};
+
+//-----------------------------------------------------------------------------------
+static inline void TransformFourSoA(const SplatMatrix& matrix, bool isPoint, __m128& x, __m128& y, __m128& z)
+{
+	__m128 results[3];
+	for (int c = 0; c < 3; ++c)
+	{
+		__m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, matrix.x[c]), _mm_mul_ps(y, matrix.y[c])), _mm_mul_ps(z, matrix.z[c]));
+		results[c] = isPoint ? _mm_add_ps(sum, matrix.w[c]) : sum;
+	}
+	x = results[0];
+	y = results[1];
+	z = results[2];
+}
+
+//-----------------------------------------------------------------------------------
+//Four packed Vector3s come in as three registers, get split into x/y/z lanes, transformed, then packed back.
+static void TransformVector3ArraySSE(Matrix4x4 const *matrix, const Vector3* in, Vector3* out, size_t count, bool isPoint)
+{
+	SplatMatrix splat(matrix);
+	size_t blockCount = count & ~(size_t)3;
+	for (size_t i = 0; i < blockCount; i += 4)
+	{
+		const float* source = &in[i].x;
+		__m128 a = _mm_loadu_ps(source + 0); //x0 y0 z0 x1
+		__m128 b = _mm_loadu_ps(source + 4); //y1 z1 x2 y2
+		__m128 c = _mm_loadu_ps(source + 8); //z2 x3 y3 z3
+
+		__m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		__m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+		TransformFourSoA(splat, isPoint, x, y, z);
+
+		__m128 xy01 = _mm_unpacklo_ps(x, y); //x0 y0 x1 y1
+		__m128 xy23 = _mm_unpackhi_ps(x, y); //x2 y2 x3 y3
+		float* destination = &out[i].x;
+		_mm_storeu_ps(destination + 0, _mm_shuffle_ps(xy01, _mm_shuffle_ps(z, xy01, _MM_SHUFFLE(3, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0)));
+		_mm_storeu_ps(destination + 4, _mm_shuffle_ps(_mm_shuffle_ps(xy01, z, _MM_SHUFFLE(1, 1, 3, 3)), xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+		_mm_storeu_ps(destination + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, xy23, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(xy23, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+	}
+	for (size_t i = blockCount; i < count; ++i)
+	{
+		out[i] = isPoint ? Matrix4x4::MatrixTransformPoint(matrix, in[i]) : Matrix4x4::MatrixTransformDirection(matrix, in[i]);
+	}
+}
+
+//-----------------------------------------------------------------------------------
+static void TransformSoAArraysSSE(Matrix4x4 const *matrix, const float* inX, const float* inY, const float* inZ, float* outX, float* outY, float* outZ, size_t count, bool isPoint)
+{
+	SplatMatrix splat(matrix);
+	size_t blockCount = count & ~(size_t)3;
+	for (size_t i = 0; i < blockCount; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(inX + i);
+		__m128 y = _mm_loadu_ps(inY + i);
+		__m128 z = _mm_loadu_ps(inZ + i);
+		TransformFourSoA(splat, isPoint, x, y, z);
+		_mm_storeu_ps(outX + i, x);
+		_mm_storeu_ps(outY + i, y);
+		_mm_storeu_ps(outZ + i, z);
+	}
+	for (size_t i = blockCount; i < count; ++i)
+	{
+		Vector3 input = Vector3(inX[i], inY[i], inZ[i]);
+		Vector3 result = isPoint ? Matrix4x4::MatrixTransformPoint(matrix, input) : Matrix4x4::MatrixTransformDirection(matrix, input);
+		outX[i] = result.x;
+		outY[i] = result.y;
+		outZ[i] = result.z;
+	}
+}
+#endif
+
+//-----------------------------------------------------------------------------------
+void Matrix4x4::MatrixTransformPoints(Matrix4x4 const *matrix, const Vector3* inPoints, Vector3* outPoints, size_t count)
+{
+#ifdef MATRIX4X4_USE_SSE
+	TransformVector3ArraySSE(matrix, inPoints, outPoints, count, true);
+#else
+	for (size_t i = 0; i < count; ++i)
+	{
+		outPoints[i] = MatrixTransformPoint(matrix, inPoints[i]);
+	}
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+void Matrix4x4::MatrixTransformDirections(Matrix4x4 const *matrix, const Vector3* inDirections, Vector3* outDirections, size_t count)
+{
+#ifdef MATRIX4X4_USE_SSE
+	TransformVector3ArraySSE(matrix, inDirections, outDirections, count, false);
+#else
+	for (size_t i = 0; i < count; ++i)
+	{
+		outDirections[i] = MatrixTransformDirection(matrix, inDirections[i]);
+	}
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+void Matrix4x4::MatrixTransformPointsSoA(Matrix4x4 const *matrix, const float* inX, const float* inY, const float* inZ, float* outX, float* outY, float* outZ, size_t count)
+{
+#ifdef MATRIX4X4_USE_SSE
+	TransformSoAArraysSSE(matrix, inX, inY, inZ, outX, outY, outZ, count, true);
+#else
+	for (size_t i = 0; i < count; ++i)
+	{
+		Vector3 result = MatrixTransformPoint(matrix, Vector3(inX[i], inY[i], inZ[i]));
+		outX[i] = result.x;
+		outY[i] = result.y;
+		outZ[i] = result.z;
+	}
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+void Matrix4x4::MatrixTransformDirectionsSoA(Matrix4x4 const *matrix, const float* inX, const float* inY, const float* inZ, float* outX, float* outY, float* outZ, size_t count)
+{
+#ifdef MATRIX4X4_USE_SSE
+	TransformSoAArraysSSE(matrix, inX, inY, inZ, outX, outY, outZ, count, false);
+#else
+	for (size_t i = 0; i < count; ++i)
+	{
+		Vector3 result = MatrixTransformDirection(matrix, Vector3(inX[i], inY[i], inZ[i]));
+		outX[i] = result.x;
+		outY[i] = result.y;
+		outZ[i] = result.z;
+	}
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+//Inverts the upper 3x3 with cofactors and pulls the translation back through it.
+void Matrix4x4::MatrixInvertAffine(Matrix4x4 *matrix)
+{
+	float *const m = matrix->data;
+	const float a00 = m[0], a01 = m[4], a02 = m[8];
+	const float a10 = m[1], a11 = m[5], a12 = m[9];
+	const float a20 = m[2], a21 = m[6], a22 = m[10];
+	const Vector3 translation = Vector3(m[3], m[7], m[11]);
+
+	float i00 = (a11 * a22) - (a12 * a21);
+	float i10 = (a12 * a20) - (a10 * a22);
+	float i20 = (a10 * a21) - (a11 * a20);
+	float determinant = (a00 * i00) + (a01 * i10) + (a02 * i20);
+	GUARANTEE_OR_DIE(determinant != 0.0f, "Matrix not Invertable.");
+	float inverseDeterminant = 1.0f / determinant;
+
+	float inverse[3][3];
+	inverse[0][0] = i00 * inverseDeterminant;
+	inverse[1][0] = i10 * inverseDeterminant;
+	inverse[2][0] = i20 * inverseDeterminant;
+	inverse[0][1] = ((a02 * a21) - (a01 * a22)) * inverseDeterminant;
+	inverse[1][1] = ((a00 * a22) - (a02 * a20)) * inverseDeterminant;
+	inverse[2][1] = ((a01 * a20) - (a00 * a21)) * inverseDeterminant;
+	inverse[0][2] = ((a01 * a12) - (a02 * a11)) * inverseDeterminant;
+	inverse[1][2] = ((a02 * a10) - (a00 * a12)) * inverseDeterminant;
+	inverse[2][2] = ((a00 * a11) - (a01 * a10)) * inverseDeterminant;
+
+	for (int r = 0; r < 3; ++r)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			m[(c * 4) + r] = inverse[r][c];
+		}
+	}
+	for (int c = 0; c < 3; ++c)
+	{
+		m[(c * 4) + 3] = -((translation.x * inverse[0][c]) + (translation.y * inverse[1][c]) + (translation.z * inverse[2][c]));
+	}
+	m[12] = 0.0f;
+	m[13] = 0.0f;
+	m[14] = 0.0f;
+	m[15] = 1.0f;
+}
+
+//-----------------------------------------------------------------------------------
+//The rotation's inverse is its transpose, no determinant needed.
+void Matrix4x4::MatrixInvertRigid(Matrix4x4 *matrix)
+{
+	float *const m = matrix->data;
+	const Vector3 translation = Vector3(m[3], m[7], m[11]);
+	std::swap(m[1], m[4]);
+	std::swap(m[2], m[8]);
+	std::swap(m[6], m[9]);
+	for (int c = 0; c < 3; ++c)
+	{
+		m[(c * 4) + 3] = -((translation.x * m[(c * 4) + 0]) + (translation.y * m[(c * 4) + 1]) + (translation.z * m[(c * 4) + 2]));
+	}
+	m[12] = 0.0f;
+	m[13] = 0.0f;
+	m[14] = 0.0f;
+	m[15] = 1.0f;
+}
+
 //-----------------------------------------------------------------------------------
 // Lifted from GLU
 void Matrix4x4::MatrixInvert(Matrix4x4 *mat)
@@ -359,13 +658,7 @@ void Matrix4x4::MatrixMakeLookAt(Matrix4x4* matrix, const Vector3& from, const V
 //-----------------------------------------------------------------------------------
 void Matrix4x4::MatrixInvertOrthogonal(Matrix4x4* matrix)
 {
-	Vector3 translation = MatrixGetOffset(matrix);
-	MatrixTranspose(matrix);
-	MatrixSetColumn(matrix, 3, Vector4(0.0f, 0.0f, 0.0f, 1.0f));
-	Matrix4x4 translationMatrix;
-	MatrixMakeTranslation(&translationMatrix, translation);
-	MatrixInvert(&translationMatrix);
-	MatrixMultiply(matrix, &translationMatrix, matrix);
+	MatrixInvertRigid(matrix);
 }
 
 //------------------------------------------------------------------------
@@ -472,21 +765,25 @@ Matrix4x4 Matrix4x4::MatrixFromBasis(const Vector3& right, const Vector3& up, co
 }
 
 //-----------------------------------------------------------------------------------
+//Lerps every element, which matches lerping the basis vectors as long as both matrices are affine.
 Matrix4x4 Matrix4x4::MatrixLerp(const Matrix4x4& a, const Matrix4x4& b, const float time)
 {
-	Vector3 r0, u0, f0, t0;
-	Matrix4x4::GetBasis(a, r0, u0, f0, t0);
-
-	Vector3 r1, u1, f1, t1;
-	Matrix4x4::GetBasis(b, r1, u1, f1, t1);
-
-	Vector3 r, u, f, t;
-	r = MathUtils::Lerp(time, r0, r1);
-	u = MathUtils::Lerp(time, u0, u1);
-	f = MathUtils::Lerp(time, f0, f1);
-	t = MathUtils::Lerp(time, t0, t1);
-
-	return MatrixFromBasis(r, u, f, t);
+	Matrix4x4 result;
+#ifdef MATRIX4X4_USE_SSE
+	__m128 blend = _mm_set1_ps(time);
+	for (int i = 0; i < 16; i += 4)
+	{
+		__m128 start = _mm_loadu_ps(&a.data[i]);
+		__m128 end = _mm_loadu_ps(&b.data[i]);
+		_mm_storeu_ps(&result.data[i], _mm_add_ps(start, _mm_mul_ps(_mm_sub_ps(end, start), blend)));
+	}
+#else
+	for (int i = 0; i < 16; ++i)
+	{
+		result.data[i] = a.data[i] + ((b.data[i] - a.data[i]) * time);
+	}
+#endif
+	return result;
 }
 
 void Matrix4x4::GetBasis(const Matrix4x4& a, Vector3& b1, Vector3& b2, Vector3& b3, Vector3& b4)
@@ -532,6 +829,24 @@ Vector3 Matrix4x4::MatrixGetOffset(Matrix4x4 const *matrix)
 
 //-----------------------------------------------------------------------------------
 void Matrix4x4::MatrixTranspose(Matrix4x4* matrix)
+{
+#ifdef MATRIX4X4_USE_SSE
+	__m128 column0 = _mm_loadu_ps(&matrix->data[0]);
+	__m128 column1 = _mm_loadu_ps(&matrix->data[4]);
+	__m128 column2 = _mm_loadu_ps(&matrix->data[8]);
+	__m128 column3 = _mm_loadu_ps(&matrix->data[12]);
+	_MM_TRANSPOSE4_PS(column0, column1, column2, column3);
+	_mm_storeu_ps(&matrix->data[0], column0);
+	_mm_storeu_ps(&matrix->data[4], column1);
+	_mm_storeu_ps(&matrix->data[8], column2);
+	_mm_storeu_ps(&matrix->data[12], column3);
+#else
+	MatrixTransposeScalar(matrix);
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+void Matrix4x4::MatrixTransposeScalar(Matrix4x4* matrix)
 {
 	float *data = matrix->data;
 	for (unsigned int y = 1; y < 4; y++)
@@ -2,6 +2,7 @@
 #include "Engine/Math/Vector3.hpp"
 #include "Engine/Math/Vector4.hpp"
 #include <string.h>
+#include <stddef.h>
 #include <algorithm>
 
 class Matrix4x4
@@ -28,7 +29,19 @@ public:
 	static void MatrixGetRow(Matrix4x4 const *matrix, int row, Vector4 *out);
 	static Vector4 MatrixGetRow(Matrix4x4 const *matrix, int row);
 	static void MatrixMultiply(Matrix4x4 *outResult, Matrix4x4 const *leftMatrix, Matrix4x4 const *rightMatrix);
+	static void MatrixMultiplyScalar(Matrix4x4 *outResult, Matrix4x4 const *leftMatrix, Matrix4x4 const *rightMatrix);
+	static Vector4 MatrixTransformVector4(Matrix4x4 const *matrix, const Vector4& vector);
+	static Vector3 MatrixTransformPoint(Matrix4x4 const *matrix, const Vector3& point);
+	static Vector3 MatrixTransformDirection(Matrix4x4 const *matrix, const Vector3& direction);
+	//Array versions of the two above, equivalent to calling them once per element. in and out may be the same array.
+	static void MatrixTransformPoints(Matrix4x4 const *matrix, const Vector3* inPoints, Vector3* outPoints, size_t count);
+	static void MatrixTransformDirections(Matrix4x4 const *matrix, const Vector3* inDirections, Vector3* outDirections, size_t count);
+	static void MatrixTransformPointsSoA(Matrix4x4 const *matrix, const float* inX, const float* inY, const float* inZ, float* outX, float* outY, float* outZ, size_t count);
+	static void MatrixTransformDirectionsSoA(Matrix4x4 const *matrix, const float* inX, const float* inY, const float* inZ, float* outX, float* outY, float* outZ, size_t count);
 	static void MatrixInvert(Matrix4x4 *matrix);
+	//Cheaper inverses for matrices whose last column is (0, 0, 0, 1). Rigid also requires an orthonormal basis (rotation + translation only).
+	static void MatrixInvertAffine(Matrix4x4 *matrix);
+	static void MatrixInvertRigid(Matrix4x4 *matrix);
 	static void MatrixMakeRotationAroundX(Matrix4x4 *matrix, const float radians);
 	static void MatrixMakeRotationAroundY(Matrix4x4 *matrix, const float radians);
 	static void MatrixMakeRotationAroundZ(Matrix4x4 *matrix, const float radians);
@@ -36,6 +49,7 @@ public:
 	static void MatrixMakeScale(Matrix4x4* matrix, float scale);
 	static Vector3 MatrixGetOffset(Matrix4x4 const *matrix);
 	static void MatrixTranspose(Matrix4x4* matrix);
+	static void MatrixTransposeScalar(Matrix4x4* matrix);
 	static void MatrixSetOffset(Matrix4x4* m, const Vector3& offset);
 
 	//MEMBER FUNCTIONS//////////////////////////////////////////////////////////////////////////
@@ -61,36 +75,19 @@ public:
 //----------------------------------------------------------------------
 inline Matrix4x4 operator*(const Matrix4x4& lhs, const Matrix4x4& rhs)
 {
-	float values[16];
-	Vector4 column, row;
-	for (int r = 0; r < 4; ++r) {
-		Matrix4x4::MatrixGetRow(&lhs, r, &row);
-		for (int c = 0; c < 4; ++c) {
-			float v = Vector4::Dot(row, rhs.column[c]);
-			values[(c * 4) + r] = v;
-		}
-	}
-
-	return Matrix4x4(values);
+	Matrix4x4 result;
+	Matrix4x4::MatrixMultiply(&result, &lhs, &rhs);
+	return result;
 }
 
 //----------------------------------------------------------------------
 inline Vector3 operator*(const Vector3& lhs, const Matrix4x4& rhs)
 {
-	return Vector3(
-		Vector4::Dot(Vector4(lhs, 0), Matrix4x4::MatrixGetColumn(&rhs, 0)),
-		Vector4::Dot(Vector4(lhs, 0), Matrix4x4::MatrixGetColumn(&rhs, 1)),
-		Vector4::Dot(Vector4(lhs, 0), Matrix4x4::MatrixGetColumn(&rhs, 2))
-		);
+	return Matrix4x4::MatrixTransformDirection(&rhs, lhs);
 }
 
 //----------------------------------------------------------------------
 inline Vector4 operator*(const Vector4& lhs, const Matrix4x4& rhs)
 {
-	return Vector4(
-		Vector4::Dot(lhs, Matrix4x4::MatrixGetColumn(&rhs, 0)),
-		Vector4::Dot(lhs, Matrix4x4::MatrixGetColumn(&rhs, 1)),
-		Vector4::Dot(lhs, Matrix4x4::MatrixGetColumn(&rhs, 2)),
-		Vector4::Dot(lhs, Matrix4x4::MatrixGetColumn(&rhs, 3))
-		);
+	return Matrix4x4::MatrixTransformVector4(&rhs, lhs);
 }
@@ -0,0 +1,110 @@
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Input/Console.hpp"
+#include <algorithm>
+#include <math.h>
+
+//The console side of Matrix4x4, kept out of Matrix4x4.cpp so the tools can do math without linking the console.
+//Same check Matrix4x4.cpp makes to pick its kernels.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define MATRIX4X4_USE_SSE
+#endif
+
+//-----------------------------------------------------------------------------------
+static Matrix4x4 MakeRandomRigidMatrix()
+{
+	Matrix4x4 matrix;
+	Vector3 offset = Vector3(MathUtils::GetRandom(-100.0f, 100.0f), MathUtils::GetRandom(-100.0f, 100.0f), MathUtils::GetRandom(-100.0f, 100.0f));
+	Matrix4x4::MatrixMakeRotationEuler(&matrix, MathUtils::GetRandom(-MathUtils::PI, MathUtils::PI), MathUtils::GetRandom(-MathUtils::PI, MathUtils::PI), MathUtils::GetRandom(-MathUtils::PI, MathUtils::PI), Vector3(0.0f));
+	Matrix4x4::MatrixSetOffset(&matrix, offset);
+	return matrix;
+}
+
+//-----------------------------------------------------------------------------------
+static float GetMaxDifference(const Matrix4x4& first, const Matrix4x4& second)
+{
+	float maxDifference = 0.0f;
+	for (int i = 0; i < 16; ++i)
+	{
+		maxDifference = std::max(maxDifference, fabs(first.data[i] - second.data[i]));
+	}
+	return maxDifference;
+}
+
+//-----------------------------------------------------------------------------------
+//Checks the fast paths against the general scalar implementations on random bone-like matrices.
+CONSOLE_COMMAND(matrixSelfTest)
+{
+	int numIterations = args.HasArgs(1) ? args.GetIntArgument(0) : 10000;
+	float maxMultiplyError = 0.0f;
+	float maxTransposeError = 0.0f;
+	float maxTransformError = 0.0f;
+	float maxBatchError = 0.0f;
+	float maxAffineInverseError = 0.0f;
+	float maxRigidInverseError = 0.0f;
+	for (int i = 0; i < numIterations; ++i)
+	{
+		Matrix4x4 rigid = MakeRandomRigidMatrix();
+		Matrix4x4 affine = MakeRandomRigidMatrix();
+		Matrix4x4 scale;
+		Matrix4x4::MatrixMakeScale(&scale, MathUtils::GetRandom(0.1f, 10.0f));
+		Matrix4x4::MatrixMultiplyScalar(&affine, &scale, &affine);
+
+		Matrix4x4 fastProduct;
+		Matrix4x4 scalarProduct;
+		Matrix4x4::MatrixMultiply(&fastProduct, &rigid, &affine);
+		Matrix4x4::MatrixMultiplyScalar(&scalarProduct, &rigid, &affine);
+		maxMultiplyError = std::max(maxMultiplyError, GetMaxDifference(fastProduct, scalarProduct));
+
+		Matrix4x4 fastTranspose = affine;
+		Matrix4x4 scalarTranspose = affine;
+		Matrix4x4::MatrixTranspose(&fastTranspose);
+		Matrix4x4::MatrixTransposeScalar(&scalarTranspose);
+		maxTransposeError = std::max(maxTransposeError, GetMaxDifference(fastTranspose, scalarTranspose));
+
+		Vector4 point = Vector4(MathUtils::GetRandom(-100.0f, 100.0f), MathUtils::GetRandom(-100.0f, 100.0f), MathUtils::GetRandom(-100.0f, 100.0f), 1.0f);
+		Vector3 transformed = Matrix4x4::MatrixTransformPoint(&affine, Vector3(point.x, point.y, point.z));
+		for (int column = 0; column < 3; ++column)
+		{
+			float expected = Vector4::Dot(point, affine.column[column]);
+			maxTransformError = std::max(maxTransformError, fabs((&transformed.x)[column] - expected) / std::max(1.0f, fabs(expected)));
+		}
+
+		Vector3 points[7];
+		Vector3 batchedPoints[7];
+		for (int pointIndex = 0; pointIndex < 7; ++pointIndex)
+		{
+			points[pointIndex] = Vector3(MathUtils::GetRandom(-100.0f, 100.0f), MathUtils::GetRandom(-100.0f, 100.0f), MathUtils::GetRandom(-100.0f, 100.0f));
+		}
+		Matrix4x4::MatrixTransformPoints(&affine, points, batchedPoints, 7);
+		for (int pointIndex = 0; pointIndex < 7; ++pointIndex)
+		{
+			Vector3 expected = Matrix4x4::MatrixTransformPoint(&affine, points[pointIndex]);
+			maxBatchError = std::max(maxBatchError, (batchedPoints[pointIndex] - expected).CalculateMagnitude() / std::max(1.0f, expected.CalculateMagnitude()));
+		}
+
+		Matrix4x4 fastInverse = affine;
+		Matrix4x4 generalInverse = affine;
+		Matrix4x4::MatrixInvertAffine(&fastInverse);
+		Matrix4x4::MatrixInvert(&generalInverse);
+		maxAffineInverseError = std::max(maxAffineInverseError, GetMaxDifference(fastInverse, generalInverse));
+
+		fastInverse = rigid;
+		generalInverse = rigid;
+		Matrix4x4::MatrixInvertRigid(&fastInverse);
+		Matrix4x4::MatrixInvert(&generalInverse);
+		maxRigidInverseError = std::max(maxRigidInverseError, GetMaxDifference(fastInverse, generalInverse));
+	}
+
+	const float tolerance = 1e-3f;
+	bool passed = maxMultiplyError < tolerance && maxTransposeError == 0.0f && maxTransformError < tolerance && maxBatchError < tolerance && maxAffineInverseError < tolerance && maxRigidInverseError < tolerance;
+	RGBA resultColor = passed ? RGBA::GREEN : RGBA::RED;
+#ifdef MATRIX4X4_USE_SSE
+	Console::instance->PrintLine(Stringf("SSE kernels, %i random matrices:", numIterations), resultColor);
+#else
+	Console::instance->PrintLine(Stringf("Scalar kernels, %i random matrices:", numIterations), resultColor);
+#endif
+	Console::instance->PrintLine(Stringf("Multiply %g, Transpose %g, TransformPoint %g, TransformPoints %g", maxMultiplyError, maxTransposeError, maxTransformError, maxBatchError), resultColor);
+	Console::instance->PrintLine(Stringf("InvertAffine %g, InvertRigid %g (max error vs MatrixInvert)", maxAffineInverseError, maxRigidInverseError), resultColor);
+}
@@ -1,78 +1,18 @@
 #include "Engine/Renderer/AnimationMotion.hpp"
 #include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/AnimationReplay.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Input/BinaryReader.hpp"
+#include "Engine/Input/FileView.hpp"
 #include "Engine/Input/BinaryWriter.hpp"
-#include "Engine/Input/Console.hpp"
 #include <vector>
+#include <algorithm>
+#include <math.h>
 
-extern Skeleton* g_loadedSkeleton;
 AnimationMotion* g_loadedMotion = nullptr;
 std::vector<AnimationMotion*>* g_loadedMotions = nullptr;
 
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(saveMotion)
-{
-    if (!args.HasArgs(1))
-    {
-        Console::instance->PrintLine("saveMotion <filename>", RGBA::RED);
-        return;
-    }
-    std::string filename = args.GetStringArgument(0);
-    if (!g_loadedSkeleton)
-    {
-        Console::instance->PrintLine("Error: No skeleton has been loaded yet, use fbxLoad to bring in a mesh with a skeleton first.", RGBA::RED);
-        return;
-    }
-    g_loadedMotion->WriteToFile(filename.c_str());
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(loadMotion)
-{
-    if (!args.HasArgs(1))
-    {
-        Console::instance->PrintLine("loadMotion <filename>", RGBA::RED);
-        return;
-    }
-    std::string filename = args.GetStringArgument(0);
-    if (g_loadedMotion)
-    {
-        delete g_loadedMotion;
-    }
-    g_loadedMotion = new AnimationMotion();
-    g_loadedMotion->ReadFromFile(filename.c_str());
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(combineMotions)
-{
-    if (!args.HasArgs(2))
-    {
-        Console::instance->PrintLine("combineMotions <filename1> <filename2>", RGBA::RED);
-        return;
-    }
-    std::string filename0 = args.GetStringArgument(0);
-    std::string filename1 = args.GetStringArgument(1);
-    if (g_loadedMotion)
-    {
-        delete g_loadedMotion;
-        g_loadedMotion = nullptr;
-    }
-    if (g_loadedMotions)
-    {
-        g_loadedMotions->clear();
-        delete g_loadedMotions;
-        g_loadedMotions = nullptr;
-    }
-    g_loadedMotions = new std::vector<AnimationMotion*>();
-    g_loadedMotions->push_back(new AnimationMotion());
-    g_loadedMotions->push_back(new AnimationMotion());
-    g_loadedMotions->at(0)->ReadFromFile(filename0.c_str());
-    g_loadedMotions->at(1)->ReadFromFile(filename1.c_str());
-}
-
 //-----------------------------------------------------------------------------------
 AnimationMotion::AnimationMotion(const std::string& motionName, float timeSpan, float framerate, Skeleton* skeleton)
     : m_motionName(motionName)
@@ -90,6 +30,10 @@ AnimationMotion::AnimationMotion(const std::string& motionName, float timeSpan,
 //-----------------------------------------------------------------------------------
 AnimationMotion::~AnimationMotion()
 {
+    if (AnimationRecorder::instance)
+    {
+        AnimationRecorder::instance->ForgetMotion(this);
+    }
     delete[] m_keyframes;
 }
 
@@ -193,6 +137,11 @@ Matrix4x4* AnimationMotion::GetJointKeyframes(uint32_t jointIndex)
 //-----------------------------------------------------------------------------------
 void AnimationMotion::ApplyMotionToSkeleton(Skeleton* skeleton, float time, BoneMask& mask)
 {
+    if (AnimationRecorder::instance)
+    {
+        AnimationRecorder::instance->RecordLayer(skeleton, this, time, mask);
+    }
+
     uint32_t frame0 = 0;
     uint32_t frame1 = 0;
     float blend;
@@ -258,9 +207,27 @@ void AnimationMotion::ApplyMotionToSkeleton(Skeleton* skeleton, float time, Bone
         //(Or set your matrix tree's world to this, and set
         //bone to model on Skelelton world's array
         //skeleton->SetWorldBoneToModel(finalModel, jointIndex);
-        skeleton->SetLocalBoneToModelAndWorldUpdate(finalModel, jointIndex);
         //skeleton->m_jointArray[jointIndex].m_boneToModelSpace = finalModel; //SetJointWorldTransform(jointIndex, newModel);
+        skeleton->m_jointArray[jointIndex].m_localBoneToModelSpace = finalModel;
+    }
+    //Locals are all set, push them down the hierarchy once instead of per joint.
+    skeleton->UpdateWorldFromLocals();
+}
+
+//-----------------------------------------------------------------------------------
+//Permutes the per-joint keyframe tracks to match a skeleton that has had its joints reordered.
+void AnimationMotion::RemapJoints(const std::vector<int>& oldToNewJointIndices)
+{
+    ASSERT_OR_DIE(oldToNewJointIndices.size() == (size_t)m_jointCount, "Joint remap didn't match the motion's joint count!");
+    Matrix4x4* remappedKeyframes = new Matrix4x4[m_frameCount * m_jointCount];
+    for (int oldIndex = 0; oldIndex < m_jointCount; ++oldIndex)
+    {
+        Matrix4x4* oldTrack = GetJointKeyframes(oldIndex);
+        Matrix4x4* newTrack = remappedKeyframes + (m_frameCount * oldToNewJointIndices[oldIndex]);
+        std::copy(oldTrack, oldTrack + m_frameCount, newTrack);
     }
+    delete[] m_keyframes;
+    m_keyframes = remappedKeyframes;
 }
 
 //-----------------------------------------------------------------------------------
@@ -274,6 +241,9 @@ void AnimationMotion::WriteToFile(const char* filename)
     writer.Close();
 }
 
+//-----------------------------------------------------------------------------------
+static_assert(sizeof(Matrix4x4) == sizeof(float) * 16, "Keyframes are serialized as one contiguous block of floats");
+
 //-----------------------------------------------------------------------------------
 void AnimationMotion::WriteToStream(IBinaryWriter& writer)
 {
@@ -286,7 +256,7 @@ void AnimationMotion::WriteToStream(IBinaryWriter& writer)
     //Joint count
     //Keyframes
 
-    writer.Write<uint32_t>(FILE_VERSION);
+    writer.Write<uint32_t>((uint32_t)FILE_VERSION);
     writer.Write<uint32_t>(m_frameCount);
     writer.Write<float>(m_totalLengthSeconds);
     writer.Write<float>(m_frameRate);
@@ -296,15 +266,9 @@ void AnimationMotion::WriteToStream(IBinaryWriter& writer)
     writer.Write<PLAYBACK_MODE>(m_playbackMode);
     writer.Write<float>(m_lastTime);
 
+    //The keyframes are one contiguous block of floats, so they go out in a single write.
     unsigned int numKeyframes = m_frameCount * m_jointCount;
-    for (unsigned int index = 0; index < numKeyframes; ++index)
-    {
-        Matrix4x4 mat = m_keyframes[index];
-        for (int i = 0; i < 16; ++i)
-        {
-            writer.Write<float>(mat.data[i]);
-        }
-    }
+    writer.WriteArray(m_keyframes[0].data, numKeyframes * 16);
 }
 
 //-----------------------------------------------------------------------------------
@@ -326,35 +290,23 @@ void AnimationMotion::ReadFromStream(IBinaryReader& reader)
     ASSERT_OR_DIE(reader.Read<float>(m_totalLengthSeconds), "Failed to read frame count");
     ASSERT_OR_DIE(reader.Read<float>(m_frameRate), "Failed to read frame count");
     ASSERT_OR_DIE(reader.Read<float>(m_frameTime), "Failed to read frame count");
-    const char* motionName = nullptr;
-    reader.ReadString(motionName, 64);
-    m_motionName = std::string(motionName);
+    reader.ReadString(m_motionName);
     ASSERT_OR_DIE(reader.Read<int>(m_jointCount), "Failed to read frame count");
     ASSERT_OR_DIE(reader.Read<PLAYBACK_MODE>(m_playbackMode), "Failed to read playback mode");
     ASSERT_OR_DIE(reader.Read<float>(m_lastTime), "Failed to read last time");
 
     unsigned int numKeyframes = m_frameCount * m_jointCount; 
     m_keyframes = new Matrix4x4[numKeyframes];
-    for (unsigned int index = 0; index < numKeyframes; ++index)
-    {
-        Matrix4x4 matrix = Matrix4x4::IDENTITY;
-        for (int i = 0; i < 16; ++i)
-        {
-            reader.Read<float>(matrix.data[i]);
-        }
-        m_keyframes[index] = matrix;
-    }
+    ASSERT_OR_DIE(reader.ReadArray(m_keyframes[0].data, numKeyframes * 16), "Failed to read keyframes");
 }
 
 //-----------------------------------------------------------------------------------
 void AnimationMotion::ReadFromFile(const char* filename)
 {
-    BinaryFileReader reader;
-    ASSERT_OR_DIE(reader.Open(filename), "File Open failed!");
-    {
-        ReadFromStream(reader);
-    }
-    reader.Close();
+    FileView file;
+    ASSERT_OR_DIE(file.Open(filename), "File Open failed!");
+    BinaryMemoryReader reader(file.GetData(), file.GetSize());
+    ReadFromStream(reader);
 }
 
 //-----------------------------------------------------------------------------------
@@ -372,3 +324,24 @@ void BoneMask::SetAllBonesTo(float boneWeight)
         maskWeight = boneWeight;
     }
 }
+
+
+//-----------------------------------------------------------------------------------
+//Only maps to a whole subtree when the skeleton is depth-first ordered, see Skeleton::GetSubtreeEndIndex.
+void BoneMask::SetBoneRangeTo(unsigned int startIndex, unsigned int endIndex, float boneWeight)
+{
+    ASSERT_OR_DIE(startIndex <= endIndex && endIndex <= boneMasks.size(), "Bone range was outside of the mask!");
+    std::fill(boneMasks.begin() + startIndex, boneMasks.begin() + endIndex, boneWeight);
+}
+
+//-----------------------------------------------------------------------------------
+void BoneMask::RemapBones(const std::vector<int>& oldToNewJointIndices)
+{
+    ASSERT_OR_DIE(oldToNewJointIndices.size() == boneMasks.size(), "Joint remap didn't match the mask's bone count!");
+    std::vector<float> remappedMasks(boneMasks.size());
+    for (size_t oldIndex = 0; oldIndex < boneMasks.size(); ++oldIndex)
+    {
+        remappedMasks[oldToNewJointIndices[oldIndex]] = boneMasks[oldIndex];
+    }
+    boneMasks.swap(remappedMasks);
+}
\ No newline at end of file
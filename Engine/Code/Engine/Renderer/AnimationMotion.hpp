@@ -12,6 +12,8 @@ struct BoneMask
 {
     BoneMask(unsigned int numBones);
     void SetAllBonesTo(float boneWeight);
+    void SetBoneRangeTo(unsigned int startIndex, unsigned int endIndex, float boneWeight);
+    void RemapBones(const std::vector<int>& oldToNewJointIndices);
 
     std::vector<float> boneMasks;
 };
@@ -40,6 +42,7 @@ public:
     Matrix4x4* GetJointKeyframes(uint32_t jointIndex);
     void ApplyMotionToSkeleton(Skeleton* skeleton, float time);
     void ApplyMotionToSkeleton(Skeleton* skeleton, float time, BoneMask& boneMask);
+    void RemapJoints(const std::vector<int>& oldToNewJointIndices);
     
     //FILE IO//////////////////////////////////////////////////////////////////////////
     void WriteToFile(const char* filename);
@@ -59,5 +62,5 @@ public:
     PLAYBACK_MODE m_playbackMode;
     float m_lastTime;
 
-    const unsigned int FILE_VERSION = 1;
+    static const unsigned int FILE_VERSION = 1;
 };
\ No newline at end of file
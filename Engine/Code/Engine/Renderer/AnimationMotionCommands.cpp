@@ -0,0 +1,70 @@
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Input/Console.hpp"
+
+//The console side of AnimationMotion, kept out of AnimationMotion.cpp so the cooker can read and write motions without linking the console.
+extern Skeleton* g_loadedSkeleton;
+extern AnimationMotion* g_loadedMotion;
+extern std::vector<AnimationMotion*>* g_loadedMotions;
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(saveMotion)
+{
+    if (!args.HasArgs(1))
+    {
+        Console::instance->PrintLine("saveMotion <filename>", RGBA::RED);
+        return;
+    }
+    std::string filename = args.GetStringArgument(0);
+    if (!g_loadedSkeleton)
+    {
+        Console::instance->PrintLine("Error: No skeleton has been loaded yet, use fbxLoad to bring in a mesh with a skeleton first.", RGBA::RED);
+        return;
+    }
+    g_loadedMotion->WriteToFile(filename.c_str());
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(loadMotion)
+{
+    if (!args.HasArgs(1))
+    {
+        Console::instance->PrintLine("loadMotion <filename>", RGBA::RED);
+        return;
+    }
+    std::string filename = args.GetStringArgument(0);
+    if (g_loadedMotion)
+    {
+        delete g_loadedMotion;
+    }
+    g_loadedMotion = new AnimationMotion();
+    g_loadedMotion->ReadFromFile(filename.c_str());
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(combineMotions)
+{
+    if (!args.HasArgs(2))
+    {
+        Console::instance->PrintLine("combineMotions <filename1> <filename2>", RGBA::RED);
+        return;
+    }
+    std::string filename0 = args.GetStringArgument(0);
+    std::string filename1 = args.GetStringArgument(1);
+    if (g_loadedMotion)
+    {
+        delete g_loadedMotion;
+        g_loadedMotion = nullptr;
+    }
+    if (g_loadedMotions)
+    {
+        g_loadedMotions->clear();
+        delete g_loadedMotions;
+        g_loadedMotions = nullptr;
+    }
+    g_loadedMotions = new std::vector<AnimationMotion*>();
+    g_loadedMotions->push_back(new AnimationMotion());
+    g_loadedMotions->push_back(new AnimationMotion());
+    g_loadedMotions->at(0)->ReadFromFile(filename0.c_str());
+    g_loadedMotions->at(1)->ReadFromFile(filename1.c_str());
+}
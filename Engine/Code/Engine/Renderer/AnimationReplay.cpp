@@ -0,0 +1,407 @@
+#include "Engine/Renderer/AnimationReplay.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/ProfilingUtils.h"
+#include "Engine/Input/BinaryReader.hpp"
+#include "Engine/Input/FileView.hpp"
+#include "Engine/Input/BinaryWriter.hpp"
+#include <math.h>
+
+AnimationRecorder* AnimationRecorder::instance = nullptr;
+
+//-----------------------------------------------------------------------------------
+AnimationRecorder::AnimationRecorder(bool recordPoses)
+    : m_recordPoses(recordPoses)
+{
+}
+
+//-----------------------------------------------------------------------------------
+//Called from ApplyMotionToSkeleton before it touches anything, so the motion state is what the call is about to read.
+void AnimationRecorder::RecordLayer(Skeleton* skeleton, AnimationMotion* motion, float time, const BoneMask& mask)
+{
+    AnimationReplayLayer layer;
+    layer.instanceIndex = GetInstanceIndex(skeleton);
+    layer.motionHandle = GetMotionHandle(motion);
+    layer.playbackMode = (uint8_t)motion->m_playbackMode;
+    layer.time = time;
+    layer.lastTime = motion->m_lastTime;
+
+    uint32_t maskKey = ((uint32_t)layer.instanceIndex << 16) | layer.motionHandle;
+    auto lastMask = m_lastMasks.find(maskKey);
+    if (lastMask == m_lastMasks.end() || lastMask->second != mask.boneMasks)
+    {
+        layer.boneMasks = mask.boneMasks;
+        m_lastMasks[maskKey] = mask.boneMasks;
+    }
+    m_currentFrame.layers.push_back(layer);
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationRecorder::EndFrame()
+{
+    if (m_recordPoses)
+    {
+        //Delta against what the player will have reconstructed rather than the true last pose, so quantization error can't build up.
+        const float stepsPerUnit = (float)POSE_QUANTIZATION_STEPS_PER_UNIT;
+        for (size_t instanceIndex = 0; instanceIndex < m_instances.size(); ++instanceIndex)
+        {
+            Skeleton* skeleton = m_instances[instanceIndex];
+            std::vector<Matrix4x4>& reconstructedPose = m_reconstructedPoses[instanceIndex];
+            for (size_t jointIndex = 0; jointIndex < reconstructedPose.size(); ++jointIndex)
+            {
+                const Matrix4x4& pose = skeleton ? skeleton->m_jointArray[jointIndex].m_localBoneToModelSpace : reconstructedPose[jointIndex];
+                for (int i = 0; i < POSE_FLOATS_PER_JOINT; ++i)
+                {
+                    float delta = (pose.data[i] - reconstructedPose[jointIndex].data[i]) * stepsPerUnit;
+                    int quantizedDelta = (int)floor(delta + 0.5f);
+                    quantizedDelta = quantizedDelta > INT16_MAX ? INT16_MAX : (quantizedDelta < INT16_MIN ? INT16_MIN : quantizedDelta);
+                    m_currentFrame.quantizedPoseDeltas.push_back((int16_t)quantizedDelta);
+                    reconstructedPose[jointIndex].data[i] += (float)quantizedDelta / stepsPerUnit;
+                }
+            }
+        }
+    }
+    m_frames.push_back(m_currentFrame);
+    m_currentFrame = AnimationReplayFrame();
+}
+
+//-----------------------------------------------------------------------------------
+uint16_t AnimationRecorder::GetInstanceIndex(Skeleton* skeleton)
+{
+    for (size_t i = 0; i < m_instances.size(); ++i)
+    {
+        if (m_instances[i] == skeleton)
+        {
+            return (uint16_t)i;
+        }
+    }
+    ASSERT_OR_DIE(m_instances.size() < UINT16_MAX, "Too many skeletons in one recording!");
+
+    //First time we've seen this skeleton, stash the pose it started from since masked layers blend against it.
+    std::vector<Matrix4x4> initialPose;
+    for (const Joint& joint : skeleton->m_jointArray)
+    {
+        initialPose.push_back(joint.m_localBoneToModelSpace);
+    }
+    m_instances.push_back(skeleton);
+    m_initialPoses.push_back(initialPose);
+    m_reconstructedPoses.push_back(initialPose);
+    return (uint16_t)(m_instances.size() - 1);
+}
+
+//-----------------------------------------------------------------------------------
+uint16_t AnimationRecorder::GetMotionHandle(AnimationMotion* motion)
+{
+    for (size_t i = 0; i < m_motions.size(); ++i)
+    {
+        if (m_motions[i] == motion)
+        {
+            return (uint16_t)i;
+        }
+    }
+    ASSERT_OR_DIE(m_motions.size() < UINT16_MAX, "Too many motions in one recording!");
+    m_motions.push_back(motion);
+    m_motionNames.push_back(motion->m_motionName);
+    m_motionJointCounts.push_back(motion->m_jointCount);
+    return (uint16_t)(m_motions.size() - 1);
+}
+
+//-----------------------------------------------------------------------------------
+//The slot stays so the instance indices already recorded keep pointing at the right pose.
+void AnimationRecorder::ForgetSkeleton(const Skeleton* skeleton)
+{
+    for (Skeleton*& instance : m_instances)
+    {
+        if (instance == skeleton)
+        {
+            instance = nullptr;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Nulled rather than erased, so a new motion that happens to get the same address gets a handle of its own.
+void AnimationRecorder::ForgetMotion(const AnimationMotion* motion)
+{
+    for (AnimationMotion*& recordedMotion : m_motions)
+    {
+        if (recordedMotion == motion)
+        {
+            recordedMotion = nullptr;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationRecorder::WriteToFile(const char* filename)
+{
+    BinaryFileWriter writer;
+    ASSERT_OR_DIE(writer.Open(filename), "File Open failed!");
+    {
+        WriteToStream(writer);
+    }
+    writer.Close();
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationRecorder::WriteToStream(IBinaryWriter& writer)
+{
+    //FILE VERSION
+    //Has poses
+    //Motion count, then name and joint count for each
+    //Instance count, then the initial local pose for each
+    //Frame count, then for each frame:
+    //  Layer count, then instance, motion, playback mode, time, last time and mask for each
+    //  Quantized pose deltas
+
+    writer.Write<uint32_t>((uint32_t)FILE_VERSION);
+    writer.Write<uint8_t>(m_recordPoses ? 1 : 0);
+
+    writer.Write<uint32_t>(m_motionNames.size());
+    for (size_t i = 0; i < m_motionNames.size(); ++i)
+    {
+        writer.WriteString(m_motionNames[i].c_str());
+        writer.Write<int>(m_motionJointCounts[i]);
+    }
+
+    writer.Write<uint32_t>(m_initialPoses.size());
+    for (const std::vector<Matrix4x4>& pose : m_initialPoses)
+    {
+        writer.Write<uint32_t>(pose.size());
+        if (!pose.empty())
+        {
+            writer.WriteArray(pose[0].data, pose.size() * 16);
+        }
+    }
+
+    writer.Write<uint32_t>(m_frames.size());
+    for (const AnimationReplayFrame& frame : m_frames)
+    {
+        writer.Write<uint32_t>(frame.layers.size());
+        for (const AnimationReplayLayer& layer : frame.layers)
+        {
+            writer.Write<uint16_t>(layer.instanceIndex);
+            writer.Write<uint16_t>(layer.motionHandle);
+            writer.Write<uint8_t>(layer.playbackMode);
+            writer.Write<float>(layer.time);
+            writer.Write<float>(layer.lastTime);
+            writer.Write<uint32_t>(layer.boneMasks.size());
+            writer.WriteArray(layer.boneMasks);
+        }
+        if (m_recordPoses)
+        {
+            writer.Write<uint32_t>(frame.quantizedPoseDeltas.size());
+            writer.WriteArray(frame.quantizedPoseDeltas);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+AnimationReplayStats AnimationReplayPlayer::Replay(const Skeleton& bindSkeleton, const std::vector<AnimationMotion*>& availableMotions)
+{
+    //Match recorded motions to loaded ones by name. Names can repeat (two takes both called "Take 001"), so hand them out in order.
+    std::vector<AnimationMotion*> motions;
+    std::vector<bool> isMotionUsed(availableMotions.size(), false);
+    for (size_t handle = 0; handle < m_motionNames.size(); ++handle)
+    {
+        AnimationMotion* match = nullptr;
+        for (size_t i = 0; i < availableMotions.size(); ++i)
+        {
+            if (!isMotionUsed[i] && availableMotions[i]->m_motionName == m_motionNames[handle] && availableMotions[i]->m_jointCount == m_motionJointCounts[handle])
+            {
+                match = availableMotions[i];
+                isMotionUsed[i] = true;
+                break;
+            }
+        }
+        ASSERT_OR_DIE(match != nullptr, Stringf("Couldn't find a loaded motion matching '%s' for the replay!", m_motionNames[handle].c_str()));
+        motions.push_back(match);
+    }
+
+    //Playback state gets overwritten per layer, put it back afterwards so live motions aren't disturbed.
+    std::vector<AnimationMotion::PLAYBACK_MODE> savedPlaybackModes;
+    std::vector<float> savedLastTimes;
+    for (AnimationMotion* motion : motions)
+    {
+        savedPlaybackModes.push_back(motion->m_playbackMode);
+        savedLastTimes.push_back(motion->m_lastTime);
+    }
+    //Don't record ourselves if a recording happens to be running.
+    AnimationRecorder* activeRecorder = AnimationRecorder::instance;
+    AnimationRecorder::instance = nullptr;
+
+    std::vector<Skeleton*> instances;
+    for (const std::vector<Matrix4x4>& initialPose : m_initialPoses)
+    {
+        ASSERT_OR_DIE(initialPose.size() == bindSkeleton.m_jointArray.size(), "Replay skeleton didn't match the recorded joint count!");
+        Skeleton* skeleton = new Skeleton();
+        skeleton->m_jointArray = bindSkeleton.m_jointArray;
+        for (size_t jointIndex = 0; jointIndex < initialPose.size(); ++jointIndex)
+        {
+            skeleton->m_jointArray[jointIndex].m_localBoneToModelSpace = initialPose[jointIndex];
+        }
+        skeleton->UpdateWorldFromLocals();
+        instances.push_back(skeleton);
+    }
+    std::vector<std::vector<Matrix4x4>> reconstructedPoses = m_initialPoses;
+    std::map<uint32_t, BoneMask> masks;
+
+    AnimationReplayStats stats;
+    m_frameSeconds.clear();
+    m_frameDivergence.clear();
+    const float stepsPerUnit = (float)AnimationRecorder::POSE_QUANTIZATION_STEPS_PER_UNIT;
+    uint32_t numInstancesSeen = 0;
+    for (size_t frameIndex = 0; frameIndex < m_frames.size(); ++frameIndex)
+    {
+        const AnimationReplayFrame& frame = m_frames[frameIndex];
+        double frameSeconds = 0.0;
+        for (const AnimationReplayLayer& layer : frame.layers)
+        {
+            uint32_t maskKey = ((uint32_t)layer.instanceIndex << 16) | layer.motionHandle;
+            auto mask = masks.find(maskKey);
+            if (mask == masks.end())
+            {
+                mask = masks.insert(std::make_pair(maskKey, BoneMask(0))).first;
+            }
+            if (!layer.boneMasks.empty())
+            {
+                mask->second.boneMasks = layer.boneMasks;
+            }
+
+            AnimationMotion* motion = motions[layer.motionHandle];
+            motion->m_playbackMode = (AnimationMotion::PLAYBACK_MODE)layer.playbackMode;
+            motion->m_lastTime = layer.lastTime;
+            numInstancesSeen = (layer.instanceIndex + 1u > numInstancesSeen) ? layer.instanceIndex + 1u : numInstancesSeen;
+
+            StartTiming();
+            motion->ApplyMotionToSkeleton(instances[layer.instanceIndex], layer.time, mask->second);
+            frameSeconds += EndTiming();
+        }
+
+        //The recorder wrote deltas for every instance it had seen by the end of the frame, which is the same set we've seen.
+        float frameDivergence = 0.0f;
+        if (m_hasPoses)
+        {
+            size_t deltaIndex = 0;
+            for (uint32_t instanceIndex = 0; instanceIndex < numInstancesSeen; ++instanceIndex)
+            {
+                std::vector<Matrix4x4>& reconstructedPose = reconstructedPoses[instanceIndex];
+                const std::vector<Joint>& joints = instances[instanceIndex]->m_jointArray;
+                for (size_t jointIndex = 0; jointIndex < reconstructedPose.size(); ++jointIndex)
+                {
+                    for (int i = 0; i < AnimationRecorder::POSE_FLOATS_PER_JOINT; ++i)
+                    {
+                        ASSERT_OR_DIE(deltaIndex < frame.quantizedPoseDeltas.size(), "Replay had fewer pose deltas than expected!");
+                        reconstructedPose[jointIndex].data[i] += (float)frame.quantizedPoseDeltas[deltaIndex++] / stepsPerUnit;
+                        float divergence = fabs(reconstructedPose[jointIndex].data[i] - joints[jointIndex].m_localBoneToModelSpace.data[i]);
+                        frameDivergence = divergence > frameDivergence ? divergence : frameDivergence;
+                    }
+                }
+            }
+            ASSERT_OR_DIE(deltaIndex == frame.quantizedPoseDeltas.size(), "Replay had more pose deltas than expected!");
+        }
+
+        m_frameSeconds.push_back(frameSeconds);
+        m_frameDivergence.push_back(frameDivergence);
+        stats.totalSeconds += frameSeconds;
+        stats.minFrameSeconds = (frameIndex == 0 || frameSeconds < stats.minFrameSeconds) ? frameSeconds : stats.minFrameSeconds;
+        stats.maxFrameSeconds = frameSeconds > stats.maxFrameSeconds ? frameSeconds : stats.maxFrameSeconds;
+        if (frameDivergence > stats.maxPoseDivergence)
+        {
+            stats.maxPoseDivergence = frameDivergence;
+            stats.worstFrameIndex = frameIndex;
+        }
+        ++stats.frameCount;
+    }
+
+    for (Skeleton* skeleton : instances)
+    {
+        delete skeleton;
+    }
+    for (size_t i = 0; i < motions.size(); ++i)
+    {
+        motions[i]->m_playbackMode = savedPlaybackModes[i];
+        motions[i]->m_lastTime = savedLastTimes[i];
+    }
+    AnimationRecorder::instance = activeRecorder;
+    return stats;
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationReplayPlayer::ReadFromStream(IBinaryReader& reader)
+{
+    //See AnimationRecorder::WriteToStream for the layout.
+
+    uint32_t fileVersion = 0;
+    ASSERT_OR_DIE(reader.Read<uint32_t>(fileVersion), "Failed to read file version");
+    ASSERT_OR_DIE(fileVersion == AnimationRecorder::FILE_VERSION, "File version didn't match!");
+    uint8_t hasPoses = 0;
+    ASSERT_OR_DIE(reader.Read<uint8_t>(hasPoses), "Failed to read pose flag");
+    m_hasPoses = hasPoses != 0;
+
+    uint32_t motionCount = 0;
+    ASSERT_OR_DIE(reader.Read<uint32_t>(motionCount), "Failed to read motion count");
+    m_motionNames.resize(motionCount);
+    m_motionJointCounts.resize(motionCount);
+    for (uint32_t i = 0; i < motionCount; ++i)
+    {
+        //A short read still returns the stored length, but leaves the string short of it.
+        ASSERT_OR_DIE(reader.ReadString(m_motionNames[i]) == m_motionNames[i].size() + 1, "Failed to read motion name");
+        ASSERT_OR_DIE(reader.Read<int>(m_motionJointCounts[i]), "Failed to read motion joint count");
+    }
+
+    uint32_t instanceCount = 0;
+    ASSERT_OR_DIE(reader.Read<uint32_t>(instanceCount), "Failed to read instance count");
+    m_initialPoses.resize(instanceCount);
+    for (uint32_t instanceIndex = 0; instanceIndex < instanceCount; ++instanceIndex)
+    {
+        uint32_t jointCount = 0;
+        ASSERT_OR_DIE(reader.Read<uint32_t>(jointCount), "Failed to read joint count");
+        m_initialPoses[instanceIndex].resize(jointCount);
+        if (jointCount > 0)
+        {
+            ASSERT_OR_DIE(reader.ReadArray(m_initialPoses[instanceIndex][0].data, jointCount * 16), "Failed to read initial pose");
+        }
+    }
+
+    uint32_t frameCount = 0;
+    ASSERT_OR_DIE(reader.Read<uint32_t>(frameCount), "Failed to read frame count");
+    m_frames.resize(frameCount);
+    for (AnimationReplayFrame& frame : m_frames)
+    {
+        uint32_t layerCount = 0;
+        ASSERT_OR_DIE(reader.Read<uint32_t>(layerCount), "Failed to read layer count");
+        frame.layers.resize(layerCount);
+        for (AnimationReplayLayer& layer : frame.layers)
+        {
+            ASSERT_OR_DIE(reader.Read<uint16_t>(layer.instanceIndex), "Failed to read layer instance");
+            ASSERT_OR_DIE(reader.Read<uint16_t>(layer.motionHandle), "Failed to read layer motion");
+            ASSERT_OR_DIE(reader.Read<uint8_t>(layer.playbackMode), "Failed to read layer playback mode");
+            ASSERT_OR_DIE(reader.Read<float>(layer.time), "Failed to read layer time");
+            ASSERT_OR_DIE(reader.Read<float>(layer.lastTime), "Failed to read layer last time");
+            uint32_t maskCount = 0;
+            ASSERT_OR_DIE(reader.Read<uint32_t>(maskCount), "Failed to read layer mask count");
+            layer.boneMasks.resize(maskCount);
+            ASSERT_OR_DIE(reader.ReadArray(layer.boneMasks), "Failed to read layer mask");
+            ASSERT_OR_DIE(layer.instanceIndex < instanceCount && layer.motionHandle < motionCount, "Replay layer referenced something that wasn't recorded!");
+        }
+        if (m_hasPoses)
+        {
+            uint32_t deltaCount = 0;
+            ASSERT_OR_DIE(reader.Read<uint32_t>(deltaCount), "Failed to read pose delta count");
+            frame.quantizedPoseDeltas.resize(deltaCount);
+            ASSERT_OR_DIE(reader.ReadArray(frame.quantizedPoseDeltas), "Failed to read pose deltas");
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationReplayPlayer::ReadFromFile(const char* filename)
+{
+    FileView file;
+    ASSERT_OR_DIE(file.Open(filename), "File Open failed!");
+    BinaryMemoryReader reader(file.GetData(), file.GetSize());
+    ReadFromStream(reader);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "Engine/Math/Matrix4x4.hpp"
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <vector>
+
+class Skeleton;
+class AnimationMotion;
+struct BoneMask;
+class IBinaryReader;
+class IBinaryWriter;
+
+//-----------------------------------------------------------------------------------
+//One ApplyMotionToSkeleton call, with all of the motion state it reads so it can be reissued exactly.
+struct AnimationReplayLayer
+{
+    uint16_t instanceIndex;
+    uint16_t motionHandle;
+    uint8_t playbackMode;
+    float time;
+    float lastTime;
+    //Left empty when the mask matches the last one recorded for this instance and motion.
+    std::vector<float> boneMasks;
+};
+
+//-----------------------------------------------------------------------------------
+struct AnimationReplayFrame
+{
+    std::vector<AnimationReplayLayer> layers;
+    //Local pose deltas for every instance seen so far, [instance][joint][POSE_FLOATS_PER_JOINT]. Empty unless poses are recorded.
+    std::vector<int16_t> quantizedPoseDeltas;
+};
+
+//-----------------------------------------------------------------------------------
+struct AnimationReplayStats
+{
+    AnimationReplayStats() : frameCount(0), totalSeconds(0.0), minFrameSeconds(0.0), maxFrameSeconds(0.0), maxPoseDivergence(0.0f), worstFrameIndex(0) {};
+
+    uint32_t frameCount;
+    double totalSeconds;
+    double minFrameSeconds;
+    double maxFrameSeconds;
+    float maxPoseDivergence;
+    uint32_t worstFrameIndex;
+};
+
+//-----------------------------------------------------------------------------------
+class AnimationRecorder
+{
+public:
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    AnimationRecorder(bool recordPoses);
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    void RecordLayer(Skeleton* skeleton, AnimationMotion* motion, float time, const BoneMask& mask);
+    void EndFrame();
+    inline uint32_t GetFrameCount() const { return m_frames.size(); };
+    //Called by ~Skeleton and ~AnimationMotion while recording, so the recorder never reads one that's been deleted.
+    //A forgotten skeleton holds its last pose for the rest of the recording.
+    void ForgetSkeleton(const Skeleton* skeleton);
+    void ForgetMotion(const AnimationMotion* motion);
+
+    //FILE IO//////////////////////////////////////////////////////////////////////////
+    void WriteToFile(const char* filename);
+    void WriteToStream(IBinaryWriter& writer);
+
+    //STATIC VARIABLES//////////////////////////////////////////////////////////////////////////
+    //Set while a recording is running, ApplyMotionToSkeleton reports to it.
+    static AnimationRecorder* instance;
+
+    //1: Initial Version
+    static const uint32_t FILE_VERSION = 1;
+    //Only the first three columns of a local matrix change, the last is always (0, 0, 0, 1).
+    static const int POSE_FLOATS_PER_JOINT = 12;
+    //Pose deltas are stored in 1/4096ths of a unit.
+    static const int POSE_QUANTIZATION_STEPS_PER_UNIT = 4096;
+
+private:
+    uint16_t GetInstanceIndex(Skeleton* skeleton);
+    uint16_t GetMotionHandle(AnimationMotion* motion);
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    std::vector<Skeleton*> m_instances;
+    std::vector<std::vector<Matrix4x4>> m_initialPoses;
+    std::vector<std::vector<Matrix4x4>> m_reconstructedPoses;
+    std::map<uint32_t, std::vector<float>> m_lastMasks;
+    std::vector<AnimationMotion*> m_motions;
+    //Copied when the motion is first seen, since it may be gone by the time the recording is written.
+    std::vector<std::string> m_motionNames;
+    std::vector<int> m_motionJointCounts;
+    std::vector<AnimationReplayFrame> m_frames;
+    AnimationReplayFrame m_currentFrame;
+    bool m_recordPoses;
+};
+
+//-----------------------------------------------------------------------------------
+//Headless playback of a recording: needs no renderer, only the skeleton and motions the recording was made with.
+class AnimationReplayPlayer
+{
+public:
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    AnimationReplayPlayer() : m_hasPoses(false) {};
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    AnimationReplayStats Replay(const Skeleton& bindSkeleton, const std::vector<AnimationMotion*>& availableMotions);
+
+    //FILE IO//////////////////////////////////////////////////////////////////////////
+    void ReadFromStream(IBinaryReader& reader);
+    void ReadFromFile(const char* filename);
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    std::vector<std::string> m_motionNames;
+    std::vector<int> m_motionJointCounts;
+    std::vector<std::vector<Matrix4x4>> m_initialPoses;
+    std::vector<AnimationReplayFrame> m_frames;
+    bool m_hasPoses;
+    //Filled in by Replay, one entry per frame.
+    std::vector<double> m_frameSeconds;
+    std::vector<float> m_frameDivergence;
+};
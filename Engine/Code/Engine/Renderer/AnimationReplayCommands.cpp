@@ -0,0 +1,84 @@
+#include "Engine/Renderer/AnimationReplay.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Input/Console.hpp"
+
+//The console side of the animation recorder and player, kept out of AnimationReplay.cpp so neither needs the console.
+extern Skeleton* g_loadedSkeleton;
+extern AnimationMotion* g_loadedMotion;
+extern std::vector<AnimationMotion*>* g_loadedMotions;
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(recordAnim)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("recordAnim <record poses (0/1)>", RGBA::RED);
+        return;
+    }
+    if (AnimationRecorder::instance)
+    {
+        Console::instance->PrintLine("Error: Already recording, use saveAnimRecording to finish the current recording first.", RGBA::RED);
+        return;
+    }
+    bool recordPoses = args.HasArgs(1) ? (args.GetIntArgument(0) != 0) : true;
+    AnimationRecorder::instance = new AnimationRecorder(recordPoses);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(saveAnimRecording)
+{
+    if (!args.HasArgs(1))
+    {
+        Console::instance->PrintLine("saveAnimRecording <filename>", RGBA::RED);
+        return;
+    }
+    if (!AnimationRecorder::instance)
+    {
+        Console::instance->PrintLine("Error: Nothing is being recorded, use recordAnim to start a recording first.", RGBA::RED);
+        return;
+    }
+    std::string filename = args.GetStringArgument(0);
+    AnimationRecorder::instance->WriteToFile(filename.c_str());
+    Console::instance->PrintLine(Stringf("Saved %i frames to '%s'.", AnimationRecorder::instance->GetFrameCount(), filename.c_str()));
+    delete AnimationRecorder::instance;
+    AnimationRecorder::instance = nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(replayAnim)
+{
+    if (!args.HasArgs(1))
+    {
+        Console::instance->PrintLine("replayAnim <filename>", RGBA::RED);
+        return;
+    }
+    if (!g_loadedSkeleton)
+    {
+        Console::instance->PrintLine("Error: No skeleton has been loaded yet, use fbxLoad to bring in a mesh with a skeleton first.", RGBA::RED);
+        return;
+    }
+    std::vector<AnimationMotion*> motions;
+    if (g_loadedMotion)
+    {
+        motions.push_back(g_loadedMotion);
+    }
+    if (g_loadedMotions)
+    {
+        motions.insert(motions.end(), g_loadedMotions->begin(), g_loadedMotions->end());
+    }
+
+    std::string filename = args.GetStringArgument(0);
+    AnimationReplayPlayer player;
+    player.ReadFromFile(filename.c_str());
+    AnimationReplayStats stats = player.Replay(*g_loadedSkeleton, motions);
+
+    double averageSeconds = stats.frameCount > 0 ? stats.totalSeconds / (double)stats.frameCount : 0.0;
+    Console::instance->PrintLine(Stringf("Replayed %i frames: avg %.4fms, min %.4fms, max %.4fms", stats.frameCount, averageSeconds * 1000.0, stats.minFrameSeconds * 1000.0, stats.maxFrameSeconds * 1000.0));
+    if (player.m_hasPoses)
+    {
+        RGBA color = stats.maxPoseDivergence > (1.0f / (float)AnimationRecorder::POSE_QUANTIZATION_STEPS_PER_UNIT) ? RGBA::RED : RGBA::WHITE;
+        Console::instance->PrintLine(Stringf("Max pose divergence %f on frame %i", stats.maxPoseDivergence, stats.worstFrameIndex), color);
+    }
+}
@@ -0,0 +1,328 @@
+#include "Engine/Renderer/AssetLoading.hpp"
+#include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/ShaderProgram.hpp"
+#include "Engine/Renderer/Material.hpp"
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Input/FileView.hpp"
+#include "Engine/Input/InputOutputUtils.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Tools/AssetCooker.hpp"
+#include "Engine/Tools/EngineCookSteps.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Time/Time.hpp"
+
+//-----------------------------------------------------------------------------------
+struct DecodedImage
+{
+    DecodedImage() : data(nullptr), numComponents(0), texelSize(0, 0) {};
+    unsigned char* data;
+    int numComponents;
+    Vector2Int texelSize;
+};
+
+//-----------------------------------------------------------------------------------
+struct ShaderSources
+{
+    std::string vertSource;
+    std::string fragSource;
+};
+
+//-----------------------------------------------------------------------------------
+static bool ReadTextFile(const std::string& filename, std::string& outText)
+{
+    FileView file;
+    if (!file.Open(filename.c_str()))
+    {
+        return false;
+    }
+    outText.assign(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(asyncLoadTest)
+{
+    if (!args.HasArgs(0))
+    {
+        Console::instance->PrintLine("asyncLoadTest", RGBA::RED);
+        return;
+    }
+    const char* TEXTURES[] = { "Data/Images/Test.png", "Data/Images/stone_diffuse.png", "Data/Images/stone_normal.png", "Data/Images/pattern_81/maymay.tga", "Data/Images/perlinNoise.png" };
+    const char* MESHES[] = { "Data/joltik.picomesh" };
+    const char* MOTIONS[] = { "run.picomotion", "lose.picomotion" };
+
+    //Everything on this thread, one after the other, as the game used to load.
+    double startTime = GetCurrentTimeSeconds();
+    for (const char* filename : TEXTURES)
+    {
+        int numComponents;
+        Vector2Int texelSize;
+        Texture::FreeImageData(Texture::LoadImageData(filename, numComponents, texelSize));
+    }
+    for (const char* filename : MESHES)
+    {
+        MeshBuilder builder;
+        builder.ReadFromFile(filename);
+    }
+    for (const char* filename : MOTIONS)
+    {
+        AnimationMotion motion;
+        motion.ReadFromFile(filename);
+    }
+    double synchronousSeconds = GetCurrentTimeSeconds() - startTime;
+
+    //The same files through a headless loader, which never runs the main thread (GL) steps.
+    AsyncLoader loader(0, true);
+    std::vector<LoadHandle> handles;
+    startTime = GetCurrentTimeSeconds();
+    for (const char* filename : TEXTURES)
+    {
+        handles.push_back(LoadTextureAsync(filename, &loader));
+    }
+    std::vector<AssetHandle<MeshBuilder>> builders;
+    for (const char* filename : MESHES)
+    {
+        builders.push_back(LoadMeshBuilderAsync(filename, &loader));
+        handles.push_back(builders.back());
+    }
+    std::vector<AssetHandle<AnimationMotion>> motions;
+    for (const char* filename : MOTIONS)
+    {
+        motions.push_back(LoadMotionAsync(filename, &loader));
+        handles.push_back(motions.back());
+    }
+    handles.push_back(LoadMeshBuilderAsync("Data/missing.picomesh", &loader));
+    loader.Flush();
+    double asyncSeconds = GetCurrentTimeSeconds() - startTime;
+
+    int numReady = 0;
+    for (const LoadHandle& handle : handles)
+    {
+        numReady += handle.IsReady() ? 1 : 0;
+    }
+    for (const AssetHandle<MeshBuilder>& builder : builders)
+    {
+        delete builder.Get();
+    }
+    for (const AssetHandle<AnimationMotion>& motion : motions)
+    {
+        delete motion.Get();
+    }
+    //The missing mesh is there to make sure failures come back as failures.
+    bool passed = numReady == (int)handles.size() - 1 && handles.back().IsFailed();
+    Console::instance->PrintLine(Stringf("%i/%i ready on %i workers. Synchronous: %.2f ms, async: %.2f ms. %s", numReady, handles.size(), loader.GetWorkerCount(),
+        synchronousSeconds * 1000.0, asyncSeconds * 1000.0, passed ? "Passed." : "FAILED!"), passed ? RGBA::GREEN : RGBA::RED);
+}
+
+//-----------------------------------------------------------------------------------
+AssetHandle<Texture> LoadTextureAsync(const std::string& imageFilePath, AsyncLoader* loader)
+{
+    Texture* loadedTexture = Texture::GetTextureByName(imageFilePath);
+    if (loadedTexture && !loader->IsHeadless())
+    {
+        return loader->AddReady(imageFilePath, loadedTexture);
+    }
+    //Asking twice while it's still decoding shouldn't decode the same image twice.
+    LoadHandle inFlight = loader->FindInFlight(imageFilePath);
+    if (inFlight.IsValid())
+    {
+        return inFlight;
+    }
+
+    bool isHeadless = loader->IsHeadless();
+    std::shared_ptr<DecodedImage> image = std::make_shared<DecodedImage>();
+    AssetHandle<Texture> handle = loader->Enqueue(imageFilePath,
+        [imageFilePath, image, isHeadless](void*&)
+        {
+            image->data = Texture::LoadImageData(imageFilePath, image->numComponents, image->texelSize);
+            if (isHeadless && image->data)
+            {
+                //Nothing's ever going to upload it.
+                Texture::FreeImageData(image->data);
+                return true;
+            }
+            return image->data != nullptr;
+        },
+        [imageFilePath, image](void*& outResult)
+        {
+            //Something could have loaded it synchronously while this was decoding.
+            Texture* texture = Texture::GetTextureByName(imageFilePath);
+            if (texture)
+            {
+                Texture::FreeImageData(image->data);
+            }
+            else
+            {
+                texture = Texture::CreateTextureFromData(imageFilePath, image->data, image->numComponents, image->texelSize);
+            }
+            outResult = texture;
+            return true;
+        });
+    loader->TrackInFlight(imageFilePath, handle);
+    return handle;
+}
+
+//-----------------------------------------------------------------------------------
+AssetHandle<ShaderProgram> LoadShaderProgramAsync(const std::string& vertShaderPath, const std::string& fragShaderPath, AsyncLoader* loader)
+{
+    std::shared_ptr<ShaderSources> sources = std::make_shared<ShaderSources>();
+    return loader->Enqueue(vertShaderPath + "+" + fragShaderPath,
+        [vertShaderPath, fragShaderPath, sources](void*&)
+        {
+            return ReadTextFile(vertShaderPath, sources->vertSource) && ReadTextFile(fragShaderPath, sources->fragSource);
+        },
+        [vertShaderPath, fragShaderPath, sources](void*& outResult)
+        {
+            outResult = ShaderProgram::CreateFromSource(sources->vertSource, sources->fragSource, vertShaderPath.c_str(), fragShaderPath.c_str());
+            return true;
+        });
+}
+
+//-----------------------------------------------------------------------------------
+AssetHandle<Material> CreateMaterialAsync(const AssetHandle<ShaderProgram>& shaderProgram, const RenderState& renderState, const MaterialTextures& textures, AsyncLoader* loader)
+{
+    std::vector<LoadHandle> dependencies;
+    dependencies.push_back(shaderProgram);
+    const AssetHandle<Texture>* textureHandles[] = { &textures.diffuse, &textures.normal, &textures.emissive, &textures.noise };
+    for (const AssetHandle<Texture>* texture : textureHandles)
+    {
+        if (texture->IsValid())
+        {
+            dependencies.push_back(*texture);
+        }
+    }
+    return loader->Enqueue("Material: " + shaderProgram.GetName(), nullptr,
+        [shaderProgram, renderState, textures](void*& outResult)
+        {
+            Material* material = new Material(shaderProgram.Get(), renderState);
+            if (textures.diffuse.IsValid())
+            {
+                material->SetDiffuseTexture(textures.diffuse.Get());
+            }
+            if (textures.normal.IsValid())
+            {
+                material->SetNormalTexture(textures.normal.Get());
+            }
+            if (textures.emissive.IsValid())
+            {
+                material->SetEmissiveTexture(textures.emissive.Get());
+            }
+            if (textures.noise.IsValid())
+            {
+                material->SetNoiseTexture(textures.noise.Get());
+            }
+            outResult = material;
+            return true;
+        },
+        dependencies);
+}
+
+//-----------------------------------------------------------------------------------
+AssetHandle<MeshBuilder> LoadMeshBuilderAsync(const std::string& filename, AsyncLoader* loader)
+{
+    return loader->Enqueue(filename,
+        [filename](void*& outResult)
+        {
+            //The readers die on a missing file, so find out here and fail the request instead.
+            if (!FileExists(filename))
+            {
+                return false;
+            }
+            MeshBuilder* builder = new MeshBuilder();
+            builder->ReadFromFile(filename.c_str());
+            outResult = builder;
+            return true;
+        },
+        nullptr);
+}
+
+//-----------------------------------------------------------------------------------
+AssetHandle<Mesh> CreateMeshAsync(const AssetHandle<MeshBuilder>& builder, VertexCopyCallback* copyFunction, unsigned int sizeofVertex, Mesh::BindMeshToVAOForVertex* bindMeshFunction, AsyncLoader* loader)
+{
+    return loader->Enqueue("Mesh: " + builder.GetName(), nullptr,
+        [builder, copyFunction, sizeofVertex, bindMeshFunction](void*& outResult)
+        {
+            Mesh* mesh = new Mesh();
+            builder.Get()->CopyToMesh(mesh, copyFunction, sizeofVertex, bindMeshFunction);
+            outResult = mesh;
+            return true;
+        },
+        { builder });
+}
+
+//-----------------------------------------------------------------------------------
+AssetHandle<Mesh> CreateMeshAsync(const AssetHandle<MeshBuilder>& builder, MeshCopyFunction* copyFunction, AsyncLoader* loader)
+{
+    return loader->Enqueue("Mesh: " + builder.GetName(), nullptr,
+        [builder, copyFunction](void*& outResult)
+        {
+            Mesh* mesh = new Mesh();
+            copyFunction(*builder.Get(), mesh);
+            outResult = mesh;
+            return true;
+        },
+        { builder });
+}
+
+//-----------------------------------------------------------------------------------
+AssetHandle<Skeleton> LoadSkeletonAsync(const std::string& filename, AsyncLoader* loader)
+{
+    return loader->Enqueue(filename,
+        [filename](void*& outResult)
+        {
+            if (!FileExists(filename))
+            {
+                return false;
+            }
+            Skeleton* skeleton = new Skeleton();
+            skeleton->ReadFromFile(filename.c_str());
+            outResult = skeleton;
+            return true;
+        },
+        nullptr);
+}
+
+//-----------------------------------------------------------------------------------
+AssetHandle<AnimationMotion> LoadMotionAsync(const std::string& filename, AsyncLoader* loader)
+{
+    return loader->Enqueue(filename,
+        [filename](void*& outResult)
+        {
+            if (!FileExists(filename))
+            {
+                return false;
+            }
+            AnimationMotion* motion = new AnimationMotion();
+            motion->ReadFromFile(filename.c_str());
+            outResult = motion;
+            return true;
+        },
+        nullptr);
+}
+
+//-----------------------------------------------------------------------------------
+//Cooks Data into Cooked and packs Data.pak, the same as running the cooker with its default settings. Blocks until it's done.
+CONSOLE_COMMAND(cook)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("cook <force>", RGBA::RED);
+        return;
+    }
+    CookSettings settings;
+    settings.force = args.HasArgs(1) && args.GetStringArgument(0) == "force";
+    AssetCooker cooker(settings);
+    RegisterEngineCookSteps(cooker);
+    CookReport report;
+    bool succeeded = cooker.Cook(report);
+    for (const std::string& message : report.messages)
+    {
+        Console::instance->PrintLine(message, message.compare(0, 6, "Error:") == 0 ? RGBA::RED : RGBA::WHITE);
+    }
+    Console::instance->PrintLine(Stringf("Cooked %u of %u files in %.2f seconds: %u up to date, %u skipped, %u failed, %u stale outputs removed.%s",
+        report.numCooked, report.numSources, report.seconds, report.numUpToDate, report.numSkipped, report.numFailed, report.numRemoved,
+        report.wasPacked ? Stringf(" Packed %s.", settings.archivePath.c_str()).c_str() : ""), succeeded ? RGBA::GREEN : RGBA::RED);
+}
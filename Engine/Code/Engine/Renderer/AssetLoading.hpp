@@ -0,0 +1,39 @@
+#pragma once
+#include "Engine/Core/AsyncLoader.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/Vertex.hpp"
+#include <string>
+
+class Texture;
+class ShaderProgram;
+class Material;
+class MeshBuilder;
+class Skeleton;
+class AnimationMotion;
+struct RenderState;
+
+//-----------------------------------------------------------------------------------
+//Any of these can be left empty.
+struct MaterialTextures
+{
+    AssetHandle<Texture> diffuse;
+    AssetHandle<Texture> normal;
+    AssetHandle<Texture> emissive;
+    AssetHandle<Texture> noise;
+};
+
+//ASYNC LOADS//////////////////////////////////////////////////////////////////////////
+//Typed requests on top of the AsyncLoader. File reads and decoding happen on the workers, GL objects get created on the
+//main thread as the loader is updated. These all have to be requested from the main thread.
+//Textures go into the Texture registry like CreateOrGetTexture's do, and asking for one that's already loaded or on its way through the same loader
+//hands back the same handle. Everything else is owned by whoever asked for it once it's ready.
+AssetHandle<Texture> LoadTextureAsync(const std::string& imageFilePath, AsyncLoader* loader = AsyncLoader::instance);
+AssetHandle<ShaderProgram> LoadShaderProgramAsync(const std::string& vertShaderPath, const std::string& fragShaderPath, AsyncLoader* loader = AsyncLoader::instance);
+AssetHandle<Material> CreateMaterialAsync(const AssetHandle<ShaderProgram>& shaderProgram, const RenderState& renderState, const MaterialTextures& textures, AsyncLoader* loader = AsyncLoader::instance);
+AssetHandle<MeshBuilder> LoadMeshBuilderAsync(const std::string& filename, AsyncLoader* loader = AsyncLoader::instance);
+//Uploads once the builder's ready. The builder stays owned by its own handle's owner.
+AssetHandle<Mesh> CreateMeshAsync(const AssetHandle<MeshBuilder>& builder, VertexCopyCallback* copyFunction, unsigned int sizeofVertex, Mesh::BindMeshToVAOForVertex* bindMeshFunction, AsyncLoader* loader = AsyncLoader::instance);
+//Same as above for a VertexLayout (ie: CreateMeshAsync(builder, &Layout_PCUTB::CopyToMesh)).
+AssetHandle<Mesh> CreateMeshAsync(const AssetHandle<MeshBuilder>& builder, MeshCopyFunction* copyFunction, AsyncLoader* loader = AsyncLoader::instance);
+AssetHandle<Skeleton> LoadSkeletonAsync(const std::string& filename, AsyncLoader* loader = AsyncLoader::instance);
+AssetHandle<AnimationMotion> LoadMotionAsync(const std::string& filename, AsyncLoader* loader = AsyncLoader::instance);
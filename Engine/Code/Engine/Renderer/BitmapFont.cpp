@@ -2,6 +2,7 @@
 #include "Engine/Renderer/AABB2.hpp"
 #include "Engine/Renderer/Texture.hpp"
 #include "Engine/Input/InputOutputUtils.hpp"
+#include "Engine/Input/FileView.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 
@@ -159,14 +160,41 @@ BitmapFont::BitmapFont(const std::string& bitmapFontName, const std::string& gly
         RenderState(RenderState::DepthTestingMode::OFF, RenderState::FaceCullingMode::CULL_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND)))
 {
     m_imageDimensions = m_spriteSheet.GetTexture()->m_texelSize;
-    std::vector<std::string> glyphSheet;
-    ReadTextFileIntoVector(glyphSheet, "Data/Fonts/" + glyphFileName + ".fnt");
-    ParseGlyphInfo(glyphSheet);
+    std::string glyphFilePath = "Data/Fonts/" + glyphFileName + ".fnt";
+    FileView glyphFile;
+    ASSERT_OR_DIE(glyphFile.Open(glyphFilePath.c_str()), "Failed to open " + glyphFilePath);
+    ParseGlyphInfo(glyphFile.GetText());
     m_material->SetDiffuseTexture(m_spriteSheet.GetTexture());
 }
 
 //-----------------------------------------------------------------------------------
-void BitmapFont::ParseGlyphInfo(std::vector<std::string>& glyphMetaFile)
+//Pulls out the integer after each '=' on the line (ie: "char id=32 x=155 ..."), in order. Returns how many it found.
+static int ParseValuesAfterEquals(const StringView& line, int* outValues, int maxValues)
+{
+    int numValues = 0;
+    const char* current = line.data;
+    const char* end = line.data + line.length;
+    while (current < end && numValues < maxValues)
+    {
+        if (*current++ != '=')
+        {
+            continue;
+        }
+        bool isNegative = current < end && *current == '-';
+        current += isNegative ? 1 : 0;
+        int value = 0;
+        while (current < end && *current >= '0' && *current <= '9')
+        {
+            value = (value * 10) + (*current++ - '0');
+        }
+        outValues[numValues++] = isNegative ? -value : value;
+    }
+    return numValues;
+}
+
+//-----------------------------------------------------------------------------------
+//Parses straight out of the file's text, a line at a time.
+void BitmapFont::ParseGlyphInfo(const StringView& glyphFileText)
 {
     const int ID_INDEX = 0;
     const int X_INDEX = 1;
@@ -179,51 +207,35 @@ void BitmapFont::ParseGlyphInfo(std::vector<std::string>& glyphMetaFile)
     const int FIRST_INDEX = 0;
     const int SECOND_INDEX = 1;
     const int AMOUNT_INDEX = 2;
-    std::vector<std::string>* values;
-    int numLines = glyphMetaFile.size();
-    //Find the number of characters
-    int lineIndex = 3;
-    values = ExtractStringsBetween(glyphMetaFile[lineIndex++], "=", "\r");
-    int numberOfCharacters = std::stoi((*values)[0]);
-    delete values;
-    for (int i = 0; i < numberOfCharacters; i++)
-    {
-        Glyph letter;
-        std::string& currentString = glyphMetaFile[lineIndex + i];
-        values = ExtractStringsBetween(currentString, "=", " ");
-        letter.id = (char)std::stoi((*values)[ID_INDEX]);
-        letter.x = std::stoi((*values)[X_INDEX]);
-        letter.y = std::stoi((*values)[Y_INDEX]);
-        letter.width = std::stoi((*values)[WIDTH_INDEX]);
-        letter.height = std::stoi((*values)[HEIGHT_INDEX]);
-        letter.xOffset = std::stoi((*values)[X_OFFSET_INDEX]);
-        letter.yOffset = std::stoi((*values)[Y_OFFSET_INDEX]);
-        letter.xAdvance = std::stoi((*values)[X_ADVANCE_INDEX]);
-
-        m_glyphMap.emplace((char)letter.id, letter);
-        int letterHeight = letter.yOffset + letter.height;
-        m_maxHeight = letterHeight > m_maxHeight ? letterHeight : m_maxHeight;
-        delete values;
-    }
-    lineIndex += numberOfCharacters;
-    //If we're not at the end of file, do the kerning info
-    if (numLines == lineIndex)
-    {
-        return;
-    }
-    values = ExtractStringsBetween(glyphMetaFile[lineIndex++], "=", "\r");
-    int numberOfKernings = std::stoi((*values)[0]);
-    delete values;
-    for (int i = 0; i < numberOfKernings; i++)
+    const int MAX_VALUES = 10;
+    int values[MAX_VALUES];
+    LineIterator lines(glyphFileText);
+    StringView line;
+    while (lines.GetNextLine(line))
     {
-        std::string& currentString = glyphMetaFile[lineIndex + i];
-        values = ExtractStringsBetween(currentString, "=", " ");
-        char first = (char)std::stoi((*values)[FIRST_INDEX]);
-        char second = (char)std::stoi((*values)[SECOND_INDEX]);
-        int amount = std::stoi((*values)[AMOUNT_INDEX]);
-        Kerning info = Kerning(first, second, amount);
-        m_kerningMap.emplace(info.kerningPair, info.kerningOffsetAmount);
-        delete values;
+        if (line.StartsWith("char "))
+        {
+            ASSERT_OR_DIE(ParseValuesAfterEquals(line, values, MAX_VALUES) > X_ADVANCE_INDEX, "Glyph line is missing values");
+            Glyph letter;
+            letter.id = (char)values[ID_INDEX];
+            letter.x = values[X_INDEX];
+            letter.y = values[Y_INDEX];
+            letter.width = values[WIDTH_INDEX];
+            letter.height = values[HEIGHT_INDEX];
+            letter.xOffset = values[X_OFFSET_INDEX];
+            letter.yOffset = values[Y_OFFSET_INDEX];
+            letter.xAdvance = values[X_ADVANCE_INDEX];
+
+            m_glyphMap.emplace((char)letter.id, letter);
+            int letterHeight = letter.yOffset + letter.height;
+            m_maxHeight = letterHeight > m_maxHeight ? letterHeight : m_maxHeight;
+        }
+        else if (line.StartsWith("kerning "))
+        {
+            ASSERT_OR_DIE(ParseValuesAfterEquals(line, values, MAX_VALUES) > AMOUNT_INDEX, "Kerning line is missing values");
+            Kerning info = Kerning((char)values[FIRST_INDEX], (char)values[SECOND_INDEX], values[AMOUNT_INDEX]);
+            m_kerningMap.emplace(info.kerningPair, info.kerningOffsetAmount);
+        }
     }
 }
 
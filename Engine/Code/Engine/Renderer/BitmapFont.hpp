@@ -6,6 +6,8 @@
 #include <vector>
 #include <string>
 
+struct StringView;
+
 //---------------------------------------------------------------------------
 struct Glyph
 {
@@ -68,7 +70,7 @@ private:
 	BitmapFont(const std::string& bitmapFontName, const std::string& glyphFileName);
 
 	//HELPER FUNCTIONS//////////////////////////////////////////////////////////////////////////
-	void ParseGlyphInfo(std::vector<std::string>& glyphSheet);
+	void ParseGlyphInfo(const StringView& glyphFileText);
 
 	//MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
 	static std::map< std::string, BitmapFont* > s_fontRegistry;
@@ -1,11 +1,14 @@
 #include "Engine/Renderer/DebugRenderer.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/Vertex.hpp"
-#include "Engine/Math/Vector3Int.hpp"
-#include <vector>
+#include "Engine/Renderer/VertexLayout.hpp"
+#include "Engine/Renderer/PrimitiveLibrary.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include <algorithm>
 
 DebugRenderer* DebugRenderer::instance = nullptr;
 std::set<DebugRenderer::Command*> DebugRenderer::s_renderCommands;
+std::vector<DebugRenderer::SphereInstance> DebugRenderer::s_spheres;
 
 //-----------------------------------------------------------------------------------
 void DebugRenderer::Update(float deltaSeconds)
@@ -16,6 +19,7 @@ void DebugRenderer::Update(float deltaSeconds)
         command->m_duration -= deltaSeconds;
         if (command->HasExpired())
         {
+            delete command;
             commandIter = s_renderCommands.erase(commandIter);
             if (commandIter == s_renderCommands.end())
             {
@@ -23,6 +27,11 @@ void DebugRenderer::Update(float deltaSeconds)
             }
         }
     }
+    for (SphereInstance& sphere : s_spheres)
+    {
+        sphere.m_duration -= deltaSeconds;
+    }
+    s_spheres.erase(std::remove_if(s_spheres.begin(), s_spheres.end(), [](const SphereInstance& sphere) { return sphere.m_duration < 0.0f; }), s_spheres.end());
 }
 
 //-----------------------------------------------------------------------------------
@@ -32,6 +41,32 @@ void DebugRenderer::Render() const
     {
         command->Render();
     }
+    if (s_spheres.empty())
+    {
+        return;
+    }
+    //Layout_PCT's vertices are byte for byte Vertex_PCTs, so the shared mesh's buffer can be drawn directly.
+    const Mesh* sphereMesh = PrimitiveLibrary::GetMesh<Layout_PCT>(PrimitiveLibrary::ICOSPHERE, SPHERE_DETAIL);
+    for (const SphereInstance& sphere : s_spheres)
+    {
+        Renderer::instance->PushMatrix();
+        {
+            Renderer::instance->Translate(sphere.m_position);
+            Renderer::instance->Scale(sphere.m_radius, sphere.m_radius, sphere.m_radius);
+
+            bool depthTestOn = sphere.m_mode == DepthTestingMode::OFF ? false : true;
+            Renderer::instance->EnableDepthTest(depthTestOn);
+            Renderer::instance->SetPointSize(5.0f);
+            Renderer::instance->DrawVBO_PCT(sphereMesh->m_vbo, sphereMesh->m_numVerts, sphere.m_color, Renderer::DrawMode::POINTS);
+            if (sphere.m_mode == DepthTestingMode::XRAY)
+            {
+                Renderer::instance->EnableDepthTest(false);
+                Renderer::instance->SetPointSize(2.0f);
+                Renderer::instance->DrawVBO_PCT(sphereMesh->m_vbo, sphereMesh->m_numVerts, sphere.m_color, Renderer::DrawMode::POINTS);
+            }
+        }
+        Renderer::instance->PopMatrix();
+    }
 }
 
 //-----------------------------------------------------------------------------------
@@ -65,8 +100,7 @@ void DebugRenderer::DrawDebugAABB3(const AABB3& bounds, const RGBA& strokeColor,
 //-----------------------------------------------------------------------------------
 void DebugRenderer::DrawDebugSphere(const Vector3& position, float radius, const RGBA& color, float duration, DepthTestingMode mode)
 {
-    DebugRenderer::Command* command = new DebugRenderer::SphereCommand(position, radius, color, duration, mode);
-    s_renderCommands.emplace(command);
+    s_spheres.emplace_back(position, radius, color, duration, mode);
 }
 
 //-----------------------------------------------------------------------------------
@@ -155,132 +189,6 @@ void DebugRenderer::ArrowCommand::Render() const
     }
 }
 
-//-----------------------------------------------------------------------------------
-DebugRenderer::SphereCommand::SphereCommand(const Vector3& position, float radius, const RGBA& color, float duration, DepthTestingMode mode)
-    : m_position(position)
-    , m_radius(radius)
-{
-    m_color = color;
-    m_duration = duration;
-    m_mode = mode;
-    //Generate points to use for the sphere algorithm
-    //We need to start off with an octahedron to keep the faces even.
-    std::vector<Vertex_PCT> verts;
-    std::vector<Vector3Int> indices;
-    Vector3 initialPoints[6] = { { 0, 0, radius }, { 0, 0, -radius }, { -radius, -radius, 0 }, { radius, -radius, 0 }, { radius, radius, 0 }, { -radius,  radius, 0 } };
-    Vertex_PCT vert;
-    vert.color = color;
-
-    for (int i = 0; i < 6; i++)
-    {
-        vert.pos = Vector3::GetNormalized(initialPoints[i]) * radius;
-        verts.push_back(vert);
-    }
-
-    indices.push_back(Vector3Int(0, 3, 4));
-    indices.push_back(Vector3Int(0, 4, 5));
-    indices.push_back(Vector3Int(0, 5, 2));
-    indices.push_back(Vector3Int(0, 2, 3));
-    indices.push_back(Vector3Int(1, 4, 3));
-    indices.push_back(Vector3Int(1, 5, 4));
-    indices.push_back(Vector3Int(1, 2, 5));
-    indices.push_back(Vector3Int(1, 3, 2));
-
-    for (int i = 0; i < 3; i++)
-    {
-        int n = indices.size();
-        for (int j = 0; j < n; j++)
-        {
-            // Calculate the midpoints 
-            Vector3 point1 = Vector3::GetMidpoint(verts.at(indices.at(j).x).pos, verts.at(indices.at(j).y).pos);
-            Vector3 point2 = Vector3::GetMidpoint(verts.at(indices.at(j).y).pos, verts.at(indices.at(j).z).pos);
-            Vector3 point3 = Vector3::GetMidpoint(verts.at(indices.at(j).z).pos, verts.at(indices.at(j).x).pos);
-
-            //Move the points to the outside of our sphere.
-            point1.Normalize();
-            point2.Normalize();
-            point3.Normalize();
-
-            //Add these vertices to the list of verts, and store their array location.
-            //Naiive way to check for dupes is here. I'll find a better solution later.
-            int point1Location = -1;
-            int point2Location = -1;
-            int point3Location = -1;
-            for (unsigned int q = 0; q < verts.size(); q++)
-            {
-                Vector3 compare = verts.at(q).pos;
-                if (compare == point1)
-                    point1Location = q;
-                if (compare == point2)
-                    point2Location = q;
-                if (compare == point3)
-                    point3Location = q;
-            }
-            if (point1Location == -1)
-            {
-                point1Location = verts.size(); 
-                vert.pos = point1 * radius;
-                verts.push_back(vert);
-            }
-
-            if (point2Location == -1)
-            {
-                point2Location = verts.size();
-                vert.pos = point2 * radius;
-                verts.push_back(vert);
-            }
-
-            if (point3Location == -1)
-            {
-                point3Location = verts.size();
-                vert.pos = point3 * radius;
-                verts.push_back(vert);
-            }
-
-            //Create 3 new faces (the outer triangles, the pieces of the triforce)
-            indices.push_back(Vector3Int(indices.at(j).x, point1Location, point3Location));
-            indices.push_back(Vector3Int(point1Location, indices.at(j).y, point2Location));
-            indices.push_back(Vector3Int(point3Location, point2Location, indices.at(j).z));
-
-            //Replace the original face with the inner, upside-down triangle (not the triforce)
-            indices.at(j).x = point1Location;
-            indices.at(j).y = point2Location;
-            indices.at(j).z = point3Location;
-        }
-    }
-    //Send sphere to the graphics card
-    m_vboId = Renderer::instance->GenerateBufferID();
-    m_numVerts = verts.size();
-    Renderer::instance->BindAndBufferVBOData(m_vboId, verts.data(), m_numVerts);
-}
-
-//-----------------------------------------------------------------------------------
-DebugRenderer::SphereCommand::~SphereCommand()
-{
-    Renderer::instance->DeleteBuffers(m_vboId);
-}
-
-//-----------------------------------------------------------------------------------
-void DebugRenderer::SphereCommand::Render() const
-{
-    Renderer::instance->PushMatrix();
-    {
-        Renderer::instance->Translate(m_position);
-
-        bool depthTestOn = m_mode == DepthTestingMode::OFF ? false : true;
-        Renderer::instance->EnableDepthTest(depthTestOn);
-        Renderer::instance->SetPointSize(5.0f);
-        Renderer::instance->DrawVBO_PCT(m_vboId, m_numVerts, Renderer::DrawMode::POINTS);
-        if (m_mode == DepthTestingMode::XRAY)
-        {
-            Renderer::instance->EnableDepthTest(false);
-            Renderer::instance->SetPointSize(2.0f);
-            Renderer::instance->DrawVBO_PCT(m_vboId, m_numVerts, Renderer::DrawMode::POINTS);
-        }
-    }
-    Renderer::instance->PopMatrix();
-}
-
 //-----------------------------------------------------------------------------------
 DebugRenderer::AABB3Command::AABB3Command(const AABB3& bounds, const RGBA& strokeColor, const RGBA& fillColor, float duration, DepthTestingMode mode)
     : m_bounds(bounds)
@@ -1,9 +1,10 @@
 #pragma once
 
 #include <set>
-#include "Engine\Math\Vector3.hpp"
-#include "Engine\Renderer\RGBA.hpp"
-#include "Engine\Renderer\AABB3.hpp"
+#include <vector>
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Renderer/RGBA.hpp"
+#include "Engine/Renderer/AABB3.hpp"
 
 class DebugRenderer
 {
@@ -34,6 +35,7 @@ private:
 	{
 	public:
 		Command();
+		virtual ~Command() {};
 		virtual void Render() const;
 		inline bool HasExpired() { return m_duration < 0.0f; };
 
@@ -86,18 +88,21 @@ private:
 	};
 
 	//---------------------------------------------------------------------------
-	class SphereCommand : public Command
+	//Kept by value and all drawn from PrimitiveLibrary's shared sphere, so drawing lots of them doesn't allocate or build any geometry.
+	struct SphereInstance
 	{
-	public:
-		SphereCommand(const Vector3& position, float radius, const RGBA& color, float duration, DepthTestingMode mode);
-		~SphereCommand();
-		virtual void Render() const;
-
+		SphereInstance(const Vector3& position, float radius, const RGBA& color, float duration, DepthTestingMode mode)
+			: m_position(position), m_radius(radius), m_color(color), m_duration(duration), m_mode(mode) {};
 		Vector3 m_position;
 		float m_radius;
-		int m_vboId;
-		int m_numVerts;
+		RGBA m_color;
+		float m_duration;
+		DebugRenderer::DepthTestingMode m_mode;
 	};
 
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int SPHERE_DETAIL = 3;
+
 	static std::set<Command*> s_renderCommands;
+	static std::vector<SphereInstance> s_spheres;
 };
\ No newline at end of file
@@ -0,0 +1,406 @@
+#include "Engine/Renderer/Impostor.hpp"
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/VertexLayout.hpp"
+#include "Engine/Renderer/MeshRenderer.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/Material.hpp"
+#include "Engine/Renderer/ShaderProgram.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Renderer/AnimationReplay.hpp"
+#include "Engine/Renderer/SpriteSheet.hpp"
+#include "Engine/Renderer/SpriteAnim.hpp"
+#include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/AABB2.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Input/BinaryWriter.hpp"
+#include "Engine/Input/Console.hpp"
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+Impostor* g_loadedImpostor = nullptr;
+extern MeshBuilder* g_loadedMeshBuilder;
+extern Skeleton* g_loadedSkeleton;
+extern AnimationMotion* g_loadedMotion;
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(bakeImpostor)
+{
+    if (!(args.HasArgs(4) || args.HasArgs(5)))
+    {
+        Console::instance->PrintLine("bakeImpostor <numViews> <numFrames> <cellSize> <switchDistance> <optional .tga filename>", RGBA::RED);
+        return;
+    }
+    if (!g_loadedMeshBuilder || !g_loadedSkeleton || !g_loadedMotion)
+    {
+        Console::instance->PrintLine("Error: Need a mesh, skeleton and motion loaded, use fbxLoad to bring in an animated mesh first.", RGBA::RED);
+        return;
+    }
+    int numViews = args.GetIntArgument(0);
+    int numFrames = args.GetIntArgument(1);
+    int cellSize = args.GetIntArgument(2);
+    float switchDistance = args.GetFloatArgument(3);
+    if (numViews <= 0 || numFrames <= 0 || cellSize <= 0)
+    {
+        Console::instance->PrintLine("Error: numViews, numFrames and cellSize all need to be positive.", RGBA::RED);
+        return;
+    }
+
+    std::vector<unsigned char> pixels;
+    ImpostorDescription description = ImpostorBaker::Bake(*g_loadedMeshBuilder, *g_loadedSkeleton, g_loadedMotion, numViews, numFrames, cellSize, pixels);
+    uint32_t atlasWidth = description.numFrames * description.cellSize;
+    uint32_t atlasHeight = description.numViews * description.cellSize;
+    if (args.HasArgs(5))
+    {
+        ImpostorBaker::WriteToTGA(args.GetStringArgument(4).c_str(), pixels, atlasWidth, atlasHeight);
+    }
+
+    //Texture takes ownership of the buffer and frees it with the stbi allocator.
+    unsigned char* textureData = (unsigned char*)malloc(pixels.size());
+    memcpy(textureData, pixels.data(), pixels.size());
+    //The old impostor releases its atlas, which has to happen before a rebake of the same motion registers one under the same name.
+    delete g_loadedImpostor;
+    g_loadedImpostor = nullptr;
+    Texture* atlas = Texture::CreateTextureFromData(Stringf("Impostor_%s", g_loadedMotion->m_motionName.c_str()), textureData, 4, Vector2Int(atlasWidth, atlasHeight));
+    g_loadedImpostor = new Impostor(atlas, description, switchDistance);
+    Console::instance->PrintLine(Stringf("Baked a %ix%i impostor atlas, switching over at %.1f units.", atlasWidth, atlasHeight, switchDistance));
+}
+
+//-----------------------------------------------------------------------------------
+static inline float EdgeFunction(float ax, float ay, float bx, float by, float px, float py)
+{
+    return ((px - ax) * (by - ay)) - ((py - ay) * (bx - ax));
+}
+
+//-----------------------------------------------------------------------------------
+//Renders each of the motion's frames from numViews angles around the up axis, orthographic and lit from the viewer.
+ImpostorDescription ImpostorBaker::Bake(const MeshBuilder& mesh, const Skeleton& skeleton, AnimationMotion* motion, uint32_t numViews, uint32_t numFrames, uint32_t cellSize, std::vector<unsigned char>& outRGBAPixels)
+{
+    ImpostorDescription description;
+    description.numViews = numViews;
+    description.numFrames = numFrames;
+    description.cellSize = cellSize;
+    description.durationSeconds = motion->m_totalLengthSeconds;
+
+    const bool isSkinned = (mesh.m_dataMask & (1 << MeshBuilder::BONE_WEIGHTS_BIT)) != 0;
+    const bool hasColor = (mesh.m_dataMask & (1 << MeshBuilder::COLOR_BIT)) != 0;
+    const uint32_t numVertices = mesh.m_vertices.size();
+    ASSERT_OR_DIE(mesh.GetVertexStorage() == MeshBuilder::INTERLEAVED_STORAGE, "Impostors bake from interleaved vertices, switch the builder's storage back first");
+
+    //Pose a scratch copy so the bake doesn't disturb the skeleton or motion being shown.
+    Skeleton posedSkeleton;
+    posedSkeleton.m_jointArray = skeleton.m_jointArray;
+    BoneMask fullMask(posedSkeleton.GetJointCount());
+    fullMask.SetAllBonesTo(1.0f);
+    AnimationMotion::PLAYBACK_MODE savedPlaybackMode = motion->m_playbackMode;
+    float savedLastTime = motion->m_lastTime;
+    AnimationRecorder* activeRecorder = AnimationRecorder::instance;
+    AnimationRecorder::instance = nullptr;
+    motion->m_playbackMode = AnimationMotion::LOOP;
+
+    //Skin every frame up front, the bounds over the whole motion decide how big the quad has to be.
+    std::vector<Vector3> positions(numFrames * numVertices);
+    std::vector<Vector3> normals(numFrames * numVertices);
+    std::vector<Matrix4x4> boneMatrices(posedSkeleton.GetJointCount());
+    float maxHorizontalRadius = 0.0f;
+    float minHeight = FLT_MAX;
+    float maxHeight = -FLT_MAX;
+    for (uint32_t frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+    {
+        float time = motion->m_totalLengthSeconds * ((float)frameIndex / (float)numFrames);
+        motion->ApplyMotionToSkeleton(&posedSkeleton, time, fullMask);
+        for (size_t jointIndex = 0; jointIndex < boneMatrices.size(); ++jointIndex)
+        {
+            const Joint& joint = posedSkeleton.m_jointArray[jointIndex];
+            Matrix4x4::MatrixMultiply(&boneMatrices[jointIndex], &joint.m_modelToBoneSpace, &joint.m_boneToModelSpace);
+        }
+
+        for (uint32_t vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+        {
+            const Vertex_Master& vertex = mesh.m_vertices[vertexIndex];
+            Vector4 position = Vector4(vertex.position, 1.0f);
+            Vector4 normal = Vector4(vertex.normal, 0.0f);
+            if (isSkinned)
+            {
+                const int boneIndices[4] = { vertex.boneIndices.x, vertex.boneIndices.y, vertex.boneIndices.z, vertex.boneIndices.w };
+                const float boneWeights[4] = { vertex.boneWeights.x, vertex.boneWeights.y, vertex.boneWeights.z, vertex.boneWeights.w };
+                Vector4 skinnedPosition = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+                Vector4 skinnedNormal = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (boneWeights[i] > 0.0f)
+                    {
+                        skinnedPosition += (position * boneMatrices[boneIndices[i]]) * boneWeights[i];
+                        skinnedNormal += (normal * boneMatrices[boneIndices[i]]) * boneWeights[i];
+                    }
+                }
+                position = skinnedPosition;
+                normal = skinnedNormal;
+            }
+
+            Vector3 finalPosition = Vector3(position.x, position.y, position.z);
+            Vector3 finalNormal = Vector3(normal.x, normal.y, normal.z);
+            if (finalNormal.CalculateMagnitude() > 0.0f)
+            {
+                finalNormal.Normalize();
+            }
+            positions[(frameIndex * numVertices) + vertexIndex] = finalPosition;
+            normals[(frameIndex * numVertices) + vertexIndex] = finalNormal;
+
+            float horizontalRadius = sqrt((finalPosition.x * finalPosition.x) + (finalPosition.z * finalPosition.z));
+            maxHorizontalRadius = horizontalRadius > maxHorizontalRadius ? horizontalRadius : maxHorizontalRadius;
+            minHeight = finalPosition.y < minHeight ? finalPosition.y : minHeight;
+            maxHeight = finalPosition.y > maxHeight ? finalPosition.y : maxHeight;
+        }
+    }
+    motion->m_playbackMode = savedPlaybackMode;
+    motion->m_lastTime = savedLastTime;
+    AnimationRecorder::instance = activeRecorder;
+
+    //Square cells centered on the up axis through the model origin, so every view lines up with the character's position.
+    float heightExtents = (numVertices > 0) ? (maxHeight - minHeight) : 0.0f;
+    description.worldSize = std::max(maxHorizontalRadius * 2.0f, heightExtents);
+    description.worldSize = description.worldSize > 0.0f ? description.worldSize : 1.0f;
+    description.centerHeight = (numVertices > 0) ? (minHeight + maxHeight) * 0.5f : 0.0f;
+
+    const uint32_t atlasWidth = numFrames * cellSize;
+    const uint32_t atlasHeight = numViews * cellSize;
+    outRGBAPixels.assign(atlasWidth * atlasHeight * 4, 0);
+    std::vector<float> depthBuffer(cellSize * cellSize);
+    std::vector<Vector3> screenPositions(numVertices);
+    const float pixelsPerUnit = (float)cellSize / description.worldSize;
+    const uint32_t numIndices = mesh.m_indices.size() > 0 ? mesh.m_indices.size() : numVertices;
+
+    for (uint32_t viewIndex = 0; viewIndex < numViews; ++viewIndex)
+    {
+        //Same basis as Impostor::AddImpostorQuad picks the view with.
+        float viewAngle = MathUtils::TWO_PI * ((float)viewIndex / (float)numViews);
+        Vector3 forward = Vector3(sin(viewAngle), 0.0f, cos(viewAngle));
+        Vector3 right = Vector3(cos(viewAngle), 0.0f, -sin(viewAngle));
+
+        for (uint32_t frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+        {
+            const Vector3* framePositions = &positions[frameIndex * numVertices];
+            const Vector3* frameNormals = &normals[frameIndex * numVertices];
+            for (uint32_t vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+            {
+                const Vector3& position = framePositions[vertexIndex];
+                //Rows run top down to match how stbi hands back loaded images.
+                screenPositions[vertexIndex].x = (MathUtils::Dot(position, right) * pixelsPerUnit) + ((float)cellSize * 0.5f);
+                screenPositions[vertexIndex].y = ((description.centerHeight - position.y) * pixelsPerUnit) + ((float)cellSize * 0.5f);
+                screenPositions[vertexIndex].z = MathUtils::Dot(position, forward);
+            }
+            std::fill(depthBuffer.begin(), depthBuffer.end(), FLT_MAX);
+            const uint32_t cellX = frameIndex * cellSize;
+            const uint32_t cellY = viewIndex * cellSize;
+
+            for (uint32_t triangleStart = 0; triangleStart + 2 < numIndices; triangleStart += 3)
+            {
+                uint32_t i0 = mesh.m_indices.size() > 0 ? mesh.m_indices[triangleStart + 0] : triangleStart + 0;
+                uint32_t i1 = mesh.m_indices.size() > 0 ? mesh.m_indices[triangleStart + 1] : triangleStart + 1;
+                uint32_t i2 = mesh.m_indices.size() > 0 ? mesh.m_indices[triangleStart + 2] : triangleStart + 2;
+                const Vector3& s0 = screenPositions[i0];
+                const Vector3& s1 = screenPositions[i1];
+                const Vector3& s2 = screenPositions[i2];
+                float area = EdgeFunction(s0.x, s0.y, s1.x, s1.y, s2.x, s2.y);
+                if (fabs(area) < 1e-8f)
+                {
+                    continue;
+                }
+
+                int minX = std::max(0, (int)floor(std::min(s0.x, std::min(s1.x, s2.x))));
+                int maxX = std::min((int)cellSize - 1, (int)ceil(std::max(s0.x, std::max(s1.x, s2.x))));
+                int minY = std::max(0, (int)floor(std::min(s0.y, std::min(s1.y, s2.y))));
+                int maxY = std::min((int)cellSize - 1, (int)ceil(std::max(s0.y, std::max(s1.y, s2.y))));
+                for (int y = minY; y <= maxY; ++y)
+                {
+                    for (int x = minX; x <= maxX; ++x)
+                    {
+                        float px = (float)x + 0.5f;
+                        float py = (float)y + 0.5f;
+                        //No culling, so accept either winding.
+                        float w0 = EdgeFunction(s1.x, s1.y, s2.x, s2.y, px, py) / area;
+                        float w1 = EdgeFunction(s2.x, s2.y, s0.x, s0.y, px, py) / area;
+                        float w2 = 1.0f - w0 - w1;
+                        if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                        {
+                            continue;
+                        }
+                        float depth = (w0 * s0.z) + (w1 * s1.z) + (w2 * s2.z);
+                        float& storedDepth = depthBuffer[(y * cellSize) + x];
+                        if (depth >= storedDepth)
+                        {
+                            continue;
+                        }
+                        storedDepth = depth;
+
+                        Vector3 normal = (frameNormals[i0] * w0) + (frameNormals[i1] * w1) + (frameNormals[i2] * w2);
+                        float normalLength = normal.CalculateMagnitude();
+                        float lighting = normalLength > 0.0f ? fabs(MathUtils::Dot(normal, forward)) / normalLength : 1.0f;
+                        lighting = 0.3f + (0.7f * lighting);
+
+                        RGBA color = RGBA::WHITE;
+                        if (hasColor)
+                        {
+                            //Flat color from the closest corner is plenty at impostor distances.
+                            uint32_t closestIndex = (w0 >= w1 && w0 >= w2) ? i0 : ((w1 >= w2) ? i1 : i2);
+                            color = mesh.m_vertices[closestIndex].color;
+                        }
+                        unsigned char* pixel = &outRGBAPixels[(((cellY + y) * atlasWidth) + (cellX + x)) * 4];
+                        pixel[0] = (unsigned char)((float)color.red * lighting);
+                        pixel[1] = (unsigned char)((float)color.green * lighting);
+                        pixel[2] = (unsigned char)((float)color.blue * lighting);
+                        pixel[3] = 255;
+                    }
+                }
+            }
+        }
+    }
+
+    return description;
+}
+
+//-----------------------------------------------------------------------------------
+//Uncompressed 32 bit TGA with a top-left origin, which stbi reads back in the same row order we baked in.
+void ImpostorBaker::WriteToTGA(const char* filename, const std::vector<unsigned char>& rgbaPixels, uint32_t width, uint32_t height)
+{
+    BinaryFileWriter writer;
+    ASSERT_OR_DIE(writer.Open(filename), "File Open failed!");
+    {
+        writer.Write<uint8_t>(0); //ID length
+        writer.Write<uint8_t>(0); //No color map
+        writer.Write<uint8_t>(2); //Uncompressed true color
+        writer.Write<uint16_t>(0); //Color map spec
+        writer.Write<uint16_t>(0);
+        writer.Write<uint8_t>(0);
+        writer.Write<uint16_t>(0); //X origin
+        writer.Write<uint16_t>(0); //Y origin
+        writer.Write<uint16_t>((uint16_t)width);
+        writer.Write<uint16_t>((uint16_t)height);
+        writer.Write<uint8_t>(32);
+        writer.Write<uint8_t>(0x28); //8 alpha bits, top-left origin
+
+        std::vector<unsigned char> bgraPixels(rgbaPixels.size());
+        for (size_t i = 0; i + 3 < rgbaPixels.size(); i += 4)
+        {
+            bgraPixels[i + 0] = rgbaPixels[i + 2];
+            bgraPixels[i + 1] = rgbaPixels[i + 1];
+            bgraPixels[i + 2] = rgbaPixels[i + 0];
+            bgraPixels[i + 3] = rgbaPixels[i + 3];
+        }
+        writer.WriteBytes(bgraPixels.data(), bgraPixels.size());
+    }
+    writer.Close();
+}
+
+//-----------------------------------------------------------------------------------
+Impostor::Impostor(Texture* atlas, const ImpostorDescription& description, float switchDistance)
+    : m_description(description)
+    , m_switchDistance(switchDistance)
+    , m_sheet(new SpriteSheet(atlas, description.numFrames, description.numViews))
+    , m_material(new Material(new ShaderProgram("Data/Shaders/fixedVertexFormat.vert", "Data/Shaders/fixedVertexFormat.frag"),
+        RenderState(RenderState::DepthTestingMode::ON, RenderState::FaceCullingMode::RENDER_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND)))
+    , m_quadMesh(new Mesh())
+    , m_quadRenderer(new MeshRenderer(m_quadMesh, m_material))
+    , m_quadVertexCount(0)
+{
+    m_material->SetDiffuseTexture(atlas);
+    for (uint32_t viewIndex = 0; viewIndex < description.numViews; ++viewIndex)
+    {
+        int startIndex = viewIndex * description.numFrames;
+        m_viewAnims.push_back(new SpriteAnim(*m_sheet, description.durationSeconds, AnimMode::LOOP, startIndex, startIndex + description.numFrames - 1));
+    }
+}
+
+//-----------------------------------------------------------------------------------
+Impostor::~Impostor()
+{
+    for (SpriteAnim* anim : m_viewAnims)
+    {
+        delete anim;
+    }
+    delete m_quadRenderer;
+    delete m_quadMesh;
+    Texture::ReleaseTexture(m_sheet->GetTexture());
+    delete m_sheet;
+    delete m_material->m_shaderProgram;
+    delete m_material;
+}
+
+//-----------------------------------------------------------------------------------
+bool Impostor::ShouldUseImpostor(const Vector3& characterPosition, const Vector3& cameraPosition) const
+{
+    Vector3 displacement = characterPosition - cameraPosition;
+    return MathUtils::Dot(displacement, displacement) > (m_switchDistance * m_switchDistance);
+}
+
+//-----------------------------------------------------------------------------------
+//Appends one camera-facing quad, picking the baked view closest to the camera's angle and the frame for timeSeconds.
+//Batch every far character into the same builder, then draw them all with RenderImpostorQuads.
+void Impostor::AddImpostorQuad(MeshBuilder& builder, const Vector3& characterPosition, const Vector3& cameraPosition, float timeSeconds, float characterYawRadians)
+{
+    Vector3 toCharacter = characterPosition - cameraPosition;
+    toCharacter.y = 0.0f;
+    if (toCharacter.CalculateMagnitude() <= 0.0f)
+    {
+        toCharacter = Vector3::FORWARD;
+    }
+    toCharacter.Normalize();
+
+    float viewAngle = atan2(toCharacter.x, toCharacter.z) - characterYawRadians;
+    float viewStep = MathUtils::TWO_PI / (float)m_description.numViews;
+    int viewIndex = (int)floor((viewAngle / viewStep) + 0.5f) % (int)m_description.numViews;
+    viewIndex = viewIndex < 0 ? viewIndex + m_description.numViews : viewIndex;
+
+    SpriteAnim* anim = m_viewAnims[viewIndex];
+    float animTime = fmod(timeSeconds, m_description.durationSeconds);
+    animTime = animTime < 0.0f ? animTime + m_description.durationSeconds : animTime;
+    //Keep clear of the very end, SpriteAnim would step one sprite past the view's last frame there.
+    float frameSeconds = m_description.durationSeconds / (float)m_description.numFrames;
+    anim->SetSecondsElapsed(std::min(animTime, m_description.durationSeconds - (frameSeconds * 0.5f)));
+    AABB2 texCoords = anim->GetCurrentTexCoords();
+
+    Vector3 right = Vector3(toCharacter.z, 0.0f, -toCharacter.x);
+    float halfSize = m_description.worldSize * 0.5f;
+    Vector3 center = characterPosition + (Vector3::UP * m_description.centerHeight);
+    Vector3 bottomLeft = center - (right * halfSize) - (Vector3::UP * halfSize);
+    Vector3 bottomRight = center + (right * halfSize) - (Vector3::UP * halfSize);
+    Vector3 topRight = center + (right * halfSize) + (Vector3::UP * halfSize);
+    Vector3 topLeft = center - (right * halfSize) + (Vector3::UP * halfSize);
+
+    int startingVertex = builder.GetCurrentIndex();
+    builder.SetColor(RGBA::WHITE);
+    builder.SetTBN(right, Vector3::UP, -toCharacter);
+    builder.SetUV(texCoords.mins);
+    builder.AddVertex(bottomLeft);
+    builder.SetUV(Vector2(texCoords.maxs.x, texCoords.mins.y));
+    builder.AddVertex(bottomRight);
+    builder.SetUV(texCoords.maxs);
+    builder.AddVertex(topRight);
+    builder.SetUV(Vector2(texCoords.mins.x, texCoords.maxs.y));
+    builder.AddVertex(topLeft);
+    builder.AddQuadIndices(startingVertex + 3, startingVertex + 2, startingVertex + 0, startingVertex + 1);
+}
+
+//-----------------------------------------------------------------------------------
+void Impostor::RenderImpostorQuads(MeshBuilder& builder)
+{
+    if (builder.IsEmpty())
+    {
+        return;
+    }
+    //Only the vertices move from frame to frame, so the buffers are only made again when the number of quads changes.
+    if (builder.GetVertexCount() == m_quadVertexCount)
+    {
+        Layout_PCUTB::UpdateMesh(builder, m_quadMesh);
+    }
+    else
+    {
+        builder.CopyToMesh<Layout_PCUTB>(m_quadMesh);
+        m_quadVertexCount = builder.GetVertexCount();
+    }
+    m_quadRenderer->Render();
+}
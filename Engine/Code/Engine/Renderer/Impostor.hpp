@@ -0,0 +1,68 @@
+#pragma once
+#include "Engine/Math/Vector3.hpp"
+#include <stdint.h>
+#include <vector>
+
+class MeshBuilder;
+class Skeleton;
+class AnimationMotion;
+class SpriteSheet;
+class SpriteAnim;
+class Texture;
+class Material;
+class Mesh;
+class MeshRenderer;
+
+//-----------------------------------------------------------------------------------
+//Everything needed to turn a baked atlas back into a SpriteSheet and per-view SpriteAnims.
+//The atlas is numFrames sprites wide and numViews sprites tall, so view v's animation is sprites [v * numFrames, (v + 1) * numFrames).
+struct ImpostorDescription
+{
+    ImpostorDescription() : numViews(0), numFrames(0), cellSize(0), durationSeconds(0.0f), worldSize(0.0f), centerHeight(0.0f) {};
+
+    uint32_t numViews;
+    uint32_t numFrames;
+    uint32_t cellSize;
+    float durationSeconds;
+    //Side length of the square quad, in model units.
+    float worldSize;
+    //Height above the character's origin that the quad is centered on.
+    float centerHeight;
+};
+
+//-----------------------------------------------------------------------------------
+//Software renders a character into an impostor atlas. Doesn't touch the GPU, so it can run headless.
+class ImpostorBaker
+{
+public:
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static ImpostorDescription Bake(const MeshBuilder& mesh, const Skeleton& skeleton, AnimationMotion* motion, uint32_t numViews, uint32_t numFrames, uint32_t cellSize, std::vector<unsigned char>& outRGBAPixels);
+    static void WriteToTGA(const char* filename, const std::vector<unsigned char>& rgbaPixels, uint32_t width, uint32_t height);
+};
+
+//-----------------------------------------------------------------------------------
+//Runtime half: swaps a character for a camera-facing quad once it's far enough away.
+//Takes ownership of the atlas, which is released along with the impostor.
+class Impostor
+{
+public:
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    Impostor(Texture* atlas, const ImpostorDescription& description, float switchDistance);
+    ~Impostor();
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    bool ShouldUseImpostor(const Vector3& characterPosition, const Vector3& cameraPosition) const;
+    void AddImpostorQuad(MeshBuilder& builder, const Vector3& characterPosition, const Vector3& cameraPosition, float timeSeconds, float characterYawRadians = 0.0f);
+    void RenderImpostorQuads(MeshBuilder& builder);
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    ImpostorDescription m_description;
+    float m_switchDistance;
+    SpriteSheet* m_sheet;
+    std::vector<SpriteAnim*> m_viewAnims;
+    Material* m_material;
+    //One mesh for every frame's batch of quads, rewritten in place while the number of quads stays the same.
+    Mesh* m_quadMesh;
+    MeshRenderer* m_quadRenderer;
+    unsigned int m_quadVertexCount;
+};
@@ -6,6 +6,7 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/ShaderProgram.hpp"
 #include "Engine/Renderer/Material.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 
 #define WIN32_LEAN_AND_MEAN
@@ -19,6 +20,10 @@ Mesh::Mesh()
     : m_drawMode(Renderer::DrawMode::TRIANGLES)
 	, m_vbo(0)
 	, m_ibo(0)
+	, m_ownsIndexBuffer(true)
+	, m_sizeofIndex(sizeof(unsigned int))
+	, m_boundingRadius(0.0f)
+	, m_positionDequantize(0.0f, 0.0f, 0.0f, 1.0f)
 {
 
 }
@@ -26,49 +31,189 @@ Mesh::Mesh()
 //-----------------------------------------------------------------------------------
 Mesh::~Mesh()
 {
-	if (m_vbo != 0)
-	{
-		Renderer::instance->DeleteBuffers(m_vbo);
-	}
-	if (m_ibo != 0)
-	{
-		Renderer::instance->RenderBufferDestroy(m_ibo);
-	}
+	ReleaseBuffers();
+}
+
+//-----------------------------------------------------------------------------------
+void Mesh::RenderFromIBO(GLuint vaoID, Material* material, unsigned int lod) const
+{
+    unsigned int firstIndex = 0;
+    unsigned int numIndices = m_numIndices;
+    if (lod < m_lodRanges.size())
+    {
+        firstIndex = m_lodRanges[lod].firstIndex;
+        numIndices = m_lodRanges[lod].numIndices;
+    }
+    DrawIndexRange(vaoID, material, firstIndex, numIndices);
+}
+
+//-----------------------------------------------------------------------------------
+void Mesh::RenderSubMeshFromIBO(GLuint vaoID, Material* material, unsigned int lod, unsigned int subMesh) const
+{
+    ASSERT_OR_DIE(lod < m_lodRanges.size() && subMesh < m_lodRanges[lod].subMeshes.size(), "Mesh doesn't have that LOD or submesh");
+    const SubMeshRange& range = m_lodRanges[lod].subMeshes[subMesh];
+    DrawIndexRange(vaoID, material, range.firstIndex, range.numIndices);
 }
 
 //-----------------------------------------------------------------------------------
-void Mesh::RenderFromIBO(GLuint vaoID, Material* material) const
+unsigned int Mesh::GetSubMeshCount() const
+{
+    return m_lodRanges.empty() ? 0 : m_lodRanges[0].subMeshes.size();
+}
+
+//-----------------------------------------------------------------------------------
+void Mesh::DrawIndexRange(GLuint vaoID, Material* material, unsigned int firstIndex, unsigned int numIndices) const
 {
     glBindVertexArray(vaoID);
     material->SetUpRenderState();
     //Draw with IBO
-    glDrawElements(Renderer::instance->GetDrawMode(m_drawMode), m_numIndices, GL_UNSIGNED_INT, (GLvoid*)0);
+    glDrawElements(Renderer::instance->GetDrawMode(m_drawMode), numIndices, m_sizeofIndex == sizeof(unsigned short) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (GLvoid*)(firstIndex * m_sizeofIndex));
     material->CleanUpRenderState();
     glUseProgram(NULL);
     glBindVertexArray(NULL);
 }
 
+//-----------------------------------------------------------------------------------
+//Picks the smallest LOD whose screen size threshold the mesh is still under.
+unsigned int Mesh::SelectLOD(float projectedSize) const
+{
+	unsigned int lod = 0;
+	for (unsigned int i = 1; i < m_lodRanges.size(); ++i)
+	{
+		if (projectedSize < m_lodRanges[i].screenSize)
+		{
+			lod = i;
+		}
+	}
+	return lod;
+}
+
+//-----------------------------------------------------------------------------------
+//How much of the screen's height the bounding sphere covers, 1.0 being the full height.
+float Mesh::CalculateProjectedSize(float boundingRadius, float distance, float fovYDegrees)
+{
+	float halfHeightAtDistance = distance * tan(MathUtils::DegreesToRadians(fovYDegrees) * 0.5f);
+	if (halfHeightAtDistance <= boundingRadius)
+	{
+		return 1.0f;
+	}
+	return boundingRadius / halfHeightAtDistance;
+}
+
 //Pushes data over to the GPU and creates the buffers. The mesh doesn't store any of the vertexes or indexes, just the buffer locations.
 //-----------------------------------------------------------------------------------
-void Mesh::Init(void* vertexData, unsigned int numVertices, unsigned int sizeofVertex, void* indexData, unsigned int numIndices, BindMeshToVAOForVertex* BindMeshFunction)
+//Indices can be 16 or 32 bit, sizeofIndex says which.
+void Mesh::Init(void* vertexData, unsigned int numVertices, unsigned int sizeofVertex, void* indexData, unsigned int numIndices, BindMeshToVAOForVertex* BindMeshFunction, unsigned int sizeofIndex)
+{
+	m_numVerts = numVertices;
+	m_numIndices = numIndices;
+	m_vertexBindFunctionPointer = BindMeshFunction;
+	m_streams.clear();
+	CreateBuffers(vertexData, sizeofVertex * numVertices, indexData, numIndices, sizeofIndex);
+}
+
+//-----------------------------------------------------------------------------------
+//The vertex block holds each attribute as its own array (ie: every position, then every normal...), so it can be uploaded as-is from a mapped file.
+void Mesh::InitFromStreams(const void* vertexBlock, unsigned int vertexBlockSize, unsigned int numVertices, const std::vector<VertexStream>& streams, const void* indexData, unsigned int numIndices, unsigned int sizeofIndex)
+{
+	m_numVerts = numVertices;
+	m_numIndices = numIndices;
+	m_vertexBindFunctionPointer = nullptr;
+	m_streams = streams;
+	CreateBuffers(vertexBlock, vertexBlockSize, indexData, numIndices, sizeofIndex);
+}
+
+//-----------------------------------------------------------------------------------
+void Mesh::InitWithSharedIndices(const void* vertexData, unsigned int numVertices, unsigned int sizeofVertex, GLuint sharedIbo, unsigned int numIndices, unsigned int sizeofIndex, BindMeshToVAOForVertex* BindMeshFunction)
 {
+	ASSERT_OR_DIE(sharedIbo != 0, "Tried to share an index buffer that doesn't exist");
 	m_numVerts = numVertices;
 	m_numIndices = numIndices;
 	m_vertexBindFunctionPointer = BindMeshFunction;
+	m_streams.clear();
+	ReleaseBuffers();
+	m_sizeofIndex = sizeofIndex;
+	m_vbo = Renderer::instance->GenerateBufferID();
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	glBufferData(GL_ARRAY_BUFFER, numVertices * sizeofVertex, vertexData, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, NULL);
+	GL_CHECK_ERROR();
+	m_ibo = sharedIbo;
+	m_ownsIndexBuffer = false;
+}
+
+//-----------------------------------------------------------------------------------
+void Mesh::CreateBuffers(const void* vertexData, unsigned int vertexDataSize, const void* indexData, unsigned int numIndices, unsigned int sizeofIndex)
+{
+	//Meshes get re-initialized in place (ie: after a weld), so don't leak the old buffers.
+	ReleaseBuffers();
+	m_sizeofIndex = sizeofIndex;
 	m_vbo = Renderer::instance->GenerateBufferID();
 	GL_CHECK_ERROR();
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeofVertex * numVertices, vertexData, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, vertexDataSize, vertexData, GL_STATIC_DRAW);
 	glBindBuffer(GL_ARRAY_BUFFER, NULL);
 	GL_CHECK_ERROR();
-	m_ibo = Renderer::instance->RenderBufferCreate(indexData, numIndices, sizeof(unsigned int), GL_STATIC_DRAW);
+	m_ibo = Renderer::instance->RenderBufferCreate(const_cast<void*>(indexData), numIndices, sizeofIndex, GL_STATIC_DRAW);
+	m_ownsIndexBuffer = true;
 	GL_CHECK_ERROR();
 }
 
 //-----------------------------------------------------------------------------------
-void Mesh::BindToVAO(GLuint vaoID, ShaderProgram* shaderProgram)
+//Shared index buffers are left for their owner to delete.
+void Mesh::ReleaseBuffers()
 {
-	m_vertexBindFunctionPointer(vaoID, m_vbo, m_ibo, shaderProgram);
+	if (m_vbo != 0)
+	{
+		Renderer::instance->DeleteBuffers(m_vbo);
+		m_vbo = 0;
+	}
+	if (m_ibo != 0 && m_ownsIndexBuffer)
+	{
+		Renderer::instance->RenderBufferDestroy(m_ibo);
+	}
+	m_ibo = 0;
 }
 
+//-----------------------------------------------------------------------------------
+//Rewrites the vertex buffer in place for meshes that change every frame (ie: water), leaving the indices and LODs alone.
+//The vertices have to be the same count and layout as the ones the mesh was made with.
+void Mesh::UpdateVertices(const void* vertexData, unsigned int numVertices, unsigned int sizeofVertex)
+{
+	ASSERT_OR_DIE(m_vbo != 0, "Tried to update the vertices of a mesh that was never initialized");
+	ASSERT_OR_DIE(numVertices == m_numVerts, "UpdateVertices can't change the number of vertices in a mesh");
+	ASSERT_OR_DIE(m_vertexBindFunctionPointer != nullptr, "UpdateVertices only works on interleaved meshes");
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, numVertices * sizeofVertex, vertexData);
+	glBindBuffer(GL_ARRAY_BUFFER, NULL);
+	GL_CHECK_ERROR();
+}
 
+//-----------------------------------------------------------------------------------
+void Mesh::BindToVAO(GLuint vaoID, ShaderProgram* shaderProgram)
+{
+	if (m_vertexBindFunctionPointer)
+	{
+		m_vertexBindFunctionPointer(vaoID, m_vbo, m_ibo, shaderProgram);
+		return;
+	}
+	glBindVertexArray(vaoID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	for (const VertexStream& stream : m_streams)
+	{
+		if (stream.isInteger)
+		{
+			shaderProgram->ShaderProgramBindIntegerProperty(stream.attributeName, stream.componentCount, stream.type, stream.stride, stream.offset);
+		}
+		else
+		{
+			shaderProgram->ShaderProgramBindProperty(stream.attributeName, stream.componentCount, stream.type, stream.normalize, stream.stride, stream.offset);
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, NULL);
+	if (m_ibo != NULL)
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+	}
+	glBindVertexArray(NULL);
+}
@@ -2,6 +2,7 @@
 #include <vector>
 #include "Engine/Renderer/RGBA.hpp"
 #include "Engine/Math/Vector2.hpp"
+#include "Engine/Math/Vector4.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 
 class Vector3Int;
@@ -16,25 +17,84 @@ class Mesh
 	typedef unsigned int GLuint;
 public:
 	typedef void (BindMeshToVAOForVertex)(GLuint vao, GLuint vbo, GLuint ibo, ShaderProgram* program);
+
+	//The slice of the index buffer one submesh of one LOD draws from, for meshes merged by MeshBuilder::MergeBatch.
+	struct SubMeshRange
+	{
+		SubMeshRange() : firstIndex(0), numIndices(0), materialID(0) {};
+		SubMeshRange(unsigned int firstIndex, unsigned int numIndices, unsigned int materialID) : firstIndex(firstIndex), numIndices(numIndices), materialID(materialID) {};
+		unsigned int firstIndex;
+		unsigned int numIndices;
+		unsigned int materialID;
+	};
+
+	//The slice of the index buffer one LOD draws from.
+	struct LODRange
+	{
+		LODRange() : firstIndex(0), numIndices(0), screenSize(1.0f) {};
+		LODRange(unsigned int firstIndex, unsigned int numIndices, float screenSize) : firstIndex(firstIndex), numIndices(numIndices), screenSize(screenSize) {};
+		unsigned int firstIndex;
+		unsigned int numIndices;
+		float screenSize;
+		//Every LOD has the same submeshes in the same order, each inside this LOD's slice. Empty if the mesh wasn't merged.
+		std::vector<SubMeshRange> subMeshes;
+	};
+
+	//One attribute's tightly packed run inside the vertex buffer, for meshes uploaded straight from a MeshFile.
+	struct VertexStream
+	{
+		VertexStream(const char* attributeName, int componentCount, unsigned int type, bool normalize, bool isInteger, unsigned int offset, unsigned int stride)
+			: attributeName(attributeName), componentCount(componentCount), type(type), normalize(normalize), isInteger(isInteger), offset(offset), stride(stride) {};
+		const char* attributeName;
+		int componentCount;
+		unsigned int type;
+		bool normalize;
+		bool isInteger;
+		unsigned int offset;
+		unsigned int stride;
+	};
+
 	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
 	Mesh();
 	~Mesh();
 
 	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
-	void RenderFromIBO(GLuint vaoID, Material* material) const;
+	//Draws one LOD's slice of the index buffer, or every index if the mesh has no LODs.
+	void RenderFromIBO(GLuint vaoID, Material* material, unsigned int lod = 0) const;
+	//Draws one submesh of one LOD, so each can go out with its own material.
+	void RenderSubMeshFromIBO(GLuint vaoID, Material* material, unsigned int lod, unsigned int subMesh) const;
+	unsigned int GetSubMeshCount() const;
+	//Meshes are shared between renderers, so the LOD is handed back for whoever draws this instance (see MeshRenderer::SetLOD).
+	unsigned int SelectLOD(float projectedSize) const;
+	static float CalculateProjectedSize(float boundingRadius, float distance, float fovYDegrees);
 
 	//HELPER FUNCTIONS//////////////////////////////////////////////////////////////////////////
-	void Init(void* vertexData, unsigned int numVertices, unsigned int sizeofVertex, void* indexData, unsigned int numIndices, BindMeshToVAOForVertex* BindMeshFunction);
+	void Init(void* vertexData, unsigned int numVertices, unsigned int sizeofVertex, void* indexData, unsigned int numIndices, BindMeshToVAOForVertex* BindMeshFunction, unsigned int sizeofIndex = sizeof(unsigned int));
+	void InitFromStreams(const void* vertexBlock, unsigned int vertexBlockSize, unsigned int numVertices, const std::vector<VertexStream>& streams, const void* indexData, unsigned int numIndices, unsigned int sizeofIndex);
+	//Draws from an index buffer some other mesh or system owns (ie: every terrain chunk at the same LOD), which has to outlive this mesh.
+	void InitWithSharedIndices(const void* vertexData, unsigned int numVertices, unsigned int sizeofVertex, GLuint sharedIbo, unsigned int numIndices, unsigned int sizeofIndex, BindMeshToVAOForVertex* BindMeshFunction);
 	void BindToVAO(GLuint m_vaoID, ShaderProgram* m_shaderProgram);
+	void UpdateVertices(const void* vertexData, unsigned int numVertices, unsigned int sizeofVertex);
 
 	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
 	GLuint m_vbo;
 	GLuint m_ibo;
+	bool m_ownsIndexBuffer;
 	unsigned int m_numVerts;
 	unsigned int m_numIndices;
+	unsigned int m_sizeofIndex;
+	std::vector<LODRange> m_lodRanges;
+	float m_boundingRadius;
+	//Offset in xyz, scale in w. Identity unless the vertices are quantized, see VertexPacking.
+	Vector4 m_positionDequantize;
 	BindMeshToVAOForVertex* m_vertexBindFunctionPointer;
+	//Only used when there's no bind function, see InitFromStreams.
+	std::vector<VertexStream> m_streams;
 	Renderer::DrawMode m_drawMode;
 
 private:
+	void DrawIndexRange(GLuint vaoID, Material* material, unsigned int firstIndex, unsigned int numIndices) const;
+	void CreateBuffers(const void* vertexData, unsigned int vertexDataSize, const void* indexData, unsigned int numIndices, unsigned int sizeofIndex);
+	void ReleaseBuffers();
 	Mesh(const Mesh&);
 };
\ No newline at end of file
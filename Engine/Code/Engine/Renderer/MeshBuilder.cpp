@@ -1,12 +1,26 @@
 #include "Engine/Renderer/MeshBuilder.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/AsyncLoader.hpp"
 #include "Engine/Input/Console.hpp"
 #include "Engine/Input/BinaryWriter.hpp"
 #include "Engine/Input/BinaryReader.hpp"
+#include "Engine/Input/FileView.hpp"
+#include "Engine/Input/InputOutputUtils.hpp"
 #include "Engine/Renderer/AABB2.hpp"
-#include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/VertexLayout.hpp"
+#include "Engine/Renderer/MeshFile.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Time/Time.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
 
 extern MeshBuilder* g_loadedMeshBuilder;
 extern Mesh* g_loadedMesh;
@@ -38,206 +52,900 @@ CONSOLE_COMMAND(loadMesh)
         return;
     }
     std::string filename = args.GetStringArgument(0);
-    if (g_loadedMeshBuilder)
+    if (!FileExists(filename))
     {
-        delete g_loadedMeshBuilder;
+        Console::instance->PrintLine(Stringf("Error: Couldn't find %s.", filename.c_str()), RGBA::RED);
+        return;
     }
-    g_loadedMeshBuilder = new MeshBuilder();
-    g_loadedMeshBuilder->ReadFromFile(filename.c_str());
-    g_loadedMesh = new Mesh();
-    g_loadedMeshBuilder->CopyToMesh(g_loadedMesh, &Vertex_PCUTB::Copy, sizeof(Vertex_PCUTB), &Vertex_PCUTB::BindMeshToVAO);
+    //Read and parse on the loader's workers so the frame doesn't stall, only the upload happens on the main thread.
+    //The old mesh stays loaded until the new one's ready.
+    std::shared_ptr<MeshFile> meshFile = std::make_shared<MeshFile>();
+    AsyncLoader::instance->Enqueue("loadMesh " + filename,
+        [filename, meshFile](void*& outResult)
+        {
+            MeshBuilder* builder = new MeshBuilder();
+            if (meshFile->Open(filename.c_str()))
+            {
+                //Upload straight from the file view, the builder copy is only kept around for the other tools.
+                builder->ReadFromMeshFile(*meshFile);
+            }
+            else
+            {
+                builder->ReadFromFile(filename.c_str());
+            }
+            outResult = builder;
+            return true;
+        },
+        [filename, meshFile](void*& outResult)
+        {
+            MeshBuilder* builder = static_cast<MeshBuilder*>(outResult);
+            Mesh* mesh = new Mesh();
+            if (meshFile->IsOpen())
+            {
+                meshFile->UploadToMesh(mesh);
+                meshFile->Close();
+            }
+            else
+            {
+                builder->CopyToMesh<Layout_PCUTB>(mesh);
+            }
+            delete g_loadedMeshBuilder;
+            g_loadedMeshBuilder = builder;
+            g_loadedMesh = mesh;
+            Console::instance->PrintLine(Stringf("Loaded %s.", filename.c_str()));
+            return true;
+        });
 }
-#endif
 
 //-----------------------------------------------------------------------------------
-MeshBuilder::MeshBuilder()
-    : m_startIndex(0)
-    , m_materialName(nullptr)
-    , m_dataMask(0)
-    , m_drawMode(Renderer::DrawMode::TRIANGLES)
-    , m_isSkinned(false)
-    , m_stamp()
+CONSOLE_COMMAND(upgradeMesh)
 {
-
+    if (!args.HasArgs(2))
+    {
+        Console::instance->PrintLine("upgradeMesh <old filename> <new filename>", RGBA::RED);
+        return;
+    }
+    std::string oldFilename = args.GetStringArgument(0);
+    std::string newFilename = args.GetStringArgument(1);
+    MeshBuilder builder;
+    builder.ReadFromFile(oldFilename.c_str());
+    builder.WriteToFile(newFilename.c_str());
+
+    //Read it back and make sure nothing was lost on the way.
+    MeshBuilder upgraded;
+    upgraded.ReadFromFile(newFilename.c_str());
+    bool matches = upgraded.m_vertices.size() == builder.m_vertices.size() && upgraded.m_indices == builder.m_indices && upgraded.m_lods.size() == builder.m_lods.size();
+    for (unsigned int i = 0; matches && i < builder.m_vertices.size(); ++i)
+    {
+        matches = upgraded.m_vertices[i].position == builder.m_vertices[i].position && upgraded.m_vertices[i].uv0 == builder.m_vertices[i].uv0;
+    }
+    Console::instance->PrintLine(Stringf("Upgraded %s to %s: %i vertices, %i indices, %i LODs. %s", oldFilename.c_str(), newFilename.c_str(), builder.m_vertices.size(), builder.m_indices.size(), builder.m_lods.size(),
+        matches ? "Round trip matches." : "Round trip MISMATCH!"), matches ? RGBA::GREEN : RGBA::RED);
 }
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::Begin()
+CONSOLE_COMMAND(weldMesh)
 {
-    m_startIndex = m_vertices.size();
+    if (!(args.HasArgs(0) || args.HasArgs(1) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("weldMesh <optional position epsilon> <optional direction epsilon> <optional uv epsilon>", RGBA::RED);
+        return;
+    }
+    if (!g_loadedMeshBuilder)
+    {
+        Console::instance->PrintLine("Error: No mesh has been loaded yet, use fbxLoad or loadMesh to bring in a mesh first.", RGBA::RED);
+        return;
+    }
+    MeshBuilder::WeldEpsilons epsilons;
+    if (args.HasArgs(1) || args.HasArgs(3))
+    {
+        epsilons.position = args.GetFloatArgument(0);
+    }
+    if (args.HasArgs(3))
+    {
+        epsilons.direction = args.GetFloatArgument(1);
+        epsilons.uv = args.GetFloatArgument(2);
+    }
+    unsigned int originalVertexCount = g_loadedMeshBuilder->m_vertices.size();
+    unsigned int removedVertexCount = g_loadedMeshBuilder->WeldVertices(epsilons);
+    Console::instance->PrintLine(Stringf("Welded %i vertices down to %i, removed %i.", originalVertexCount, g_loadedMeshBuilder->m_vertices.size(), removedVertexCount));
+    if (g_loadedMesh)
+    {
+        g_loadedMeshBuilder->CopyToMesh<Layout_SkinnedPCTN>(g_loadedMesh);
+    }
 }
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::End()
+CONSOLE_COMMAND(analyzeMesh)
 {
-    if (m_startIndex < m_vertices.size())
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
     {
-        m_startIndex = m_vertices.size();
+        Console::instance->PrintLine("analyzeMesh <optional cache size>", RGBA::RED);
+        return;
+    }
+    if (!g_loadedMeshBuilder)
+    {
+        Console::instance->PrintLine("Error: No mesh has been loaded yet, use fbxLoad or loadMesh to bring in a mesh first.", RGBA::RED);
+        return;
     }
+    unsigned int cacheSize = args.HasArgs(1) ? args.GetIntArgument(0) : MeshOptimizer::DEFAULT_CACHE_SIZE;
+    VertexCacheStats stats = g_loadedMeshBuilder->AnalyzeVertexCache(cacheSize);
+    Console::instance->PrintLine(Stringf("%i triangles, %i vertices: ACMR %.3f, ATVR %.3f (%i entry FIFO)", stats.triangleCount, stats.uniqueVertexCount, stats.acmr, stats.atvr, cacheSize));
 }
 
 //-----------------------------------------------------------------------------------
-MeshBuilder* MeshBuilder::Merge(MeshBuilder* meshBuilderArray, unsigned int numberOfMeshes)
+CONSOLE_COMMAND(optimizeMesh)
 {
-    MeshBuilder* combinedMesh = new MeshBuilder();
-    for (unsigned int i = 0; i < numberOfMeshes; i++)
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
     {
-        int numPreexistingVerts = combinedMesh->m_indices.size();
-        MeshBuilder& currentMesh = meshBuilderArray[i];
-        for (Vertex_Master vert : currentMesh.m_vertices)
-        {
-            combinedMesh->m_vertices.push_back(vert);
-        }
-        for (unsigned int index : currentMesh.m_indices)
-        {
-            combinedMesh->m_indices.push_back(index + (i * numPreexistingVerts));
-        }
-        combinedMesh->m_dataMask |= currentMesh.m_dataMask;
+        Console::instance->PrintLine("optimizeMesh <optional cache size>", RGBA::RED);
+        return;
+    }
+    if (!g_loadedMeshBuilder)
+    {
+        Console::instance->PrintLine("Error: No mesh has been loaded yet, use fbxLoad or loadMesh to bring in a mesh first.", RGBA::RED);
+        return;
+    }
+    unsigned int cacheSize = args.HasArgs(1) ? args.GetIntArgument(0) : MeshOptimizer::DEFAULT_CACHE_SIZE;
+    if (cacheSize <= 3 || cacheSize > MeshOptimizer::MAX_CACHE_SIZE)
+    {
+        Console::instance->PrintLine(Stringf("Error: Cache size has to be between 4 and %i.", MeshOptimizer::MAX_CACHE_SIZE), RGBA::RED);
+        return;
+    }
+    VertexCacheStats before = g_loadedMeshBuilder->AnalyzeVertexCache(cacheSize);
+    g_loadedMeshBuilder->OptimizeVertexCache(cacheSize);
+    g_loadedMeshBuilder->OptimizeVertexFetch();
+    VertexCacheStats after = g_loadedMeshBuilder->AnalyzeVertexCache(cacheSize);
+    Console::instance->PrintLine(Stringf("ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", before.acmr, after.acmr, before.atvr, after.atvr));
+    if (g_loadedMesh)
+    {
+        g_loadedMeshBuilder->CopyToMesh<Layout_SkinnedPCTN>(g_loadedMesh);
     }
-    return combinedMesh;
 }
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::CopyToMesh(Mesh* mesh, VertexCopyCallback* copyFunction, unsigned int sizeofVertex, Mesh::BindMeshToVAOForVertex* bindMeshFunction)
+CONSOLE_COMMAND(packMesh)
 {
-    // First, we need to allocate a buffer to copy 
-    // our vertices into, that matches what the mesh
-    // wants.  
-    unsigned int vertexCount = m_vertices.size();
-    if (vertexCount == 0) {
-        // nothing in this mesh.
+    if (!args.HasArgs(0))
+    {
+        Console::instance->PrintLine("packMesh", RGBA::RED);
         return;
     }
-
-    unsigned int vertexSize = sizeofVertex; //mesh->vdefn->vertexSize;
-    unsigned int vertex_buffer_size = vertexCount * vertexSize;
-
-    byte* vertexBuffer = new byte[vertex_buffer_size];
-    byte* currentBufferIndex = vertexBuffer;
-
-//	mesh->m_verts.clear();
-    for (unsigned int vertex_index = 0;	vertex_index < vertexCount;	++vertex_index) 
+    if (!g_loadedMeshBuilder || !g_loadedMesh)
+    {
+        Console::instance->PrintLine("Error: No mesh has been loaded yet, use fbxLoad or loadMesh to bring in a mesh first.", RGBA::RED);
+        return;
+    }
+    unsigned int vertexCount = g_loadedMeshBuilder->GetVertexCount();
+    if (g_loadedMeshBuilder->IsInMask(MeshBuilder::BONE_INDICES_BIT))
+    {
+        g_loadedMeshBuilder->CopyToMesh<Layout_PackedSkinnedPCTN>(g_loadedMesh);
+        Console::instance->PrintLine(Stringf("Packed %i skinned vertices, %i bytes -> %i bytes.", vertexCount, vertexCount * sizeof(Layout_SkinnedPCTN::Vertex), vertexCount * sizeof(Layout_PackedSkinnedPCTN::Vertex)));
+    }
+    else
     {
-        copyFunction(m_vertices[vertex_index], currentBufferIndex);
-        currentBufferIndex += vertexSize;
+        g_loadedMeshBuilder->CopyToMesh<Layout_PackedPCUTB>(g_loadedMesh);
+        Console::instance->PrintLine(Stringf("Packed %i vertices, %i bytes -> %i bytes.", vertexCount, vertexCount * sizeof(Layout_PCUTB::Vertex), vertexCount * sizeof(Layout_PackedPCUTB::Vertex)));
     }
-    mesh->Init(vertexBuffer, vertexCount, sizeofVertex, m_indices.data(), m_indices.size(), bindMeshFunction);
-    mesh->m_drawMode = this->m_drawMode;
-    // Make sure we clean up after ourselves
-    delete vertexBuffer;
 }
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::AddVertex(const Vector3& position)
+CONSOLE_COMMAND(generateLODs)
 {
-    m_stamp.position = position;
-    m_vertices.push_back(m_stamp);
-    SetMaskBit(POSITION_BIT);
+    if (args.HasArgs(0))
+    {
+        Console::instance->PrintLine("generateLODs <triangle ratio> <optional more triangle ratios...>", RGBA::RED);
+        return;
+    }
+    if (!g_loadedMeshBuilder)
+    {
+        Console::instance->PrintLine("Error: No mesh has been loaded yet, use fbxLoad or loadMesh to bring in a mesh first.", RGBA::RED);
+        return;
+    }
+    std::vector<float> ratios;
+    for (unsigned int i = 0; i < args.GetNumArgs(); ++i)
+    {
+        float ratio = args.GetFloatArgument(i);
+        if (ratio <= 0.0f || ratio >= 1.0f || (!ratios.empty() && ratio >= ratios.back()))
+        {
+            Console::instance->PrintLine("Error: Ratios have to be between 0 and 1, largest first.", RGBA::RED);
+            return;
+        }
+        ratios.push_back(ratio);
+    }
+    double startTime = GetCurrentTimeSeconds();
+    g_loadedMeshBuilder->GenerateLODs(ratios);
+    double generateSeconds = GetCurrentTimeSeconds() - startTime;
+    g_loadedMeshBuilder->OptimizeVertexCache();
+    Console::instance->PrintLine(Stringf("LOD 0: %i triangles, simplified in %.2f ms", g_loadedMeshBuilder->m_indices.size() / 3, generateSeconds * 1000.0));
+    for (unsigned int i = 0; i < g_loadedMeshBuilder->m_lods.size(); ++i)
+    {
+        const MeshBuilder::MeshLOD& lod = g_loadedMeshBuilder->m_lods[i];
+        Console::instance->PrintLine(Stringf("LOD %i: %i triangles, used below %.2f of the screen", i + 1, lod.indices.size() / 3, lod.screenSize));
+    }
+    if (g_loadedMesh)
+    {
+        g_loadedMeshBuilder->CopyToMesh<Layout_SkinnedPCTN>(g_loadedMesh);
+    }
 }
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::AddQuadIndicesClockwise(unsigned int tlIndex, unsigned int trIndex, unsigned int blIndex, unsigned int brIndex)
+CONSOLE_COMMAND(generateTangents)
 {
-    m_indices.push_back(brIndex);
-    m_indices.push_back(blIndex);
-    m_indices.push_back(tlIndex);
-    m_indices.push_back(brIndex);
-    m_indices.push_back(tlIndex);
-    m_indices.push_back(trIndex);
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("generateTangents <optional thread count>", RGBA::RED);
+        return;
+    }
+    if (!g_loadedMeshBuilder)
+    {
+        Console::instance->PrintLine("Error: No mesh has been loaded yet, use fbxLoad or loadMesh to bring in a mesh first.", RGBA::RED);
+        return;
+    }
+    unsigned int numThreads = args.HasArgs(1) ? args.GetIntArgument(0) : 0;
+    unsigned int originalVertexCount = g_loadedMeshBuilder->GetVertexCount();
+    if (!g_loadedMeshBuilder->GenerateTangents(numThreads))
+    {
+        Console::instance->PrintLine("Error: Tangents need an indexed triangle mesh with UVs.", RGBA::RED);
+        return;
+    }
+    Console::instance->PrintLine(Stringf("Generated tangents, split %i vertices along mirror seams.", g_loadedMeshBuilder->GetVertexCount() - originalVertexCount));
+    if (g_loadedMesh)
+    {
+        g_loadedMeshBuilder->CopyToMesh<Layout_SkinnedPCTN>(g_loadedMesh);
+    }
 }
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::AddQuadIndices(unsigned int tlIndex, unsigned int trIndex, unsigned int blIndex, unsigned int brIndex)
+//Generated normals have to come out the same way the builders make them, Cross(bitangent, tangent), or lit meshes cooked without normals turn inside out.
+CONSOLE_COMMAND(tangentSelfTest)
 {
-    m_indices.push_back(brIndex);
-    m_indices.push_back(tlIndex);
-    m_indices.push_back(blIndex);
-    m_indices.push_back(brIndex);
-    m_indices.push_back(trIndex);
-    m_indices.push_back(tlIndex);
+    UNUSED(args);
+    MeshBuilder quad;
+    quad.Begin();
+    quad.AddQuad(Vector3::ZERO, Vector3::UP, 1.0f, Vector3::RIGHT, 1.0f);
+    quad.End();
+    bool passed = quad.GenerateTangents(1);
+    const Vector3 expectedNormal = Vector3::Cross(Vector3::UP, Vector3::RIGHT);
+    for (const Vertex_Master& vertex : quad.m_vertices)
+    {
+        passed = passed && (vertex.normal - expectedNormal).CalculateMagnitude() < 0.001f && (vertex.tangent - Vector3::RIGHT).CalculateMagnitude() < 0.001f;
+    }
+
+    //Every face of a cube has to end up facing away from its center.
+    MeshBuilder cube;
+    cube.Begin();
+    cube.AddCube(2.0f);
+    cube.End();
+    passed = passed && cube.GenerateTangents(1);
+    const Vector3 center(1.0f, 1.0f, 1.0f);
+    for (const Vertex_Master& vertex : cube.m_vertices)
+    {
+        const Vector3 outward = vertex.position - center;
+        passed = passed && (outward.x * vertex.normal.x) + (outward.y * vertex.normal.y) + (outward.z * vertex.normal.z) > 0.0f;
+    }
+    Console::instance->PrintLine(passed ? "Passed." : "FAILED!", passed ? RGBA::GREEN : RGBA::RED);
 }
+#endif
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::AddQuadIndices()
+MeshBuilder::MeshBuilder()
+    : m_startIndex(0)
+    , m_materialName()
+    , m_dataMask(0)
+    , m_drawMode(Renderer::DrawMode::TRIANGLES)
+    , m_isSkinned(false)
+    , m_stamp()
+    , m_vertexStorage(INTERLEAVED_STORAGE)
+    , m_streamVertexCount(0)
+    , m_streamMask(0)
 {
-    unsigned int lastIndex = m_vertices.size(); 
-    AddQuadIndices(lastIndex + 3, lastIndex + 2, lastIndex + 0, lastIndex + 1);
+
 }
 
+//VERTEX STREAMS//////////////////////////////////////////////////////////////////////////
 //-----------------------------------------------------------------------------------
-void MeshBuilder::BuildQuad(
-    const Vector3& initial_position,
-    const Vector3& right,
-    const Vector3& up,
-    float startX, float endX,
-    float startY, float endY,
-    float startU, float endU,
-    float startV, float endV)
+//Where each attribute lives in a Vertex_Master and how big it is, in MeshDataFlag order. Streams hold the attribute exactly as it's laid out here.
+struct MasterAttribute
 {
-    this->Begin();
-
-    float const xStep = endX - startX;
-    float const yStep = endY - startY;
-    float const uStep = endU - startU;
-    float const vStep = endV - startV;
-
-    // So, what is our tangent, normal, and bitangent?
-    Vector3 tangent = right;
-    Vector3 bitangent = up;
-    Vector3 normal = Vector3::Cross(bitangent, tangent);
-    this->SetTBN(tangent, bitangent, normal);
+    size_t offset;
+    unsigned int size;
+};
 
-    // Okay, now, let's add all our vertices
-    float x, y;
-    float u, v;
-
-    y = startY;
-    v = startV;
+static const MasterAttribute MASTER_ATTRIBUTES[MeshBuilder::NUM_MESH_DATA] =
+{
+    { offsetof(Vertex_Master, position), sizeof(Vector3) },
+    { offsetof(Vertex_Master, tangent), sizeof(Vector3) },
+    { offsetof(Vertex_Master, bitangent), sizeof(Vector3) },
+    { offsetof(Vertex_Master, normal), sizeof(Vector3) },
+    { offsetof(Vertex_Master, color), sizeof(RGBA) },
+    { offsetof(Vertex_Master, uv0), sizeof(Vector2) },
+    { offsetof(Vertex_Master, uv1), sizeof(Vector2) },
+    { offsetof(Vertex_Master, normalizedGlyphPosition), sizeof(Vector2) },
+    { offsetof(Vertex_Master, normalizedStringPosition), sizeof(Vector2) },
+    { offsetof(Vertex_Master, normalizedFragPosition), sizeof(float) },
+    { offsetof(Vertex_Master, boneWeights), sizeof(Vector4) },
+    { offsetof(Vertex_Master, boneIndices), sizeof(Vector4Int) },
+};
 
-    for (unsigned int iy = 0; iy < 2; ++iy) {
-        x = startX;
-        u = startU;
+//-----------------------------------------------------------------------------------
+//Runs a pass that's written against m_vertices on a builder that might be streaming, and puts the streams back once it's done.
+class ScopedInterleave
+{
+public:
+    ScopedInterleave(MeshBuilder& builder) : m_builder(builder), m_wasStreaming(builder.GetVertexStorage() == MeshBuilder::STREAM_STORAGE)
+    {
+        m_builder.SetVertexStorage(MeshBuilder::INTERLEAVED_STORAGE);
+    };
+    ~ScopedInterleave()
+    {
+        m_builder.SetVertexStorage(m_wasStreaming ? MeshBuilder::STREAM_STORAGE : MeshBuilder::INTERLEAVED_STORAGE);
+    };
 
-        for (uint32_t ix = 0; ix < 2; ++ix) {
-            this->SetUV(u, v);
+private:
+    ScopedInterleave(const ScopedInterleave&);
+    MeshBuilder& m_builder;
+    bool m_wasStreaming;
+};
 
-            Vector3 position = initial_position
-                + (right * x)
-                + (up * y);
+//-----------------------------------------------------------------------------------
+//Converts whatever's already been built, so storage can be switched at any point.
+void MeshBuilder::SetVertexStorage(VertexStorage storage)
+{
+    if (storage == m_vertexStorage)
+    {
+        return;
+    }
+    if (storage == STREAM_STORAGE)
+    {
+        m_streamVertexCount = m_vertices.size();
+        for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+        {
+            m_streams[flag].clear();
+            if (!IsInMask((MeshDataFlag)flag))
+            {
+                continue;
+            }
+            const MasterAttribute& attribute = MASTER_ATTRIBUTES[flag];
+            m_streams[flag].resize(m_streamVertexCount * attribute.size);
+            byte* destination = m_streams[flag].data();
+            for (const Vertex_Master& vertex : m_vertices)
+            {
+                memcpy(destination, (const byte*)&vertex + attribute.offset, attribute.size);
+                destination += attribute.size;
+            }
+        }
+        m_streamMask = m_dataMask;
+        std::vector<Vertex_Master>().swap(m_vertices);
+    }
+    else
+    {
+        PadStreams();
+        m_vertices.assign(m_streamVertexCount, Vertex_Master());
+        for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+        {
+            if (IsInMask((MeshDataFlag)flag))
+            {
+                const MasterAttribute& attribute = MASTER_ATTRIBUTES[flag];
+                const byte* source = m_streams[flag].data();
+                for (Vertex_Master& vertex : m_vertices)
+                {
+                    memcpy((byte*)&vertex + attribute.offset, source, attribute.size);
+                    source += attribute.size;
+                }
+            }
+            std::vector<byte>().swap(m_streams[flag]);
+        }
+        m_streamVertexCount = 0;
+        m_streamMask = 0;
+    }
+    m_vertexStorage = storage;
+}
 
-            this->AddVertex(position);
+//-----------------------------------------------------------------------------------
+//Attributes switched on partway through get defaults for the vertices that came before them, so every stream in the mask stays the same length.
+void MeshBuilder::PadStreams()
+{
+    if (m_streamMask == m_dataMask)
+    {
+        return;
+    }
+    const Vertex_Master defaults;
+    for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+    {
+        const MasterAttribute& attribute = MASTER_ATTRIBUTES[flag];
+        std::vector<byte>& stream = m_streams[flag];
+        if (!IsInMask((MeshDataFlag)flag) || stream.size() >= m_streamVertexCount * attribute.size)
+        {
+            continue;
+        }
+        const byte* value = (const byte*)&defaults + attribute.offset;
+        stream.reserve(m_streamVertexCount * attribute.size);
+        while (stream.size() < m_streamVertexCount * attribute.size)
+        {
+            stream.insert(stream.end(), value, value + attribute.size);
+        }
+    }
+    m_streamMask = m_dataMask;
+}
 
-            x += xStep;
-            u += uStep;
+//-----------------------------------------------------------------------------------
+void MeshBuilder::AppendStampToStreams()
+{
+    PadStreams();
+    for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+    {
+        if (IsInMask((MeshDataFlag)flag))
+        {
+            const byte* value = (const byte*)&m_stamp + MASTER_ATTRIBUTES[flag].offset;
+            m_streams[flag].insert(m_streams[flag].end(), value, value + MASTER_ATTRIBUTES[flag].size);
         }
+    }
+    ++m_streamVertexCount;
+}
 
-        y += yStep;
-        v += vStep;
+//-----------------------------------------------------------------------------------
+//Adds count vertices at once, one span per attribute. Spans switch their attribute on in the mask, and any attribute in the mask without a span
+//is filled from the current stamp the same as AddVertex would. Returns the index of the first new vertex.
+unsigned int MeshBuilder::AppendVertices(unsigned int count, const AttributeSpan* spans, unsigned int numSpans)
+{
+    const unsigned int firstVertex = GetVertexCount();
+    const AttributeSpan* spanForAttribute[NUM_MESH_DATA] = {};
+    for (unsigned int i = 0; i < numSpans; ++i)
+    {
+        ASSERT_OR_DIE(spans[i].attribute < NUM_MESH_DATA && spans[i].data, "AppendVertices was given a span with no data");
+        spanForAttribute[spans[i].attribute] = &spans[i];
+        SetMaskBit(spans[i].attribute);
     }
 
-    this->AddQuadIndices(1, 3, 0, 2);
+    if (m_vertexStorage == STREAM_STORAGE)
+    {
+        PadStreams();
+        for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+        {
+            if (!IsInMask((MeshDataFlag)flag))
+            {
+                continue;
+            }
+            const unsigned int size = MASTER_ATTRIBUTES[flag].size;
+            std::vector<byte>& stream = m_streams[flag];
+            stream.resize((firstVertex + count) * size);
+            byte* destination = stream.data() + (firstVertex * size);
+            const AttributeSpan* span = spanForAttribute[flag];
+            const byte* source = span ? (const byte*)span->data : (const byte*)&m_stamp + MASTER_ATTRIBUTES[flag].offset;
+            const unsigned int stride = span ? (span->stride == 0 ? size : span->stride) : 0;
+            if (stride == size)
+            {
+                memcpy(destination, source, count * size);
+                continue;
+            }
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                memcpy(destination, source, size);
+                destination += size;
+                source += stride;
+            }
+        }
+        m_streamVertexCount += count;
+        return firstVertex;
+    }
 
-    this->End();
+    m_vertices.resize(firstVertex + count, m_stamp);
+    for (unsigned int i = 0; i < numSpans; ++i)
+    {
+        const MasterAttribute& attribute = MASTER_ATTRIBUTES[spans[i].attribute];
+        const unsigned int stride = spans[i].stride == 0 ? attribute.size : spans[i].stride;
+        const byte* source = (const byte*)spans[i].data;
+        for (unsigned int vertexIndex = firstVertex; vertexIndex < firstVertex + count; ++vertexIndex)
+        {
+            memcpy((byte*)&m_vertices[vertexIndex] + attribute.offset, source, attribute.size);
+            source += stride;
+        }
+    }
+    return firstVertex;
 }
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::BuildPlane(
-    const Vector3& initialPosition,
-    const Vector3& right,
-    const Vector3& up,
-    float startX, float endX, uint32_t xSections,
-    float startY, float endY, uint32_t ySections)
+void MeshBuilder::AppendIndices(const unsigned int* indices, unsigned int count, unsigned int baseVertex /*= 0*/)
 {
-    ASSERT_OR_DIE(xSections > 0, "xSections passed in to BuildPlane has an invalid value");
-    ASSERT_OR_DIE(ySections > 0, "ySections passed in to BuildPlane has an invalid value");
-
-    this->Begin();
+    const size_t firstIndex = m_indices.size();
+    m_indices.resize(firstIndex + count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        m_indices[firstIndex + i] = indices[i] + baseVertex;
+    }
+}
 
-    //Add vertices to patch
-    uint32_t xVertCount = xSections + 1;
-    uint32_t yVertCount = ySections + 1;
+//-----------------------------------------------------------------------------------
+void MeshBuilder::AppendIndices(const uint16_t* indices, unsigned int count, unsigned int baseVertex /*= 0*/)
+{
+    const size_t firstIndex = m_indices.size();
+    m_indices.resize(firstIndex + count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        m_indices[firstIndex + i] = indices[i] + baseVertex;
+    }
+}
 
-    float const xRange = endX - startX;
+//-----------------------------------------------------------------------------------
+//Works with either storage. Attributes that aren't in the mask come back with their defaults.
+void MeshBuilder::GetVertex(unsigned int index, Vertex_Master& outVertex) const
+{
+    if (m_vertexStorage == INTERLEAVED_STORAGE)
+    {
+        outVertex = m_vertices[index];
+        return;
+    }
+    outVertex = Vertex_Master();
+    for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+    {
+        const MasterAttribute& attribute = MASTER_ATTRIBUTES[flag];
+        if (IsInMask((MeshDataFlag)flag) && m_streams[flag].size() >= (index + 1) * attribute.size)
+        {
+            memcpy((byte*)&outVertex + attribute.offset, &m_streams[flag][index * attribute.size], attribute.size);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//The attribute's tightly packed values, or null if the builder isn't streaming or the attribute isn't in the mask.
+void* MeshBuilder::GetAttributeStream(MeshDataFlag attribute)
+{
+    if (m_vertexStorage != STREAM_STORAGE || !IsInMask(attribute))
+    {
+        return nullptr;
+    }
+    PadStreams();
+    return m_streams[attribute].data();
+}
+
+//-----------------------------------------------------------------------------------
+//Same as above, except it can't pad out an attribute that was switched on since the last vertex went in, so that comes back null too.
+const void* MeshBuilder::GetAttributeStream(MeshDataFlag attribute) const
+{
+    if (m_vertexStorage != STREAM_STORAGE || !IsInMask(attribute) || m_streams[attribute].size() < m_streamVertexCount * MASTER_ATTRIBUTES[attribute].size)
+    {
+        return nullptr;
+    }
+    return m_streams[attribute].data();
+}
+
+//-----------------------------------------------------------------------------------
+//Where an attribute's values start and how far apart they are, whichever storage is in use. Interleaved steps through m_vertices,
+//streams are tightly packed, and an attribute that isn't streamed comes back as its default with a stride of 0.
+const byte* MeshBuilder::GetAttributeData(MeshDataFlag attribute, unsigned int& outStride) const
+{
+    static const Vertex_Master defaultVertex;
+    if (m_vertexStorage == INTERLEAVED_STORAGE)
+    {
+        outStride = sizeof(Vertex_Master);
+        return m_vertices.empty() ? nullptr : (const byte*)m_vertices.data() + MASTER_ATTRIBUTES[attribute].offset;
+    }
+    const void* stream = GetAttributeStream(attribute);
+    if (stream)
+    {
+        outStride = MASTER_ATTRIBUTES[attribute].size;
+        return (const byte*)stream;
+    }
+    outStride = 0;
+    return (const byte*)&defaultVertex + MASTER_ATTRIBUTES[attribute].offset;
+}
+
+//-----------------------------------------------------------------------------------
+//Returns false if there aren't any vertices. Streams walk one contiguous array of positions.
+bool MeshBuilder::CalculateBounds(Vector3& outMins, Vector3& outMaxs) const
+{
+    const unsigned int vertexCount = GetVertexCount();
+    const Vector3* positions = static_cast<const Vector3*>(GetAttributeStream(POSITION_BIT));
+    if (vertexCount == 0 || (m_vertexStorage == STREAM_STORAGE && !positions))
+    {
+        return false;
+    }
+    const size_t stride = positions ? sizeof(Vector3) : sizeof(Vertex_Master);
+    const byte* position = positions ? (const byte*)positions : (const byte*)&m_vertices[0].position;
+    outMins = outMaxs = *(const Vector3*)position;
+    for (unsigned int i = 0; i < vertexCount; ++i, position += stride)
+    {
+        const Vector3& point = *(const Vector3*)position;
+        outMins = Vector3(std::min(outMins.x, point.x), std::min(outMins.y, point.y), std::min(outMins.z, point.z));
+        outMaxs = Vector3(std::max(outMaxs.x, point.x), std::max(outMaxs.y, point.y), std::max(outMaxs.z, point.z));
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Radius of the sphere around the origin that holds every vertex.
+float MeshBuilder::CalculateBoundingRadius() const
+{
+    const unsigned int vertexCount = GetVertexCount();
+    const Vector3* positions = static_cast<const Vector3*>(GetAttributeStream(POSITION_BIT));
+    if (vertexCount == 0 || (m_vertexStorage == STREAM_STORAGE && !positions))
+    {
+        return 0.0f;
+    }
+    const size_t stride = positions ? sizeof(Vector3) : sizeof(Vertex_Master);
+    const byte* position = positions ? (const byte*)positions : (const byte*)&m_vertices[0].position;
+    float boundingRadiusSquared = 0.0f;
+    for (unsigned int i = 0; i < vertexCount; ++i, position += stride)
+    {
+        const Vector3& point = *(const Vector3*)position;
+        boundingRadiusSquared = std::max(boundingRadiusSquared, MathUtils::Dot(point, point));
+    }
+    return sqrt(boundingRadiusSquared);
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::Begin()
+{
+    m_startIndex = GetVertexCount();
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::End()
+{
+    if (m_startIndex < GetVertexCount())
+    {
+        m_startIndex = GetVertexCount();
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//MergeBatch without transforms, each builder's material ID is its place in the array. Comes back interleaved, like its inputs usually are.
+MeshBuilder* MeshBuilder::Merge(MeshBuilder* meshBuilderArray, unsigned int numberOfMeshes)
+{
+    std::vector<MergeInput> inputs(numberOfMeshes);
+    for (unsigned int i = 0; i < numberOfMeshes; i++)
+    {
+        inputs[i] = MergeInput(&meshBuilderArray[i], nullptr, i);
+    }
+    MeshBuilder* combinedMesh = MergeBatch(inputs.data(), numberOfMeshes);
+    combinedMesh->SetVertexStorage(INTERLEAVED_STORAGE);
+    return combinedMesh;
+}
+
+//-----------------------------------------------------------------------------------
+//Collapses the inputs into one streamed builder for static batching. Everything is sized up front and each input goes in as one append per attribute,
+//with its indices rebased onto where its vertices landed. Attributes missing from some of the inputs get their defaults there.
+//Unindexed inputs are given linear indices, so every input has a submesh range and mirrored ones can have their winding flipped.
+//LODs aren't carried over, generate them again on the result. The inputs have to share a draw mode, the material name comes from the first one.
+MeshBuilder* MeshBuilder::MergeBatch(const MergeInput* inputs, unsigned int numInputs)
+{
+    MeshBuilder* merged = new MeshBuilder();
+    merged->SetVertexStorage(STREAM_STORAGE);
+    unsigned int totalVertices = 0;
+    unsigned int totalIndices = 0;
+    for (unsigned int i = 0; i < numInputs; ++i)
+    {
+        ASSERT_OR_DIE(inputs[i].builder, "MergeBatch was given an input without a builder");
+        ASSERT_OR_DIE(inputs[i].builder->m_drawMode == inputs[0].builder->m_drawMode, "MergeBatch inputs have to share a draw mode");
+        const unsigned int vertexCount = inputs[i].builder->GetVertexCount();
+        totalVertices += vertexCount;
+        totalIndices += inputs[i].builder->m_indices.empty() ? vertexCount : inputs[i].builder->m_indices.size();
+        merged->m_dataMask |= inputs[i].builder->m_dataMask;
+    }
+    if (numInputs > 0)
+    {
+        merged->m_drawMode = inputs[0].builder->m_drawMode;
+        merged->SetMaterialName(inputs[0].builder->GetMaterialName());
+    }
+    merged->Reserve(totalVertices, totalIndices);
+    merged->m_subMeshes.reserve(numInputs);
+
+    std::vector<AttributeSpan> spans;
+    spans.reserve(NUM_MESH_DATA);
+    for (unsigned int i = 0; i < numInputs; ++i)
+    {
+        const MeshBuilder& input = *inputs[i].builder;
+        const unsigned int vertexCount = input.GetVertexCount();
+        spans.clear();
+        for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+        {
+            unsigned int stride = 0;
+            const byte* data = merged->IsInMask((MeshDataFlag)flag) ? input.GetAttributeData((MeshDataFlag)flag, stride) : nullptr;
+            //A stride of 0 is a streamed input without this attribute, which leaves it to the merged builder's defaults.
+            if (data && stride != 0)
+            {
+                spans.push_back(AttributeSpan((MeshDataFlag)flag, data, stride));
+            }
+        }
+        const unsigned int firstVertex = merged->AppendVertices(vertexCount, spans.data(), spans.size());
+        const unsigned int firstIndex = merged->m_indices.size();
+        if (input.m_indices.empty())
+        {
+            for (unsigned int vertex = 0; vertex < vertexCount; ++vertex)
+            {
+                merged->m_indices.push_back(firstVertex + vertex);
+            }
+        }
+        else
+        {
+            merged->AppendIndices(input.m_indices.data(), input.m_indices.size(), firstVertex);
+        }
+        const unsigned int numIndices = merged->m_indices.size() - firstIndex;
+        if (inputs[i].transform)
+        {
+            merged->TransformStreamRange(*inputs[i].transform, firstVertex, vertexCount, firstIndex, numIndices);
+        }
+        merged->m_subMeshes.push_back(SubMesh(firstIndex, numIndices, inputs[i].materialID));
+    }
+    return merged;
+}
+
+//-----------------------------------------------------------------------------------
+//Grows the storage in use (and every stream in the data mask) to hold this many in total, set the mask first when streaming.
+void MeshBuilder::Reserve(unsigned int vertexCount, unsigned int indexCount)
+{
+    m_indices.reserve(indexCount);
+    if (m_vertexStorage == INTERLEAVED_STORAGE)
+    {
+        m_vertices.reserve(vertexCount);
+        return;
+    }
+    for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+    {
+        if (IsInMask((MeshDataFlag)flag))
+        {
+            m_streams[flag].reserve(vertexCount * MASTER_ATTRIBUTES[flag].size);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Positions go through the batched Matrix4x4 transforms (SSE when MATRIX4X4_USE_SSE is on), which is why MergeBatch streams.
+//Normals take the inverse transpose so non-uniform scales don't skew them, and a mirroring transform flips the triangles back to the right winding.
+void MeshBuilder::TransformStreamRange(const Matrix4x4& transform, unsigned int firstVertex, unsigned int numVertices, unsigned int firstIndex, unsigned int numIndices)
+{
+    Vector3* positions = static_cast<Vector3*>(GetAttributeStream(POSITION_BIT));
+    if (positions)
+    {
+        Matrix4x4::MatrixTransformPoints(&transform, positions + firstVertex, positions + firstVertex, numVertices);
+    }
+
+    Matrix4x4 normalTransform = transform;
+    Matrix4x4::MatrixInvertAffine(&normalTransform);
+    Matrix4x4::MatrixTranspose(&normalTransform);
+    const MeshDataFlag directions[] = { NORMAL_BIT, TANGENT_BIT, BITANGENT_BIT };
+    for (MeshDataFlag flag : directions)
+    {
+        Vector3* stream = static_cast<Vector3*>(GetAttributeStream(flag));
+        if (!stream)
+        {
+            continue;
+        }
+        Matrix4x4::MatrixTransformDirections(flag == NORMAL_BIT ? &normalTransform : &transform, stream + firstVertex, stream + firstVertex, numVertices);
+        for (unsigned int i = firstVertex; i < firstVertex + numVertices; ++i)
+        {
+            stream[i].Normalize();
+        }
+    }
+
+    const float* m = transform.data;
+    float determinant = MathUtils::Dot(Vector3(m[0], m[1], m[2]), Vector3::Cross(Vector3(m[4], m[5], m[6]), Vector3(m[8], m[9], m[10])));
+    if (determinant < 0.0f && m_drawMode == Renderer::DrawMode::TRIANGLES)
+    {
+        for (unsigned int i = firstIndex; i + 2 < firstIndex + numIndices; i += 3)
+        {
+            std::swap(m_indices[i + 1], m_indices[i + 2]);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::AddVertex(const Vector3& position)
+{
+    m_stamp.position = position;
+    SetMaskBit(POSITION_BIT);
+    if (m_vertexStorage == STREAM_STORAGE)
+    {
+        AppendStampToStreams();
+        return;
+    }
+    m_vertices.push_back(m_stamp);
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::AddQuadIndicesClockwise(unsigned int tlIndex, unsigned int trIndex, unsigned int blIndex, unsigned int brIndex)
+{
+    m_indices.push_back(brIndex);
+    m_indices.push_back(blIndex);
+    m_indices.push_back(tlIndex);
+    m_indices.push_back(brIndex);
+    m_indices.push_back(tlIndex);
+    m_indices.push_back(trIndex);
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::AddQuadIndices(unsigned int tlIndex, unsigned int trIndex, unsigned int blIndex, unsigned int brIndex)
+{
+    m_indices.push_back(brIndex);
+    m_indices.push_back(tlIndex);
+    m_indices.push_back(blIndex);
+    m_indices.push_back(brIndex);
+    m_indices.push_back(trIndex);
+    m_indices.push_back(tlIndex);
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::AddQuadIndices()
+{
+    unsigned int lastIndex = GetVertexCount();
+    AddQuadIndices(lastIndex + 3, lastIndex + 2, lastIndex + 0, lastIndex + 1);
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::BuildQuad(
+    const Vector3& initial_position,
+    const Vector3& right,
+    const Vector3& up,
+    float startX, float endX,
+    float startY, float endY,
+    float startU, float endU,
+    float startV, float endV)
+{
+    this->Begin();
+
+    float const xStep = endX - startX;
+    float const yStep = endY - startY;
+    float const uStep = endU - startU;
+    float const vStep = endV - startV;
+
+    // So, what is our tangent, normal, and bitangent?
+    Vector3 tangent = right;
+    Vector3 bitangent = up;
+    Vector3 normal = Vector3::Cross(bitangent, tangent);
+    this->SetTBN(tangent, bitangent, normal);
+
+    // Okay, now, let's add all our vertices
+    float x, y;
+    float u, v;
+
+    y = startY;
+    v = startV;
+
+    for (unsigned int iy = 0; iy < 2; ++iy) {
+        x = startX;
+        u = startU;
+
+        for (uint32_t ix = 0; ix < 2; ++ix) {
+            this->SetUV(u, v);
+
+            Vector3 position = initial_position
+                + (right * x)
+                + (up * y);
+
+            this->AddVertex(position);
+
+            x += xStep;
+            u += uStep;
+        }
+
+        y += yStep;
+        v += vStep;
+    }
+
+    this->AddQuadIndices(1, 3, 0, 2);
+
+    this->End();
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::BuildPlane(
+    const Vector3& initialPosition,
+    const Vector3& right,
+    const Vector3& up,
+    float startX, float endX, uint32_t xSections,
+    float startY, float endY, uint32_t ySections)
+{
+    ASSERT_OR_DIE(xSections > 0, "xSections passed in to BuildPlane has an invalid value");
+    ASSERT_OR_DIE(ySections > 0, "ySections passed in to BuildPlane has an invalid value");
+
+    this->Begin();
+
+    //Add vertices to patch
+    uint32_t xVertCount = xSections + 1;
+    uint32_t yVertCount = ySections + 1;
+
+    float const xRange = endX - startX;
     float const yRange = endY - startY;
     float const xStep = xRange / (float)xSections;
     float const yStep = yRange / (float)ySections;
@@ -332,78 +1040,170 @@ void MeshBuilder::BuildPlaneFromFunc(
     &plane);
 }
 
+//PARALLEL HELPERS//////////////////////////////////////////////////////////////////////////
 //-----------------------------------------------------------------------------------
-void MeshBuilder::BuildPatch(
-    float startX, float endX, uint32_t xSections,
-    float startY, float endY, uint32_t ySections,
-    PatchFunction* patchFunction,
-    void *userData)
+//0 threads asks for one per hardware thread, as long as there's enough work to be worth starting them.
+static unsigned int ChooseThreadCount(uint32_t workSize, uint32_t minWorkForParallel, unsigned int numThreads)
 {
-    ASSERT_OR_DIE(xSections > 0, "xSections passed in to BuildPlane has an invalid value");
-    ASSERT_OR_DIE(ySections > 0, "ySections passed in to BuildPlane has an invalid value");
-
-    this->Begin();
+    if (numThreads != 0)
+    {
+        return numThreads;
+    }
+    unsigned int threadCount = std::thread::hardware_concurrency();
+    return workSize < minWorkForParallel || threadCount < 1 ? 1 : threadCount;
+}
 
-    uint32_t xVertCount = xSections + 1;
-    uint32_t yVertCount = ySections + 1;
+//-----------------------------------------------------------------------------------
+//Hands the tiles out to this thread and threadCount - 1 helpers until they're all done, the same way Compression decodes blocks.
+//Tiles finish in any order, so each one has to write its results somewhere of its own.
+static void RunTilesInParallel(uint32_t numTiles, unsigned int threadCount, const std::function<void(uint32_t tile)>& work)
+{
+    std::atomic<uint32_t> nextTile(0);
+    auto runTiles = [&]()
+    {
+        for (uint32_t tile = nextTile++; tile < numTiles; tile = nextTile++)
+        {
+            work(tile);
+        }
+    };
 
-    float const xRange = endX - startX;
-    float const yRange = endY - startY;
-    float const xStep = xRange / (float)xSections;
-    float const yStep = yRange / (float)ySections;
-
-    float const uStep = 1.0f / (float)xSections;
-    float const vStep = 1.0f / (float)ySections;
-
-    uint32_t startVertIndex = this->GetCurrentIndex();
-
-    //Add in the vertices
-    float x, y;
-    float u, v;
-
-    y = startY;
-    v = 0.0f;
-
-    float const delta = .01f; // artitrarily small value, can go smaller
-
-    for (uint32_t iy = 0; iy < yVertCount; ++iy) {
-        x = startX;
-        u = 0.0f;
-
-        for (uint32_t ix = 0; ix < xVertCount; ++ix) {
-            this->SetUV(u, v);
-
-            // calculate tangent along u (that is, x)
-            Vector3 tangent = patchFunction(userData, x + delta, y) - patchFunction(userData, x - delta, y);
-
-            // calculate bitangent along v (taht is, y)
-            Vector3 bitangent = patchFunction(userData, x, y + delta) - patchFunction(userData, x, y - delta);
+    if (threadCount < 2 || numTiles < 2)
+    {
+        runTiles();
+        return;
+    }
+    threadCount = threadCount < numTiles ? threadCount : numTiles;
+    std::vector<std::thread> helpers;
+    helpers.reserve(threadCount - 1);
+    for (unsigned int i = 1; i < threadCount; ++i)
+    {
+        helpers.emplace_back(runTiles);
+    }
+    runTiles();
+    for (std::thread& helper : helpers)
+    {
+        helper.join();
+    }
+}
 
-            tangent.Normalize();
-            bitangent.Normalize();
-            Vector3 normal = Vector3::Cross(bitangent, tangent);
-            bitangent = Vector3::Cross(tangent, normal);
-            this->SetTBN(tangent, bitangent, normal);
+//PATCHES//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+//Every sample of a patch, row by row, ready to be appended or written over an earlier patch's vertices.
+struct PatchGrid
+{
+    uint32_t xVertCount;
+    uint32_t yVertCount;
+    std::vector<Vector3> positions;
+    std::vector<Vector3> tangents;
+    std::vector<Vector3> bitangents;
+    std::vector<Vector3> normals;
+    std::vector<Vector2> uvs;
+};
+
+//Rows of samples handed out to a thread at a time, and the smallest grid worth starting threads for.
+static const uint32_t PATCH_TILE_ROWS = 8;
+static const uint32_t MIN_SAMPLES_FOR_PARALLEL_PATCH = 64 * 64;
 
-            Vector3 position = patchFunction(userData, x, y);
-            this->AddVertex(position);
+//-----------------------------------------------------------------------------------
+//Samples the function once per vertex, in parallel tiles of rows, so it has to be safe to call from several threads at once.
+//The tangent frames come from central differences between neighbouring samples (one sided along the edges) once every sample is in,
+//rather than from extra calls to the function.
+static void EvaluatePatch(float startX, float endX, uint32_t xSections, float startY, float endY, uint32_t ySections, MeshBuilder::PatchFunction* patchFunction, void* userData, PatchGrid& outGrid)
+{
+    ASSERT_OR_DIE(xSections > 0, "xSections passed in to BuildPatch has an invalid value");
+    ASSERT_OR_DIE(ySections > 0, "ySections passed in to BuildPatch has an invalid value");
+
+    const uint32_t xVertCount = xSections + 1;
+    const uint32_t yVertCount = ySections + 1;
+    const uint32_t numSamples = xVertCount * yVertCount;
+    const uint32_t numTiles = (yVertCount + PATCH_TILE_ROWS - 1) / PATCH_TILE_ROWS;
+    const float xStep = (endX - startX) / (float)xSections;
+    const float yStep = (endY - startY) / (float)ySections;
+    const float uStep = 1.0f / (float)xSections;
+    const float vStep = 1.0f / (float)ySections;
+
+    outGrid.xVertCount = xVertCount;
+    outGrid.yVertCount = yVertCount;
+    outGrid.positions.resize(numSamples);
+    outGrid.tangents.resize(numSamples);
+    outGrid.bitangents.resize(numSamples);
+    outGrid.normals.resize(numSamples);
+    outGrid.uvs.resize(numSamples);
+
+    const unsigned int threadCount = ChooseThreadCount(numSamples, MIN_SAMPLES_FOR_PARALLEL_PATCH, 0);
+    RunTilesInParallel(numTiles, threadCount, [&](uint32_t tile)
+    {
+        const uint32_t endRow = (tile + 1) * PATCH_TILE_ROWS < yVertCount ? (tile + 1) * PATCH_TILE_ROWS : yVertCount;
+        for (uint32_t iy = tile * PATCH_TILE_ROWS; iy < endRow; ++iy)
+        {
+            const float y = startY + (yStep * (float)iy);
+            for (uint32_t ix = 0; ix < xVertCount; ++ix)
+            {
+                const uint32_t sample = (iy * xVertCount) + ix;
+                outGrid.positions[sample] = patchFunction(userData, startX + (xStep * (float)ix), y);
+                outGrid.uvs[sample] = Vector2(uStep * (float)ix, vStep * (float)iy);
+            }
+        }
+    });
 
-            x += xStep;
-            u += uStep;
+    //Every tile reads the rows either side of it, so this waits until all the positions are in.
+    RunTilesInParallel(numTiles, threadCount, [&](uint32_t tile)
+    {
+        const uint32_t endRow = (tile + 1) * PATCH_TILE_ROWS < yVertCount ? (tile + 1) * PATCH_TILE_ROWS : yVertCount;
+        for (uint32_t iy = tile * PATCH_TILE_ROWS; iy < endRow; ++iy)
+        {
+            const uint32_t below = iy > 0 ? iy - 1 : iy;
+            const uint32_t above = iy < yVertCount - 1 ? iy + 1 : iy;
+            for (uint32_t ix = 0; ix < xVertCount; ++ix)
+            {
+                const uint32_t left = ix > 0 ? ix - 1 : ix;
+                const uint32_t right = ix < xVertCount - 1 ? ix + 1 : ix;
+                const uint32_t sample = (iy * xVertCount) + ix;
+                //Tangent along u (that is, x) and bitangent along v (that is, y).
+                Vector3 tangent = outGrid.positions[(iy * xVertCount) + right] - outGrid.positions[(iy * xVertCount) + left];
+                Vector3 bitangent = outGrid.positions[(above * xVertCount) + ix] - outGrid.positions[(below * xVertCount) + ix];
+                tangent.Normalize();
+                bitangent.Normalize();
+                Vector3 normal = Vector3::Cross(bitangent, tangent);
+                normal.Normalize();
+                outGrid.tangents[sample] = tangent;
+                outGrid.bitangents[sample] = Vector3::Cross(tangent, normal);
+                outGrid.normals[sample] = normal;
+            }
         }
+    });
+}
 
-        y += yStep;
-        v += vStep;
-    }
+//-----------------------------------------------------------------------------------
+void MeshBuilder::BuildPatch(
+    float startX, float endX, uint32_t xSections,
+    float startY, float endY, uint32_t ySections,
+    PatchFunction* patchFunction,
+    void *userData)
+{
+    PatchGrid grid;
+    EvaluatePatch(startX, endX, xSections, startY, endY, ySections, patchFunction, userData, grid);
+
+    this->Begin();
+    const AttributeSpan spans[] =
+    {
+        AttributeSpan(POSITION_BIT, grid.positions.data()),
+        AttributeSpan(TANGENT_BIT, grid.tangents.data()),
+        AttributeSpan(BITANGENT_BIT, grid.bitangents.data()),
+        AttributeSpan(NORMAL_BIT, grid.normals.data()),
+        AttributeSpan(UV0_BIT, grid.uvs.data())
+    };
+    uint32_t startVertIndex = AppendVertices(grid.positions.size(), spans, sizeof(spans) / sizeof(spans[0]));
 
     //Add all the indices for the patch
+    m_indices.reserve(m_indices.size() + (xSections * ySections * 6));
     for (uint32_t iy = 0; iy < ySections; ++iy) {
         for (uint32_t ix = 0; ix < xSections; ++ix) {
 
             uint32_t blIdx = startVertIndex
-                + (iy * xVertCount) + ix;
+                + (iy * grid.xVertCount) + ix;
             uint32_t brIdx = blIdx + 1;
-            uint32_t tlIdx = blIdx + xVertCount;
+            uint32_t tlIdx = blIdx + grid.xVertCount;
             uint32_t trIdx = tlIdx + 1;
 
             this->AddQuadIndices(tlIdx, trIdx, blIdx, brIdx);
@@ -412,6 +1212,46 @@ void MeshBuilder::BuildPatch(
     this->End();
 }
 
+//-----------------------------------------------------------------------------------
+//Re-evaluates a patch BuildPatch added at firstVertex with the same number of sections, rewriting its positions, tangent frames and UVs.
+//The indices don't change, so a mesh made from this builder only needs its vertex buffer updated (see VertexLayout::UpdateMesh).
+void MeshBuilder::UpdatePatch(unsigned int firstVertex,
+    float startX, float endX, uint32_t xSections,
+    float startY, float endY, uint32_t ySections,
+    PatchFunction* patchFunction,
+    void* userData)
+{
+    PatchGrid grid;
+    EvaluatePatch(startX, endX, xSections, startY, endY, ySections, patchFunction, userData, grid);
+    const unsigned int count = grid.positions.size();
+    ASSERT_OR_DIE(firstVertex + count <= GetVertexCount(), "UpdatePatch was given a patch bigger than the one that's there");
+    OverwriteAttribute(POSITION_BIT, grid.positions.data(), firstVertex, count);
+    OverwriteAttribute(TANGENT_BIT, grid.tangents.data(), firstVertex, count);
+    OverwriteAttribute(BITANGENT_BIT, grid.bitangents.data(), firstVertex, count);
+    OverwriteAttribute(NORMAL_BIT, grid.normals.data(), firstVertex, count);
+    OverwriteAttribute(UV0_BIT, grid.uvs.data(), firstVertex, count);
+}
+
+//-----------------------------------------------------------------------------------
+//Writes tightly packed values over a range of existing vertices, in whichever storage is in use.
+void MeshBuilder::OverwriteAttribute(MeshDataFlag attribute, const void* data, unsigned int firstVertex, unsigned int count)
+{
+    const MasterAttribute& masterAttribute = MASTER_ATTRIBUTES[attribute];
+    const byte* source = (const byte*)data;
+    ASSERT_OR_DIE(IsInMask(attribute), "Tried to overwrite an attribute the builder doesn't have");
+    if (m_vertexStorage == STREAM_STORAGE)
+    {
+        byte* stream = static_cast<byte*>(GetAttributeStream(attribute));
+        memcpy(stream + (firstVertex * masterAttribute.size), source, count * masterAttribute.size);
+        return;
+    }
+    for (unsigned int i = firstVertex; i < firstVertex + count; ++i)
+    {
+        memcpy((byte*)&m_vertices[i] + masterAttribute.offset, source, masterAttribute.size);
+        source += masterAttribute.size;
+    }
+}
+
 //-----------------------------------------------------------------------------------
 void MeshBuilder::WriteDataMask(IBinaryWriter& writer)
 {
@@ -449,112 +1289,770 @@ void MeshBuilder::WriteDataMask(IBinaryWriter& writer)
     }
     if ((m_dataMask & (1 << NORMALIZED_STRING_POSITION_BIT)) != 0)
     {
-        writer.WriteString("NormalizedStringPosition");
+        writer.WriteString("NormalizedStringPosition");
+    }
+    if ((m_dataMask & (1 << NORMALIZED_FRAG_POSITION_BIT)) != 0)
+    {
+        writer.WriteString("NormalizedFragPosition");
+    }
+    if ((m_dataMask & (1 << BONE_INDICES_BIT)) != 0)
+    {
+        writer.WriteString("BoneIndices");
+    }
+    if ((m_dataMask & (1 << BONE_WEIGHTS_BIT)) != 0)
+    {
+        writer.WriteString("BoneWeights");
+    }
+
+    writer.WriteString(nullptr);
+}
+
+//-----------------------------------------------------------------------------------
+uint32_t MeshBuilder::ReadDataMask(IBinaryReader& reader)
+{
+    uint32_t mask = 0;
+    std::string str;
+    size_t size = reader.ReadString(str);
+    while (size > 0) 
+    {
+        if (str == "Position")
+        {
+            mask |= (1 << POSITION_BIT);
+        }
+        else if (str == "Tangent")
+        {
+            mask |= (1 << TANGENT_BIT);
+        }
+        else if (str == "Bitangent")
+        {
+            mask |= (1 << BITANGENT_BIT);
+        }
+        else if (str == "Normal")
+        {
+            mask |= (1 << NORMAL_BIT);
+        }
+        else if (str == "Color")
+        {
+            mask |= (1 << COLOR_BIT);
+        }
+        else if (str == "UV0")
+        {
+            mask |= (1 << UV0_BIT);
+        }
+        else if (str == "UV1")
+        {
+            mask |= (1 << UV1_BIT);
+        }
+        else if (str == "NormalizedGlyphPosition")
+        {
+            mask |= (1 << NORMALIZED_GLYPH_POSITION_BIT);
+        }
+        else if (str == "NormalizedStringPosition")
+        {
+            mask |= (1 << NORMALIZED_STRING_POSITION_BIT);
+        }
+        else if (str == "NormalizedFragPosition")
+        {
+            mask |= (1 << NORMALIZED_FRAG_POSITION_BIT);
+        }
+        else if (str == "BoneIndices")
+        {
+            mask |= (1 << BONE_INDICES_BIT);
+        }
+        else if (str == "BoneWeights")
+        {
+            mask |= (1 << BONE_WEIGHTS_BIT);
+        }
+
+
+        size = reader.ReadString(str);
+    }
+    return mask;
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::RenormalizeSkinWeights()
+{
+    //Renormalize the bone weights.
+    float totalWeight = m_stamp.boneWeights.x + m_stamp.boneWeights.y + m_stamp.boneWeights.z + m_stamp.boneWeights.w;
+    if (totalWeight > 0.0f)
+    {
+        m_stamp.boneWeights /= totalWeight;
+    }
+    else
+    {
+        m_stamp.boneWeights = { 1.0f, 0.0f, 0.0f, 0.0f };
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Points the skin indices at a skeleton whose joints have been reordered (see Skeleton::ReorderJointsDepthFirst).
+void MeshBuilder::RemapBoneIndices(const std::vector<int>& oldToNewJointIndices)
+{
+    if (!IsInMask(BONE_INDICES_BIT))
+    {
+        return;
+    }
+    ScopedInterleave interleaved(*this);
+    const int numJoints = (int)oldToNewJointIndices.size();
+    for (Vertex_Master& vertex : m_vertices)
+    {
+        Vector4Int& boneIndices = vertex.boneIndices;
+        ASSERT_OR_DIE(boneIndices.x < numJoints && boneIndices.y < numJoints && boneIndices.z < numJoints && boneIndices.w < numJoints, "Bone index was outside of the joint remap!");
+        boneIndices.x = oldToNewJointIndices[boneIndices.x];
+        boneIndices.y = oldToNewJointIndices[boneIndices.y];
+        boneIndices.z = oldToNewJointIndices[boneIndices.z];
+        boneIndices.w = oldToNewJointIndices[boneIndices.w];
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Snaps to a grid of size epsilon, or keeps the exact bits (with -0 folded into 0) when epsilon is 0.
+static inline uint32_t GetWeldKey(float value, float epsilon)
+{
+    if (epsilon > 0.0f)
+    {
+        return (uint32_t)(int32_t)floor((value / epsilon) + 0.5f);
+    }
+    uint32_t bits = 0;
+    if (value != 0.0f)
+    {
+        memcpy(&bits, &value, sizeof(bits));
+    }
+    return bits;
+}
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t HashWeldKey(const uint32_t* key, unsigned int keyLength)
+{
+    //FNV-1a over the words
+    uint32_t hash = 2166136261u;
+    for (unsigned int i = 0; i < keyLength; ++i)
+    {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+//-----------------------------------------------------------------------------------
+//Merges vertices whose attributes (only the ones in the data mask) match, and rewrites the indices to use the survivors.
+//Unindexed meshes are treated as if they had linear indices. Returns how many vertices were removed.
+//Epsilon matching snaps to a grid, so two values just either side of a cell boundary won't be merged.
+unsigned int MeshBuilder::WeldVertices(const WeldEpsilons& epsilons)
+{
+    ScopedInterleave interleaved(*this);
+    const unsigned int vertexCount = m_vertices.size();
+    if (vertexCount == 0)
+    {
+        return 0;
+    }
+    if (m_indices.empty())
+    {
+        AddLinearIndices();
+    }
+
+    //Build every vertex's key up front into one flat array, they're all the same length.
+    std::vector<uint32_t> keys;
+    for (const Vertex_Master& vertex : m_vertices)
+    {
+        keys.push_back(GetWeldKey(vertex.position.x, epsilons.position));
+        keys.push_back(GetWeldKey(vertex.position.y, epsilons.position));
+        keys.push_back(GetWeldKey(vertex.position.z, epsilons.position));
+        const Vector3* directions[3] = { &vertex.tangent, &vertex.bitangent, &vertex.normal };
+        const MeshDataFlag directionFlags[3] = { TANGENT_BIT, BITANGENT_BIT, NORMAL_BIT };
+        for (int i = 0; i < 3; ++i)
+        {
+            if (IsInMask(directionFlags[i]))
+            {
+                keys.push_back(GetWeldKey(directions[i]->x, epsilons.direction));
+                keys.push_back(GetWeldKey(directions[i]->y, epsilons.direction));
+                keys.push_back(GetWeldKey(directions[i]->z, epsilons.direction));
+            }
+        }
+        if (IsInMask(COLOR_BIT))
+        {
+            keys.push_back((vertex.color.red << 24) | (vertex.color.green << 16) | (vertex.color.blue << 8) | vertex.color.alpha);
+        }
+        if (IsInMask(UV0_BIT))
+        {
+            keys.push_back(GetWeldKey(vertex.uv0.x, epsilons.uv));
+            keys.push_back(GetWeldKey(vertex.uv0.y, epsilons.uv));
+        }
+        if (IsInMask(UV1_BIT))
+        {
+            keys.push_back(GetWeldKey(vertex.uv1.x, epsilons.uv));
+            keys.push_back(GetWeldKey(vertex.uv1.y, epsilons.uv));
+        }
+        if (IsInMask(NORMALIZED_GLYPH_POSITION_BIT))
+        {
+            keys.push_back(GetWeldKey(vertex.normalizedGlyphPosition.x, 0.0f));
+            keys.push_back(GetWeldKey(vertex.normalizedGlyphPosition.y, 0.0f));
+        }
+        if (IsInMask(NORMALIZED_STRING_POSITION_BIT))
+        {
+            keys.push_back(GetWeldKey(vertex.normalizedStringPosition.x, 0.0f));
+            keys.push_back(GetWeldKey(vertex.normalizedStringPosition.y, 0.0f));
+        }
+        if (IsInMask(NORMALIZED_FRAG_POSITION_BIT))
+        {
+            keys.push_back(GetWeldKey(vertex.normalizedFragPosition, 0.0f));
+        }
+        if (IsInMask(BONE_WEIGHTS_BIT))
+        {
+            keys.push_back(GetWeldKey(vertex.boneWeights.x, epsilons.boneWeight));
+            keys.push_back(GetWeldKey(vertex.boneWeights.y, epsilons.boneWeight));
+            keys.push_back(GetWeldKey(vertex.boneWeights.z, epsilons.boneWeight));
+            keys.push_back(GetWeldKey(vertex.boneWeights.w, epsilons.boneWeight));
+        }
+        if (IsInMask(BONE_INDICES_BIT))
+        {
+            keys.push_back((uint32_t)vertex.boneIndices.x);
+            keys.push_back((uint32_t)vertex.boneIndices.y);
+            keys.push_back((uint32_t)vertex.boneIndices.z);
+            keys.push_back((uint32_t)vertex.boneIndices.w);
+        }
+    }
+    const unsigned int keyLength = keys.size() / vertexCount;
+
+    //Open addressing with linear probing, kept at most half full. Slots hold the original index of the first vertex seen with that key.
+    static const uint32_t EMPTY_SLOT = 0xFFFFFFFF;
+    uint32_t tableSize = 1;
+    while (tableSize < vertexCount * 2)
+    {
+        tableSize <<= 1;
+    }
+    const uint32_t tableMask = tableSize - 1;
+    std::vector<uint32_t> table(tableSize, EMPTY_SLOT);
+    std::vector<unsigned int> oldToNew(vertexCount);
+    std::vector<Vertex_Master> weldedVertices;
+    weldedVertices.reserve(vertexCount);
+
+    for (unsigned int vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+    {
+        const uint32_t* key = &keys[vertexIndex * keyLength];
+        uint32_t slot = HashWeldKey(key, keyLength) & tableMask;
+        while (table[slot] != EMPTY_SLOT && memcmp(&keys[table[slot] * keyLength], key, keyLength * sizeof(uint32_t)) != 0)
+        {
+            slot = (slot + 1) & tableMask;
+        }
+        if (table[slot] == EMPTY_SLOT)
+        {
+            table[slot] = vertexIndex;
+            oldToNew[vertexIndex] = weldedVertices.size();
+            weldedVertices.push_back(m_vertices[vertexIndex]);
+        }
+        else
+        {
+            oldToNew[vertexIndex] = oldToNew[table[slot]];
+        }
+    }
+
+    for (unsigned int& index : m_indices)
+    {
+        ASSERT_OR_DIE(index < vertexCount, "Index was outside of the vertex array!");
+        index = oldToNew[index];
+    }
+    for (MeshLOD& lod : m_lods)
+    {
+        for (unsigned int& index : lod.indices)
+        {
+            index = oldToNew[index];
+        }
+    }
+    unsigned int removedVertexCount = vertexCount - weldedVertices.size();
+    m_vertices.swap(weldedVertices);
+    m_startIndex = m_vertices.size();
+    return removedVertexCount;
+}
+
+//-----------------------------------------------------------------------------------
+//Whether m_subMeshes still splits up m_indices end to end and every LOD has its own ranges for them.
+//Anything that rebuilt the indices since MergeBatch leaves them stale.
+bool MeshBuilder::HasValidSubMeshes() const
+{
+    unsigned int nextIndex = 0;
+    for (const SubMesh& subMesh : m_subMeshes)
+    {
+        if (subMesh.firstIndex != nextIndex)
+        {
+            return false;
+        }
+        nextIndex += subMesh.numIndices;
+    }
+    for (const MeshLOD& lod : m_lods)
+    {
+        if (lod.subMeshes.size() != m_subMeshes.size())
+        {
+            return false;
+        }
+    }
+    return !m_subMeshes.empty() && nextIndex == m_indices.size();
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::OptimizeVertexCache(unsigned int cacheSize)
+{
+    if (m_drawMode != Renderer::DrawMode::TRIANGLES || m_indices.empty())
+    {
+        return;
+    }
+    //Submeshes are reordered within their own ranges so they can still be drawn one at a time, as long as they still cover every index.
+    const bool keepSubMeshes = HasValidSubMeshes();
+    if (!keepSubMeshes)
+    {
+        MeshOptimizer::OptimizeVertexCache(m_indices.data(), m_indices.size(), GetVertexCount(), cacheSize);
+    }
+    for (unsigned int i = 0; keepSubMeshes && i < m_subMeshes.size(); ++i)
+    {
+        MeshOptimizer::OptimizeVertexCache(m_indices.data() + m_subMeshes[i].firstIndex, m_subMeshes[i].numIndices, GetVertexCount(), cacheSize);
+    }
+    for (MeshLOD& lod : m_lods)
+    {
+        if (lod.subMeshes.empty())
+        {
+            MeshOptimizer::OptimizeVertexCache(lod.indices.data(), lod.indices.size(), GetVertexCount(), cacheSize);
+        }
+        for (const SubMesh& subMesh : lod.subMeshes)
+        {
+            MeshOptimizer::OptimizeVertexCache(lod.indices.data() + subMesh.firstIndex, subMesh.numIndices, GetVertexCount(), cacheSize);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Renumbers vertices in the order the indices first touch them, run after OptimizeVertexCache. Drops unreferenced vertices and returns how many.
+//Only LOD 0 decides the order, the LODs reuse a subset of its vertices so they just follow along.
+unsigned int MeshBuilder::OptimizeVertexFetch()
+{
+    if (m_indices.empty())
+    {
+        return 0;
     }
-    if ((m_dataMask & (1 << NORMALIZED_FRAG_POSITION_BIT)) != 0)
+    std::vector<unsigned int> oldToNew;
+    const unsigned int vertexCount = GetVertexCount();
+    size_t referencedCount = MeshOptimizer::BuildVertexFetchRemap(m_indices.data(), m_indices.size(), vertexCount, oldToNew);
+    for (MeshLOD& lod : m_lods)
     {
-        writer.WriteString("NormalizedFragPosition");
+        for (unsigned int& index : lod.indices)
+        {
+            index = oldToNew[index];
+        }
     }
-    if ((m_dataMask & (1 << BONE_INDICES_BIT)) != 0)
+    if (m_vertexStorage == STREAM_STORAGE)
     {
-        writer.WriteString("BoneIndices");
+        //Each stream gets reordered on its own.
+        PadStreams();
+        for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+        {
+            if (!IsInMask((MeshDataFlag)flag))
+            {
+                continue;
+            }
+            const unsigned int size = MASTER_ATTRIBUTES[flag].size;
+            std::vector<byte> reorderedStream(referencedCount * size);
+            for (unsigned int oldIndex = 0; oldIndex < vertexCount; ++oldIndex)
+            {
+                if (oldToNew[oldIndex] != MeshOptimizer::INVALID_VERTEX)
+                {
+                    memcpy(&reorderedStream[oldToNew[oldIndex] * size], &m_streams[flag][oldIndex * size], size);
+                }
+            }
+            m_streams[flag].swap(reorderedStream);
+        }
+        m_streamVertexCount = referencedCount;
+        m_startIndex = m_streamVertexCount;
+        return vertexCount - referencedCount;
     }
-    if ((m_dataMask & (1 << BONE_WEIGHTS_BIT)) != 0)
+    std::vector<Vertex_Master> reorderedVertices(referencedCount);
+    for (unsigned int oldIndex = 0; oldIndex < m_vertices.size(); ++oldIndex)
     {
-        writer.WriteString("BoneWeights");
+        if (oldToNew[oldIndex] != MeshOptimizer::INVALID_VERTEX)
+        {
+            reorderedVertices[oldToNew[oldIndex]] = m_vertices[oldIndex];
+        }
     }
+    unsigned int droppedCount = m_vertices.size() - referencedCount;
+    m_vertices.swap(reorderedVertices);
+    m_startIndex = m_vertices.size();
+    return droppedCount;
+}
 
-    writer.WriteString(nullptr);
+//-----------------------------------------------------------------------------------
+VertexCacheStats MeshBuilder::AnalyzeVertexCache(unsigned int cacheSize) const
+{
+    return MeshOptimizer::AnalyzeVertexCache(m_indices.data(), m_indices.size(), GetVertexCount(), cacheSize);
 }
 
 //-----------------------------------------------------------------------------------
-uint32_t MeshBuilder::ReadDataMask(IBinaryReader& reader)
+//Marks every vertex at a position that more than one submesh uses. GenerateLODs simplifies the submeshes one at a time and keeps these where
+//they are, otherwise each side of the seam would collapse it its own way and open a crack between them.
+static void FindSubMeshSeams(const std::vector<unsigned int>& indices, const std::vector<MeshBuilder::SubMesh>& subMeshes, const std::vector<Vector3>& positions,
+    std::vector<uint8_t>& outIsOnSeam)
 {
-    uint32_t mask = 0;
-    const char* str = nullptr;
-    size_t size = reader.ReadString(str, 64);
-    while (size > 0) 
+    static const unsigned int NO_OWNER = 0xFFFFFFFF;
+    static const unsigned int SHARED = 0xFFFFFFFE;
+    const unsigned int vertexCount = positions.size();
+    std::vector<unsigned int> owners(vertexCount, NO_OWNER);
+    for (unsigned int subMeshIndex = 0; subMeshIndex < subMeshes.size(); ++subMeshIndex)
     {
-        if (strcmp(str, "Position") == 0)
+        const MeshBuilder::SubMesh& subMesh = subMeshes[subMeshIndex];
+        for (unsigned int i = subMesh.firstIndex; i < subMesh.firstIndex + subMesh.numIndices; ++i)
         {
-            mask |= (1 << POSITION_BIT);
+            unsigned int& owner = owners[indices[i]];
+            owner = (owner == NO_OWNER || owner == subMeshIndex) ? subMeshIndex : SHARED;
         }
-        else if (strcmp(str, "Tangent") == 0)
+    }
+
+    std::vector<unsigned int> sorted(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        sorted[i] = i;
+    }
+    std::sort(sorted.begin(), sorted.end(), [&positions](unsigned int lhs, unsigned int rhs)
+    {
+        const Vector3& a = positions[lhs];
+        const Vector3& b = positions[rhs];
+        return (a.x != b.x) ? (a.x < b.x) : ((a.y != b.y) ? (a.y < b.y) : (a.z < b.z));
+    });
+    outIsOnSeam.assign(vertexCount, 0);
+    for (unsigned int i = 0; i < vertexCount;)
+    {
+        unsigned int end = i + 1;
+        while (end < vertexCount && positions[sorted[end]] == positions[sorted[i]])
         {
-            mask |= (1 << TANGENT_BIT);
+            ++end;
         }
-        else if (strcmp(str, "Bitangent") == 0)
+        unsigned int groupOwner = NO_OWNER;
+        bool isOnSeam = false;
+        for (unsigned int j = i; j < end; ++j)
         {
-            mask |= (1 << BITANGENT_BIT);
+            unsigned int owner = owners[sorted[j]];
+            if (owner != NO_OWNER)
+            {
+                isOnSeam = isOnSeam || owner == SHARED || (groupOwner != NO_OWNER && groupOwner != owner);
+                groupOwner = owner;
+            }
         }
-        else if (strcmp(str, "Normal") == 0)
+        for (unsigned int j = i; isOnSeam && j < end; ++j)
         {
-            mask |= (1 << NORMAL_BIT);
+            outIsOnSeam[sorted[j]] = 1;
         }
-        else if (strcmp(str, "Color") == 0)
+        i = end;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Simplifies one submesh over just the vertices it uses, so the cost follows the submesh's size rather than the whole mesh's. Appends to outIndices.
+static void SimplifySubMesh(const unsigned int* indices, size_t indexCount, const std::vector<Vector3>& positions, const std::vector<int>& collapseRegions,
+    const std::vector<uint8_t>& lockedVertices, size_t targetIndexCount, std::vector<unsigned int>& outIndices)
+{
+    std::unordered_map<unsigned int, unsigned int> globalToLocal;
+    std::vector<unsigned int> localToGlobal;
+    std::vector<unsigned int> localIndices(indexCount);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        auto inserted = globalToLocal.insert(std::make_pair(indices[i], (unsigned int)localToGlobal.size()));
+        if (inserted.second)
         {
-            mask |= (1 << COLOR_BIT);
+            localToGlobal.push_back(indices[i]);
         }
-        else if (strcmp(str, "UV0") == 0)
+        localIndices[i] = inserted.first->second;
+    }
+
+    std::vector<Vector3> localPositions(localToGlobal.size());
+    std::vector<int> localRegions(collapseRegions.empty() ? 0 : localToGlobal.size());
+    std::vector<uint8_t> localLocked(lockedVertices.empty() ? 0 : localToGlobal.size());
+    for (unsigned int i = 0; i < localToGlobal.size(); ++i)
+    {
+        localPositions[i] = positions[localToGlobal[i]];
+        if (!localRegions.empty())
         {
-            mask |= (1 << UV0_BIT);
+            localRegions[i] = collapseRegions[localToGlobal[i]];
         }
-        else if (strcmp(str, "UV1") == 0)
+        if (!localLocked.empty())
         {
-            mask |= (1 << UV1_BIT);
+            localLocked[i] = lockedVertices[localToGlobal[i]];
         }
-        else if (strcmp(str, "NormalizedGlyphPosition") == 0)
+    }
+    std::vector<unsigned int> simplified;
+    MeshOptimizer::Simplify(localIndices.data(), indexCount, localPositions, localRegions, localLocked, targetIndexCount, simplified);
+    for (unsigned int localIndex : simplified)
+    {
+        outIndices.push_back(localToGlobal[localIndex]);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Replaces the LOD chain with one LOD per ratio (fractions of LOD 0's triangle count, largest first). Each LOD is simplified from the one before it,
+//so the chain nests and the whole thing costs about as much as the first step. Skinned meshes won't collapse across dominant bone boundaries,
+//which keeps joints from getting smeared into their neighbors. Merged meshes are simplified a submesh at a time, each to the ratio of its own
+//triangles, so every LOD can still be drawn a submesh (and material) at a time.
+void MeshBuilder::GenerateLODs(const std::vector<float>& triangleRatios)
+{
+    m_lods.clear();
+    if (m_drawMode != Renderer::DrawMode::TRIANGLES || m_indices.empty())
+    {
+        return;
+    }
+
+    ScopedInterleave interleaved(*this);
+    std::vector<Vector3> positions;
+    positions.reserve(m_vertices.size());
+    for (const Vertex_Master& vertex : m_vertices)
+    {
+        positions.push_back(vertex.position);
+    }
+    std::vector<int> dominantBones;
+    if (IsInMask(BONE_WEIGHTS_BIT) && IsInMask(BONE_INDICES_BIT))
+    {
+        dominantBones.reserve(m_vertices.size());
+        for (const Vertex_Master& vertex : m_vertices)
         {
-            mask |= (1 << NORMALIZED_GLYPH_POSITION_BIT);
+            const Vector4& weights = vertex.boneWeights;
+            const Vector4Int& bones = vertex.boneIndices;
+            int dominantBone = bones.x;
+            float dominantWeight = weights.x;
+            dominantBone = weights.y > dominantWeight ? bones.y : dominantBone;
+            dominantWeight = weights.y > dominantWeight ? weights.y : dominantWeight;
+            dominantBone = weights.z > dominantWeight ? bones.z : dominantBone;
+            dominantWeight = weights.z > dominantWeight ? weights.z : dominantWeight;
+            dominantBone = weights.w > dominantWeight ? bones.w : dominantBone;
+            dominantBones.push_back(dominantBone);
         }
-        else if (strcmp(str, "NormalizedStringPosition") == 0)
+    }
+
+    const bool keepSubMeshes = HasValidSubMeshes();
+    std::vector<uint8_t> isOnSeam;
+    if (keepSubMeshes)
+    {
+        FindSubMeshSeams(m_indices, m_subMeshes, positions, isOnSeam);
+    }
+
+    m_lods.reserve(triangleRatios.size());
+    const std::vector<unsigned int>* sourceIndices = &m_indices;
+    const std::vector<SubMesh>* sourceSubMeshes = &m_subMeshes;
+    for (float ratio : triangleRatios)
+    {
+        ASSERT_OR_DIE(ratio > 0.0f && ratio < 1.0f, "LOD triangle ratios have to be between 0 and 1!");
+        size_t targetIndexCount = ((size_t)((float)(m_indices.size() / 3) * ratio)) * 3;
+        if (targetIndexCount >= sourceIndices->size())
         {
-            mask |= (1 << NORMALIZED_STRING_POSITION_BIT);
+            continue;
         }
-        else if (strcmp(str, "NormalizedFragPosition") == 0)
+        //Triangle count is proportional to projected area, so a ratio r LOD holds the same density at sqrt(r) of the size.
+        MeshLOD lod(ratio, sqrt(ratio));
+        if (!keepSubMeshes)
         {
-            mask |= (1 << NORMALIZED_FRAG_POSITION_BIT);
+            MeshOptimizer::Simplify(sourceIndices->data(), sourceIndices->size(), positions, dominantBones, isOnSeam, targetIndexCount, lod.indices);
         }
-        else if (strcmp(str, "BoneIndices") == 0)
+        for (unsigned int i = 0; keepSubMeshes && i < m_subMeshes.size(); ++i)
         {
-            mask |= (1 << BONE_INDICES_BIT);
+            const SubMesh& source = (*sourceSubMeshes)[i];
+            const unsigned int* sourceRange = sourceIndices->data() + source.firstIndex;
+            size_t subMeshTargetIndexCount = ((size_t)((float)(m_subMeshes[i].numIndices / 3) * ratio)) * 3;
+            const unsigned int firstIndex = lod.indices.size();
+            if (subMeshTargetIndexCount >= source.numIndices)
+            {
+                lod.indices.insert(lod.indices.end(), sourceRange, sourceRange + source.numIndices);
+            }
+            else
+            {
+                SimplifySubMesh(sourceRange, source.numIndices, positions, dominantBones, isOnSeam, subMeshTargetIndexCount, lod.indices);
+            }
+            lod.subMeshes.push_back(SubMesh(firstIndex, lod.indices.size() - firstIndex, source.materialID));
         }
-        else if (strcmp(str, "BoneWeights") == 0)
+        if (lod.indices.empty() || lod.indices.size() == sourceIndices->size())
         {
-            mask |= (1 << BONE_WEIGHTS_BIT);
+            //Nothing left that can collapse, further LODs would just be copies.
+            break;
         }
+        m_lods.push_back(lod);
+        sourceIndices = &m_lods.back().indices;
+        sourceSubMeshes = &m_lods.back().subMeshes;
+    }
+}
 
+//Triangles or vertices handed out to a thread at a time in GenerateTangents, and the smallest mesh worth starting threads for.
+static const uint32_t TANGENT_TILE_SIZE = 4096;
+static const uint32_t MIN_TRIANGLES_FOR_PARALLEL_TANGENTS = 16384;
 
-        size = reader.ReadString(str, 64);
+//-----------------------------------------------------------------------------------
+//Any vector perpendicular to the normal, for vertices whose UVs don't give them a tangent.
+static Vector3 GetFallbackTangent(const Vector3& normal)
+{
+    Vector3 tangent = Vector3::Cross(Vector3::UP, normal);
+    if (tangent.CalculateMagnitude() < 0.0001f)
+    {
+        tangent = Vector3::Cross(Vector3::FORWARD, normal);
     }
-    delete str;
-    return mask;
+    tangent.Normalize();
+    return tangent;
 }
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::RenormalizeSkinWeights()
+//Replaces every vertex's tangent and bitangent with ones that follow the UVs, for normal mapping. Each triangle's UV gradient is
+//accumulated onto its corners weighted by the corner's angle, and each vertex then gets the sum made orthonormal to its normal
+//(normals are generated the same way if the mesh doesn't have any). Vertices shared by triangles with mirrored UVs are split,
+//one copy for each side of the mirror seam, so the LODs should be generated afterwards.
+//Triangles are evaluated in parallel ranges, and each vertex sums its corners in triangle order whichever thread it lands on,
+//so the results are the same for any number of threads. This is meant for cooking (see RegisterEngineCookSteps), not loading.
+//Returns false if there's nothing to go on (no UVs or no triangles).
+bool MeshBuilder::GenerateTangents(unsigned int numThreads /*= 0*/)
 {
-    //Renormalize the bone weights.
-    float totalWeight = m_stamp.boneWeights.x + m_stamp.boneWeights.y + m_stamp.boneWeights.z + m_stamp.boneWeights.w;
-    if (totalWeight > 0.0f)
+    if (m_drawMode != Renderer::DrawMode::TRIANGLES || m_indices.size() < 3 || !IsInMask(UV0_BIT))
     {
-        m_stamp.boneWeights /= totalWeight;
+        return false;
     }
-    else
+    ScopedInterleave interleaved(*this);
+    const uint32_t numTriangles = m_indices.size() / 3;
+    const uint32_t numTriangleTiles = (numTriangles + TANGENT_TILE_SIZE - 1) / TANGENT_TILE_SIZE;
+    const unsigned int threadCount = ChooseThreadCount(numTriangles, MIN_TRIANGLES_FOR_PARALLEL_TANGENTS, numThreads);
+    const bool hasNormals = IsInMask(NORMAL_BIT);
+
+    //Per triangle directions, and per corner weights.
+    std::vector<Vector3> faceTangents(numTriangles);
+    std::vector<Vector3> faceBitangents(numTriangles);
+    std::vector<Vector3> faceNormals(numTriangles);
+    std::vector<float> cornerAngles(numTriangles * 3);
+    std::vector<byte> isMirrored(numTriangles);
+    RunTilesInParallel(numTriangleTiles, threadCount, [&](uint32_t tile)
     {
-        m_stamp.boneWeights = { 1.0f, 0.0f, 0.0f, 0.0f };
+        const uint32_t endTriangle = (tile + 1) * TANGENT_TILE_SIZE < numTriangles ? (tile + 1) * TANGENT_TILE_SIZE : numTriangles;
+        for (uint32_t triangle = tile * TANGENT_TILE_SIZE; triangle < endTriangle; ++triangle)
+        {
+            const Vertex_Master* corners[3] =
+            {
+                &m_vertices[m_indices[(triangle * 3)]],
+                &m_vertices[m_indices[(triangle * 3) + 1]],
+                &m_vertices[m_indices[(triangle * 3) + 2]]
+            };
+            const Vector3 edge1 = corners[1]->position - corners[0]->position;
+            const Vector3 edge2 = corners[2]->position - corners[0]->position;
+            const Vector2 uvEdge1 = corners[1]->uv0 - corners[0]->uv0;
+            const Vector2 uvEdge2 = corners[2]->uv0 - corners[0]->uv0;
+            const float uvArea = (uvEdge1.x * uvEdge2.y) - (uvEdge2.x * uvEdge1.y);
+
+            //Degenerate UVs leave the tangents at zero so they don't drag their neighbors around.
+            Vector3 tangent = Vector3::ZERO;
+            Vector3 bitangent = Vector3::ZERO;
+            if (uvArea != 0.0f)
+            {
+                tangent = ((edge1 * uvEdge2.y) - (edge2 * uvEdge1.y)) * (1.0f / uvArea);
+                bitangent = ((edge2 * uvEdge1.x) - (edge1 * uvEdge2.x)) * (1.0f / uvArea);
+                tangent = tangent.CalculateMagnitude() > 0.0f ? Vector3::GetNormalized(tangent) : Vector3::ZERO;
+                bitangent = bitangent.CalculateMagnitude() > 0.0f ? Vector3::GetNormalized(bitangent) : Vector3::ZERO;
+            }
+            faceTangents[triangle] = tangent;
+            faceBitangents[triangle] = bitangent;
+            isMirrored[triangle] = uvArea < 0.0f ? 1 : 0;
+            Vector3 normal = Vector3::Cross(edge2, edge1);
+            faceNormals[triangle] = normal.CalculateMagnitude() > 0.0f ? Vector3::GetNormalized(normal) : Vector3::ZERO;
+
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                Vector3 toNext = corners[(corner + 1) % 3]->position - corners[corner]->position;
+                Vector3 toPrevious = corners[(corner + 2) % 3]->position - corners[corner]->position;
+                const float lengths = toNext.CalculateMagnitude() * toPrevious.CalculateMagnitude();
+                float cosine = lengths > 0.0f ? ((toNext.x * toPrevious.x) + (toNext.y * toPrevious.y) + (toNext.z * toPrevious.z)) / lengths : 1.0f;
+                cosine = cosine < -1.0f ? -1.0f : (cosine > 1.0f ? 1.0f : cosine);
+                cornerAngles[(triangle * 3) + corner] = acos(cosine);
+            }
+        }
+    });
+
+    //Split vertices used from both sides of a mirror seam, the mirrored side gets the copy. This runs in index order so the copies always land in the same place.
+    static const byte USED_UNMIRRORED = 1;
+    static const byte USED_MIRRORED = 2;
+    std::vector<byte> usage(m_vertices.size(), 0);
+    for (uint32_t corner = 0; corner < m_indices.size(); ++corner)
+    {
+        usage[m_indices[corner]] |= isMirrored[corner / 3] ? USED_MIRRORED : USED_UNMIRRORED;
+    }
+    std::vector<unsigned int> mirroredCopies(m_vertices.size(), (unsigned int)MeshOptimizer::INVALID_VERTEX);
+    for (uint32_t corner = 0; corner < m_indices.size(); ++corner)
+    {
+        const unsigned int vertex = m_indices[corner];
+        if (!isMirrored[corner / 3] || usage[vertex] != (USED_UNMIRRORED | USED_MIRRORED))
+        {
+            continue;
+        }
+        if (mirroredCopies[vertex] == MeshOptimizer::INVALID_VERTEX)
+        {
+            mirroredCopies[vertex] = m_vertices.size();
+            m_vertices.push_back(m_vertices[vertex]);
+        }
+        m_indices[corner] = mirroredCopies[vertex];
+    }
+
+    //Every vertex's corners, in triangle order.
+    const uint32_t numVertices = m_vertices.size();
+    std::vector<uint32_t> cornerStarts(numVertices + 1, 0);
+    for (unsigned int index : m_indices)
+    {
+        ++cornerStarts[index + 1];
     }
+    for (uint32_t vertex = 0; vertex < numVertices; ++vertex)
+    {
+        cornerStarts[vertex + 1] += cornerStarts[vertex];
+    }
+    std::vector<uint32_t> vertexCorners(m_indices.size());
+    std::vector<uint32_t> nextCorner(cornerStarts.begin(), cornerStarts.end() - 1);
+    for (uint32_t corner = 0; corner < m_indices.size(); ++corner)
+    {
+        vertexCorners[nextCorner[m_indices[corner]]++] = corner;
+    }
+
+    const uint32_t numVertexTiles = (numVertices + TANGENT_TILE_SIZE - 1) / TANGENT_TILE_SIZE;
+    RunTilesInParallel(numVertexTiles, threadCount, [&](uint32_t tile)
+    {
+        const uint32_t endVertex = (tile + 1) * TANGENT_TILE_SIZE < numVertices ? (tile + 1) * TANGENT_TILE_SIZE : numVertices;
+        for (uint32_t vertex = tile * TANGENT_TILE_SIZE; vertex < endVertex; ++vertex)
+        {
+            Vector3 tangent = Vector3::ZERO;
+            Vector3 bitangent = Vector3::ZERO;
+            Vector3 normal = Vector3::ZERO;
+            for (uint32_t i = cornerStarts[vertex]; i < cornerStarts[vertex + 1]; ++i)
+            {
+                const uint32_t corner = vertexCorners[i];
+                const float weight = cornerAngles[corner];
+                tangent += faceTangents[corner / 3] * weight;
+                bitangent += faceBitangents[corner / 3] * weight;
+                normal += faceNormals[corner / 3] * weight;
+            }
+            Vertex_Master& output = m_vertices[vertex];
+            if (hasNormals)
+            {
+                normal = output.normal;
+            }
+            normal = normal.CalculateMagnitude() > 0.0f ? Vector3::GetNormalized(normal) : Vector3::UP;
+
+            //Gram-Schmidt the tangent against the normal, then rebuild the bitangent from both on the side the UVs say it belongs.
+            const float tangentAlongNormal = (tangent.x * normal.x) + (tangent.y * normal.y) + (tangent.z * normal.z);
+            tangent -= normal * tangentAlongNormal;
+            tangent = tangent.CalculateMagnitude() > 0.0001f ? Vector3::GetNormalized(tangent) : GetFallbackTangent(normal);
+            Vector3 orthogonalBitangent = Vector3::Cross(tangent, normal);
+            const float handedness = (orthogonalBitangent.x * bitangent.x) + (orthogonalBitangent.y * bitangent.y) + (orthogonalBitangent.z * bitangent.z);
+            output.normal = normal;
+            output.tangent = tangent;
+            output.bitangent = handedness < 0.0f ? orthogonalBitangent * -1.0f : orthogonalBitangent;
+        }
+    });
+    SetMaskBit(NORMAL_BIT);
+    SetMaskBit(TANGENT_BIT);
+    SetMaskBit(BITANGENT_BIT);
+    return true;
 }
 
+//-----------------------------------------------------------------------------------
 bool MeshBuilder::IsEmpty()
 {
-    return m_vertices.size() == 0;
+    return GetVertexCount() == 0;
 }
 
 //-----------------------------------------------------------------------------------
 void MeshBuilder::AddTexturedAABB(const AABB2& bounds, const Vector2& uvMins, const Vector2& uvMaxs, const RGBA& color)
 {
-    int startingVertex = m_vertices.size();
+    int startingVertex = GetVertexCount();
     SetColor(color);
     SetUV(uvMins);
     AddVertex(Vector3(bounds.mins.x, bounds.mins.y, 0.0f));
@@ -567,56 +2065,11 @@ void MeshBuilder::AddTexturedAABB(const AABB2& bounds, const Vector2& uvMins, co
     AddQuadIndices(startingVertex + 3, startingVertex + 2, startingVertex + 0, startingVertex + 1);
 }
 
-//-----------------------------------------------------------------------------------
-void MeshBuilder::AddText2D(const Vector2& position, const std::string& asciiText, float scale, const RGBA& tint /*= RGBA::WHITE*/, bool drawShadow /*= false*/, const BitmapFont* font /*= nullptr*/)
-{
-    if (asciiText.empty())
-    {
-        return;
-    }
-    if (font == nullptr)
-    {
-        font = Renderer::instance->m_defaultFont;
-    }
-    int stringLength = asciiText.size();
-    Vector2 cursorPosition = position + (Vector2::UNIT_Y * (float)font->m_maxHeight * scale);
-    const Glyph* previousGlyph = nullptr;
-    for (int i = 0; i < stringLength; i++)
-    {
-        unsigned char currentCharacter = asciiText[i];
-        const Glyph* glyph = font->GetGlyph(currentCharacter);
-        float glyphWidth = static_cast<float>(glyph->width) * scale;
-        float glyphHeight = static_cast<float>(glyph->height) * scale;
-
-        if (previousGlyph)
-        {
-            const Vector2 kerning = font->GetKerning(*previousGlyph, *glyph);
-            cursorPosition += (kerning * scale);
-        }
-        Vector2 offset = Vector2(glyph->xOffset * scale, -glyph->yOffset * scale);
-        Vector2 topRight = cursorPosition + offset + Vector2(glyphWidth, 0.0f);
-        Vector2 bottomLeft = cursorPosition + offset - Vector2(0.0f, glyphHeight);
-        AABB2 quadBounds = AABB2(bottomLeft, topRight);
-        AABB2 glyphBounds = font->GetTexCoordsForGlyph(*glyph);
-        if (drawShadow)
-        {
-            float shadowWidthOffset = glyphWidth / 10.0f;
-            float shadowHeightOffset = glyphHeight / -10.0f;
-            Vector2 shadowOffset = Vector2(shadowWidthOffset, shadowHeightOffset);
-            AABB2 shadowBounds = AABB2(bottomLeft + shadowOffset, topRight + shadowOffset);
-            this->AddTexturedAABB(shadowBounds, glyphBounds.mins, glyphBounds.maxs, RGBA::BLACK);
-        }
-        this->AddTexturedAABB(quadBounds, glyphBounds.mins, glyphBounds.maxs, tint);
-        cursorPosition.x += glyph->xAdvance * scale;
-        previousGlyph = glyph;
-    }
-}
-
 //-----------------------------------------------------------------------------------
 void MeshBuilder::AddGlyph(const Vector3& bottomLeft, const Vector3& up, const Vector3& right, float upExtents, float rightExtents, const Vector2& uvMins, const Vector2& uvMaxs, const RGBA& color,
     float stringCoordXMin, float stringCoordXMax, float fragCoordXMin, float fragCoordXMax)
 {
-    int startingVertex = m_vertices.size();
+    int startingVertex = GetVertexCount();
     Vector3 topLeft = bottomLeft + (up * upExtents);
     Vector3 bottomRight = bottomLeft + (right * rightExtents);
     Vector3 topRight = topLeft + (right * rightExtents);
@@ -644,63 +2097,6 @@ void MeshBuilder::AddGlyph(const Vector3& bottomLeft, const Vector3& up, const V
     AddQuadIndices(startingVertex + 3, startingVertex + 2, startingVertex + 0, startingVertex + 1);
 }
 
-//-----------------------------------------------------------------------------------
-void MeshBuilder::AddStringEffectFragment(const std::string& asciiText, const BitmapFont* font, float scale, float totalStringWidth, float totalWidthUpToNow,
-    const Vector3& bottomLeft, const Vector3& up, const Vector3& right, float width, float height, int lineNum, float lineWidth, float lineAlignment)
-{
-    if (asciiText.empty())
-    {
-        return;
-    }
-    if (font == nullptr)
-    {
-        font = Renderer::instance->m_defaultFont;
-    }
-    int stringLength = asciiText.size();
-    Vector3 cursorPosition = bottomLeft + (up * height) - ((float)lineNum * font->m_maxHeight * scale * up) + ((width - lineWidth) * lineAlignment * right * scale) + (totalWidthUpToNow * scale * right);
-    const Glyph* previousGlyph = nullptr;
-    float totalWidthSoFar = totalWidthUpToNow;
-    float localWidthSoFar = 0;
-    float fragmentWidth = font->CalcTextWidth(asciiText, scale);
-    for (int i = 0; i < stringLength; i++)
-    {
-        unsigned char currentCharacter = asciiText[i];
-        const Glyph* glyph = font->GetGlyph(currentCharacter);
-        float glyphWidth = static_cast<float>(glyph->width) * scale;
-        float glyphHeight = static_cast<float>(glyph->height) * scale;
-
-        if (previousGlyph)
-        {
-            const Vector2 kerning = font->GetKerning(*previousGlyph, *glyph);
-            cursorPosition += kerning.x * scale * right + kerning.y * scale * up;
-        }
-        Vector3 offset = (right * (glyph->xOffset * scale)) + (up * (-glyph->yOffset * scale));
-        Vector3 topRight = cursorPosition + offset + (right * (glyphWidth));
-        Vector3 bl = cursorPosition + offset - (up * glyphHeight);
-        AABB2 quadBounds = AABB2(Vector2(bl.x, bl.y), Vector2(topRight.x, topRight.y));
-        AABB2 glyphBounds = font->GetTexCoordsForGlyph(*glyph);
-        // 		if (drawShadow)
-        // 		{
-        // 			float shadowWidthOffset = glyphWidth / 10.0f;
-        // 			float shadowHeightOffset = glyphHeight / -10.0f;
-        // 			Vector3 shadowOffset = (right * shadowWidthOffset) + (up * shadowHeightOffset);
-        // 			//Vector2 shadowOffset = Vector2(shadowWidthOffset, shadowHeightOffset);
-        // 			//AABB2 shadowBounds = AABB2(bottomLeft + shadowOffset, topRight + shadowOffset);
-        // 			this->AddGlyph(bottomLeft, up, right, shadowHeightOffset, shadowWidthOffset, glyphBounds.mins, glyphBounds.maxs, RGBA::BLACK);
-        // 		}
-        //this->AddTexturedAABB(quadBounds, glyphBounds.mins, glyphBounds.maxs, RGBA::WHITE);
-        float stringXMin = totalWidthSoFar / totalStringWidth;
-        float fragXMin = localWidthSoFar / fragmentWidth;
-        totalWidthSoFar += glyph->xAdvance * scale;
-        localWidthSoFar += glyph->xAdvance * scale;
-        float stringXMax = totalWidthSoFar / totalStringWidth;
-        float fragXMax = localWidthSoFar / fragmentWidth;
-        cursorPosition += glyph->xAdvance * scale * right;
-        this->AddGlyph(bl, up, right, (glyph->height * scale), (glyph->width * scale), glyphBounds.mins, glyphBounds.maxs, RGBA::WHITE, stringXMin, stringXMax, fragXMin, fragXMax);
-        previousGlyph = glyph;
-    }
-}
-
 //-----------------------------------------------------------------------------------
 void MeshBuilder::AddIndex(int index)
 {
@@ -710,21 +2106,18 @@ void MeshBuilder::AddIndex(int index)
 //-----------------------------------------------------------------------------------
 void MeshBuilder::AddLinearIndices()
 {
-    for (unsigned int i = 0; i < m_vertices.size(); ++i)
+    const unsigned int vertexCount = GetVertexCount();
+    for (unsigned int i = 0; i < vertexCount; ++i)
     {
         AddIndex(i);
     }
 }
 
 //-----------------------------------------------------------------------------------
+//Files are always saved in the mappable MeshFile format, WriteToStream is still there for writing into other streams.
 void MeshBuilder::WriteToFile(const char* filename)
 {
-    BinaryFileWriter writer;
-    ASSERT_OR_DIE(writer.Open(filename), "File Open failed!");
-    {
-        WriteToStream(writer);
-    }
-    writer.Close();
+    ASSERT_OR_DIE(MeshFile::Write(filename, *this), "File Open failed!");
 }
 
 //-----------------------------------------------------------------------------------
@@ -735,31 +2128,111 @@ void MeshBuilder::WriteToStream(IBinaryWriter& writer)
     //vertex data mask (ie: position, tangent, normal, etc...)
     //vertices
     //indices
+    //LOD count, then each LOD's triangle ratio, screen size and indices
 
-    writer.Write<uint32_t>(FILE_VERSION);
-    writer.WriteString(m_materialName);
+    ScopedInterleave interleaved(*this);
+    writer.Write<uint32_t>((uint32_t)FILE_VERSION);
+    writer.WriteString(m_materialName.empty() ? nullptr : m_materialName.c_str());
     WriteDataMask(writer);
     uint32_t vertexCount = m_vertices.size();
     uint32_t indicesCount = m_indices.size();
     writer.Write<uint32_t>(vertexCount);
-    for (Vertex_Master vertex : m_vertices)
+    //Vectors go out through their components, so each float gets swapped on its own rather than the whole vector being reversed.
+    for (const Vertex_Master& vertex : m_vertices)
     {
-        //TODO("Clean this up when you're not running on no sleep, it's not efficient");
-        IsInMask(POSITION_BIT) ? writer.Write<Vector3>(vertex.position) : false;
-        IsInMask(TANGENT_BIT) ? writer.Write<Vector3>(vertex.tangent) : false;
-        IsInMask(BITANGENT_BIT) ? writer.Write<Vector3>(vertex.bitangent) : false;
-        IsInMask(NORMAL_BIT) ? writer.Write<Vector3>(vertex.normal) : false;
+        IsInMask(POSITION_BIT) ? writer.WriteArray(&vertex.position.x, 3) : false;
+        IsInMask(TANGENT_BIT) ? writer.WriteArray(&vertex.tangent.x, 3) : false;
+        IsInMask(BITANGENT_BIT) ? writer.WriteArray(&vertex.bitangent.x, 3) : false;
+        IsInMask(NORMAL_BIT) ? writer.WriteArray(&vertex.normal.x, 3) : false;
         IsInMask(COLOR_BIT) ? writer.Write<RGBA>(vertex.color) : false;
-        IsInMask(UV0_BIT) ? writer.Write<Vector2>(vertex.uv0) : false;
-        IsInMask(UV1_BIT) ? writer.Write<Vector2>(vertex.uv1) : false;
-        IsInMask(BONE_INDICES_BIT) ? writer.Write<Vector4Int>(vertex.boneIndices) : false;
-        IsInMask(BONE_WEIGHTS_BIT) ? writer.Write<Vector4>(vertex.boneWeights) : false;
+        IsInMask(UV0_BIT) ? writer.WriteArray(&vertex.uv0.x, 2) : false;
+        IsInMask(UV1_BIT) ? writer.WriteArray(&vertex.uv1.x, 2) : false;
+        IsInMask(BONE_INDICES_BIT) ? writer.WriteArray(&vertex.boneIndices.x, 4) : false;
+        IsInMask(BONE_WEIGHTS_BIT) ? writer.WriteArray(&vertex.boneWeights.x, 4) : false;
     }
     writer.Write<uint32_t>(indicesCount);
-    for (unsigned int index : m_indices)
+    writer.WriteArray(m_indices);
+    writer.Write<uint32_t>(m_lods.size());
+    for (const MeshLOD& lod : m_lods)
+    {
+        writer.Write<float>(lod.triangleRatio);
+        writer.Write<float>(lod.screenSize);
+        writer.Write<uint32_t>(lod.indices.size());
+        writer.WriteArray(lod.indices);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Counts come straight out of the file, so the size is worked out in 64 bits and checked before anything is skipped.
+static bool SkipStreamBytes(BinaryMemoryReader& reader, uint64_t numBytes)
+{
+    return numBytes <= reader.GetRemainingSize() && reader.ReadInPlace((size_t)numBytes) != nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+static bool SkipStreamString(BinaryMemoryReader& reader, uint32_t& outLength)
+{
+    return reader.Read<uint32_t>(outLength) && SkipStreamBytes(reader, outLength);
+}
+
+//-----------------------------------------------------------------------------------
+//Follows the same layout ReadFromStream does, checking every count against what's left of the buffer before trusting it.
+bool MeshBuilder::IsReadableStream(const void* data, size_t size)
+{
+    BinaryMemoryReader reader(data, size);
+    uint32_t fileVersion = 0;
+    uint32_t length = 0;
+    if (!reader.Read<uint32_t>(fileVersion) || fileVersion == 0 || fileVersion > FILE_VERSION || !SkipStreamString(reader, length))
+    {
+        return false;
+    }
+
+    //Every name in the data mask has to fit before ReadDataMask is allowed to size a string off one of them.
+    const byte* maskStart = static_cast<const byte*>(data) + (size - reader.GetRemainingSize());
+    do
+    {
+        if (!SkipStreamString(reader, length))
+        {
+            return false;
+        }
+    } while (length > 0);
+    const byte* maskEnd = static_cast<const byte*>(data) + (size - reader.GetRemainingSize());
+    BinaryMemoryReader maskReader(maskStart, maskEnd - maskStart);
+    uint32_t dataMask = ReadDataMask(maskReader);
+
+    //Only these attributes are stored per vertex.
+    static const MeshDataFlag STORED_ATTRIBUTES[] = { POSITION_BIT, TANGENT_BIT, BITANGENT_BIT, NORMAL_BIT, COLOR_BIT, UV0_BIT, UV1_BIT, BONE_INDICES_BIT, BONE_WEIGHTS_BIT };
+    uint64_t sizeofVertex = 0;
+    for (MeshDataFlag attribute : STORED_ATTRIBUTES)
+    {
+        sizeofVertex += (dataMask & (1 << attribute)) != 0 ? MASTER_ATTRIBUTES[attribute].size : 0;
+    }
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    if (!reader.Read<uint32_t>(vertexCount) || !SkipStreamBytes(reader, vertexCount * sizeofVertex)
+        || !reader.Read<uint32_t>(indexCount) || !SkipStreamBytes(reader, indexCount * (uint64_t)sizeof(uint32_t)))
+    {
+        return false;
+    }
+    if (fileVersion < 2)
+    {
+        return true;
+    }
+
+    uint32_t lodCount = 0;
+    if (!reader.Read<uint32_t>(lodCount))
     {
-        writer.Write<unsigned int>(index);
+        return false;
+    }
+    for (uint32_t i = 0; i < lodCount; ++i)
+    {
+        //Triangle ratio and screen size, then the LOD's indices.
+        if (!SkipStreamBytes(reader, sizeof(float) * 2) || !reader.Read<uint32_t>(indexCount) || !SkipStreamBytes(reader, indexCount * (uint64_t)sizeof(uint32_t)))
+        {
+            return false;
+        }
     }
+    return true;
 }
 
 //-----------------------------------------------------------------------------------
@@ -770,55 +2243,151 @@ void MeshBuilder::ReadFromStream(IBinaryReader& reader)
     //vertex data mask (ie: position, tangent, normal, etc...)
     //vertices
     //indices
+    //LOD count, then each LOD's triangle ratio, screen size and indices (version 2+)
 
     uint32_t fileVersion;
-    const char* materialName = nullptr;
     uint32_t vertexCount;
     uint32_t indicesCount;
 
+    ScopedInterleave interleaved(*this);
     ASSERT_OR_DIE(reader.Read<uint32_t>(fileVersion), "Failed to read file version");
-    reader.ReadString(materialName, 64);
-    SetMaterialName(materialName);
+    ASSERT_OR_DIE(fileVersion <= FILE_VERSION, "Mesh file is from a newer version of the engine");
+    reader.ReadString(m_materialName);
     m_dataMask = ReadDataMask(reader);
     ASSERT_OR_DIE(reader.Read<uint32_t>(vertexCount), "Failed to read vertex count");
+    m_vertices.reserve(m_vertices.size() + vertexCount);
     for (unsigned int i = 0; i < vertexCount; ++i)
     {
-        //TODO("Clean this up when you're not running on no sleep, it's not efficient");
         Vertex_Master vertex;
-        IsInMask(POSITION_BIT) ? reader.Read<Vector3>(vertex.position) : false;
-        IsInMask(TANGENT_BIT) ? reader.Read<Vector3>(vertex.tangent) : false;
-        IsInMask(BITANGENT_BIT) ? reader.Read<Vector3>(vertex.bitangent) : false;
-        IsInMask(NORMAL_BIT) ? reader.Read<Vector3>(vertex.normal) : false;
+        IsInMask(POSITION_BIT) ? reader.ReadArray(&vertex.position.x, 3) : false;
+        IsInMask(TANGENT_BIT) ? reader.ReadArray(&vertex.tangent.x, 3) : false;
+        IsInMask(BITANGENT_BIT) ? reader.ReadArray(&vertex.bitangent.x, 3) : false;
+        IsInMask(NORMAL_BIT) ? reader.ReadArray(&vertex.normal.x, 3) : false;
         IsInMask(COLOR_BIT) ? reader.Read<RGBA>(vertex.color) : false;
-        IsInMask(UV0_BIT) ? reader.Read<Vector2>(vertex.uv0) : false;
-        IsInMask(UV1_BIT) ? reader.Read<Vector2>(vertex.uv1) : false;
-        IsInMask(BONE_INDICES_BIT) ? reader.Read<Vector4Int>(vertex.boneIndices) : false;
-        IsInMask(BONE_WEIGHTS_BIT) ? reader.Read<Vector4>(vertex.boneWeights) : false;
+        IsInMask(UV0_BIT) ? reader.ReadArray(&vertex.uv0.x, 2) : false;
+        IsInMask(UV1_BIT) ? reader.ReadArray(&vertex.uv1.x, 2) : false;
+        IsInMask(BONE_INDICES_BIT) ? reader.ReadArray(&vertex.boneIndices.x, 4) : false;
+        IsInMask(BONE_WEIGHTS_BIT) ? reader.ReadArray(&vertex.boneWeights.x, 4) : false;
         m_vertices.push_back(vertex);
     }	
     ASSERT_OR_DIE(reader.Read<uint32_t>(indicesCount), "Failed to read index count");
-    for (unsigned int i = 0; i < indicesCount; ++i)
+    size_t firstNewIndex = m_indices.size();
+    m_indices.resize(firstNewIndex + indicesCount);
+    ASSERT_OR_DIE(indicesCount == 0 || reader.ReadArray(&m_indices[firstNewIndex], indicesCount), "Failed to read indices");
+    m_lods.clear();
+    if (fileVersion >= 2)
     {
-        unsigned int index;
-        reader.Read<unsigned int>(index);
-        m_indices.push_back(index);
+        uint32_t lodCount;
+        ASSERT_OR_DIE(reader.Read<uint32_t>(lodCount), "Failed to read LOD count");
+        m_lods.resize(lodCount);
+        for (MeshLOD& lod : m_lods)
+        {
+            uint32_t lodIndicesCount;
+            reader.Read<float>(lod.triangleRatio);
+            reader.Read<float>(lod.screenSize);
+            ASSERT_OR_DIE(reader.Read<uint32_t>(lodIndicesCount), "Failed to read LOD index count");
+            lod.indices.resize(lodIndicesCount);
+            ASSERT_OR_DIE(reader.ReadArray(lod.indices), "Failed to read LOD indices");
+        }
     }
 }
 
 //-----------------------------------------------------------------------------------
+//Reads either a mappable MeshFile or an older version 1/2 stream, whichever the file turns out to be.
 void MeshBuilder::ReadFromFile(const char* filename)
 {
-    BinaryFileReader reader;
-    ASSERT_OR_DIE(reader.Open(filename), "File Open failed!");
+    MeshFile meshFile;
+    if (meshFile.Open(filename))
+    {
+        ReadFromMeshFile(meshFile);
+        return;
+    }
+    FileView file;
+    ASSERT_OR_DIE(file.Open(filename), "File Open failed!");
+    ASSERT_OR_DIE(!MeshFile::IsMeshFile(file.GetData(), file.GetSize()), "Mesh file is corrupt or from a newer version of the engine");
+    BinaryMemoryReader reader(file.GetData(), file.GetSize());
+    ReadFromStream(reader);
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::ReadFromMeshFile(const MeshFile& file)
+{
+    const MeshFileHeader& header = file.GetHeader();
+    SetMaterialName(file.GetMaterialName());
+    m_dataMask = header.dataMask;
+    if (m_vertexStorage == STREAM_STORAGE)
+    {
+        //The file's streams are already laid out the way ours are, so each one is a single copy.
+        for (std::vector<byte>& stream : m_streams)
+        {
+            stream.clear();
+        }
+        m_streamVertexCount = 0;
+        m_streamMask = m_dataMask;
+        std::vector<AttributeSpan> spans;
+        for (unsigned int flag = 0; flag < NUM_MESH_DATA; ++flag)
+        {
+            const void* stream = file.GetAttributeStream((MeshDataFlag)flag);
+            if (stream)
+            {
+                spans.push_back(AttributeSpan((MeshDataFlag)flag, stream));
+            }
+        }
+        AppendVertices(header.vertexCount, spans.data(), spans.size());
+    }
+    else
+    {
+        file.ReadVertices(m_vertices);
+    }
+
+    uint32_t lodCount = 0;
+    const MeshFileLOD* lods = file.GetLODs(lodCount);
+    const void* indices = file.GetIndices();
+    std::vector<unsigned int> allIndices(header.indexCount);
+    if (header.sizeofIndex == sizeof(uint16_t))
+    {
+        const uint16_t* shortIndices = static_cast<const uint16_t*>(indices);
+        std::copy(shortIndices, shortIndices + header.indexCount, allIndices.begin());
+    }
+    else
     {
-        ReadFromStream(reader);
+        memcpy(allIndices.data(), indices, sizeof(uint32_t) * header.indexCount);
+    }
+    //MeshFile::Open has already checked every LOD's range against the indices.
+    m_indices.assign(allIndices.begin() + lods[0].firstIndex, allIndices.begin() + lods[0].firstIndex + lods[0].numIndices);
+    m_lods.assign(lodCount - 1, MeshLOD());
+    for (uint32_t i = 1; i < lodCount; ++i)
+    {
+        MeshLOD& lod = m_lods[i - 1];
+        lod.triangleRatio = lods[i].triangleRatio;
+        lod.screenSize = lods[i].screenSize;
+        lod.indices.assign(allIndices.begin() + lods[i].firstIndex, allIndices.begin() + lods[i].firstIndex + lods[i].numIndices);
+    }
+
+    //The file counts submeshes from the start of all the indices, the builder from the start of their LOD.
+    uint32_t subMeshesPerLOD = 0;
+    const MeshFileSubMesh* subMeshes = file.GetSubMeshes(subMeshesPerLOD);
+    m_subMeshes.clear();
+    for (uint32_t i = 0; i < lodCount * subMeshesPerLOD; ++i)
+    {
+        const uint32_t lodIndex = i / subMeshesPerLOD;
+        std::vector<SubMesh>& lodSubMeshes = lodIndex == 0 ? m_subMeshes : m_lods[lodIndex - 1].subMeshes;
+        lodSubMeshes.push_back(SubMesh(subMeshes[i].firstIndex - lods[lodIndex].firstIndex, subMeshes[i].numIndices, subMeshes[i].materialID));
     }
-    reader.Close();
 }
 
 //-----------------------------------------------------------------------------------
 void MeshBuilder::FlipVs()
 {
+    Vector2* uvs = static_cast<Vector2*>(GetAttributeStream(UV0_BIT));
+    if (uvs)
+    {
+        for (unsigned int index = 0; index < m_streamVertexCount; ++index)
+        {
+            uvs[index].y = 1.0f - uvs[index].y;
+        }
+        return;
+    }
     for (unsigned int index = 0; index < m_vertices.size(); ++index)
     {
         m_vertices[index].uv0.y = 1.0f - m_vertices[index].uv0.y;
@@ -904,98 +2473,166 @@ void MeshBuilder::AddUVSphere(float radius, int numSegments, const RGBA& color /
 }
 
 //-----------------------------------------------------------------------------------
-void MeshBuilder::AddIcoSphere(float radius, const RGBA& color /*= RGBA::WHITE*/, int numPasses /*= 3*/, const Vector3& offset /*= Vector3::ZERO*/)
+//Finds the vertex halfway along an edge, adding it the first time either of the faces on the edge asks for it.
+static unsigned int GetEdgeMidpoint(unsigned int first, unsigned int second, std::vector<Vector3>& positions, std::vector<Vector2>& uvs, std::unordered_map<uint64_t, unsigned int>& midpoints)
 {
-    Vector3 initialPoints[6] = { { 0, 0, radius },{ 0, 0, -radius },{ -radius, -radius, 0 },{ radius, -radius, 0 },{ radius, radius, 0 },{ -radius,  radius, 0 } };
-    Vector2 initialUVs[6] = { {0.5f, 0.5f}, {0.5f, 0.5f}, {1.0f, 1.0f}, {0.0f, 1.0f}, { 0.0f, 0.0f },{ 1.0f, 0.0f } };
-    SetColor(color);
-    const int initialIndex = m_vertices.size();
+    const uint64_t edgeKey = first < second ? ((uint64_t)first << 32) | second : ((uint64_t)second << 32) | first;
+    auto found = midpoints.find(edgeKey);
+    if (found != midpoints.end())
+    {
+        return found->second;
+    }
+    //Move the point to the outside of our sphere.
+    Vector3 midpoint = Vector3::GetMidpoint(positions[first], positions[second]);
+    midpoint.Normalize();
+    const unsigned int midpointIndex = positions.size();
+    positions.push_back(midpoint);
+    uvs.push_back(Vector2::GetMidpoint(uvs[first], uvs[second]));
+    midpoints.emplace(edgeKey, midpointIndex);
+    return midpointIndex;
+}
 
+//-----------------------------------------------------------------------------------
+//Starts from an octahedron to keep the faces even, and splits every face into four each pass.
+//Faces share their edges' midpoints through a hash of the edge, so each pass is linear in the number of faces.
+void MeshBuilder::AddIcoSphere(float radius, const RGBA& color /*= RGBA::WHITE*/, int numPasses /*= 3*/, const Vector3& offset /*= Vector3::ZERO*/)
+{
+    static const Vector3 initialPoints[6] = { { 0, 0, 1 },{ 0, 0, -1 },{ -1, -1, 0 },{ 1, -1, 0 },{ 1, 1, 0 },{ -1,  1, 0 } };
+    static const Vector2 initialUVs[6] = { {0.5f, 0.5f}, {0.5f, 0.5f}, {1.0f, 1.0f}, {0.0f, 1.0f}, { 0.0f, 0.0f },{ 1.0f, 0.0f } };
+    static const unsigned int initialIndices[24] = { 0, 3, 4,  0, 4, 5,  0, 5, 2,  0, 2, 3,  1, 4, 3,  1, 5, 4,  1, 2, 5,  1, 3, 2 };
+    ASSERT_OR_DIE(numPasses >= 0 && numPasses <= 10, "AddIcoSphere was asked for too many subdivisions");
+
+    //Every pass quadruples the faces, and a closed mesh has half again as many edges as faces, each of which gets a new vertex.
+    const unsigned int numFaces = 8 << (2 * numPasses);
+    const unsigned int numVertices = (numFaces / 2) + 2;
+    std::vector<Vector3> positions;
+    std::vector<Vector2> uvs;
+    std::vector<unsigned int> faces(initialIndices, initialIndices + 24);
+    std::vector<unsigned int> subdividedFaces;
+    std::unordered_map<uint64_t, unsigned int> midpoints;
+    positions.reserve(numVertices);
+    uvs.reserve(numVertices);
+    faces.reserve(numFaces * 3);
+    subdividedFaces.reserve(numFaces * 3);
+    midpoints.reserve(numFaces * 3 / 2);
     for (int i = 0; i < 6; i++)
     {
-        SetUV(initialUVs[i]);
-        AddVertex((Vector3::GetNormalized(initialPoints[i]) * radius) + offset);
+        positions.push_back(Vector3::GetNormalized(initialPoints[i]));
+        uvs.push_back(initialUVs[i]);
     }
 
-    AddIndex(0 + initialIndex); AddIndex(3 + initialIndex); AddIndex(4 + initialIndex);
-    AddIndex(0 + initialIndex); AddIndex(4 + initialIndex); AddIndex(5 + initialIndex);
-    AddIndex(0 + initialIndex); AddIndex(5 + initialIndex); AddIndex(2 + initialIndex);
-    AddIndex(0 + initialIndex); AddIndex(2 + initialIndex); AddIndex(3 + initialIndex);
-    AddIndex(1 + initialIndex); AddIndex(4 + initialIndex); AddIndex(3 + initialIndex);
-    AddIndex(1 + initialIndex); AddIndex(5 + initialIndex); AddIndex(4 + initialIndex);
-    AddIndex(1 + initialIndex); AddIndex(2 + initialIndex); AddIndex(5 + initialIndex);
-    AddIndex(1 + initialIndex); AddIndex(3 + initialIndex); AddIndex(2 + initialIndex);
-
     for (int i = 0; i < numPasses; i++)
     {
-        int numberOfFaces = m_indices.size() / 3;
-        int indicesIndex = initialIndex;
-        for (int j = 0; j < numberOfFaces; j++)
-        {
-            //Get first 3 indices
-            const int x = indicesIndex++;
-            const int y = indicesIndex++;
-            const int z = indicesIndex++;
-            // Calculate the midpoints 
-            Vector3 point1 = Vector3::GetMidpoint(m_vertices.at(m_indices.at(x)).position, m_vertices.at(m_indices.at(y)).position);
-            Vector3 point2 = Vector3::GetMidpoint(m_vertices.at(m_indices.at(y)).position, m_vertices.at(m_indices.at(z)).position);
-            Vector3 point3 = Vector3::GetMidpoint(m_vertices.at(m_indices.at(z)).position, m_vertices.at(m_indices.at(x)).position);
-
-            //Calculate UV midpoints
-            Vector2 uvPoint1 = Vector2::GetMidpoint(m_vertices.at(m_indices.at(x)).uv0, m_vertices.at(m_indices.at(y)).uv0);
-            Vector2 uvPoint2 = Vector2::GetMidpoint(m_vertices.at(m_indices.at(y)).uv0, m_vertices.at(m_indices.at(z)).uv0);
-            Vector2 uvPoint3 = Vector2::GetMidpoint(m_vertices.at(m_indices.at(z)).uv0, m_vertices.at(m_indices.at(x)).uv0);
-
-            //Move the points to the outside of our sphere.
-            point1.Normalize();
-            point2.Normalize();
-            point3.Normalize();
-
-            //Add these vertices to the list of verts, and store their array location.
-            //Naiive way to check for dupes is here. I'll find a better solution later.
-            int point1Location = -1;
-            int point2Location = -1;
-            int point3Location = -1;
-            for (unsigned int q = 0; q < m_vertices.size(); q++)
-            {
-                Vector3 compare = m_vertices.at(q).position;
-                if (compare == point1)
-                    point1Location = q;
-                if (compare == point2)
-                    point2Location = q;
-                if (compare == point3)
-                    point3Location = q;
-            }
-            if (point1Location == -1)
+        midpoints.clear();
+        subdividedFaces.clear();
+        for (unsigned int face = 0; face < faces.size(); face += 3)
+        {
+            const unsigned int x = faces[face];
+            const unsigned int y = faces[face + 1];
+            const unsigned int z = faces[face + 2];
+            const unsigned int point1 = GetEdgeMidpoint(x, y, positions, uvs, midpoints);
+            const unsigned int point2 = GetEdgeMidpoint(y, z, positions, uvs, midpoints);
+            const unsigned int point3 = GetEdgeMidpoint(z, x, positions, uvs, midpoints);
+            const unsigned int newFaces[12] =
             {
-                point1Location = m_vertices.size();
-                SetUV(uvPoint1);
-                AddVertex(point1 * radius);
-            }
+                point1, point2, point3, //The inner, upside-down triangle (not the triforce)
+                x, point1, point3,      //And the 3 outer triangles, the pieces of the triforce
+                point1, y, point2,
+                point3, point2, z
+            };
+            subdividedFaces.insert(subdividedFaces.end(), newFaces, newFaces + 12);
+        }
+        faces.swap(subdividedFaces);
+    }
 
-            if (point2Location == -1)
-            {
-                point2Location = m_vertices.size();
-                SetUV(uvPoint2);
-                AddVertex(point2 * radius);
-            }
+    //Tangents run around the sphere's up axis, falling back to right at the poles.
+    std::vector<Vector3> normals(positions);
+    std::vector<Vector3> tangents(positions.size());
+    std::vector<Vector3> bitangents(positions.size());
+    for (unsigned int i = 0; i < positions.size(); ++i)
+    {
+        Vector3 tangent = Vector3::Cross(Vector3::UP, normals[i]);
+        tangent = tangent.CalculateMagnitude() > 0.0001f ? Vector3::GetNormalized(tangent) : Vector3::RIGHT;
+        tangents[i] = tangent;
+        bitangents[i] = Vector3::Cross(tangent, normals[i]);
+        positions[i] = (positions[i] * radius) + offset;
+    }
 
-            if (point3Location == -1)
-            {
-                point3Location = m_vertices.size();
-                SetUV(uvPoint3);
-                AddVertex(point3 * radius);
-            }
+    SetColor(color);
+    const AttributeSpan spans[] =
+    {
+        AttributeSpan(POSITION_BIT, positions.data()),
+        AttributeSpan(NORMAL_BIT, normals.data()),
+        AttributeSpan(TANGENT_BIT, tangents.data()),
+        AttributeSpan(BITANGENT_BIT, bitangents.data()),
+        AttributeSpan(UV0_BIT, uvs.data())
+    };
+    const unsigned int firstVertex = AppendVertices(positions.size(), spans, sizeof(spans) / sizeof(spans[0]));
+    AppendIndices(faces.data(), faces.size(), firstVertex);
+}
+
+//-----------------------------------------------------------------------------------
+//Capped along the up axis and centered on the origin. The seam and the caps get their own vertices so the UVs and normals don't smear.
+void MeshBuilder::AddCylinder(float radius, float height, unsigned int numSides, const RGBA& color /*= RGBA::WHITE*/)
+{
+    ASSERT_OR_DIE(numSides >= 3, "A cylinder needs at least 3 sides");
+    const float halfHeight = height * 0.5f;
+    const float radiansPerSide = MathUtils::TWO_PI / (float)numSides;
+    SetColor(color);
 
-            //Create 3 new faces (the outer triangles, the pieces of the triforce)
-            AddIndex(m_indices.at(x));		AddIndex(point1Location);		AddIndex(point3Location);
-            AddIndex(point1Location);		AddIndex(m_indices.at(y));		AddIndex(point2Location);
-            AddIndex(point3Location);		AddIndex(point2Location);		AddIndex(m_indices.at(z));
+    //Sides, bottom row then top row.
+    const unsigned int sideStart = GetVertexCount();
+    for (unsigned int row = 0; row < 2; ++row)
+    {
+        const float y = row == 0 ? -halfHeight : halfHeight;
+        for (unsigned int side = 0; side <= numSides; ++side)
+        {
+            const float radians = radiansPerSide * (float)(side % numSides);
+            const Vector3 normal(cos(radians), 0.0f, sin(radians));
+            const Vector3 tangent = Vector3::Cross(Vector3::UP, normal);
+            SetUV(Vector2((float)side / (float)numSides, row == 0 ? 1.0f : 0.0f));
+            SetNormal(normal);
+            SetTangent(tangent);
+            SetBitangent(Vector3::Cross(tangent, normal));
+            AddVertex((normal * radius) + (Vector3::UP * y));
+        }
+    }
+    const unsigned int rowLength = numSides + 1;
+    for (unsigned int side = 0; side < numSides; ++side)
+    {
+        const unsigned int bottom = sideStart + side;
+        const unsigned int top = bottom + rowLength;
+        AddIndex(bottom); AddIndex(top); AddIndex(bottom + 1);
+        AddIndex(bottom + 1); AddIndex(top); AddIndex(top + 1);
+    }
 
-            //Replace the original face with the inner, upside-down triangle (not the triforce)
-            m_indices.at(x) = point1Location;
-            m_indices.at(y) = point2Location;
-            m_indices.at(z) = point3Location;
+    //Caps, each a fan around its center.
+    for (unsigned int cap = 0; cap < 2; ++cap)
+    {
+        const float sign = cap == 0 ? -1.0f : 1.0f;
+        const Vector3 normal = Vector3::UP * sign;
+        const Vector3 tangent = Vector3::RIGHT * sign;
+        const unsigned int center = GetVertexCount();
+        SetNormal(normal);
+        SetTangent(tangent);
+        SetBitangent(Vector3::Cross(tangent, normal));
+        SetUV(Vector2(0.5f, 0.5f));
+        AddVertex(normal * halfHeight);
+        for (unsigned int side = 0; side < numSides; ++side)
+        {
+            const float radians = radiansPerSide * (float)side;
+            const float x = cos(radians);
+            const float z = sin(radians);
+            SetUV(Vector2(0.5f + (x * 0.5f), 0.5f + (z * sign * 0.5f)));
+            AddVertex(Vector3(x * radius, halfHeight * sign, z * radius));
+        }
+        for (unsigned int side = 0; side < numSides; ++side)
+        {
+            const unsigned int current = center + 1 + side;
+            const unsigned int next = center + 1 + ((side + 1) % numSides);
+            AddIndex(center);
+            AddIndex(cap == 0 ? current : next);
+            AddIndex(cap == 0 ? next : current);
         }
     }
 }
@@ -1012,7 +2649,7 @@ void MeshBuilder::AddQuad(
     float uvStepSize /*= 1.0f*/
     )
 {
-    unsigned int currentVert = this->m_vertices.size();
+    unsigned int currentVert = GetVertexCount();
     SetColor(color);
 
     SetUV(uvOffset + (Vector2::UNIT_Y * uvStepSize));
@@ -1045,7 +2682,7 @@ void MeshBuilder::AddQuad(
 
 void MeshBuilder::AddLine(const Vector3& start, const Vector3& end, const RGBA& color/* = RGBA::WHITE*/, const Vector2& uvBegin /* = Vector2::ZERO*/, const Vector2& uvEnd /* = Vector2::ZERO*/)
 {
-    uint32_t currentVert = m_vertices.size();
+    uint32_t currentVert = GetVertexCount();
     m_drawMode = Renderer::DrawMode::LINES;
     SetColor(color);
     SetUV(uvBegin);
@@ -2,13 +2,17 @@
 #include "Engine/Renderer/Mesh.hpp"
 #include "Engine/Renderer/RGBA.hpp"
 #include "Engine/Renderer/Vertex.hpp"
+#include "Engine/Renderer/MeshOptimizer.hpp"
 #include "Engine/Math/Vector3.hpp"
 #include "Engine/Math/Vector2.hpp"
 #include <vector>
+#include <string>
 
 class IBinaryWriter;
 class IBinaryReader;
 class AABB2;
+class MeshFile;
+class Matrix4x4;
 
 class MeshBuilder
 {
@@ -31,6 +35,15 @@ public:
         NUM_MESH_DATA
     };
 
+    //How the vertices are kept. Interleaved keeps a whole Vertex_Master per vertex in m_vertices, which is what most of the builder works on.
+    //Streams keeps a tightly packed array for each attribute in the data mask instead, a fraction of the memory for generators and importers
+    //that only fill in a few attributes, and each attribute can be worked on as one contiguous array. m_vertices stays empty while streaming.
+    enum VertexStorage
+    {
+        INTERLEAVED_STORAGE,
+        STREAM_STORAGE
+    };
+
     //TYPEDEFS//////////////////////////////////////////////////////////////////////////
     typedef Vector3(PatchFunction)(const void* userData, float x, float y);
     struct PlaneData
@@ -42,6 +55,64 @@ public:
         Vector3 up;
     };
 
+    //Grid sizes attributes are snapped to before comparing them in WeldVertices. 0 means they have to match exactly.
+    struct WeldEpsilons
+    {
+        WeldEpsilons() : position(0.0f), direction(0.0f), uv(0.0f), boneWeight(0.0f) {};
+        WeldEpsilons(float position, float direction, float uv, float boneWeight) : position(position), direction(direction), uv(uv), boneWeight(boneWeight) {};
+        float position;
+        float direction;
+        float uv;
+        float boneWeight;
+    };
+
+    //One attribute's values for AppendVertices, laid out the same way as in a Vertex_Master (ie: Vector3 for positions, RGBA for colors).
+    //A stride of 0 means they're tightly packed, anything else steps through interleaved source data.
+    struct AttributeSpan
+    {
+        AttributeSpan() : attribute(POSITION_BIT), data(nullptr), stride(0) {};
+        AttributeSpan(MeshDataFlag attribute, const void* data, unsigned int stride = 0) : attribute(attribute), data(data), stride(stride) {};
+        MeshDataFlag attribute;
+        const void* data;
+        unsigned int stride;
+    };
+
+    //One of MergeBatch's inputs. The builder isn't changed or taken ownership of.
+    struct MergeInput
+    {
+        MergeInput() : builder(nullptr), transform(nullptr), materialID(0) {};
+        MergeInput(const MeshBuilder* builder, const Matrix4x4* transform = nullptr, unsigned int materialID = 0) : builder(builder), transform(transform), materialID(materialID) {};
+        const MeshBuilder* builder;
+        //Baked into the input's vertices on the way in, null leaves them where they are. Has to be affine.
+        const Matrix4x4* transform;
+        //Whatever the caller uses to pick the submesh's material, it's only recorded.
+        unsigned int materialID;
+    };
+
+    //The range of an index buffer one of MergeBatch's inputs ended up in.
+    struct SubMesh
+    {
+        SubMesh() : firstIndex(0), numIndices(0), materialID(0) {};
+        SubMesh(unsigned int firstIndex, unsigned int numIndices, unsigned int materialID) : firstIndex(firstIndex), numIndices(numIndices), materialID(materialID) {};
+        unsigned int firstIndex;
+        unsigned int numIndices;
+        unsigned int materialID;
+    };
+
+    //A reduced index buffer over the same vertices. LOD 0 is m_indices itself and isn't stored here.
+    struct MeshLOD
+    {
+        MeshLOD() : triangleRatio(1.0f), screenSize(1.0f) {};
+        MeshLOD(float triangleRatio, float screenSize) : triangleRatio(triangleRatio), screenSize(screenSize) {};
+        //Fraction of LOD 0's triangles we asked the simplifier for.
+        float triangleRatio;
+        //Switch to this LOD once the mesh's projected size drops below this (see Mesh::CalculateProjectedSize).
+        float screenSize;
+        std::vector<unsigned int> indices;
+        //Where each of m_subMeshes ended up in indices, in the same order. Empty if the mesh has no submeshes.
+        std::vector<SubMesh> subMeshes;
+    };
+
     //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
     MeshBuilder();
 
@@ -49,9 +120,17 @@ public:
     void Begin();
     void End();
     static MeshBuilder* Merge(MeshBuilder* meshBuilderArray, unsigned int numberOfMeshes);
+    static MeshBuilder* MergeBatch(const MergeInput* inputs, unsigned int numInputs);
+    void Reserve(unsigned int vertexCount, unsigned int indexCount);
     void CopyToMesh(Mesh* mesh, VertexCopyCallback* copyFunction, unsigned int sizeofVertex, Mesh::BindMeshToVAOForVertex* bindMeshFunction);
+    //Converts straight into the layout's packed vertices (see VertexLayout.hpp), without going through a callback per vertex.
+    template<typename Layout> inline void CopyToMesh(Mesh* mesh) const { Layout::CopyToMesh(*this, mesh); };
+    void InitMeshFromVertices(Mesh* mesh, const void* vertices, unsigned int vertexCount, unsigned int sizeofVertex, Mesh::BindMeshToVAOForVertex* bindMeshFunction, const Vector4& positionDequantize) const;
     void AddVertex(const Vector3& position);
+    unsigned int AppendVertices(unsigned int count, const AttributeSpan* spans, unsigned int numSpans);
     void AddIndex(int index);
+    void AppendIndices(const unsigned int* indices, unsigned int count, unsigned int baseVertex = 0);
+    void AppendIndices(const uint16_t* indices, unsigned int count, unsigned int baseVertex = 0);
     void AddLinearIndices();
     void AddQuadIndicesClockwise(unsigned int tlIndex, unsigned int trIndex, unsigned int blIndex, unsigned int brIndex);
     void AddQuadIndices(unsigned int tlIndex, unsigned int trIndex, unsigned int blIndex, unsigned int brIndex);
@@ -65,18 +144,36 @@ public:
     void AddCube(float sideLength, const RGBA& color = RGBA::WHITE);
     void AddUVSphere(float radius, int numSegments, const RGBA& color = RGBA::WHITE);
     void AddIcoSphere(float radius, const RGBA& color = RGBA::WHITE, int numPasses = 3, const Vector3& offset = Vector3::ZERO);
+    void AddCylinder(float radius, float height, unsigned int numSides, const RGBA& color = RGBA::WHITE);
     void AddQuad(const Vector3& bottomLeft, const Vector3& up, float upLength, const Vector3& right, float rightLength, const RGBA& color = RGBA::WHITE, const Vector2& uvOffset = Vector2::ZERO, float uvStepSize = 1.0f);
     void AddLine(const Vector3& start, const Vector3& end, const RGBA& color = RGBA::WHITE, const Vector2& uvBegin  = Vector2::ZERO, const Vector2& uvEnd  = Vector2::ZERO);
     void BuildQuad(const Vector3& initialPosition, const Vector3& right, const Vector3& up, float startX, float endX, float startY, float endY, float startU = 0.0f, float endU = 1.0f, float startV = 0.0f, float endV = 1.0f);
     void BuildPlane(const Vector3& initialPosition, const Vector3& right, const Vector3& up, float startX, float endX, uint32_t xSections, float startY, float endY, uint32_t ySections);
     void BuildPlaneFromFunc(const Vector3& initialPosition, const Vector3& right, const Vector3& up, float startX, float endX, uint32_t xSections, float startY, float endY, uint32_t ySections);
     void BuildPatch(float startX, float endX, uint32_t xSections, float startY, float endY, uint32_t ySections, PatchFunction* patchFunction, void* userData);
+    void UpdatePatch(unsigned int firstVertex, float startX, float endX, uint32_t xSections, float startY, float endY, uint32_t ySections, PatchFunction* patchFunction, void* userData);
     void FlipVs();
+    unsigned int WeldVertices(const WeldEpsilons& epsilons = WeldEpsilons());
+    void OptimizeVertexCache(unsigned int cacheSize = MeshOptimizer::DEFAULT_CACHE_SIZE);
+    unsigned int OptimizeVertexFetch();
+    VertexCacheStats AnalyzeVertexCache(unsigned int cacheSize = MeshOptimizer::DEFAULT_CACHE_SIZE) const;
+    void GenerateLODs(const std::vector<float>& triangleRatios);
+    bool HasValidSubMeshes() const;
+    bool GenerateTangents(unsigned int numThreads = 0);
 
     //GETTERS//////////////////////////////////////////////////////////////////////////
-    inline unsigned int GetCurrentIndex() { return m_vertices.size(); };
+    inline unsigned int GetCurrentIndex() { return GetVertexCount(); };
+    inline unsigned int GetVertexCount() const { return m_vertexStorage == STREAM_STORAGE ? m_streamVertexCount : m_vertices.size(); };
+    inline VertexStorage GetVertexStorage() const { return m_vertexStorage; };
+    void GetVertex(unsigned int index, Vertex_Master& outVertex) const;
+    void* GetAttributeStream(MeshDataFlag attribute);
+    const void* GetAttributeStream(MeshDataFlag attribute) const;
+    const byte* GetAttributeData(MeshDataFlag attribute, unsigned int& outStride) const;
+    bool CalculateBounds(Vector3& outMins, Vector3& outMaxs) const;
+    float CalculateBoundingRadius() const;
 
     //SETTERS//////////////////////////////////////////////////////////////////////////
+    void SetVertexStorage(VertexStorage storage);
     inline void SetColor(const RGBA& color) { m_stamp.color = color; SetMaskBit(COLOR_BIT); };
     inline void SetTangent(const Vector3& tangent) { m_stamp.tangent = tangent; SetMaskBit(TANGENT_BIT); };
     inline void SetBitangent(const Vector3& bitangent) { m_stamp.bitangent = bitangent; SetMaskBit(BITANGENT_BIT); };
@@ -109,35 +206,55 @@ public:
     inline void SetNormalizedGlyphCoords(const Vector2& ngc) { m_stamp.normalizedGlyphPosition = ngc; };
     inline void SetNormalizedStringCoords(const Vector2& nsc) { m_stamp.normalizedStringPosition = nsc; }
     inline void SetNormalizedFragCoords(float nfc) { m_stamp.normalizedFragPosition = nfc; }
-    inline void SetMaterialName(const char* materialName) { m_materialName = materialName; };
+    inline void SetMaterialName(const char* materialName) { m_materialName = materialName ? materialName : ""; };
     inline void SetMaskBit(const MeshDataFlag flag) { m_dataMask |= (1 << flag); };
     inline void ClearMaskBit(const MeshDataFlag flag) { m_dataMask &= ~(1 << flag); };
 
     //QUERIES//////////////////////////////////////////////////////////////////////////
-    inline bool IsInMask(const MeshDataFlag flag) { return ((m_dataMask & (1 << flag)) != 0); };
+    inline bool IsInMask(const MeshDataFlag flag) const { return ((m_dataMask & (1 << flag)) != 0); };
+    inline const char* GetMaterialName() const { return m_materialName.c_str(); };
 
     //I/O//////////////////////////////////////////////////////////////////////////
     void WriteToFile(const char* filename);
     void WriteToStream(IBinaryWriter& writer);
     void ReadFromStream(IBinaryReader& reader);
     void ReadFromFile(const char* filename);
+    void ReadFromMeshFile(const MeshFile& file);
+    //ReadFromStream dies on a stream that's cut off or corrupt, this checks one up front without building anything.
+    static bool IsReadableStream(const void* data, size_t size);
     void WriteDataMask(IBinaryWriter& writer);
-    uint32_t ReadDataMask(IBinaryReader& reader);
+    static uint32_t ReadDataMask(IBinaryReader& reader);
     void RenormalizeSkinWeights();
+    void RemapBoneIndices(const std::vector<int>& oldToNewJointIndices);
     bool IsEmpty();
     //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
     std::vector<Vertex_Master> m_vertices;
     std::vector<unsigned int> m_indices;
+    std::vector<MeshLOD> m_lods;
+    //Filled in by MergeBatch, one per input in the order they were given. Ranges of m_indices, each LOD has its own in MeshLOD::subMeshes.
+    std::vector<SubMesh> m_subMeshes;
     uint32_t m_dataMask;
 
+    //Stream format, files carry on from here as MeshFile::FILE_VERSION.
+    //1: Initial Version
+    //2: LOD chain after the indices
+    static const uint32_t FILE_VERSION = 2;
+
 private:
+    void PadStreams();
+    void AppendStampToStreams();
+    void OverwriteAttribute(MeshDataFlag attribute, const void* data, unsigned int firstVertex, unsigned int count);
+    void TransformStreamRange(const Matrix4x4& transform, unsigned int firstVertex, unsigned int numVertices, unsigned int firstIndex, unsigned int numIndices);
+
     //Tracks all info added to the mesh.
     Vertex_Master m_stamp;
     unsigned int m_startIndex;
-    const char* m_materialName;
+    std::string m_materialName;
     Renderer::DrawMode m_drawMode;
     bool m_isSkinned;
-
-    //1: Initial Version
-    static const uint32_t FILE_VERSION = 1;
+    VertexStorage m_vertexStorage;
+    unsigned int m_streamVertexCount;
+    //The data mask the streams were last brought up to date with, attributes added since get padded out before anything else is appended.
+    uint32_t m_streamMask;
+    std::vector<byte> m_streams[NUM_MESH_DATA];
 };
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/AABB2.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+
+//The parts of MeshBuilder that need the renderer: handing what's been built to a Mesh, and laying text out with a font.
+//Kept out of MeshBuilder.cpp so the cooker can build meshes without linking GL.
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::CopyToMesh(Mesh* mesh, VertexCopyCallback* copyFunction, unsigned int sizeofVertex, Mesh::BindMeshToVAOForVertex* bindMeshFunction)
+{
+    // First, we need to allocate a buffer to copy 
+    // our vertices into, that matches what the mesh
+    // wants.  
+    unsigned int vertexCount = GetVertexCount();
+    if (vertexCount == 0) {
+        // nothing in this mesh.
+        return;
+    }
+
+    unsigned int vertexSize = sizeofVertex; //mesh->vdefn->vertexSize;
+    std::vector<byte> vertexBuffer(vertexCount * vertexSize);
+    byte* currentBufferIndex = vertexBuffer.data();
+
+    //Streams get gathered back into a Vertex_Master one at a time, the copy functions only know how to read those.
+    Vertex_Master gathered;
+    for (unsigned int vertex_index = 0;	vertex_index < vertexCount;	++vertex_index) 
+    {
+        if (m_vertexStorage == STREAM_STORAGE)
+        {
+            GetVertex(vertex_index, gathered);
+        }
+        copyFunction(m_vertexStorage == STREAM_STORAGE ? gathered : m_vertices[vertex_index], currentBufferIndex);
+        currentBufferIndex += vertexSize;
+    }
+    InitMeshFromVertices(mesh, vertexBuffer.data(), vertexCount, sizeofVertex, bindMeshFunction, Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+//-----------------------------------------------------------------------------------
+//Submesh ranges are relative to their LOD in the builder, the mesh's count from the start of the whole index buffer.
+static void AddSubMeshRanges(const std::vector<MeshBuilder::SubMesh>& subMeshes, Mesh::LODRange& outLODRange)
+{
+    for (const MeshBuilder::SubMesh& subMesh : subMeshes)
+    {
+        outLODRange.subMeshes.push_back(Mesh::SubMeshRange(outLODRange.firstIndex + subMesh.firstIndex, subMesh.numIndices, subMesh.materialID));
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//The rest of CopyToMesh, once the vertices are in the mesh's format: uploads them along with the indices and every LOD's range.
+void MeshBuilder::InitMeshFromVertices(Mesh* mesh, const void* vertices, unsigned int vertexCount, unsigned int sizeofVertex, Mesh::BindMeshToVAOForVertex* bindMeshFunction, const Vector4& positionDequantize) const
+{
+    //All the LODs share one index buffer, each one drawing its own range of it.
+    std::vector<unsigned int> allIndices(m_indices);
+    const bool keepSubMeshes = HasValidSubMeshes();
+    mesh->m_lodRanges.clear();
+    mesh->m_lodRanges.push_back(Mesh::LODRange(0, m_indices.size(), 1.0f));
+    if (keepSubMeshes)
+    {
+        AddSubMeshRanges(m_subMeshes, mesh->m_lodRanges.back());
+    }
+    for (const MeshLOD& lod : m_lods)
+    {
+        mesh->m_lodRanges.push_back(Mesh::LODRange(allIndices.size(), lod.indices.size(), lod.screenSize));
+        if (keepSubMeshes)
+        {
+            AddSubMeshRanges(lod.subMeshes, mesh->m_lodRanges.back());
+        }
+        allIndices.insert(allIndices.end(), lod.indices.begin(), lod.indices.end());
+    }
+    mesh->m_boundingRadius = CalculateBoundingRadius();
+
+    //Halve the index buffer whenever every index fits in 16 bits.
+    void* vertexData = const_cast<void*>(vertices);
+    if (vertexCount <= 0x10000)
+    {
+        std::vector<unsigned short> shortIndices(allIndices.begin(), allIndices.end());
+        mesh->Init(vertexData, vertexCount, sizeofVertex, shortIndices.data(), shortIndices.size(), bindMeshFunction, sizeof(unsigned short));
+    }
+    else
+    {
+        mesh->Init(vertexData, vertexCount, sizeofVertex, allIndices.data(), allIndices.size(), bindMeshFunction);
+    }
+    mesh->m_drawMode = this->m_drawMode;
+    mesh->m_positionDequantize = positionDequantize;
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::AddText2D(const Vector2& position, const std::string& asciiText, float scale, const RGBA& tint /*= RGBA::WHITE*/, bool drawShadow /*= false*/, const BitmapFont* font /*= nullptr*/)
+{
+    if (asciiText.empty())
+    {
+        return;
+    }
+    if (font == nullptr)
+    {
+        font = Renderer::instance->m_defaultFont;
+    }
+    int stringLength = asciiText.size();
+    Vector2 cursorPosition = position + (Vector2::UNIT_Y * (float)font->m_maxHeight * scale);
+    const Glyph* previousGlyph = nullptr;
+    for (int i = 0; i < stringLength; i++)
+    {
+        unsigned char currentCharacter = asciiText[i];
+        const Glyph* glyph = font->GetGlyph(currentCharacter);
+        float glyphWidth = static_cast<float>(glyph->width) * scale;
+        float glyphHeight = static_cast<float>(glyph->height) * scale;
+
+        if (previousGlyph)
+        {
+            const Vector2 kerning = font->GetKerning(*previousGlyph, *glyph);
+            cursorPosition += (kerning * scale);
+        }
+        Vector2 offset = Vector2(glyph->xOffset * scale, -glyph->yOffset * scale);
+        Vector2 topRight = cursorPosition + offset + Vector2(glyphWidth, 0.0f);
+        Vector2 bottomLeft = cursorPosition + offset - Vector2(0.0f, glyphHeight);
+        AABB2 quadBounds = AABB2(bottomLeft, topRight);
+        AABB2 glyphBounds = font->GetTexCoordsForGlyph(*glyph);
+        if (drawShadow)
+        {
+            float shadowWidthOffset = glyphWidth / 10.0f;
+            float shadowHeightOffset = glyphHeight / -10.0f;
+            Vector2 shadowOffset = Vector2(shadowWidthOffset, shadowHeightOffset);
+            AABB2 shadowBounds = AABB2(bottomLeft + shadowOffset, topRight + shadowOffset);
+            this->AddTexturedAABB(shadowBounds, glyphBounds.mins, glyphBounds.maxs, RGBA::BLACK);
+        }
+        this->AddTexturedAABB(quadBounds, glyphBounds.mins, glyphBounds.maxs, tint);
+        cursorPosition.x += glyph->xAdvance * scale;
+        previousGlyph = glyph;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void MeshBuilder::AddStringEffectFragment(const std::string& asciiText, const BitmapFont* font, float scale, float totalStringWidth, float totalWidthUpToNow,
+    const Vector3& bottomLeft, const Vector3& up, const Vector3& right, float width, float height, int lineNum, float lineWidth, float lineAlignment)
+{
+    if (asciiText.empty())
+    {
+        return;
+    }
+    if (font == nullptr)
+    {
+        font = Renderer::instance->m_defaultFont;
+    }
+    int stringLength = asciiText.size();
+    Vector3 cursorPosition = bottomLeft + (up * height) - ((float)lineNum * font->m_maxHeight * scale * up) + ((width - lineWidth) * lineAlignment * right * scale) + (totalWidthUpToNow * scale * right);
+    const Glyph* previousGlyph = nullptr;
+    float totalWidthSoFar = totalWidthUpToNow;
+    float localWidthSoFar = 0;
+    float fragmentWidth = font->CalcTextWidth(asciiText, scale);
+    for (int i = 0; i < stringLength; i++)
+    {
+        unsigned char currentCharacter = asciiText[i];
+        const Glyph* glyph = font->GetGlyph(currentCharacter);
+        float glyphWidth = static_cast<float>(glyph->width) * scale;
+        float glyphHeight = static_cast<float>(glyph->height) * scale;
+
+        if (previousGlyph)
+        {
+            const Vector2 kerning = font->GetKerning(*previousGlyph, *glyph);
+            cursorPosition += kerning.x * scale * right + kerning.y * scale * up;
+        }
+        Vector3 offset = (right * (glyph->xOffset * scale)) + (up * (-glyph->yOffset * scale));
+        Vector3 topRight = cursorPosition + offset + (right * (glyphWidth));
+        Vector3 bl = cursorPosition + offset - (up * glyphHeight);
+        AABB2 quadBounds = AABB2(Vector2(bl.x, bl.y), Vector2(topRight.x, topRight.y));
+        AABB2 glyphBounds = font->GetTexCoordsForGlyph(*glyph);
+        // 		if (drawShadow)
+        // 		{
+        // 			float shadowWidthOffset = glyphWidth / 10.0f;
+        // 			float shadowHeightOffset = glyphHeight / -10.0f;
+        // 			Vector3 shadowOffset = (right * shadowWidthOffset) + (up * shadowHeightOffset);
+        // 			//Vector2 shadowOffset = Vector2(shadowWidthOffset, shadowHeightOffset);
+        // 			//AABB2 shadowBounds = AABB2(bottomLeft + shadowOffset, topRight + shadowOffset);
+        // 			this->AddGlyph(bottomLeft, up, right, shadowHeightOffset, shadowWidthOffset, glyphBounds.mins, glyphBounds.maxs, RGBA::BLACK);
+        // 		}
+        //this->AddTexturedAABB(quadBounds, glyphBounds.mins, glyphBounds.maxs, RGBA::WHITE);
+        float stringXMin = totalWidthSoFar / totalStringWidth;
+        float fragXMin = localWidthSoFar / fragmentWidth;
+        totalWidthSoFar += glyph->xAdvance * scale;
+        localWidthSoFar += glyph->xAdvance * scale;
+        float stringXMax = totalWidthSoFar / totalStringWidth;
+        float fragXMax = localWidthSoFar / fragmentWidth;
+        cursorPosition += glyph->xAdvance * scale * right;
+        this->AddGlyph(bl, up, right, (glyph->height * scale), (glyph->width * scale), glyphBounds.mins, glyphBounds.maxs, RGBA::WHITE, stringXMin, stringXMax, fragXMin, fragXMax);
+        previousGlyph = glyph;
+    }
+}
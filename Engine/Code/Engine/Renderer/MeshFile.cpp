@@ -0,0 +1,418 @@
+#include "Engine/Renderer/MeshFile.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Input/BinaryWriter.hpp"
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------------
+//How each serialized attribute is stored in its stream and where it lives in a Vertex_Master.
+//How a shader reads each one is up to MeshFileUpload.cpp, so reading and writing files doesn't need GL.
+struct MeshFileAttribute
+{
+    MeshBuilder::MeshDataFlag flag;
+    size_t masterOffset;
+    uint32_t elementSize;
+};
+
+//Same set of attributes MeshBuilder::WriteToStream saves.
+static const MeshFileAttribute ATTRIBUTES[] =
+{
+    { MeshBuilder::POSITION_BIT, offsetof(Vertex_Master, position), sizeof(Vector3) },
+    { MeshBuilder::TANGENT_BIT, offsetof(Vertex_Master, tangent), sizeof(Vector3) },
+    { MeshBuilder::BITANGENT_BIT, offsetof(Vertex_Master, bitangent), sizeof(Vector3) },
+    { MeshBuilder::NORMAL_BIT, offsetof(Vertex_Master, normal), sizeof(Vector3) },
+    { MeshBuilder::COLOR_BIT, offsetof(Vertex_Master, color), sizeof(RGBA) },
+    { MeshBuilder::UV0_BIT, offsetof(Vertex_Master, uv0), sizeof(Vector2) },
+    { MeshBuilder::UV1_BIT, offsetof(Vertex_Master, uv1), sizeof(Vector2) },
+    { MeshBuilder::BONE_INDICES_BIT, offsetof(Vertex_Master, boneIndices), sizeof(Vector4Int) },
+    { MeshBuilder::BONE_WEIGHTS_BIT, offsetof(Vertex_Master, boneWeights), sizeof(Vector4) },
+};
+static const unsigned int NUM_ATTRIBUTES = sizeof(ATTRIBUTES) / sizeof(ATTRIBUTES[0]);
+
+//-----------------------------------------------------------------------------------
+static inline size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+//-----------------------------------------------------------------------------------
+static inline bool IsLocalLittleEndian()
+{
+    uint32_t value = 0x04030201;
+    return *(const byte*)&value == 0x01;
+}
+
+//-----------------------------------------------------------------------------------
+MeshFile::MeshFile()
+    : m_header(nullptr)
+    , m_sections(nullptr)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+bool MeshFile::IsMeshFile(const void* data, size_t size)
+{
+    uint32_t magic = 0;
+    if (size < sizeof(magic))
+    {
+        return false;
+    }
+    memcpy(&magic, data, sizeof(magic));
+    return magic == MAGIC;
+}
+
+//-----------------------------------------------------------------------------------
+static inline bool IsRangeInside(uint64_t offset, uint64_t size, uint64_t containerOffset, uint64_t containerSize)
+{
+    //Written so that no sum can wrap around, since every value here comes straight out of the file.
+    return offset >= containerOffset && offset - containerOffset <= containerSize && size <= containerSize - (offset - containerOffset);
+}
+
+//-----------------------------------------------------------------------------------
+static const MeshFileAttribute* FindAttribute(uint32_t sectionType)
+{
+    for (unsigned int i = 0; i < NUM_ATTRIBUTES; ++i)
+    {
+        if (MeshFile::ATTRIBUTE_SECTION + ATTRIBUTES[i].flag == sectionType)
+        {
+            return &ATTRIBUTES[i];
+        }
+    }
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+//Returns false for anything that isn't one of these files (ie: a version 1 or 2 stream), so callers can fall back to the old reader.
+//Also returns false for a mesh file that's corrupt or stale: every pointer handed out afterwards is used without any more checks.
+bool MeshFile::Open(const char* filename)
+{
+    Close();
+    if (!m_file.Open(filename) || !IsMeshFile(m_file.GetData(), m_file.GetSize()))
+    {
+        m_file.Close();
+        return false;
+    }
+    ASSERT_OR_DIE(IsLocalLittleEndian(), "Mesh files are mapped directly, so they can only be read on little endian machines");
+    if (!HasValidLayout())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool MeshFile::HasValidLayout()
+{
+    const byte* data = m_file.GetData();
+    const uint64_t fileSize = m_file.GetSize();
+    if (fileSize < sizeof(MeshFileHeader))
+    {
+        return false;
+    }
+    m_header = reinterpret_cast<const MeshFileHeader*>(data);
+    if (m_header->version > FILE_VERSION
+        || m_header->headerSize < sizeof(MeshFileHeader) || m_header->headerSize % sizeof(uint64_t) != 0
+        || !IsRangeInside(m_header->headerSize, (uint64_t)m_header->sectionCount * sizeof(MeshFileSection), 0, fileSize)
+        || (m_header->sizeofIndex != sizeof(uint16_t) && m_header->sizeofIndex != sizeof(uint32_t))
+        || !IsRangeInside(m_header->vertexBlockOffset, m_header->vertexBlockSize, 0, fileSize))
+    {
+        return false;
+    }
+    m_sections = reinterpret_cast<const MeshFileSection*>(data + m_header->headerSize);
+    for (uint32_t i = 0; i < m_header->sectionCount; ++i)
+    {
+        const MeshFileSection& section = m_sections[i];
+        //Sections get cast straight to their element types, so they have to keep the alignment Write gave them.
+        if (!IsRangeInside(section.offset, section.size, 0, fileSize) || section.offset % SECTION_ALIGNMENT != 0)
+        {
+            return false;
+        }
+        if (section.type >= ATTRIBUTE_SECTION)
+        {
+            //Readers copy elementSize bytes per vertex out of the stream, so it has to be exactly what the engine expects.
+            const MeshFileAttribute* attribute = FindAttribute(section.type);
+            if (!attribute || section.elementSize != attribute->elementSize || section.size != (uint64_t)m_header->vertexCount * section.elementSize
+                || !IsRangeInside(section.offset, section.size, m_header->vertexBlockOffset, m_header->vertexBlockSize))
+            {
+                return false;
+            }
+        }
+    }
+
+    const MeshFileSection* indexSection = FindSection(INDEX_SECTION);
+    if (!indexSection || indexSection->size < (uint64_t)m_header->indexCount * m_header->sizeofIndex)
+    {
+        return false;
+    }
+    const MeshFileSection* lodSection = FindSection(LOD_SECTION);
+    if (!lodSection || lodSection->size < sizeof(MeshFileLOD))
+    {
+        return false;
+    }
+    uint32_t lodCount = 0;
+    const MeshFileLOD* lods = GetLODs(lodCount);
+    for (uint32_t i = 0; i < lodCount; ++i)
+    {
+        if ((uint64_t)lods[i].firstIndex + lods[i].numIndices > m_header->indexCount)
+        {
+            return false;
+        }
+    }
+    const MeshFileSection* subMeshSection = FindSection(SUBMESH_SECTION);
+    if (subMeshSection)
+    {
+        //Each LOD's submeshes have to stay inside that LOD's indices, so drawing one can't wander into another LOD.
+        uint64_t subMeshCount = subMeshSection->size / sizeof(MeshFileSubMesh);
+        if (subMeshSection->size % sizeof(MeshFileSubMesh) != 0 || subMeshCount == 0 || subMeshCount % lodCount != 0)
+        {
+            return false;
+        }
+        uint32_t subMeshesPerLOD = 0;
+        const MeshFileSubMesh* subMeshes = GetSubMeshes(subMeshesPerLOD);
+        for (uint32_t i = 0; i < lodCount * subMeshesPerLOD; ++i)
+        {
+            const MeshFileLOD& lod = lods[i / subMeshesPerLOD];
+            if (!IsRangeInside(subMeshes[i].firstIndex, subMeshes[i].numIndices, lod.firstIndex, lod.numIndices))
+            {
+                return false;
+            }
+        }
+    }
+    const MeshFileSection* materialSection = FindSection(MATERIAL_NAME_SECTION);
+    if (materialSection && !memchr(data + materialSection->offset, '\0', (size_t)materialSection->size))
+    {
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+void MeshFile::Close()
+{
+    m_file.Close();
+    m_header = nullptr;
+    m_sections = nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+const MeshFileSection* MeshFile::FindSection(uint32_t type) const
+{
+    for (uint32_t i = 0; i < m_header->sectionCount; ++i)
+    {
+        if (m_sections[i].type == type)
+        {
+            return &m_sections[i];
+        }
+    }
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+//Tightly packed array of the attribute, one element per vertex, or nullptr if the mesh doesn't have it.
+const void* MeshFile::GetAttributeStream(MeshBuilder::MeshDataFlag attribute) const
+{
+    const MeshFileSection* section = FindSection(ATTRIBUTE_SECTION + attribute);
+    return section ? m_file.GetData() + section->offset : nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+const void* MeshFile::GetIndices() const
+{
+    const MeshFileSection* section = FindSection(INDEX_SECTION);
+    ASSERT_OR_DIE(section, "Mesh file is missing its indices");
+    return m_file.GetData() + section->offset;
+}
+
+//-----------------------------------------------------------------------------------
+const MeshFileLOD* MeshFile::GetLODs(uint32_t& outLODCount) const
+{
+    const MeshFileSection* section = FindSection(LOD_SECTION);
+    ASSERT_OR_DIE(section && section->size >= sizeof(MeshFileLOD), "Mesh file is missing its LOD table");
+    outLODCount = (uint32_t)(section->size / sizeof(MeshFileLOD));
+    return reinterpret_cast<const MeshFileLOD*>(m_file.GetData() + section->offset);
+}
+
+//-----------------------------------------------------------------------------------
+//LOD i's submeshes start at entry i * outSubMeshesPerLOD. Returns nullptr (and 0) if the mesh wasn't split into submeshes.
+const MeshFileSubMesh* MeshFile::GetSubMeshes(uint32_t& outSubMeshesPerLOD) const
+{
+    const MeshFileSection* section = FindSection(SUBMESH_SECTION);
+    if (!section)
+    {
+        outSubMeshesPerLOD = 0;
+        return nullptr;
+    }
+    uint32_t lodCount = 0;
+    GetLODs(lodCount);
+    outSubMeshesPerLOD = (uint32_t)(section->size / sizeof(MeshFileSubMesh)) / lodCount;
+    return reinterpret_cast<const MeshFileSubMesh*>(m_file.GetData() + section->offset);
+}
+
+//-----------------------------------------------------------------------------------
+const char* MeshFile::GetMaterialName() const
+{
+    const MeshFileSection* section = FindSection(MATERIAL_NAME_SECTION);
+    return section ? reinterpret_cast<const char*>(m_file.GetData() + section->offset) : nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+//Copies each attribute stream across in one pass rather than reading a vertex at a time.
+void MeshFile::ReadVertices(std::vector<Vertex_Master>& outVertices) const
+{
+    outVertices.resize(m_header->vertexCount);
+    for (unsigned int i = 0; i < NUM_ATTRIBUTES; ++i)
+    {
+        const MeshFileAttribute& attribute = ATTRIBUTES[i];
+        const byte* stream = static_cast<const byte*>(GetAttributeStream(attribute.flag));
+        if (!stream)
+        {
+            continue;
+        }
+        for (Vertex_Master& vertex : outVertices)
+        {
+            memcpy((byte*)&vertex + attribute.masterOffset, stream, attribute.elementSize);
+            stream += attribute.elementSize;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static void AppendSubMeshes(const std::vector<MeshBuilder::SubMesh>& subMeshes, uint32_t lodFirstIndex, std::vector<MeshFileSubMesh>& outSubMeshes)
+{
+    for (const MeshBuilder::SubMesh& subMesh : subMeshes)
+    {
+        MeshFileSubMesh fileSubMesh = { lodFirstIndex + subMesh.firstIndex, subMesh.numIndices, subMesh.materialID };
+        outSubMeshes.push_back(fileSubMesh);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Lays the whole file out in memory and writes it in one go.
+//HEADER
+//section table
+//vertex block: one aligned stream per attribute in the data mask
+//indices: LOD 0 then every other LOD, 16 bit if they all fit
+//LOD table
+//material name
+//submesh table, only if every LOD has one range per submesh
+bool MeshFile::Write(const char* filename, MeshBuilder& builder)
+{
+    ASSERT_OR_DIE(IsLocalLittleEndian(), "Mesh files are mapped directly, so they can only be written on little endian machines");
+    const uint32_t vertexCount = builder.GetVertexCount();
+    const uint32_t sizeofIndex = vertexCount <= 0x10000 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    std::vector<uint32_t> allIndices(builder.m_indices.begin(), builder.m_indices.end());
+    std::vector<MeshFileLOD> lods;
+    MeshFileLOD baseLOD = { 0, (uint32_t)builder.m_indices.size(), 1.0f, 1.0f };
+    lods.push_back(baseLOD);
+    std::vector<MeshFileSubMesh> subMeshes;
+    AppendSubMeshes(builder.m_subMeshes, 0, subMeshes);
+    const bool hasSubMeshes = builder.HasValidSubMeshes();
+    for (const MeshBuilder::MeshLOD& lod : builder.m_lods)
+    {
+        MeshFileLOD fileLOD = { (uint32_t)allIndices.size(), (uint32_t)lod.indices.size(), lod.triangleRatio, lod.screenSize };
+        lods.push_back(fileLOD);
+        AppendSubMeshes(lod.subMeshes, fileLOD.firstIndex, subMeshes);
+        allIndices.insert(allIndices.end(), lod.indices.begin(), lod.indices.end());
+    }
+
+    std::vector<MeshFileSection> sections;
+    std::vector<const MeshFileAttribute*> sectionAttributes;
+    for (unsigned int i = 0; i < NUM_ATTRIBUTES; ++i)
+    {
+        if (builder.IsInMask(ATTRIBUTES[i].flag))
+        {
+            MeshFileSection section = { (uint32_t)(ATTRIBUTE_SECTION + ATTRIBUTES[i].flag), ATTRIBUTES[i].elementSize, 0, (uint64_t)ATTRIBUTES[i].elementSize * vertexCount };
+            sections.push_back(section);
+            sectionAttributes.push_back(&ATTRIBUTES[i]);
+        }
+    }
+    const uint32_t numAttributeSections = sections.size();
+    const char* materialName = builder.GetMaterialName();
+    MeshFileSection indexSection = { INDEX_SECTION, sizeofIndex, 0, (uint64_t)sizeofIndex * allIndices.size() };
+    MeshFileSection lodSection = { LOD_SECTION, sizeof(MeshFileLOD), 0, sizeof(MeshFileLOD) * lods.size() };
+    MeshFileSection materialSection = { MATERIAL_NAME_SECTION, sizeof(char), 0, strlen(materialName) + 1 };
+    MeshFileSection subMeshSection = { SUBMESH_SECTION, sizeof(MeshFileSubMesh), 0, sizeof(MeshFileSubMesh) * subMeshes.size() };
+    sections.push_back(indexSection);
+    sections.push_back(lodSection);
+    sections.push_back(materialSection);
+    if (hasSubMeshes)
+    {
+        sections.push_back(subMeshSection);
+    }
+
+    MeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = FILE_VERSION;
+    header.headerSize = sizeof(MeshFileHeader);
+    header.sectionCount = sections.size();
+    header.vertexCount = vertexCount;
+    header.indexCount = allIndices.size();
+    header.sizeofIndex = sizeofIndex;
+    header.dataMask = builder.m_dataMask;
+
+    size_t cursor = AlignUp(sizeof(MeshFileHeader) + (sizeof(MeshFileSection) * sections.size()), SECTION_ALIGNMENT);
+    header.vertexBlockOffset = cursor;
+    for (MeshFileSection& section : sections)
+    {
+        section.offset = cursor;
+        cursor = AlignUp(cursor + (size_t)section.size, SECTION_ALIGNMENT);
+    }
+    header.vertexBlockSize = numAttributeSections > 0 ? (sections[numAttributeSections - 1].offset + sections[numAttributeSections - 1].size) - header.vertexBlockOffset : 0;
+
+    header.boundingRadius = builder.CalculateBoundingRadius();
+
+    std::vector<byte> fileData(cursor, 0);
+    memcpy(&fileData[0], &header, sizeof(header));
+    memcpy(&fileData[sizeof(header)], sections.data(), sizeof(MeshFileSection) * sections.size());
+    for (uint32_t sectionIndex = 0; sectionIndex < numAttributeSections; ++sectionIndex)
+    {
+        const MeshFileAttribute* format = sectionAttributes[sectionIndex];
+        byte* destination = &fileData[(size_t)sections[sectionIndex].offset];
+        //A streaming builder already has the attribute laid out the way the file wants it.
+        const void* stream = builder.GetAttributeStream(format->flag);
+        if (stream)
+        {
+            memcpy(destination, stream, (size_t)sections[sectionIndex].size);
+            continue;
+        }
+        for (const Vertex_Master& vertex : builder.m_vertices)
+        {
+            memcpy(destination, (const byte*)&vertex + format->masterOffset, format->elementSize);
+            destination += format->elementSize;
+        }
+    }
+    byte* indexDestination = &fileData[(size_t)sections[numAttributeSections].offset];
+    for (uint32_t index : allIndices)
+    {
+        if (sizeofIndex == sizeof(uint16_t))
+        {
+            uint16_t shortIndex = (uint16_t)index;
+            memcpy(indexDestination, &shortIndex, sizeof(shortIndex));
+        }
+        else
+        {
+            memcpy(indexDestination, &index, sizeof(index));
+        }
+        indexDestination += sizeofIndex;
+    }
+    memcpy(&fileData[(size_t)sections[numAttributeSections + 1].offset], lods.data(), sizeof(MeshFileLOD) * lods.size());
+    memcpy(&fileData[(size_t)sections[numAttributeSections + 2].offset], materialName, strlen(materialName) + 1);
+    if (hasSubMeshes)
+    {
+        memcpy(&fileData[(size_t)sections[numAttributeSections + 3].offset], subMeshes.data(), sizeof(MeshFileSubMesh) * subMeshes.size());
+    }
+
+    BinaryFileWriter writer;
+    if (!writer.Open(filename))
+    {
+        return false;
+    }
+    bool wasWritten = writer.WriteBytes(fileData.data(), fileData.size()) == fileData.size();
+    writer.Close();
+    return wasWritten;
+}
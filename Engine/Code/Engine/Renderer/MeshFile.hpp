@@ -0,0 +1,111 @@
+#pragma once
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Input/FileView.hpp"
+#include <stdint.h>
+
+class Mesh;
+
+//-----------------------------------------------------------------------------------
+//Fixed size header at the start of a memory-mappable .picomesh. Everything is little endian and laid out exactly as it's stored.
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t sectionCount;
+    uint32_t vertexCount;
+    uint32_t indexCount; //Every LOD's indices, back to back.
+    uint32_t sizeofIndex;
+    uint32_t dataMask;
+    //All the attribute streams are packed together into this one range, so it can go to the GPU in one upload.
+    uint64_t vertexBlockOffset;
+    uint64_t vertexBlockSize;
+    float boundingRadius;
+    uint32_t padding;
+};
+
+//-----------------------------------------------------------------------------------
+//One entry of the section table, which directly follows the header.
+struct MeshFileSection
+{
+    uint32_t type;
+    uint32_t elementSize;
+    uint64_t offset;
+    uint64_t size;
+};
+
+//-----------------------------------------------------------------------------------
+//LOD 0 is always the first entry.
+struct MeshFileLOD
+{
+    uint32_t firstIndex;
+    uint32_t numIndices;
+    float triangleRatio;
+    float screenSize;
+};
+
+//-----------------------------------------------------------------------------------
+//Entries of the optional submesh table: every LOD's submeshes in the same order, LOD 0's first. Indices count from the start of the index section.
+struct MeshFileSubMesh
+{
+    uint32_t firstIndex;
+    uint32_t numIndices;
+    uint32_t materialID;
+};
+
+//-----------------------------------------------------------------------------------
+//Reads .picomesh files written by MeshFile::Write by viewing them and pointing straight into the view. Nothing is parsed per vertex:
+//UploadToMesh hands the vertex block and index stream to GL as they are, and CPU consumers get each attribute as one contiguous array.
+//The file view (and so every pointer handed out) lives until Close or the MeshFile is destroyed.
+class MeshFile
+{
+public:
+    //ENUMS//////////////////////////////////////////////////////////////////////////
+    enum SectionType
+    {
+        MATERIAL_NAME_SECTION = 1,
+        INDEX_SECTION,
+        LOD_SECTION,
+        SUBMESH_SECTION,
+        //Attribute streams are ATTRIBUTE_SECTION + their MeshBuilder::MeshDataFlag.
+        ATTRIBUTE_SECTION = 0x100
+    };
+
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    MeshFile();
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    bool Open(const char* filename);
+    void Close();
+    void UploadToMesh(Mesh* mesh) const;
+    void ReadVertices(std::vector<Vertex_Master>& outVertices) const;
+    static bool Write(const char* filename, MeshBuilder& builder);
+    static bool IsMeshFile(const void* data, size_t size);
+
+    //GETTERS//////////////////////////////////////////////////////////////////////////
+    inline const MeshFileHeader& GetHeader() const { return *m_header; };
+    inline bool IsOpen() const { return m_header != nullptr; };
+    const void* GetAttributeStream(MeshBuilder::MeshDataFlag attribute) const;
+    const void* GetIndices() const;
+    const MeshFileLOD* GetLODs(uint32_t& outLODCount) const;
+    const MeshFileSubMesh* GetSubMeshes(uint32_t& outSubMeshesPerLOD) const;
+    const char* GetMaterialName() const;
+
+    //CONSTANTS//////////////////////////////////////////////////////////////////////////
+    static const uint32_t MAGIC = 0x48534D50; //"PMSH"
+    //Carries on from MeshBuilder's stream format versions, 1 and 2 are still read through MeshBuilder::ReadFromStream.
+    //3: Mappable container with a section table and per-attribute streams
+    //4: Optional submesh table, for meshes that came out of MeshBuilder::MergeBatch
+    static const uint32_t FILE_VERSION = 4;
+    static const uint32_t SECTION_ALIGNMENT = 16;
+
+private:
+    bool HasValidLayout();
+    const MeshFileSection* FindSection(uint32_t type) const;
+    MeshFile(const MeshFile&);
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    FileView m_file;
+    const MeshFileHeader* m_header;
+    const MeshFileSection* m_sections;
+};
@@ -0,0 +1,71 @@
+#include "Engine/Renderer/MeshFile.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <gl/GL.h>
+#include "Engine/Renderer/OpenGLExtensions.hpp"
+
+//-----------------------------------------------------------------------------------
+//The GL side of MeshFile, kept out of MeshFile.cpp so the cooker can read and write mesh files without linking GL.
+//How a shader reads each attribute stream MeshFile::Write can save.
+struct MeshFileAttributeBinding
+{
+    MeshBuilder::MeshDataFlag flag;
+    uint32_t elementSize;
+    const char* shaderName;
+    int componentCount;
+    unsigned int glType;
+    bool normalize;
+    bool isInteger;
+};
+
+static const MeshFileAttributeBinding BINDINGS[] =
+{
+    { MeshBuilder::POSITION_BIT, sizeof(Vector3), "inPosition", 3, GL_FLOAT, false, false },
+    { MeshBuilder::TANGENT_BIT, sizeof(Vector3), "inTangent", 3, GL_FLOAT, false, false },
+    { MeshBuilder::BITANGENT_BIT, sizeof(Vector3), "inBitangent", 3, GL_FLOAT, false, false },
+    { MeshBuilder::NORMAL_BIT, sizeof(Vector3), "inNormal", 3, GL_FLOAT, false, false },
+    { MeshBuilder::COLOR_BIT, sizeof(RGBA), "inColor", 4, GL_UNSIGNED_BYTE, true, false },
+    { MeshBuilder::UV0_BIT, sizeof(Vector2), "inUV0", 2, GL_FLOAT, false, false },
+    { MeshBuilder::UV1_BIT, sizeof(Vector2), "inUV1", 2, GL_FLOAT, false, false },
+    { MeshBuilder::BONE_INDICES_BIT, sizeof(Vector4Int), "inBoneIndices", 4, GL_INT, false, true },
+    { MeshBuilder::BONE_WEIGHTS_BIT, sizeof(Vector4), "inBoneWeights", 4, GL_FLOAT, false, false },
+};
+static const unsigned int NUM_BINDINGS = sizeof(BINDINGS) / sizeof(BINDINGS[0]);
+
+//-----------------------------------------------------------------------------------
+//One buffer upload for the whole vertex block and one for the indices, straight out of the file view.
+void MeshFile::UploadToMesh(Mesh* mesh) const
+{
+    std::vector<Mesh::VertexStream> streams;
+    for (unsigned int i = 0; i < NUM_BINDINGS; ++i)
+    {
+        const MeshFileAttributeBinding& binding = BINDINGS[i];
+        const MeshFileSection* section = FindSection(ATTRIBUTE_SECTION + binding.flag);
+        if (section)
+        {
+            unsigned int blockOffset = (unsigned int)(section->offset - m_header->vertexBlockOffset);
+            streams.push_back(Mesh::VertexStream(binding.shaderName, binding.componentCount, binding.glType, binding.normalize, binding.isInteger, blockOffset, binding.elementSize));
+        }
+    }
+    mesh->InitFromStreams(m_file.GetData() + m_header->vertexBlockOffset, (unsigned int)m_header->vertexBlockSize, m_header->vertexCount, streams,
+        GetIndices(), m_header->indexCount, m_header->sizeofIndex);
+
+    uint32_t lodCount = 0;
+    const MeshFileLOD* lods = GetLODs(lodCount);
+    uint32_t subMeshesPerLOD = 0;
+    const MeshFileSubMesh* subMeshes = GetSubMeshes(subMeshesPerLOD);
+    mesh->m_lodRanges.clear();
+    for (uint32_t i = 0; i < lodCount; ++i)
+    {
+        mesh->m_lodRanges.push_back(Mesh::LODRange(lods[i].firstIndex, lods[i].numIndices, lods[i].screenSize));
+        for (uint32_t j = i * subMeshesPerLOD; j < (i + 1) * subMeshesPerLOD; ++j)
+        {
+            mesh->m_lodRanges.back().subMeshes.push_back(Mesh::SubMeshRange(subMeshes[j].firstIndex, subMeshes[j].numIndices, subMeshes[j].materialID));
+        }
+    }
+    mesh->m_boundingRadius = m_header->boundingRadius;
+    mesh->m_positionDequantize = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+    mesh->m_drawMode = Renderer::DrawMode::TRIANGLES;
+}
@@ -0,0 +1,812 @@
+#include "Engine/Renderer/MeshOptimizer.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <queue>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+//Scoring constants from the paper.
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+//-----------------------------------------------------------------------------------
+static float GetVertexScore(int cachePosition, unsigned int liveTriangles, unsigned int cacheSize)
+{
+    if (liveTriangles == 0)
+    {
+        //Nothing left to draw with this vertex, don't let it pull any triangle forward.
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            //Used by the last triangle, so the score is fixed to stop it favoring going back and forth over the same strip.
+            score = LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            float scaler = 1.0f / (float)(cacheSize - 3);
+            score = 1.0f - ((float)(cachePosition - 3) * scaler);
+            score = pow(score, CACHE_DECAY_POWER);
+        }
+    }
+
+    //Boost vertices with few triangles left, finishing them off frees up cache space.
+    score += VALENCE_BOOST_SCALE * pow((float)liveTriangles, -VALENCE_BOOST_POWER);
+    return score;
+}
+
+//-----------------------------------------------------------------------------------
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+{
+    ASSERT_OR_DIE(indexCount % 3 == 0, "Vertex cache optimization needs a triangle list!");
+    ASSERT_OR_DIE(cacheSize > 3 && cacheSize <= MAX_CACHE_SIZE, "Unsupported vertex cache size!");
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    //Triangle adjacency for each vertex, packed into one array. The first liveTriangles entries are the ones not yet emitted.
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        ASSERT_OR_DIE(indices[i] < vertexCount, "Index was outside of the vertex array!");
+        ++liveTriangles[indices[i]];
+    }
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveTriangles[vertex];
+    }
+    std::vector<unsigned int> adjacency(indexCount);
+    std::vector<unsigned int> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            adjacency[adjacencyFill[indices[(triangle * 3) + corner]]++] = triangle;
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        vertexScores[vertex] = GetVertexScore(-1, liveTriangles[vertex], cacheSize);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> isEmitted(triangleCount, false);
+    int bestTriangle = -1;
+    float bestScore = -1.0f;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        const unsigned int* corners = &indices[triangle * 3];
+        triangleScores[triangle] = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+        if (triangleScores[triangle] > bestScore)
+        {
+            bestScore = triangleScores[triangle];
+            bestTriangle = triangle;
+        }
+    }
+
+    //The cache keeps three extra entries so the vertices pushed out by a triangle can still be rescored,
+    //and the next cache can hold three more on top of that: the new triangle's corners go in front of all of the old ones.
+    unsigned int cache[MAX_CACHE_SIZE + 3];
+    unsigned int newCache[MAX_CACHE_SIZE + 6];
+    unsigned int cacheCount = 0;
+    std::vector<unsigned int> optimizedIndices(indexCount);
+    size_t searchCursor = 0;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        if (bestTriangle < 0)
+        {
+            //Nothing in the cache has work left, start again from the next triangle in the original order.
+            while (isEmitted[searchCursor])
+            {
+                ++searchCursor;
+            }
+            bestTriangle = searchCursor;
+        }
+
+        const unsigned int* corners = &indices[bestTriangle * 3];
+        memcpy(&optimizedIndices[emittedCount * 3], corners, 3 * sizeof(unsigned int));
+        isEmitted[bestTriangle] = true;
+
+        //Take the triangle out of each corner's live list, and put its corners at the front of the cache.
+        unsigned int newCacheCount = 0;
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int vertex = corners[corner];
+            unsigned int* liveList = &adjacency[adjacencyOffsets[vertex]];
+            for (unsigned int i = 0; i < liveTriangles[vertex]; ++i)
+            {
+                if (liveList[i] == (unsigned int)bestTriangle)
+                {
+                    liveList[i] = liveList[liveTriangles[vertex] - 1];
+                    liveList[liveTriangles[vertex] - 1] = bestTriangle;
+                    break;
+                }
+            }
+            --liveTriangles[vertex];
+            newCache[newCacheCount++] = vertex;
+        }
+        for (unsigned int i = 0; i < cacheCount; ++i)
+        {
+            unsigned int vertex = cache[i];
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+            {
+                newCache[newCacheCount++] = vertex;
+            }
+        }
+        cacheCount = newCacheCount < cacheSize + 3 ? newCacheCount : cacheSize + 3;
+        memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+
+        //Only vertices in the cache changed score, so only their triangles need looking at.
+        for (unsigned int i = 0; i < newCacheCount; ++i)
+        {
+            unsigned int vertex = newCache[i];
+            cachePositions[vertex] = (i < cacheSize) ? (int)i : -1;
+            vertexScores[vertex] = GetVertexScore(cachePositions[vertex], liveTriangles[vertex], cacheSize);
+        }
+        bestTriangle = -1;
+        bestScore = -1.0f;
+        for (unsigned int i = 0; i < cacheCount; ++i)
+        {
+            unsigned int vertex = cache[i];
+            const unsigned int* liveList = &adjacency[adjacencyOffsets[vertex]];
+            for (unsigned int j = 0; j < liveTriangles[vertex]; ++j)
+            {
+                unsigned int triangle = liveList[j];
+                const unsigned int* triangleCorners = &indices[triangle * 3];
+                float score = vertexScores[triangleCorners[0]] + vertexScores[triangleCorners[1]] + vertexScores[triangleCorners[2]];
+                triangleScores[triangle] = score;
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = triangle;
+                }
+            }
+        }
+    }
+
+    memcpy(indices, optimizedIndices.data(), indexCount * sizeof(unsigned int));
+}
+
+//-----------------------------------------------------------------------------------
+size_t MeshOptimizer::BuildVertexFetchRemap(unsigned int* indices, size_t indexCount, size_t vertexCount, std::vector<unsigned int>& outOldToNew)
+{
+    outOldToNew.assign(vertexCount, (unsigned int)INVALID_VERTEX);
+    unsigned int nextVertex = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        unsigned int& index = indices[i];
+        ASSERT_OR_DIE(index < vertexCount, "Index was outside of the vertex array!");
+        if (outOldToNew[index] == INVALID_VERTEX)
+        {
+            outOldToNew[index] = nextVertex++;
+        }
+        index = outOldToNew[index];
+    }
+    return nextVertex;
+}
+
+//-----------------------------------------------------------------------------------
+//Simulates a FIFO cache, which is what most hardware actually has, rather than the LRU the optimizer models.
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+{
+    VertexCacheStats stats;
+    stats.triangleCount = indexCount / 3;
+
+    //A vertex is in the cache if fewer than cacheSize misses have happened since it went in.
+    std::vector<uint32_t> insertTimes(vertexCount, 0);
+    std::vector<bool> isReferenced(vertexCount, false);
+    uint32_t missCount = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        unsigned int index = indices[i];
+        ASSERT_OR_DIE(index < vertexCount, "Index was outside of the vertex array!");
+        if (!isReferenced[index])
+        {
+            isReferenced[index] = true;
+            ++stats.uniqueVertexCount;
+        }
+        else if (missCount - insertTimes[index] < cacheSize)
+        {
+            continue;
+        }
+        insertTimes[index] = missCount;
+        ++missCount;
+    }
+
+    stats.vertexTransforms = missCount;
+    stats.acmr = stats.triangleCount > 0 ? (float)missCount / (float)stats.triangleCount : 0.0f;
+    stats.atvr = stats.uniqueVertexCount > 0 ? (float)missCount / (float)stats.uniqueVertexCount : 0.0f;
+    return stats;
+}
+
+//SIMPLIFICATION//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+//Symmetric 4x4 error matrix, the sum of squared distances to a set of weighted planes.
+struct Quadric
+{
+    Quadric() : a00(0.0), a01(0.0), a02(0.0), a11(0.0), a12(0.0), a22(0.0), b0(0.0), b1(0.0), b2(0.0), c(0.0) {};
+
+    //-----------------------------------------------------------------------------------
+    void AddPlane(double nx, double ny, double nz, double d, double weight)
+    {
+        a00 += weight * nx * nx;
+        a01 += weight * nx * ny;
+        a02 += weight * nx * nz;
+        a11 += weight * ny * ny;
+        a12 += weight * ny * nz;
+        a22 += weight * nz * nz;
+        b0 += weight * nx * d;
+        b1 += weight * ny * d;
+        b2 += weight * nz * d;
+        c += weight * d * d;
+    }
+
+    //-----------------------------------------------------------------------------------
+    void Add(const Quadric& other)
+    {
+        a00 += other.a00; a01 += other.a01; a02 += other.a02;
+        a11 += other.a11; a12 += other.a12; a22 += other.a22;
+        b0 += other.b0; b1 += other.b1; b2 += other.b2;
+        c += other.c;
+    }
+
+    //-----------------------------------------------------------------------------------
+    double Evaluate(const Vector3& position) const
+    {
+        double x = position.x;
+        double y = position.y;
+        double z = position.z;
+        double error = (a00 * x * x) + (a11 * y * y) + (a22 * z * z) + (2.0 * ((a01 * x * y) + (a02 * x * z) + (a12 * y * z)));
+        error += 2.0 * ((b0 * x) + (b1 * y) + (b2 * z)) + c;
+        return error > 0.0 ? error : 0.0;
+    }
+
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+};
+
+//-----------------------------------------------------------------------------------
+struct CollapseCandidate
+{
+    CollapseCandidate(double cost, unsigned int vertex, unsigned int target, uint32_t stamp) : cost(cost), vertex(vertex), target(target), stamp(stamp) {};
+    //Reversed so the std::priority_queue hands back the cheapest collapse first.
+    bool operator<(const CollapseCandidate& other) const { return cost > other.cost; };
+
+    double cost;
+    unsigned int vertex;
+    unsigned int target;
+    uint32_t stamp;
+};
+
+//-----------------------------------------------------------------------------------
+class QuadricSimplifier
+{
+public:
+    enum VertexKind
+    {
+        MANIFOLD,
+        BORDER,
+        SEAM,
+        LOCKED
+    };
+
+    //-----------------------------------------------------------------------------------
+    QuadricSimplifier(const unsigned int* indices, size_t indexCount, const std::vector<Vector3>& positions, const std::vector<int>& collapseRegions, const std::vector<uint8_t>& lockedVertices)
+        : m_indices(indices, indices + indexCount)
+        , m_positions(positions)
+        , m_regions(collapseRegions)
+        , m_locked(lockedVertices)
+        , m_liveTriangleCount(indexCount / 3)
+        , m_lastError(0.0f)
+    {
+        const size_t vertexCount = positions.size();
+        const size_t triangleCount = indexCount / 3;
+        m_isTriangleAlive.assign(triangleCount, 1);
+        m_isVertexAlive.assign(vertexCount, 1);
+        m_stamps.assign(vertexCount, 0);
+        m_vertexTriangles.resize(vertexCount);
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                ASSERT_OR_DIE(m_indices[(triangle * 3) + corner] < vertexCount, "Index was outside of the vertex array!");
+                m_vertexTriangles[m_indices[(triangle * 3) + corner]].push_back(triangle);
+            }
+        }
+        BuildPositionGroups();
+        ClassifyVertices();
+        BuildQuadrics();
+    }
+
+    //-----------------------------------------------------------------------------------
+    void Run(size_t targetTriangleCount)
+    {
+        for (unsigned int vertex = 0; vertex < m_positions.size(); ++vertex)
+        {
+            PushBestCollapse(vertex);
+        }
+        while (m_liveTriangleCount > targetTriangleCount && !m_queue.empty())
+        {
+            CollapseCandidate candidate = m_queue.top();
+            m_queue.pop();
+            if (!m_isVertexAlive[candidate.vertex] || !m_isVertexAlive[candidate.target] || candidate.stamp != m_stamps[candidate.vertex])
+            {
+                continue;
+            }
+            unsigned int pairedVertex = 0;
+            unsigned int pairedTarget = 0;
+            if (!CanCollapse(candidate.vertex, candidate.target, pairedVertex, pairedTarget))
+            {
+                PushBestCollapse(candidate.vertex);
+                continue;
+            }
+            Collapse(candidate.vertex, candidate.target);
+            if (m_kinds[candidate.vertex] == SEAM)
+            {
+                Collapse(pairedVertex, pairedTarget);
+                RefreshNeighborhood(pairedTarget);
+            }
+            m_groupQuadrics[m_groups[candidate.target]].Add(m_groupQuadrics[m_groups[candidate.vertex]]);
+            m_lastError = (float)candidate.cost;
+            RefreshNeighborhood(candidate.target);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    void GetIndices(std::vector<unsigned int>& outIndices) const
+    {
+        outIndices.clear();
+        outIndices.reserve(m_liveTriangleCount * 3);
+        for (size_t triangle = 0; triangle < m_isTriangleAlive.size(); ++triangle)
+        {
+            if (m_isTriangleAlive[triangle])
+            {
+                outIndices.insert(outIndices.end(), &m_indices[triangle * 3], &m_indices[triangle * 3] + 3);
+            }
+        }
+    }
+
+    inline float GetLastError() const { return m_lastError; };
+
+private:
+    //-----------------------------------------------------------------------------------
+    //Vertices with exactly the same position are wedges of one point, split by a UV, normal or skinning seam.
+    void BuildPositionGroups()
+    {
+        const unsigned int vertexCount = m_positions.size();
+        std::vector<unsigned int> sorted(vertexCount);
+        for (unsigned int i = 0; i < vertexCount; ++i)
+        {
+            sorted[i] = i;
+        }
+        const std::vector<Vector3>& positions = m_positions;
+        std::sort(sorted.begin(), sorted.end(), [&positions](unsigned int lhs, unsigned int rhs)
+        {
+            const Vector3& a = positions[lhs];
+            const Vector3& b = positions[rhs];
+            return (a.x != b.x) ? (a.x < b.x) : ((a.y != b.y) ? (a.y < b.y) : (a.z < b.z));
+        });
+
+        m_groups.resize(vertexCount);
+        m_groupSizes.assign(vertexCount, 0);
+        m_siblings.resize(vertexCount);
+        for (unsigned int i = 0; i < vertexCount;)
+        {
+            unsigned int end = i + 1;
+            while (end < vertexCount && m_positions[sorted[end]] == m_positions[sorted[i]])
+            {
+                ++end;
+            }
+            for (unsigned int j = i; j < end; ++j)
+            {
+                m_groups[sorted[j]] = sorted[i];
+                //Only meaningful for pairs, where it's the other wedge.
+                m_siblings[sorted[j]] = (end - i == 2) ? sorted[i + (j == i ? 1 : 0)] : sorted[j];
+            }
+            m_groupSizes[sorted[i]] = end - i;
+            i = end;
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    static inline uint64_t MakeEdgeKey(unsigned int a, unsigned int b)
+    {
+        return a < b ? (((uint64_t)a << 32) | b) : (((uint64_t)b << 32) | a);
+    }
+
+    //-----------------------------------------------------------------------------------
+    static inline size_t CountEdges(const std::vector<uint64_t>& sortedEdges, uint64_t key)
+    {
+        auto range = std::equal_range(sortedEdges.begin(), sortedEdges.end(), key);
+        return range.second - range.first;
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Counts every edge twice over: by vertex, to find attribute seams, and by position group, to find the real borders of the surface.
+    void ClassifyVertices()
+    {
+        const size_t triangleCount = m_indices.size() / 3;
+        std::vector<uint64_t> groupEdges;
+        std::vector<uint64_t> vertexEdges;
+        groupEdges.reserve(m_indices.size());
+        vertexEdges.reserve(m_indices.size());
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int a = m_indices[(triangle * 3) + corner];
+                unsigned int b = m_indices[(triangle * 3) + ((corner + 1) % 3)];
+                groupEdges.push_back(MakeEdgeKey(m_groups[a], m_groups[b]));
+                vertexEdges.push_back(MakeEdgeKey(a, b));
+            }
+        }
+        std::sort(groupEdges.begin(), groupEdges.end());
+        std::sort(vertexEdges.begin(), vertexEdges.end());
+
+        m_kinds.assign(m_positions.size(), MANIFOLD);
+        std::vector<bool> isOnBorder(m_positions.size(), false);
+        for (unsigned int vertex = 0; vertex < m_positions.size(); ++vertex)
+        {
+            unsigned int groupSize = m_groupSizes[m_groups[vertex]];
+            m_kinds[vertex] = groupSize > 2 ? LOCKED : (groupSize == 2 ? SEAM : MANIFOLD);
+        }
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int a = m_indices[(triangle * 3) + corner];
+                unsigned int b = m_indices[(triangle * 3) + ((corner + 1) % 3)];
+                size_t groupCount = CountEdges(groupEdges, MakeEdgeKey(m_groups[a], m_groups[b]));
+                if (groupCount > 2)
+                {
+                    //Non-manifold edge, leave it alone entirely.
+                    m_kinds[a] = LOCKED;
+                    m_kinds[b] = LOCKED;
+                }
+                else if (groupCount == 1)
+                {
+                    isOnBorder[a] = true;
+                    isOnBorder[b] = true;
+                    AddEdgeConstraint(a, b, triangle);
+                }
+                else if (CountEdges(vertexEdges, MakeEdgeKey(a, b)) == 1)
+                {
+                    //Two faces meet here in space but not in the index buffer: an attribute seam. Keep it straight.
+                    AddEdgeConstraint(a, b, triangle);
+                }
+            }
+        }
+        for (unsigned int vertex = 0; vertex < m_positions.size(); ++vertex)
+        {
+            if (isOnBorder[vertex])
+            {
+                m_kinds[vertex] = (m_kinds[vertex] == MANIFOLD) ? BORDER : LOCKED;
+            }
+            //A seam wedge moves with its sibling, so it can't move if either of them is locked.
+            if (!m_locked.empty() && (m_locked[vertex] || m_locked[m_siblings[vertex]]))
+            {
+                m_kinds[vertex] = LOCKED;
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    void BuildQuadrics()
+    {
+        m_groupQuadrics.resize(m_positions.size());
+        for (size_t triangle = 0; triangle < m_indices.size() / 3; ++triangle)
+        {
+            const Vector3& a = m_positions[m_indices[(triangle * 3) + 0]];
+            const Vector3& b = m_positions[m_indices[(triangle * 3) + 1]];
+            const Vector3& c = m_positions[m_indices[(triangle * 3) + 2]];
+            Vector3 normal = Vector3::Cross(b - a, c - a);
+            float doubleArea = normal.CalculateMagnitude();
+            if (doubleArea <= 0.0f)
+            {
+                continue;
+            }
+            normal = normal * (1.0f / doubleArea);
+            double d = -MathUtils::Dot(normal, a);
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                m_groupQuadrics[m_groups[m_indices[(triangle * 3) + corner]]].AddPlane(normal.x, normal.y, normal.z, d, doubleArea * 0.5);
+            }
+        }
+        for (size_t i = 0; i < m_edgeConstraints.size(); ++i)
+        {
+            m_groupQuadrics[m_edgeConstraintGroups[i]].Add(m_edgeConstraints[i]);
+        }
+        m_edgeConstraints.clear();
+        m_edgeConstraintGroups.clear();
+    }
+
+    //-----------------------------------------------------------------------------------
+    //A heavily weighted plane through the edge, perpendicular to its face, so collapses can slide along a border but not pull it inwards.
+    void AddEdgeConstraint(unsigned int a, unsigned int b, size_t triangle)
+    {
+        static const double EDGE_CONSTRAINT_WEIGHT = 10.0;
+        const Vector3& pa = m_positions[m_indices[(triangle * 3) + 0]];
+        const Vector3& pb = m_positions[m_indices[(triangle * 3) + 1]];
+        const Vector3& pc = m_positions[m_indices[(triangle * 3) + 2]];
+        Vector3 faceNormal = Vector3::Cross(pb - pa, pc - pa);
+        Vector3 edge = m_positions[b] - m_positions[a];
+        Vector3 planeNormal = Vector3::Cross(edge, faceNormal);
+        float length = planeNormal.CalculateMagnitude();
+        if (length <= 0.0f)
+        {
+            return;
+        }
+        planeNormal = planeNormal * (1.0f / length);
+        double d = -MathUtils::Dot(planeNormal, m_positions[a]);
+        double edgeLengthSquared = MathUtils::Dot(edge, edge);
+        Quadric constraint;
+        constraint.AddPlane(planeNormal.x, planeNormal.y, planeNormal.z, d, edgeLengthSquared * EDGE_CONSTRAINT_WEIGHT);
+        m_edgeConstraints.push_back(constraint);
+        m_edgeConstraintGroups.push_back(m_groups[a]);
+        m_edgeConstraints.push_back(constraint);
+        m_edgeConstraintGroups.push_back(m_groups[b]);
+    }
+
+    //-----------------------------------------------------------------------------------
+    unsigned int CountSharedTriangles(unsigned int vertex, unsigned int other) const
+    {
+        unsigned int count = 0;
+        for (unsigned int triangle : m_vertexTriangles[vertex])
+        {
+            if (m_isTriangleAlive[triangle])
+            {
+                const unsigned int* corners = &m_indices[triangle * 3];
+                count += (corners[0] == other || corners[1] == other || corners[2] == other) ? 1 : 0;
+            }
+        }
+        return count;
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Rejects collapses that would turn any of the vertex's remaining triangles over or down to nothing.
+    bool WouldFlipTriangles(unsigned int vertex, unsigned int target) const
+    {
+        const Vector3& newPosition = m_positions[target];
+        for (unsigned int triangle : m_vertexTriangles[vertex])
+        {
+            if (!m_isTriangleAlive[triangle])
+            {
+                continue;
+            }
+            const unsigned int* corners = &m_indices[triangle * 3];
+            if (corners[0] == target || corners[1] == target || corners[2] == target)
+            {
+                continue;
+            }
+            Vector3 points[3] = { m_positions[corners[0]], m_positions[corners[1]], m_positions[corners[2]] };
+            Vector3 oldNormal = Vector3::Cross(points[1] - points[0], points[2] - points[0]);
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                points[corner] = (corners[corner] == vertex) ? newPosition : points[corner];
+            }
+            Vector3 newNormal = Vector3::Cross(points[1] - points[0], points[2] - points[0]);
+            if (MathUtils::Dot(oldNormal, newNormal) <= 0.0f)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-----------------------------------------------------------------------------------
+    bool CanCollapse(unsigned int vertex, unsigned int target, unsigned int& outPairedVertex, unsigned int& outPairedTarget) const
+    {
+        if (!IsCollapseTopologyValid(vertex, target, outPairedVertex, outPairedTarget))
+        {
+            return false;
+        }
+        if (m_kinds[vertex] == SEAM && WouldFlipTriangles(outPairedVertex, outPairedTarget))
+        {
+            return false;
+        }
+        return !WouldFlipTriangles(vertex, target);
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Everything but the flip test, which is the expensive part and is left until a collapse is actually a contender.
+    bool IsCollapseTopologyValid(unsigned int vertex, unsigned int target, unsigned int& outPairedVertex, unsigned int& outPairedTarget) const
+    {
+        if (!m_regions.empty() && m_regions[vertex] != m_regions[target])
+        {
+            return false;
+        }
+        switch (m_kinds[vertex])
+        {
+        case MANIFOLD:
+            break;
+        case BORDER:
+            //Only slide along the border, onto the next border vertex.
+            if (m_kinds[target] != BORDER && m_kinds[target] != LOCKED)
+            {
+                return false;
+            }
+            if (CountSharedTriangles(vertex, target) != 1)
+            {
+                return false;
+            }
+            break;
+        case SEAM:
+        {
+            //Both wedges have to move along the seam together, onto the two wedges of another seam point.
+            if (m_kinds[target] != SEAM || m_groups[vertex] == m_groups[target])
+            {
+                return false;
+            }
+            outPairedVertex = m_siblings[vertex];
+            outPairedTarget = m_siblings[target];
+            if (!m_isVertexAlive[outPairedVertex] || !m_isVertexAlive[outPairedTarget])
+            {
+                return false;
+            }
+            if (CountSharedTriangles(vertex, target) != 1 || CountSharedTriangles(outPairedVertex, outPairedTarget) != 1)
+            {
+                return false;
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------
+    void PushBestCollapse(unsigned int vertex)
+    {
+        ++m_stamps[vertex];
+        if (!m_isVertexAlive[vertex] || m_kinds[vertex] == LOCKED)
+        {
+            return;
+        }
+        unsigned int pairedVertex = 0;
+        unsigned int pairedTarget = 0;
+        RemoveDeadTriangles(m_vertexTriangles[vertex]);
+        m_scratchCandidates.clear();
+        for (unsigned int triangle : m_vertexTriangles[vertex])
+        {
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int target = m_indices[(triangle * 3) + corner];
+                if (target == vertex || !IsCollapseTopologyValid(vertex, target, pairedVertex, pairedTarget))
+                {
+                    continue;
+                }
+                Quadric combined = m_groupQuadrics[m_groups[vertex]];
+                combined.Add(m_groupQuadrics[m_groups[target]]);
+                m_scratchCandidates.push_back(CollapseCandidate(combined.Evaluate(m_positions[target]), vertex, target, m_stamps[vertex]));
+            }
+        }
+
+        //Cheapest first, so the flip test usually only runs once.
+        auto isCheaper = [](const CollapseCandidate& lhs, const CollapseCandidate& rhs) { return lhs.cost < rhs.cost; };
+        std::vector<CollapseCandidate>::iterator cheapest = std::min_element(m_scratchCandidates.begin(), m_scratchCandidates.end(), isCheaper);
+        if (cheapest == m_scratchCandidates.end())
+        {
+            return;
+        }
+        if (CanCollapse(vertex, cheapest->target, pairedVertex, pairedTarget))
+        {
+            m_queue.push(*cheapest);
+            return;
+        }
+        std::sort(m_scratchCandidates.begin(), m_scratchCandidates.end(), isCheaper);
+        for (const CollapseCandidate& candidate : m_scratchCandidates)
+        {
+            if (CanCollapse(vertex, candidate.target, pairedVertex, pairedTarget))
+            {
+                m_queue.push(candidate);
+                return;
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    void Collapse(unsigned int vertex, unsigned int target)
+    {
+        std::vector<unsigned int>& targetTriangles = m_vertexTriangles[target];
+        for (unsigned int triangle : m_vertexTriangles[vertex])
+        {
+            if (!m_isTriangleAlive[triangle])
+            {
+                continue;
+            }
+            unsigned int* corners = &m_indices[triangle * 3];
+            if (corners[0] == target || corners[1] == target || corners[2] == target)
+            {
+                m_isTriangleAlive[triangle] = 0;
+                --m_liveTriangleCount;
+                continue;
+            }
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                corners[corner] = (corners[corner] == vertex) ? target : corners[corner];
+            }
+            targetTriangles.push_back(triangle);
+        }
+        m_vertexTriangles[vertex].clear();
+        m_isVertexAlive[vertex] = 0;
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Lists keep their dead triangles until the vertex is looked at again, this keeps them from growing as collapses pile up on a vertex.
+    void RemoveDeadTriangles(std::vector<unsigned int>& triangles) const
+    {
+        const std::vector<uint8_t>& isTriangleAlive = m_isTriangleAlive;
+        triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [&isTriangleAlive](unsigned int triangle) { return !isTriangleAlive[triangle]; }), triangles.end());
+    }
+
+    //-----------------------------------------------------------------------------------
+    void RefreshNeighborhood(unsigned int vertex)
+    {
+        m_scratchNeighbors.clear();
+        RemoveDeadTriangles(m_vertexTriangles[vertex]);
+        for (unsigned int triangle : m_vertexTriangles[vertex])
+        {
+            const unsigned int* corners = &m_indices[triangle * 3];
+            m_scratchNeighbors.insert(m_scratchNeighbors.end(), corners, corners + 3);
+        }
+        std::sort(m_scratchNeighbors.begin(), m_scratchNeighbors.end());
+        m_scratchNeighbors.erase(std::unique(m_scratchNeighbors.begin(), m_scratchNeighbors.end()), m_scratchNeighbors.end());
+        for (unsigned int neighbor : m_scratchNeighbors)
+        {
+            PushBestCollapse(neighbor);
+        }
+    }
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    std::vector<unsigned int> m_indices;
+    const std::vector<Vector3>& m_positions;
+    const std::vector<int>& m_regions;
+    const std::vector<uint8_t>& m_locked;
+    std::vector<std::vector<unsigned int>> m_vertexTriangles;
+    std::vector<uint8_t> m_isTriangleAlive;
+    std::vector<uint8_t> m_isVertexAlive;
+    std::vector<uint32_t> m_stamps;
+    std::vector<unsigned int> m_groups;
+    std::vector<unsigned int> m_groupSizes;
+    std::vector<unsigned int> m_siblings;
+    std::vector<VertexKind> m_kinds;
+    std::vector<Quadric> m_groupQuadrics;
+    std::vector<Quadric> m_edgeConstraints;
+    std::vector<unsigned int> m_edgeConstraintGroups;
+    std::vector<unsigned int> m_scratchNeighbors;
+    std::vector<CollapseCandidate> m_scratchCandidates;
+    std::priority_queue<CollapseCandidate> m_queue;
+    size_t m_liveTriangleCount;
+    float m_lastError;
+};
+
+//-----------------------------------------------------------------------------------
+float MeshOptimizer::Simplify(const unsigned int* indices, size_t indexCount, const std::vector<Vector3>& positions, const std::vector<int>& collapseRegions,
+    const std::vector<uint8_t>& lockedVertices, size_t targetIndexCount, std::vector<unsigned int>& outIndices)
+{
+    ASSERT_OR_DIE(indexCount % 3 == 0, "Simplification needs a triangle list!");
+    ASSERT_OR_DIE(collapseRegions.empty() || collapseRegions.size() == positions.size(), "Need one collapse region per vertex!");
+    ASSERT_OR_DIE(lockedVertices.empty() || lockedVertices.size() == positions.size(), "Need one lock flag per vertex!");
+    QuadricSimplifier simplifier(indices, indexCount, positions, collapseRegions, lockedVertices);
+    simplifier.Run(targetIndexCount / 3);
+    simplifier.GetIndices(outIndices);
+    return simplifier.GetLastError();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Engine/Math/Vector3.hpp"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------------
+//Results of running an index buffer through a simulated FIFO post-transform cache.
+struct VertexCacheStats
+{
+    VertexCacheStats() : vertexTransforms(0), triangleCount(0), uniqueVertexCount(0), acmr(0.0f), atvr(0.0f) {};
+
+    uint32_t vertexTransforms;
+    uint32_t triangleCount;
+    uint32_t uniqueVertexCount;
+    //Average cache miss ratio: transforms per triangle. 0.5 is the ideal for a big regular grid, 3 is no reuse at all.
+    float acmr;
+    //Average transform to vertex ratio: transforms per referenced vertex. 1 is ideal.
+    float atvr;
+};
+
+//-----------------------------------------------------------------------------------
+//Index and vertex order optimizations for triangle lists. All of these work on raw index arrays so they can run on any mesh data.
+class MeshOptimizer
+{
+public:
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    //Reorders triangles to make better use of the GPU's post-transform cache (Forsyth, "Linear-Speed Vertex Cache Optimisation").
+    static void OptimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+    //Builds a vertex remap that puts vertices in the order the indices first use them, and rewrites the indices to match.
+    //Unreferenced vertices map to INVALID_VERTEX. Returns the number of vertices still referenced.
+    static size_t BuildVertexFetchRemap(unsigned int* indices, size_t indexCount, size_t vertexCount, std::vector<unsigned int>& outOldToNew);
+    static VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+    //Quadric error edge collapse down to at most targetIndexCount indices, writing the surviving triangles to outIndices. Vertices are never moved or added,
+    //so the result indexes the same vertex buffer. Vertices that share a position with other vertices are treated as attribute seams and only collapse
+    //in pairs along the seam. If collapseRegions is non-empty, vertices only collapse onto others in the same region (ie: same dominant bone).
+    //If lockedVertices is non-empty, the vertices it marks never collapse (others can still collapse onto them).
+    //Returns the quadric error of the last collapse performed.
+    static float Simplify(const unsigned int* indices, size_t indexCount, const std::vector<Vector3>& positions, const std::vector<int>& collapseRegions,
+        const std::vector<uint8_t>& lockedVertices, size_t targetIndexCount, std::vector<unsigned int>& outIndices);
+
+    //CONSTANTS//////////////////////////////////////////////////////////////////////////
+    static const unsigned int DEFAULT_CACHE_SIZE = 32;
+    static const unsigned int MAX_CACHE_SIZE = 64;
+    static const unsigned int INVALID_VERTEX = 0xFFFFFFFF;
+};
@@ -11,6 +11,7 @@ MeshRenderer::MeshRenderer()
 	, m_material(nullptr)
 	, m_model(Matrix4x4::IDENTITY)
 	, m_vaoID(0)
+	, m_lod(0)
 {
 
 }
@@ -21,6 +22,7 @@ MeshRenderer::MeshRenderer(Mesh* mesh, Material* material)
 	, m_material(material)
 	, m_model(Matrix4x4::IDENTITY)
 	, m_vaoID(0)
+	, m_lod(0)
 {
 	m_vaoID = Renderer::instance->GenerateVAOHandle();
 	GL_CHECK_ERROR();
@@ -40,9 +42,10 @@ void MeshRenderer::Render() const
 {
 	m_material->SetMatrices(m_model, Renderer::instance->m_viewStack.GetTop(), Renderer::instance->m_projStack.GetTop());
 	m_material->BindAvailableTextures();
+	m_material->SetVec4Uniform("gPositionDequantize", m_mesh->m_positionDequantize);
 	m_mesh->BindToVAO(m_vaoID, m_material->m_shaderProgram);
 	GL_CHECK_ERROR();
-	m_mesh->RenderFromIBO(m_vaoID, m_material);
+	m_mesh->RenderFromIBO(m_vaoID, m_material, m_lod);
 	GL_CHECK_ERROR();
 	Renderer::instance->UnbindIbo();
 	m_material->UnbindAvailableTextures();
@@ -54,6 +57,13 @@ void MeshRenderer::SetPosition(const Vector3& worldPosition)
 	m_model.SetTranslation(worldPosition);
 }
 
+//-----------------------------------------------------------------------------------
+//Meshes can be shared between renderers (ie: PrimitiveLibrary's), each drawing its own instance with its own model matrix.
+void MeshRenderer::SetModelMatrix(const Matrix4x4& model)
+{
+	m_model = model;
+}
+
 //-----------------------------------------------------------------------------------
 void MeshRenderer::SetVec3Uniform(const char* uniformName, const Vector3& value)
 {
@@ -19,7 +19,10 @@ public:
 	void Render() const;
 
 	void SetPosition(const Vector3& worldPosition);
+	void SetModelMatrix(const Matrix4x4& model);
 	void SetVec3Uniform(const char* uniformName, const Vector3& value);
+	//Which of the mesh's LODs this renderer draws, usually from Mesh::SelectLOD.
+	inline void SetLOD(unsigned int lod) { m_lod = lod; };
 	
 	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
 	Material* m_material;
@@ -28,6 +31,7 @@ public:
 private:
 	GLuint m_vaoID;
 	Matrix4x4 m_model;
+	unsigned int m_lod;
 
 	MeshRenderer(const MeshRenderer&);
 };
\ No newline at end of file
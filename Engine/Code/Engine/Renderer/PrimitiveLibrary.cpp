@@ -0,0 +1,109 @@
+#include "Engine/Renderer/PrimitiveLibrary.hpp"
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+std::map<unsigned int, PrimitiveLibrary::CachedPrimitive> PrimitiveLibrary::s_primitives;
+
+//-----------------------------------------------------------------------------------
+static Vector3 EvaluateUnitPlane(const void*, float x, float y)
+{
+    return Vector3(x, 0.0f, y);
+}
+
+//-----------------------------------------------------------------------------------
+const MeshBuilder* PrimitiveLibrary::GetBuilder(PrimitiveType type, unsigned int detail)
+{
+    return GetOrBuild(type, detail).builder;
+}
+
+//-----------------------------------------------------------------------------------
+Mesh* PrimitiveLibrary::GetMesh(PrimitiveType type, unsigned int detail, MeshCopyFunction* copyFunction)
+{
+    CachedPrimitive& primitive = GetOrBuild(type, detail);
+    auto found = primitive.meshes.find(copyFunction);
+    if (found != primitive.meshes.end())
+    {
+        return found->second;
+    }
+    Mesh* mesh = new Mesh();
+    copyFunction(*primitive.builder, mesh);
+    primitive.meshes.emplace(copyFunction, mesh);
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------------
+//Anything still holding a primitive's mesh has to be done with it, call before the renderer goes away.
+void PrimitiveLibrary::ClearCache()
+{
+    for (auto& primitivePair : s_primitives)
+    {
+        for (auto& meshPair : primitivePair.second.meshes)
+        {
+            delete meshPair.second;
+        }
+        delete primitivePair.second.builder;
+    }
+    s_primitives.clear();
+}
+
+//-----------------------------------------------------------------------------------
+PrimitiveLibrary::CachedPrimitive& PrimitiveLibrary::GetOrBuild(PrimitiveType type, unsigned int detail)
+{
+    ASSERT_OR_DIE(type < NUM_PRIMITIVE_TYPES, "Asked the primitive library for a primitive it doesn't know");
+    //Details that would build the same thing share one entry.
+    if (type == CUBE)
+    {
+        detail = 0;
+    }
+    else if (type == CYLINDER && detail < 3)
+    {
+        detail = 3;
+    }
+    else if (type == PLANE && detail < 1)
+    {
+        detail = 1;
+    }
+    ASSERT_OR_DIE(detail <= 0xFFFF, "Primitive detail is out of range");
+    CachedPrimitive& primitive = s_primitives[((unsigned int)type << 16) | detail];
+    if (primitive.builder == nullptr)
+    {
+        primitive.builder = Build(type, detail);
+    }
+    return primitive;
+}
+
+//-----------------------------------------------------------------------------------
+MeshBuilder* PrimitiveLibrary::Build(PrimitiveType type, unsigned int detail)
+{
+    MeshBuilder* builder = new MeshBuilder();
+    builder->SetColor(RGBA::WHITE);
+    switch (type)
+    {
+    case ICOSPHERE:
+        builder->AddIcoSphere(1.0f, RGBA::WHITE, (int)detail);
+        break;
+    case CUBE:
+    {
+        //AddCube puts a corner on the origin, so shift it over to the center.
+        builder->AddCube(1.0f);
+        Matrix4x4 centered = Matrix4x4::IDENTITY;
+        centered.SetTranslation(Vector3(-0.5f, -0.5f, -0.5f));
+        MeshBuilder::MergeInput input(builder, &centered);
+        MeshBuilder* centeredBuilder = MeshBuilder::MergeBatch(&input, 1);
+        delete builder;
+        builder = centeredBuilder;
+        break;
+    }
+    case CYLINDER:
+        builder->AddCylinder(1.0f, 1.0f, detail);
+        break;
+    case PLANE:
+        builder->BuildPatch(-0.5f, 0.5f, detail, -0.5f, 0.5f, detail, &EvaluateUnitPlane, nullptr);
+        break;
+    default:
+        ERROR_AND_DIE("Unknown primitive type");
+    }
+    return builder;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "Engine/Renderer/Vertex.hpp"
+#include <map>
+
+class Mesh;
+class MeshBuilder;
+
+//-----------------------------------------------------------------------------------
+//Unit sized primitives, generated the first time they're asked for and shared from then on. Instead of building geometry for every
+//sphere or box, draw the shared Mesh with a model matrix (ie: MeshRenderer::SetModelMatrix), or bake copies into a batch by handing
+//GetBuilder to MeshBuilder::MergeBatch with a transform. Everything is centered on the origin and white:
+//  ICOSPHERE: radius 1, detail is the number of subdivision passes.
+//  CUBE:      side length 1, detail is ignored.
+//  CYLINDER:  radius 1 and height 1 along the up axis, detail is the number of sides (at least 3).
+//  PLANE:     1 by 1 across x and z facing up, detail is the number of sections along each side (at least 1).
+//Meshes need the GL context, so this is main thread only. The cache owns everything it hands out.
+class PrimitiveLibrary
+{
+public:
+    //ENUMS//////////////////////////////////////////////////////////////////////////
+    enum PrimitiveType
+    {
+        ICOSPHERE,
+        CUBE,
+        CYLINDER,
+        PLANE,
+        NUM_PRIMITIVE_TYPES
+    };
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static const MeshBuilder* GetBuilder(PrimitiveType type, unsigned int detail);
+    static Mesh* GetMesh(PrimitiveType type, unsigned int detail, MeshCopyFunction* copyFunction);
+    template<typename Layout> static inline Mesh* GetMesh(PrimitiveType type, unsigned int detail) { return GetMesh(type, detail, &Layout::CopyToMesh); };
+    static void ClearCache();
+
+private:
+    //STRUCTS//////////////////////////////////////////////////////////////////////////
+    //One builder per primitive, with a mesh for each layout it's been uploaded as.
+    struct CachedPrimitive
+    {
+        CachedPrimitive() : builder(nullptr) {};
+        MeshBuilder* builder;
+        std::map<MeshCopyFunction*, Mesh*> meshes;
+    };
+
+    //HELPER FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static CachedPrimitive& GetOrBuild(PrimitiveType type, unsigned int detail);
+    static MeshBuilder* Build(PrimitiveType type, unsigned int detail);
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    static std::map<unsigned int, CachedPrimitive> s_primitives;
+};
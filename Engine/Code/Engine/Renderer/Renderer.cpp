@@ -21,6 +21,7 @@
 #include "Engine/Renderer/Framebuffer.hpp"
 #include "Engine/Renderer/Mesh.hpp"
 #include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/VertexLayout.hpp"
 #include "Engine/Renderer/MeshRenderer.hpp"
 #include "Engine/Input/InputOutputUtils.hpp"
 #include "Engine/Core/StringUtils.hpp"
@@ -376,7 +377,7 @@ void Renderer::DrawVertexArray(const Vertex_PCT* vertexes, int numVertexes, Draw
     builder.End();
 
     Mesh* mesh = new Mesh();
-    builder.CopyToMesh(mesh, &Vertex_PCUTB::Copy, sizeof(Vertex_PCUTB), &Vertex_PCUTB::BindMeshToVAO);
+    builder.CopyToMesh<Layout_PCUTB>(mesh);
     mesh->m_drawMode = drawMode;
     MeshRenderer* thingToRender = new MeshRenderer(mesh, m_defaultMaterial);
     m_defaultMaterial->SetMatrices(Matrix4x4::IDENTITY, m_viewStack.GetTop(), m_projStack.GetTop());
@@ -414,6 +415,30 @@ void Renderer::DrawVBO_PCT(unsigned int vboID, int numVerts, DrawMode drawMode /
     UnbindTexture();
 }
 
+//-----------------------------------------------------------------------------------
+//Ignores the vertex colors and draws everything in the tint instead, so one buffer can be shared by draws of different colors.
+void Renderer::DrawVBO_PCT(unsigned int vboID, int numVerts, const RGBA& tint, DrawMode drawMode /*= QUADS*/)
+{
+    BindTexture(*m_defaultTexture);
+    glBindBuffer(GL_ARRAY_BUFFER, vboID);
+    SetColor(tint);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex_PCT), (const GLvoid*)offsetof(Vertex_PCT, pos));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex_PCT), (const GLvoid*)offsetof(Vertex_PCT, texCoords));
+
+    glDrawArrays(GetDrawMode(drawMode), 0, numVerts);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    SetColor(RGBA::WHITE);
+    glBindBuffer(GL_ARRAY_BUFFER, NULL);
+    UnbindTexture();
+}
+
 void Renderer::DrawVBO_PCUTB(unsigned int vboID, int numVerts, DrawMode drawMode /*= QUADS*/, Texture* texture /*= nullptr*/)
 {
     if (!texture)
@@ -486,7 +511,7 @@ void Renderer::DrawText2D
     builder.End();
 
     Mesh* mesh = new Mesh();
-    builder.CopyToMesh(mesh, &Vertex_PCUTB::Copy, sizeof(Vertex_PCUTB), &Vertex_PCUTB::BindMeshToVAO);
+    builder.CopyToMesh<Layout_PCUTB>(mesh);
     mesh->m_drawMode = DrawMode::TRIANGLES;
     MeshRenderer* thingToRender = new MeshRenderer(mesh, font->GetMaterial());
     m_defaultMaterial->SetMatrices(Matrix4x4::IDENTITY, m_viewStack.GetTop(), m_projStack.GetTop());
@@ -547,7 +572,7 @@ void Renderer::DrawText2D(const Vector2& position, const std::string& asciiText,
     builder.End();
 
     Mesh* mesh = new Mesh();
-    builder.CopyToMesh(mesh, &Vertex_PCUTB::Copy, sizeof(Vertex_PCUTB), &Vertex_PCUTB::BindMeshToVAO);
+    builder.CopyToMesh<Layout_PCUTB>(mesh);
     mesh->m_drawMode = DrawMode::TRIANGLES;
     MeshRenderer* thingToRender = new MeshRenderer(mesh, font->GetMaterial());
     m_defaultMaterial->SetMatrices(Matrix4x4::IDENTITY, m_viewStack.GetTop(), m_projStack.GetTop());
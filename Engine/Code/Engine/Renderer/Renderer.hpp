@@ -94,6 +94,7 @@ public:
     void BindAndBufferVBOData(int vboID, const Vertex_PCUTB* vertexes, int numVerts);
 	void DrawVertexArray(const Vertex_PCT* vertexes, int numVertexes, DrawMode drawMode = DrawMode::QUADS);
     void DrawVBO_PCT(unsigned int vboID, int numVerts, DrawMode drawMode = DrawMode::QUADS, Texture* texture = nullptr);
+    void DrawVBO_PCT(unsigned int vboID, int numVerts, const RGBA& tint, DrawMode drawMode = DrawMode::QUADS);
     void DrawVBO_PCUTB(unsigned int vboID, int numVerts, DrawMode drawMode = DrawMode::QUADS, Texture* texture = nullptr);
 
     //DRAWING//////////////////////////////////////////////////////////////////////////
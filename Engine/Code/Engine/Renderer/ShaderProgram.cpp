@@ -6,7 +6,7 @@
 #include <stdlib.h>
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/StringUtils.hpp"
-#include "Engine/Input/InputOutputUtils.hpp"
+#include "Engine/Input/FileView.hpp"
 #include "Engine/Renderer/OpenGLExtensions.hpp"
 
 //-----------------------------------------------------------------------------------
@@ -29,6 +29,19 @@ ShaderProgram::ShaderProgram(const char* vertShaderPath, const char* fragShaderP
     FindAllUniforms();
 }
 
+//-----------------------------------------------------------------------------------
+ShaderProgram* ShaderProgram::CreateFromSource(const std::string& vertSource, const std::string& fragSource, const char* vertShaderPath, const char* fragShaderPath)
+{
+    ShaderProgram* program = new ShaderProgram();
+    program->m_vertexShaderID = program->CompileShader(vertSource.data(), (GLint)vertSource.size(), vertShaderPath, GL_VERTEX_SHADER);
+    program->m_fragmentShaderID = program->CompileShader(fragSource.data(), (GLint)fragSource.size(), fragShaderPath, GL_FRAGMENT_SHADER);
+    program->m_shaderProgramID = program->CreateAndLinkProgram(program->m_vertexShaderID, program->m_fragmentShaderID);
+    ASSERT_OR_DIE(program->m_vertexShaderID != NULL && program->m_fragmentShaderID != NULL, "Error: Vertex or Fragment Shader was null");
+    ASSERT_OR_DIE(program->m_shaderProgramID != NULL, "Error: Program linking id was null");
+    program->FindAllUniforms();
+    return program;
+}
+
 //-----------------------------------------------------------------------------------
 ShaderProgram::~ShaderProgram()
 {
@@ -40,13 +53,20 @@ ShaderProgram::~ShaderProgram()
 //-----------------------------------------------------------------------------------
 GLuint ShaderProgram::LoadShader(const char* filename, GLenum shader_type)
 {
-    char* fileBuffer = FileReadIntoNewBuffer(filename);
+    //GL takes the source with an explicit length, so it can come straight out of the file view.
+    FileView shaderFile;
+    ASSERT_OR_DIE(shaderFile.Open(filename), Stringf("Failed to open shader %s", filename));
 
+    return CompileShader(reinterpret_cast<const char*>(shaderFile.GetData()), (GLint)shaderFile.GetSize(), filename, shader_type);
+}
+
+//-----------------------------------------------------------------------------------
+GLuint ShaderProgram::CompileShader(const char* source, GLint sourceLength, const char* filename, GLenum shader_type)
+{
     GLuint shader_id = glCreateShader(shader_type);
     ASSERT_OR_DIE(shader_id != NULL, "Failed to create shader");
 
-    GLint src_length = strlen(fileBuffer);
-    glShaderSource(shader_id, 1, &fileBuffer, &src_length);
+    glShaderSource(shader_id, 1, &source, &sourceLength);
 
     glCompileShader(shader_id);
 
@@ -84,8 +104,6 @@ GLuint ShaderProgram::LoadShader(const char* filename, GLenum shader_type)
 
     //Todo: print errors if failed
 
-    free(fileBuffer);
-    fileBuffer = nullptr;
     return shader_id;
 }
 
@@ -45,6 +45,9 @@ public:
 
     //FUNCTIONS//////////////////////////////////////////////////////////////////////////
     GLuint LoadShader(const char* filename, GLuint shader_type);
+    GLuint CompileShader(const char* source, GLint sourceLength, const char* filename, GLenum shader_type);
+    //For sources that were already read in elsewhere (ie: by the AsyncLoader), the filenames are only used for error messages.
+    static ShaderProgram* CreateFromSource(const std::string& vertSource, const std::string& fragSource, const char* vertShaderPath, const char* fragShaderPath);
     GLuint CreateAndLinkProgram(GLuint vs, GLuint fs);
     void ShaderProgramBindProperty(const char *name, GLint count, GLenum type, GLboolean normalize, GLsizei stride, GLsizei offset);
     void ShaderProgramBindIntegerProperty(const char *name, GLint count, GLenum type, GLsizei stride, GLsizei offset);
@@ -1,58 +1,18 @@
 #include "Engine/Renderer/Skeleton.hpp"
-#include "Engine/Renderer/DebugRenderer.hpp"
-#include "Engine/Renderer/MeshRenderer.hpp"
-#include "Engine/Renderer/MeshBuilder.hpp"
-#include "Engine/Renderer/ShaderProgram.hpp"
-#include "Engine/Renderer/Material.hpp"
-#include "Engine/Renderer/Vertex.hpp"
 #include "Engine/Renderer/AnimationMotion.hpp"
-#include "Engine/Input/Console.hpp"
+#include "Engine/Renderer/AnimationReplay.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Input/FileView.hpp"
 
 Skeleton* g_loadedSkeleton = nullptr;
 
 //-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(saveSkel)
+Skeleton::~Skeleton()
 {
-    if (!args.HasArgs(1))
-    {
-        Console::instance->PrintLine("saveSkel <filename>", RGBA::RED);
-        return;
-    }
-    std::string filename = args.GetStringArgument(0);
-    if (!g_loadedSkeleton)
+    if (AnimationRecorder::instance)
     {
-        Console::instance->PrintLine("Error: No skeleton has been loaded yet, use fbxLoad to bring in a mesh with a skeleton first.", RGBA::RED);
-        return;
+        AnimationRecorder::instance->ForgetSkeleton(this);
     }
-    g_loadedSkeleton->WriteToFile(filename.c_str());
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(loadSkel)
-{
-    if (!args.HasArgs(1))
-    {
-        Console::instance->PrintLine("loadSkel <filename>", RGBA::RED);
-        return;
-    }
-    std::string filename = args.GetStringArgument(0);
-    if (g_loadedSkeleton)
-    {
-        delete g_loadedSkeleton;
-    }
-    g_loadedSkeleton = new Skeleton();
-    g_loadedSkeleton->ReadFromFile(filename.c_str());
-}
-
-//-----------------------------------------------------------------------------------
-Skeleton::~Skeleton()
-{
-    delete m_joints->m_mesh;
-    delete m_joints->m_material;
-    delete m_joints;
-    delete m_bones->m_mesh;
-    delete m_bones->m_material;
-    delete m_bones;
 }
 
 //-----------------------------------------------------------------------------------
@@ -62,7 +22,7 @@ void Skeleton::AddJoint(const char* str, int parentJointIndex, Matrix4x4 initial
     //m_parentIndices.push_back(parentJointIndex);
     //m_boneToModelSpace.push_back(initialBoneToModelMatrix);
     Matrix4x4 modelToBoneMatrix = initialBoneToModelMatrix;
-    Matrix4x4::MatrixInvert(&modelToBoneMatrix);
+    Matrix4x4::MatrixInvertAffine(&modelToBoneMatrix);
     //m_modelToBoneSpace.push_back(modelToBoneMatrix);
     Joint joint = Joint(std::string(str), parentJointIndex, modelToBoneMatrix, initialBoneToModelMatrix);
 
@@ -126,6 +86,18 @@ const Matrix4x4 Skeleton::GetWorldBoneToModelOutOfLocal(const int& currentIndex)
 
     return current;
 }
+//-----------------------------------------------------------------------------------
+//Only meaningful once the joints are depth-first ordered: the subtree rooted at jointIndex is then [jointIndex, end).
+int Skeleton::GetSubtreeEndIndex(int jointIndex) const
+{
+    int endIndex = jointIndex + 1;
+    while (endIndex < (int)m_jointArray.size() && m_jointArray[endIndex].m_parentIndex >= jointIndex)
+    {
+        ++endIndex;
+    }
+    return endIndex;
+}
+
 const BoneMask Skeleton::GetBoneMaskForJointName(const std::string& name, const float& flo) const
 {
     BoneMask mas(m_jointArray.size());
@@ -179,44 +151,6 @@ const BoneMask Skeleton::GetBoneMaskForJointNames(const std::vector<std::string>
     return mas;
 }
 
-//-----------------------------------------------------------------------------------
-void Skeleton::Render() const
-{
-    if (!m_joints)
-    {
-        MeshBuilder builder;
-        for (size_t i = 0; i < m_jointArray.size(); i++)// const Matrix4x4& modelSpaceMatrix : m_boneToModelSpace)
-        {
-            const Matrix4x4 modelSpaceMatrix = GetWorldBoneToModelOutOfLocal(i);// m_jointArray.at(i).m_boneToModelSpace;
-            builder.AddIcoSphere(1.0f, RGBA::BLUE, 0, modelSpaceMatrix.GetTranslation());
-        }
-        m_joints = new MeshRenderer(new Mesh(), new Material(new ShaderProgram("Data/Shaders/fixedVertexFormat.vert", "Data/Shaders/fixedVertexFormat.frag"), 
-            RenderState(RenderState::DepthTestingMode::OFF, RenderState::FaceCullingMode::RENDER_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND)));
-        m_joints->m_material->SetDiffuseTexture(Renderer::instance->m_defaultTexture);
-        builder.CopyToMesh(m_joints->m_mesh, &Vertex_PCUTB::Copy, sizeof(Vertex_PCUTB), &Vertex_PCUTB::BindMeshToVAO);
-    }
-    if (!m_bones)
-    {
-        MeshBuilder builder;
-        for (unsigned int i = 0; i < m_jointArray.size(); i++)
-        {
-            int parentIndex = m_jointArray[i].m_parentIndex;
-            if (parentIndex >= 0)
-            {
-                Matrix4x4 currentBoneToModel = GetWorldBoneToModelOutOfLocal(i); //m_jointArray[i].m_boneToModelSpace.GetTranslation()
-                Matrix4x4 parentBoneToModel = GetWorldBoneToModelOutOfLocal(parentIndex); //m_jointArray[parentIndex].m_boneToModelSpace.GetTranslation()
-                builder.AddLine(currentBoneToModel.GetTranslation(), parentBoneToModel.GetTranslation(), RGBA::SEA_GREEN);
-            }
-        }
-        m_bones = new MeshRenderer(new Mesh(), new Material(new ShaderProgram("Data/Shaders/fixedVertexFormat.vert", "Data/Shaders/fixedVertexFormat.frag"),
-            RenderState(RenderState::DepthTestingMode::OFF, RenderState::FaceCullingMode::RENDER_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND)));
-        m_bones->m_material->SetDiffuseTexture(Renderer::instance->m_defaultTexture);
-        builder.CopyToMesh(m_bones->m_mesh, &Vertex_PCUTB::Copy, sizeof(Vertex_PCUTB), &Vertex_PCUTB::BindMeshToVAO);
-    }
-    m_joints->Render();
-    m_bones->Render();
-}
-
 void Skeleton::SetWorldBoneToModelAndCacheLocal(const Matrix4x4& mat, const int& index)
 {
     //Verify not accessing invalid index
@@ -232,7 +166,7 @@ void Skeleton::SetWorldBoneToModelAndCacheLocal(const Matrix4x4& mat, const int&
     if (m_jointArray[index].m_parentIndex != -1)
     {
         Matrix4x4 parentMat = GetWorldBoneToModelOutOfLocal(m_jointArray[index].m_parentIndex);
-        Matrix4x4::MatrixInvert(&parentMat);
+        Matrix4x4::MatrixInvertAffine(&parentMat);
         Matrix4x4::MatrixMultiply(&copyAble, &mat, &parentMat);
     }
     m_jointArray[index].m_localBoneToModelSpace = copyAble;
@@ -293,6 +227,98 @@ void Skeleton::SetLocalBoneToModelAndWorldUpdate(const Matrix4x4& mat, const int
     }
 }
 
+//-----------------------------------------------------------------------------------
+//Recalculates every world matrix from the current locals in a single pass.
+//Parents are expected to come before their children (see ReorderJointsDepthFirst), any joint that breaks that falls back to walking its chain.
+void Skeleton::UpdateWorldFromLocals()
+{
+    for (size_t i = 0; i < m_jointArray.size(); i++)
+    {
+        Joint& joint = m_jointArray[i];
+        int parentIndex = joint.m_parentIndex;
+        if (parentIndex == -1)
+        {
+            joint.m_boneToModelSpace = joint.m_localBoneToModelSpace;
+        }
+        else if (parentIndex < (int)i)
+        {
+            Matrix4x4::MatrixMultiply(&joint.m_boneToModelSpace, &joint.m_localBoneToModelSpace, &m_jointArray[parentIndex].m_boneToModelSpace);
+        }
+        else
+        {
+            joint.m_boneToModelSpace = GetWorldBoneToModelOutOfLocal(i);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Puts the joints into depth-first order: every parent comes before its children, and every subtree is a contiguous range.
+//Siblings keep their original relative order. Returns the old->new index table so anything indexing joints can be remapped to match.
+std::vector<int> Skeleton::ReorderJointsDepthFirst()
+{
+    const int numJoints = (int)m_jointArray.size();
+
+    //Build child lists from the parent indices, m_children isn't filled in for skeletons read from disk.
+    std::vector<std::vector<int>> children(numJoints);
+    for (int i = 0; i < numJoints; ++i)
+    {
+        int parentIndex = m_jointArray[i].m_parentIndex;
+        if (parentIndex != -1)
+        {
+            ASSERT_OR_DIE(parentIndex >= 0 && parentIndex < numJoints, "Joint had an invalid parent index!");
+            children[parentIndex].push_back(i);
+        }
+    }
+
+    std::vector<int> oldToNew(numJoints, (int)INVALID_JOINT_INDEX);
+    std::vector<int> newToOld;
+    newToOld.reserve(numJoints);
+    std::vector<int> stack;
+    for (int rootIndex = 0; rootIndex < numJoints; ++rootIndex)
+    {
+        if (m_jointArray[rootIndex].m_parentIndex != -1)
+        {
+            continue;
+        }
+        stack.push_back(rootIndex);
+        while (!stack.empty())
+        {
+            int oldIndex = stack.back();
+            stack.pop_back();
+            oldToNew[oldIndex] = (int)newToOld.size();
+            newToOld.push_back(oldIndex);
+
+            //Push in reverse so the first child gets popped first.
+            for (auto iter = children[oldIndex].rbegin(); iter != children[oldIndex].rend(); ++iter)
+            {
+                stack.push_back(*iter);
+            }
+        }
+    }
+    ASSERT_OR_DIE((int)newToOld.size() == numJoints, "Skeleton had joints that weren't reachable from a root!");
+
+    std::vector<Joint> reorderedJoints;
+    reorderedJoints.reserve(numJoints);
+    for (int newIndex = 0; newIndex < numJoints; ++newIndex)
+    {
+        Joint joint = m_jointArray[newToOld[newIndex]];
+        joint.m_parentIndex = (joint.m_parentIndex == -1) ? -1 : oldToNew[joint.m_parentIndex];
+        joint.m_children.clear();
+        reorderedJoints.push_back(joint);
+    }
+    for (int newIndex = 0; newIndex < numJoints; ++newIndex)
+    {
+        int parentIndex = reorderedJoints[newIndex].m_parentIndex;
+        if (parentIndex != -1)
+        {
+            reorderedJoints[parentIndex].m_children.push_back(newIndex);
+        }
+    }
+    m_jointArray.swap(reorderedJoints);
+
+    return oldToNew;
+}
+
 //void Skeleton::SetLocalBoneToModel(const Matrix4x4& mat, const int& index)
 //{
 //    if (index < 0 || index >= (int)m_jointArray.size())
@@ -392,7 +418,7 @@ void Skeleton::WriteToStream(IBinaryWriter& writer)
     //Joint Heirarchy
     //Initial Model Space
 
-    writer.Write<uint32_t>(FILE_VERSION);
+    writer.Write<uint32_t>((uint32_t)FILE_VERSION);
     writer.Write<uint32_t>(m_jointArray.size());
     
     for (size_t i = 0; i < m_jointArray.size(); i++)//const std::string& str : m_names)
@@ -407,12 +433,7 @@ void Skeleton::WriteToStream(IBinaryWriter& writer)
     }
     for (size_t i = 0; i < m_jointArray.size(); i++)//const Matrix4x4& mat : m_boneToModelSpace)
     {
-        Matrix4x4 mat = m_jointArray.at(i).m_boneToModelSpace;
-        //writer.WriteBytes(mat.data, 16);
-        for (int j = 0; j < 16; ++j)
-        {
-            writer.Write<float>(mat.data[j]);
-        }
+        writer.WriteArray(m_jointArray.at(i).m_boneToModelSpace.data, 16);
     }
 }
 
@@ -434,9 +455,7 @@ void Skeleton::ReadFromStream(IBinaryReader& reader)
 
     for (unsigned int i = 0; i < numberOfJoints; ++i)
     {
-        const char* jointName = nullptr;
-        reader.ReadString(jointName, 64);
-        m_jointArray.at(i).m_name = (jointName);
+        reader.ReadString(m_jointArray.at(i).m_name);
     }
     for (unsigned int i = 0; i < numberOfJoints; ++i)
     {
@@ -446,13 +465,7 @@ void Skeleton::ReadFromStream(IBinaryReader& reader)
     }
     for (unsigned int i = 0; i < numberOfJoints; ++i)
     {
-        Matrix4x4 matrix = Matrix4x4::IDENTITY;
-        for (int j = 0; j < 16; ++j)
-        {
-            reader.Read<float>(matrix.data[j]);
-        }
-        m_jointArray.at(i).m_boneToModelSpace = matrix;
-        //m_boneToModelSpace.push_back(Matrix4x4((float*)reader.ReadBytes(16)));
+        ASSERT_OR_DIE(reader.ReadArray(m_jointArray.at(i).m_boneToModelSpace.data, 16), "Failed to read bone to model space");
         //Matrix4x4 invertedMatrix = m_boneToModelSpace[i];
         //Matrix4x4::MatrixInvert(&invertedMatrix);
         //m_modelToBoneSpace.push_back(invertedMatrix);
@@ -462,10 +475,8 @@ void Skeleton::ReadFromStream(IBinaryReader& reader)
 //-----------------------------------------------------------------------------------
 void Skeleton::ReadFromFile(const char* filename)
 {
-    BinaryFileReader reader;
-    ASSERT_OR_DIE(reader.Open(filename), "File Open failed!");
-    {
-        ReadFromStream(reader);
-    }
-    reader.Close();
+    FileView file;
+    ASSERT_OR_DIE(file.Open(filename), "File Open failed!");
+    BinaryMemoryReader reader(file.GetData(), file.GetSize());
+    ReadFromStream(reader);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <memory>
 #include "Engine/Math/Matrix4x4.hpp"
 #include "Engine/Input/BinaryReader.hpp"
 #include "Engine/Input/BinaryWriter.hpp"
@@ -39,11 +40,14 @@ public:
     void Render() const;
     void SetWorldBoneToModelAndCacheLocal(const Matrix4x4& mat, const int& index);
     void SetLocalBoneToModelAndWorldUpdate(const Matrix4x4& mat, const int& index);
+    void UpdateWorldFromLocals();
+    std::vector<int> ReorderJointsDepthFirst();
 
     //GETTERS//////////////////////////////////////////////////////////////////////////
     uint32_t GetJointCount();
     Joint GetJoint(int index);
     const Matrix4x4 GetWorldBoneToModelOutOfLocal(const int& currentIndex) const;
+    int GetSubtreeEndIndex(int jointIndex) const;
     const BoneMask GetBoneMaskForJointName(const std::string& name, const float& flo = 1.f) const;
     const BoneMask GetBoneMaskForJointNames(const std::vector<std::string>& name, const float& flo = 1.f) const;
     //FILE IO//////////////////////////////////////////////////////////////////////////
@@ -58,8 +62,10 @@ public:
     //std::vector<int> m_parentIndices;
     //std::vector<Matrix4x4> m_modelToBoneSpace;
     //std::vector<Matrix4x4> m_boneToModelSpace;
-    mutable MeshRenderer* m_joints;
-    mutable MeshRenderer* m_bones;
+    //Only created once the skeleton has been rendered. They come with a deleter from SkeletonRender.cpp,
+    //so skeletons can be made and destroyed in builds that don't link the renderer.
+    mutable std::shared_ptr<MeshRenderer> m_joints;
+    mutable std::shared_ptr<MeshRenderer> m_bones;
 
     static const unsigned int FILE_VERSION = 1;
     static const int INVALID_JOINT_INDEX = -1;
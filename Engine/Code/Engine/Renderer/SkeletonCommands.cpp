@@ -0,0 +1,39 @@
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Input/Console.hpp"
+
+//The console side of Skeleton, kept out of Skeleton.cpp so the cooker can read and write skeletons without linking the console.
+extern Skeleton* g_loadedSkeleton;
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(saveSkel)
+{
+    if (!args.HasArgs(1))
+    {
+        Console::instance->PrintLine("saveSkel <filename>", RGBA::RED);
+        return;
+    }
+    std::string filename = args.GetStringArgument(0);
+    if (!g_loadedSkeleton)
+    {
+        Console::instance->PrintLine("Error: No skeleton has been loaded yet, use fbxLoad to bring in a mesh with a skeleton first.", RGBA::RED);
+        return;
+    }
+    g_loadedSkeleton->WriteToFile(filename.c_str());
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(loadSkel)
+{
+    if (!args.HasArgs(1))
+    {
+        Console::instance->PrintLine("loadSkel <filename>", RGBA::RED);
+        return;
+    }
+    std::string filename = args.GetStringArgument(0);
+    if (g_loadedSkeleton)
+    {
+        delete g_loadedSkeleton;
+    }
+    g_loadedSkeleton = new Skeleton();
+    g_loadedSkeleton->ReadFromFile(filename.c_str());
+}
@@ -0,0 +1,56 @@
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/MeshRenderer.hpp"
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/VertexLayout.hpp"
+#include "Engine/Renderer/ShaderProgram.hpp"
+#include "Engine/Renderer/Material.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+
+//The GL side of Skeleton: the joints and bones it draws for debugging.
+
+//-----------------------------------------------------------------------------------
+static void DeleteDebugMesh(MeshRenderer* renderer)
+{
+    delete renderer->m_mesh;
+    delete renderer->m_material;
+    delete renderer;
+}
+
+//-----------------------------------------------------------------------------------
+void Skeleton::Render() const
+{
+    if (!m_joints)
+    {
+        MeshBuilder builder;
+        for (size_t i = 0; i < m_jointArray.size(); i++)// const Matrix4x4& modelSpaceMatrix : m_boneToModelSpace)
+        {
+            const Matrix4x4 modelSpaceMatrix = GetWorldBoneToModelOutOfLocal(i);// m_jointArray.at(i).m_boneToModelSpace;
+            builder.AddIcoSphere(1.0f, RGBA::BLUE, 0, modelSpaceMatrix.GetTranslation());
+        }
+        m_joints = std::shared_ptr<MeshRenderer>(new MeshRenderer(new Mesh(), new Material(new ShaderProgram("Data/Shaders/fixedVertexFormat.vert", "Data/Shaders/fixedVertexFormat.frag"), 
+            RenderState(RenderState::DepthTestingMode::OFF, RenderState::FaceCullingMode::RENDER_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND))), DeleteDebugMesh);
+        m_joints->m_material->SetDiffuseTexture(Renderer::instance->m_defaultTexture);
+        builder.CopyToMesh<Layout_PCUTB>(m_joints->m_mesh);
+    }
+    if (!m_bones)
+    {
+        MeshBuilder builder;
+        for (unsigned int i = 0; i < m_jointArray.size(); i++)
+        {
+            int parentIndex = m_jointArray[i].m_parentIndex;
+            if (parentIndex >= 0)
+            {
+                Matrix4x4 currentBoneToModel = GetWorldBoneToModelOutOfLocal(i); //m_jointArray[i].m_boneToModelSpace.GetTranslation()
+                Matrix4x4 parentBoneToModel = GetWorldBoneToModelOutOfLocal(parentIndex); //m_jointArray[parentIndex].m_boneToModelSpace.GetTranslation()
+                builder.AddLine(currentBoneToModel.GetTranslation(), parentBoneToModel.GetTranslation(), RGBA::SEA_GREEN);
+            }
+        }
+        m_bones = std::shared_ptr<MeshRenderer>(new MeshRenderer(new Mesh(), new Material(new ShaderProgram("Data/Shaders/fixedVertexFormat.vert", "Data/Shaders/fixedVertexFormat.frag"),
+            RenderState(RenderState::DepthTestingMode::OFF, RenderState::FaceCullingMode::RENDER_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND))), DeleteDebugMesh);
+        m_bones->m_material->SetDiffuseTexture(Renderer::instance->m_defaultTexture);
+        builder.CopyToMesh<Layout_PCUTB>(m_bones->m_mesh);
+    }
+    m_joints->Render();
+    m_bones->Render();
+}
@@ -11,6 +11,15 @@ SpriteSheet::SpriteSheet(const std::string& imageFilePath, int tilesWide, int ti
 
 }
 
+//-----------------------------------------------------------------------------------
+SpriteSheet::SpriteSheet(Texture* texture, int tilesWide, int tilesHigh)
+: m_spriteLayout(Vector2Int(tilesWide, tilesHigh))
+, m_spriteSheetTexture(texture)
+, m_texCoordsPerTile(Vector2(1.0f / tilesWide, 1.0f / tilesHigh))
+{
+
+}
+
 //-----------------------------------------------------------------------------------
 AABB2 SpriteSheet::GetTexCoordsForSpriteCoords(const Vector2Int& spriteCoords) const
 {
@@ -10,6 +10,7 @@ class SpriteSheet
 public:
 	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
 	SpriteSheet(const std::string& imageFilePath, int tilesWide, int tilesHigh);
+	SpriteSheet(Texture* texture, int tilesWide, int tilesHigh);
 
 	//GETTERS//////////////////////////////////////////////////////////////////////////
 	AABB2 GetTexCoordsForSpriteCoords(const Vector2Int& spriteCoords) const; // mostly for atlases
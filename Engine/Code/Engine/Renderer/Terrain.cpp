@@ -0,0 +1,557 @@
+#include "Engine/Renderer/Terrain.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/MeshRenderer.hpp"
+#include "Engine/Renderer/VertexLayout.hpp"
+#include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Math/Noise.hpp"
+#include "Engine/Math/Vector2Int.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <gl/GL.h>
+#include "Engine/Renderer/OpenGLExtensions.hpp"
+
+//Normal mapped and unquantized, so every chunk converts on its own without needing the bounds of the whole terrain.
+typedef Layout_PCUTB TerrainLayout;
+
+//-----------------------------------------------------------------------------------
+//Same order as MeshBuilder::AddQuadIndices.
+static inline void AddQuad(std::vector<unsigned int>& indices, unsigned int tl, unsigned int tr, unsigned int bl, unsigned int br)
+{
+    indices.push_back(br);
+    indices.push_back(tl);
+    indices.push_back(bl);
+    indices.push_back(br);
+    indices.push_back(tr);
+    indices.push_back(tl);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(terrainTest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("terrainTest <optional heightfield size, 513 by default>", RGBA::RED);
+        return;
+    }
+    unsigned int size = args.HasArgs(1) ? args.GetIntArgument(0) : 513;
+    TerrainSettings settings;
+    if (size <= settings.chunkSize)
+    {
+        Console::instance->PrintLine(Stringf("The heightfield needs to be at least %i samples across.", settings.chunkSize + 1), RGBA::RED);
+        return;
+    }
+    unsigned int numChunks = (size - 1) / settings.chunkSize;
+    Heightfield* heightfield = Heightfield::CreateFromNoise(size, size, HeightfieldNoise(), 32.0f);
+
+    //Every chunk at every LOD on this thread, one after the other.
+    std::vector<std::vector<TerrainLayout::Vertex>> synchronousChunks;
+    double startTime = GetCurrentTimeSeconds();
+    for (unsigned int lod = 0; lod < settings.numLODs; ++lod)
+    {
+        for (unsigned int chunkIndex = 0; chunkIndex < numChunks * numChunks; ++chunkIndex)
+        {
+            MeshBuilder builder;
+            builder.SetVertexStorage(MeshBuilder::STREAM_STORAGE);
+            Terrain::BuildChunk(*heightfield, settings, chunkIndex % numChunks, chunkIndex / numChunks, lod, builder);
+            synchronousChunks.emplace_back(builder.GetVertexCount());
+            TerrainLayout::ConvertVertices(builder, synchronousChunks.back().data());
+        }
+    }
+    double synchronousSeconds = GetCurrentTimeSeconds() - startTime;
+
+    //The same chunks through a headless loader, which have to come out byte for byte the same.
+    AsyncLoader loader(0, true);
+    std::vector<std::shared_ptr<std::vector<TerrainLayout::Vertex>>> asyncChunks;
+    startTime = GetCurrentTimeSeconds();
+    for (unsigned int lod = 0; lod < settings.numLODs; ++lod)
+    {
+        for (unsigned int chunkIndex = 0; chunkIndex < numChunks * numChunks; ++chunkIndex)
+        {
+            std::shared_ptr<std::vector<TerrainLayout::Vertex>> vertices = std::make_shared<std::vector<TerrainLayout::Vertex>>();
+            asyncChunks.push_back(vertices);
+            loader.Enqueue("terrainTest",
+                [heightfield, settings, chunkIndex, numChunks, lod, vertices](void*&)
+                {
+                    MeshBuilder builder;
+                    builder.SetVertexStorage(MeshBuilder::STREAM_STORAGE);
+                    Terrain::BuildChunk(*heightfield, settings, chunkIndex % numChunks, chunkIndex / numChunks, lod, builder);
+                    vertices->resize(builder.GetVertexCount());
+                    TerrainLayout::ConvertVertices(builder, vertices->data());
+                    return true;
+                }, nullptr);
+        }
+    }
+    loader.Flush();
+    double asyncSeconds = GetCurrentTimeSeconds() - startTime;
+
+    bool passed = true;
+    for (unsigned int i = 0; i < synchronousChunks.size(); ++i)
+    {
+        const std::vector<TerrainLayout::Vertex>& expected = synchronousChunks[i];
+        const std::vector<TerrainLayout::Vertex>& actual = *asyncChunks[i];
+        passed = passed && expected.size() == actual.size() && memcmp(expected.data(), actual.data(), expected.size() * sizeof(TerrainLayout::Vertex)) == 0;
+    }
+    delete heightfield;
+    Console::instance->PrintLine(Stringf("%i chunks at %i LODs on %i workers. Synchronous: %.2f ms, async: %.2f ms. %s", numChunks * numChunks, settings.numLODs, loader.GetWorkerCount(),
+        synchronousSeconds * 1000.0, asyncSeconds * 1000.0, passed ? "Passed." : "FAILED!"), passed ? RGBA::GREEN : RGBA::RED);
+}
+
+//-----------------------------------------------------------------------------------
+//Streams a flat strip of four chunks through a headless loader, which builds the vertices but never makes the meshes.
+//The camera starts over one end of the strip, moves to the other end, then comes back.
+CONSOLE_COMMAND(terrainStreamingTest)
+{
+    UNUSED(args);
+    TerrainSettings settings;
+    settings.chunkSize = 16;
+    settings.numLODs = 3;
+    settings.lodDistance = 16.0f;
+    settings.sampleSpacing = 1.0f;
+    const unsigned int lodBytes[] =
+    {
+        Terrain::GetChunkVertexCount(settings, 0) * sizeof(TerrainLayout::Vertex),
+        Terrain::GetChunkVertexCount(settings, 1) * sizeof(TerrainLayout::Vertex),
+        Terrain::GetChunkVertexCount(settings, 2) * sizeof(TerrainLayout::Vertex)
+    };
+    //One end's chunks want LODs 0, 0, 1 and 2, so that's all there's room for.
+    settings.memoryBudgetBytes = lodBytes[0] + lodBytes[0] + lodBytes[1] + lodBytes[2];
+
+    AsyncLoader loader(1, true);
+    Terrain terrain(new Heightfield((4 * settings.chunkSize) + 1, settings.chunkSize + 1), settings, nullptr, &loader);
+    bool passed = terrain.GetNumChunksX() == 4 && terrain.GetNumChunksZ() == 1;
+
+    //Every doubling of the distance past lodDistance drops a LOD, until there aren't any left.
+    passed = passed && terrain.SelectLOD(0.0f) == 0 && terrain.SelectLOD(15.9f) == 0;
+    passed = passed && terrain.SelectLOD(16.0f) == 1 && terrain.SelectLOD(31.9f) == 1;
+    passed = passed && terrain.SelectLOD(32.0f) == 2 && terrain.SelectLOD(1000.0f) == 2;
+
+    //Over chunk 0, the chunks' squares are 0, 8, 24 and 40 units away.
+    const Vector3 westCamera(8.0f, 0.0f, 8.0f);
+    terrain.Update(westCamera);
+    loader.Flush();
+    passed = passed && terrain.GetNumCachedChunks() == 4 && terrain.GetCachedBytes() == settings.memoryBudgetBytes;
+    passed = passed && terrain.IsChunkCached(0, 0, 0) && terrain.IsChunkCached(1, 0, 0) && terrain.IsChunkCached(2, 0, 1) && terrain.IsChunkCached(3, 0, 2);
+    passed = passed && terrain.GetNumVisibleChunks() == 0;
+
+    //Over chunk 3 every chunk wants a different LOD than before, so everything from the first frame gets evicted.
+    terrain.Update(Vector3(56.0f, 0.0f, 8.0f));
+    loader.Flush();
+    passed = passed && terrain.GetNumCachedChunks() == 4 && terrain.GetCachedBytes() <= settings.memoryBudgetBytes;
+    passed = passed && terrain.IsChunkCached(0, 0, 2) && terrain.IsChunkCached(1, 0, 1) && terrain.IsChunkCached(2, 0, 0) && terrain.IsChunkCached(3, 0, 0);
+    passed = passed && !terrain.IsChunkCached(0, 0, 0) && !terrain.IsChunkCached(3, 0, 2);
+
+    //Coming back has to build the evicted chunks again.
+    terrain.Update(westCamera);
+    loader.Flush();
+    passed = passed && terrain.GetNumCachedChunks() == 4 && terrain.GetCachedBytes() <= settings.memoryBudgetBytes;
+    passed = passed && terrain.IsChunkCached(0, 0, 0) && terrain.IsChunkCached(1, 0, 0) && terrain.IsChunkCached(2, 0, 1) && terrain.IsChunkCached(3, 0, 2);
+    passed = passed && !terrain.IsChunkCached(0, 0, 2) && !terrain.IsChunkCached(3, 0, 0);
+
+    Console::instance->PrintLine(passed ? "Passed." : "FAILED!", passed ? RGBA::GREEN : RGBA::RED);
+}
+
+//HEIGHTFIELD//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+Heightfield::Heightfield(unsigned int width, unsigned int depth)
+    : m_width(width)
+    , m_depth(depth)
+    , m_heights(width * depth, 0.0f)
+{
+    ASSERT_OR_DIE(width > 0 && depth > 0, "Heightfields need at least one sample");
+}
+
+//-----------------------------------------------------------------------------------
+Heightfield* Heightfield::CreateFromImage(const std::string& imageFilePath, float maxHeight)
+{
+    int numComponents = 0;
+    Vector2Int texelSize(0, 0);
+    unsigned char* imageData = Texture::LoadImageData(imageFilePath, numComponents, texelSize);
+    if (imageData == nullptr)
+    {
+        return nullptr;
+    }
+    Heightfield* heightfield = new Heightfield(texelSize.x, texelSize.y);
+    const float heightPerValue = maxHeight / 255.0f;
+    for (unsigned int i = 0; i < heightfield->m_heights.size(); ++i)
+    {
+        heightfield->m_heights[i] = (float)imageData[i * numComponents] * heightPerValue;
+    }
+    Texture::FreeImageData(imageData);
+    return heightfield;
+}
+
+//-----------------------------------------------------------------------------------
+Heightfield* Heightfield::CreateFromNoise(unsigned int width, unsigned int depth, const HeightfieldNoise& noise, float maxHeight)
+{
+    Heightfield* heightfield = new Heightfield(width, depth);
+    for (unsigned int z = 0; z < depth; ++z)
+    {
+        for (unsigned int x = 0; x < width; ++x)
+        {
+            float value = Compute2dFractalNoise((float)x, (float)z, noise.scale, noise.numOctaves, noise.octavePersistence, noise.octaveScale, true, noise.seed);
+            heightfield->SetHeight(x, z, ((value * 0.5f) + 0.5f) * maxHeight);
+        }
+    }
+    return heightfield;
+}
+
+//-----------------------------------------------------------------------------------
+float Heightfield::GetHeight(int x, int z) const
+{
+    x = x < 0 ? 0 : (x >= (int)m_width ? (int)m_width - 1 : x);
+    z = z < 0 ? 0 : (z >= (int)m_depth ? (int)m_depth - 1 : z);
+    return m_heights[(z * m_width) + x];
+}
+
+//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+Terrain::Terrain(Heightfield* heightfield, const TerrainSettings& settings, Material* material, AsyncLoader* loader)
+    : m_heightfield(heightfield)
+    , m_settings(settings)
+    , m_material(material)
+    , m_loader(loader)
+    , m_numChunksX((heightfield->m_width - 1) / settings.chunkSize)
+    , m_numChunksZ((heightfield->m_depth - 1) / settings.chunkSize)
+    , m_lodIndices(settings.numLODs)
+    , m_lodIndexBuffers(settings.numLODs, 0)
+    , m_lodSizeofIndex(settings.numLODs, sizeof(unsigned int))
+    , m_cachedBytes(0)
+    , m_frameNumber(0)
+{
+    ASSERT_OR_DIE(settings.numLODs > 0 && settings.chunkSize % (1 << (settings.numLODs - 1)) == 0, "Terrain chunk size has to be divisible by 2^(numLODs - 1)");
+    ASSERT_OR_DIE(m_numChunksX > 0 && m_numChunksZ > 0, "Heightfield is too small for even one terrain chunk");
+    for (unsigned int lod = 0; lod < settings.numLODs; ++lod)
+    {
+        BuildChunkIndices(settings, lod, m_lodIndices[lod]);
+        m_lodSizeofIndex[lod] = GetChunkVertexCount(settings, lod) <= 0xFFFF ? sizeof(unsigned short) : sizeof(unsigned int);
+    }
+    m_visibleChunks.reserve(m_numChunksX * m_numChunksZ);
+}
+
+//-----------------------------------------------------------------------------------
+Terrain::~Terrain()
+{
+    for (auto& pair : m_chunks)
+    {
+        DestroyChunk(pair.second);
+    }
+    for (unsigned int indexBuffer : m_lodIndexBuffers)
+    {
+        if (indexBuffer != 0)
+        {
+            Renderer::instance->RenderBufferDestroy(indexBuffer);
+        }
+    }
+    delete m_heightfield;
+}
+
+//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+//Asks for the LOD every chunk should be at, and draws the closest LOD it has ready in the meantime.
+void Terrain::Update(const Vector3& cameraPosition)
+{
+    ++m_frameNumber;
+    m_visibleChunks.clear();
+    const float chunkWorldSize = m_settings.chunkSize * m_settings.sampleSpacing;
+    for (unsigned int chunkZ = 0; chunkZ < m_numChunksZ; ++chunkZ)
+    {
+        for (unsigned int chunkX = 0; chunkX < m_numChunksX; ++chunkX)
+        {
+            //Flat distance to the chunk's square, with the height measured from its middle.
+            float minX = chunkX * chunkWorldSize;
+            float minZ = chunkZ * chunkWorldSize;
+            float dx = std::max(std::max(minX - cameraPosition.x, cameraPosition.x - (minX + chunkWorldSize)), 0.0f);
+            float dz = std::max(std::max(minZ - cameraPosition.z, cameraPosition.z - (minZ + chunkWorldSize)), 0.0f);
+            float centerHeight = m_heightfield->GetHeight((chunkX * m_settings.chunkSize) + (m_settings.chunkSize / 2), (chunkZ * m_settings.chunkSize) + (m_settings.chunkSize / 2));
+            float dy = cameraPosition.y - centerHeight;
+            unsigned int lod = SelectLOD(sqrt((dx * dx) + (dy * dy) + (dz * dz)));
+
+            CachedChunk& wanted = RequestChunk(chunkX, chunkZ, lod);
+            wanted.lastUsedFrame = m_frameNumber;
+            CachedChunk* drawn = IsChunkReady(wanted) ? &wanted : FindReadyChunk(chunkX, chunkZ, lod);
+            if (drawn)
+            {
+                drawn->lastUsedFrame = m_frameNumber;
+                m_visibleChunks.push_back(drawn->renderer);
+            }
+        }
+    }
+    EvictOverBudget();
+}
+
+//-----------------------------------------------------------------------------------
+void Terrain::Render() const
+{
+    for (const MeshRenderer* renderer : m_visibleChunks)
+    {
+        renderer->Render();
+    }
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int Terrain::SelectLOD(float distance) const
+{
+    unsigned int lod = 0;
+    float threshold = m_settings.lodDistance;
+    while (lod + 1 < m_settings.numLODs && distance >= threshold)
+    {
+        ++lod;
+        threshold *= 2.0f;
+    }
+    return lod;
+}
+
+//-----------------------------------------------------------------------------------
+//The grid's vertices row by row along x, then the bottom of the skirt along the south (first z), north, west (first x) and east edges.
+//Tangent frames come from the heightfield itself rather than the chunk's triangles, so the lighting matches across chunk edges.
+void Terrain::BuildChunk(const Heightfield& heightfield, const TerrainSettings& settings, unsigned int chunkX, unsigned int chunkZ, unsigned int lod, MeshBuilder& outBuilder)
+{
+    const unsigned int step = 1 << lod;
+    const unsigned int numQuads = settings.chunkSize >> lod;
+    const unsigned int rowCount = numQuads + 1;
+    const unsigned int gridCount = rowCount * rowCount;
+    const unsigned int vertexCount = GetChunkVertexCount(settings, lod);
+    const int firstX = chunkX * settings.chunkSize;
+    const int firstZ = chunkZ * settings.chunkSize;
+    const float differenceDistance = 2.0f * step * settings.sampleSpacing;
+    const Vector2 uvScale(1.0f / std::max(heightfield.m_width - 1, 1u), 1.0f / std::max(heightfield.m_depth - 1, 1u));
+
+    std::vector<Vector3> positions(vertexCount);
+    std::vector<Vector3> tangents(vertexCount);
+    std::vector<Vector3> bitangents(vertexCount);
+    std::vector<Vector3> normals(vertexCount);
+    std::vector<Vector2> uvs(vertexCount);
+    auto writeSample = [&](unsigned int index, int sampleX, int sampleZ, float heightOffset)
+    {
+        float heightDifferenceX = heightfield.GetHeight(sampleX + step, sampleZ) - heightfield.GetHeight(sampleX - step, sampleZ);
+        float heightDifferenceZ = heightfield.GetHeight(sampleX, sampleZ + step) - heightfield.GetHeight(sampleX, sampleZ - step);
+        positions[index] = Vector3(sampleX * settings.sampleSpacing, heightfield.GetHeight(sampleX, sampleZ) + heightOffset, sampleZ * settings.sampleSpacing);
+        tangents[index] = Vector3::GetNormalized(Vector3(differenceDistance, heightDifferenceX, 0.0f));
+        bitangents[index] = Vector3::GetNormalized(Vector3(0.0f, heightDifferenceZ, differenceDistance));
+        normals[index] = Vector3::GetNormalized(Vector3::Cross(bitangents[index], tangents[index]));
+        uvs[index] = Vector2(sampleX * uvScale.x, sampleZ * uvScale.y);
+    };
+
+    for (unsigned int z = 0; z < rowCount; ++z)
+    {
+        for (unsigned int x = 0; x < rowCount; ++x)
+        {
+            writeSample((z * rowCount) + x, firstX + (x * step), firstZ + (z * step), 0.0f);
+        }
+    }
+    const int lastOffset = settings.chunkSize;
+    for (unsigned int i = 0; i < rowCount; ++i)
+    {
+        int offset = i * step;
+        writeSample(gridCount + i, firstX + offset, firstZ, -settings.skirtDepth);
+        writeSample(gridCount + rowCount + i, firstX + offset, firstZ + lastOffset, -settings.skirtDepth);
+        writeSample(gridCount + (2 * rowCount) + i, firstX, firstZ + offset, -settings.skirtDepth);
+        writeSample(gridCount + (3 * rowCount) + i, firstX + lastOffset, firstZ + offset, -settings.skirtDepth);
+    }
+
+    outBuilder.Begin();
+    const MeshBuilder::AttributeSpan spans[] =
+    {
+        MeshBuilder::AttributeSpan(MeshBuilder::POSITION_BIT, positions.data()),
+        MeshBuilder::AttributeSpan(MeshBuilder::TANGENT_BIT, tangents.data()),
+        MeshBuilder::AttributeSpan(MeshBuilder::BITANGENT_BIT, bitangents.data()),
+        MeshBuilder::AttributeSpan(MeshBuilder::NORMAL_BIT, normals.data()),
+        MeshBuilder::AttributeSpan(MeshBuilder::UV0_BIT, uvs.data())
+    };
+    unsigned int firstVertex = outBuilder.AppendVertices(vertexCount, spans, sizeof(spans) / sizeof(spans[0]));
+    std::vector<unsigned int> indices;
+    BuildChunkIndices(settings, lod, indices);
+    outBuilder.AppendIndices(indices.data(), indices.size(), firstVertex);
+    outBuilder.End();
+}
+
+//-----------------------------------------------------------------------------------
+//Only depends on the LOD, which is what lets every chunk at that LOD share one index buffer.
+//Each skirt quad is wound to face out from the chunk, the same way the grid's quads face up.
+void Terrain::BuildChunkIndices(const TerrainSettings& settings, unsigned int lod, std::vector<unsigned int>& outIndices)
+{
+    const unsigned int numQuads = settings.chunkSize >> lod;
+    const unsigned int rowCount = numQuads + 1;
+    const unsigned int south = rowCount * rowCount;
+    const unsigned int north = south + rowCount;
+    const unsigned int west = north + rowCount;
+    const unsigned int east = west + rowCount;
+    auto grid = [rowCount](unsigned int x, unsigned int z) { return (z * rowCount) + x; };
+
+    outIndices.clear();
+    outIndices.reserve((numQuads * numQuads * 6) + (numQuads * 4 * 6));
+    for (unsigned int z = 0; z < numQuads; ++z)
+    {
+        for (unsigned int x = 0; x < numQuads; ++x)
+        {
+            AddQuad(outIndices, grid(x, z + 1), grid(x + 1, z + 1), grid(x, z), grid(x + 1, z));
+        }
+    }
+    for (unsigned int i = 0; i < numQuads; ++i)
+    {
+        AddQuad(outIndices, grid(i, 0), grid(i + 1, 0), south + i, south + i + 1);
+        AddQuad(outIndices, grid(i + 1, numQuads), grid(i, numQuads), north + i + 1, north + i);
+        AddQuad(outIndices, grid(0, i + 1), grid(0, i), west + i + 1, west + i);
+        AddQuad(outIndices, grid(numQuads, i), grid(numQuads, i + 1), east + i, east + i + 1);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int Terrain::GetChunkVertexCount(const TerrainSettings& settings, unsigned int lod)
+{
+    const unsigned int rowCount = (settings.chunkSize >> lod) + 1;
+    return (rowCount * rowCount) + (4 * rowCount);
+}
+
+//HELPER FUNCTIONS//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+//Starts loading the chunk if it isn't cached or on its way already.
+Terrain::CachedChunk& Terrain::RequestChunk(unsigned int chunkX, unsigned int chunkZ, unsigned int lod)
+{
+    unsigned int key = GetChunkKey(chunkX, chunkZ, lod);
+    auto found = m_chunks.find(key);
+    if (found != m_chunks.end())
+    {
+        return found->second;
+    }
+
+    CachedChunk& chunk = m_chunks[key];
+    chunk.numBytes = GetChunkVertexCount(m_settings, lod) * sizeof(TerrainLayout::Vertex);
+    m_cachedBytes += chunk.numBytes;
+
+    const Heightfield* heightfield = m_heightfield;
+    const TerrainSettings settings = m_settings;
+    const float boundingRadius = m_settings.chunkSize * m_settings.sampleSpacing * 0.5f * sqrt(2.0f);
+    std::shared_ptr<std::vector<TerrainLayout::Vertex>> vertices = std::make_shared<std::vector<TerrainLayout::Vertex>>();
+    chunk.handle = m_loader->Enqueue(Stringf("Terrain chunk %u, %u LOD %u", chunkX, chunkZ, lod),
+        [heightfield, settings, chunkX, chunkZ, lod, vertices](void*&)
+        {
+            MeshBuilder builder;
+            builder.SetVertexStorage(MeshBuilder::STREAM_STORAGE);
+            BuildChunk(*heightfield, settings, chunkX, chunkZ, lod, builder);
+            vertices->resize(builder.GetVertexCount());
+            TerrainLayout::ConvertVertices(builder, vertices->data());
+            return true;
+        },
+        [this, lod, vertices, boundingRadius](void*& outResult)
+        {
+            Mesh* mesh = new Mesh();
+            mesh->InitWithSharedIndices(vertices->data(), vertices->size(), sizeof(TerrainLayout::Vertex), GetIndexBuffer(lod), m_lodIndices[lod].size(), m_lodSizeofIndex[lod], &TerrainLayout::BindMeshToVAO);
+            mesh->m_boundingRadius = boundingRadius;
+            outResult = mesh;
+            return true;
+        });
+    return chunk;
+}
+
+//-----------------------------------------------------------------------------------
+//The nearest LOD to the one wanted that's ready to draw, finer ones first.
+Terrain::CachedChunk* Terrain::FindReadyChunk(unsigned int chunkX, unsigned int chunkZ, unsigned int lod)
+{
+    for (unsigned int distance = 1; distance < m_settings.numLODs; ++distance)
+    {
+        const int candidates[] = { (int)lod - (int)distance, (int)lod + (int)distance };
+        for (int candidate : candidates)
+        {
+            if (candidate < 0 || candidate >= (int)m_settings.numLODs)
+            {
+                continue;
+            }
+            auto found = m_chunks.find(GetChunkKey(chunkX, chunkZ, candidate));
+            if (found != m_chunks.end() && IsChunkReady(found->second))
+            {
+                return &found->second;
+            }
+        }
+    }
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+//A headless loader never makes the mesh, so chunks are never ready there.
+bool Terrain::IsChunkReady(CachedChunk& chunk)
+{
+    if (chunk.renderer)
+    {
+        return true;
+    }
+    if (!chunk.handle.IsReady() || chunk.handle.Get() == nullptr)
+    {
+        return false;
+    }
+    chunk.mesh = chunk.handle.Get();
+    chunk.renderer = new MeshRenderer(chunk.mesh, m_material);
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Uploaded the first time a chunk at this LOD needs it.
+unsigned int Terrain::GetIndexBuffer(unsigned int lod)
+{
+    if (m_lodIndexBuffers[lod] != 0)
+    {
+        return m_lodIndexBuffers[lod];
+    }
+    const std::vector<unsigned int>& indices = m_lodIndices[lod];
+    if (m_lodSizeofIndex[lod] == sizeof(unsigned short))
+    {
+        std::vector<unsigned short> shortIndices(indices.begin(), indices.end());
+        m_lodIndexBuffers[lod] = Renderer::instance->RenderBufferCreate(shortIndices.data(), shortIndices.size(), sizeof(unsigned short), GL_STATIC_DRAW);
+    }
+    else
+    {
+        m_lodIndexBuffers[lod] = Renderer::instance->RenderBufferCreate(const_cast<unsigned int*>(indices.data()), indices.size(), sizeof(unsigned int), GL_STATIC_DRAW);
+    }
+    GL_CHECK_ERROR();
+    return m_lodIndexBuffers[lod];
+}
+
+//-----------------------------------------------------------------------------------
+//Least recently used first. Anything used this frame stays, and so does anything still loading since its mesh is on the way.
+void Terrain::EvictOverBudget()
+{
+    if (m_cachedBytes <= m_settings.memoryBudgetBytes)
+    {
+        return;
+    }
+    std::vector<std::pair<unsigned int, unsigned int>> candidates;
+    for (auto& pair : m_chunks)
+    {
+        if (pair.second.lastUsedFrame != m_frameNumber && pair.second.handle.IsDone())
+        {
+            candidates.push_back(std::make_pair(pair.second.lastUsedFrame, pair.first));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (unsigned int i = 0; i < candidates.size() && m_cachedBytes > m_settings.memoryBudgetBytes; ++i)
+    {
+        auto found = m_chunks.find(candidates[i].second);
+        m_cachedBytes -= found->second.numBytes;
+        DestroyChunk(found->second);
+        m_chunks.erase(found);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Waits for a chunk that's still loading, since its steps point back at this terrain.
+void Terrain::DestroyChunk(CachedChunk& chunk)
+{
+    if (!chunk.handle.IsDone())
+    {
+        m_loader->Wait(chunk.handle);
+    }
+    delete chunk.renderer;
+    delete chunk.handle.Get();
+    chunk.renderer = nullptr;
+    chunk.mesh = nullptr;
+}
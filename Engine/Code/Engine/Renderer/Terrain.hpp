@@ -0,0 +1,135 @@
+#pragma once
+#include "Engine/Core/AsyncLoader.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+class Mesh;
+class MeshBuilder;
+class MeshRenderer;
+class Material;
+
+//-----------------------------------------------------------------------------------
+//Settings for Heightfield::CreateFromNoise, passed straight through to Compute2dFractalNoise.
+struct HeightfieldNoise
+{
+    HeightfieldNoise() : scale(64.0f), numOctaves(6), octavePersistence(0.5f), octaveScale(2.0f), seed(0) {};
+    float scale;
+    unsigned int numOctaves;
+    float octavePersistence;
+    float octaveScale;
+    unsigned int seed;
+};
+
+//-----------------------------------------------------------------------------------
+//A grid of heights, one per sample. Nothing here touches GL, so it can be built and read from any thread.
+class Heightfield
+{
+public:
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    Heightfield(unsigned int width, unsigned int depth);
+    //The image's first channel from 0 to 255 maps to heights from 0 to maxHeight. Returns null if the image couldn't be read.
+    static Heightfield* CreateFromImage(const std::string& imageFilePath, float maxHeight);
+    //The same settings always make the same heights, from 0 to maxHeight.
+    static Heightfield* CreateFromNoise(unsigned int width, unsigned int depth, const HeightfieldNoise& noise, float maxHeight);
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    //Samples off the edges get the nearest edge's height.
+    float GetHeight(int x, int z) const;
+    inline void SetHeight(unsigned int x, unsigned int z, float height) { m_heights[(z * m_width) + x] = height; };
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    unsigned int m_width;
+    unsigned int m_depth;
+    std::vector<float> m_heights;
+};
+
+//-----------------------------------------------------------------------------------
+struct TerrainSettings
+{
+    TerrainSettings() : chunkSize(64), numLODs(4), sampleSpacing(1.0f), lodDistance(64.0f), skirtDepth(4.0f), memoryBudgetBytes(32 * 1024 * 1024) {};
+    //Quads along each side of a chunk at LOD 0, has to be divisible by 2^(numLODs - 1).
+    unsigned int chunkSize;
+    unsigned int numLODs;
+    //World units between heightfield samples.
+    float sampleSpacing;
+    //Chunks closer than this are drawn at LOD 0, and every doubling of the distance after that drops a LOD.
+    float lodDistance;
+    //How far the skirts hang below the edges of a chunk, to cover the cracks where it meets a neighbour at another LOD.
+    float skirtDepth;
+    //Vertex buffers kept around for chunks that aren't being drawn anymore. The shared index buffers don't count.
+    unsigned int memoryBudgetBytes;
+};
+
+//-----------------------------------------------------------------------------------
+//Splits a heightfield into square chunks and streams their meshes in on the AsyncLoader's workers, picking each chunk's LOD
+//by its distance from the camera. A chunk draws whatever LOD it already has until the one it wants is ready.
+//
+//Every chunk at a LOD has the same vertex layout, so they all draw from one index buffer per LOD. Neighbours at different LODs
+//don't share edge vertices, so each chunk has a skirt hanging down from its edges to hide the cracks instead of stitching them.
+//Chunk vertices are in world space, with the heightfield's first sample at the origin and the heights going up.
+//
+//Owns the heightfield. Update and Render are main thread only, BuildChunk and BuildChunkIndices are safe anywhere (ie: headless).
+class Terrain
+{
+public:
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    Terrain(Heightfield* heightfield, const TerrainSettings& settings, Material* material, AsyncLoader* loader = AsyncLoader::instance);
+    ~Terrain();
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    void Update(const Vector3& cameraPosition);
+    void Render() const;
+    unsigned int SelectLOD(float distance) const;
+    //Positions, UVs and tangent frames for one chunk (see BuildChunkIndices for the order they're in).
+    static void BuildChunk(const Heightfield& heightfield, const TerrainSettings& settings, unsigned int chunkX, unsigned int chunkZ, unsigned int lod, MeshBuilder& outBuilder);
+    static void BuildChunkIndices(const TerrainSettings& settings, unsigned int lod, std::vector<unsigned int>& outIndices);
+    static unsigned int GetChunkVertexCount(const TerrainSettings& settings, unsigned int lod);
+
+    //GETTERS//////////////////////////////////////////////////////////////////////////
+    inline unsigned int GetNumChunksX() const { return m_numChunksX; };
+    inline unsigned int GetNumChunksZ() const { return m_numChunksZ; };
+    inline unsigned int GetCachedBytes() const { return m_cachedBytes; };
+    inline unsigned int GetNumCachedChunks() const { return m_chunks.size(); };
+    inline unsigned int GetNumVisibleChunks() const { return m_visibleChunks.size(); };
+    //Whether the chunk is cached at that LOD, loading or not.
+    inline bool IsChunkCached(unsigned int chunkX, unsigned int chunkZ, unsigned int lod) const { return m_chunks.find(GetChunkKey(chunkX, chunkZ, lod)) != m_chunks.end(); };
+
+private:
+    //STRUCTS//////////////////////////////////////////////////////////////////////////
+    struct CachedChunk
+    {
+        CachedChunk() : mesh(nullptr), renderer(nullptr), numBytes(0), lastUsedFrame(0) {};
+        AssetHandle<Mesh> handle;
+        Mesh* mesh;
+        MeshRenderer* renderer;
+        unsigned int numBytes;
+        unsigned int lastUsedFrame;
+    };
+
+    //HELPER FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    Terrain(const Terrain&);
+    CachedChunk& RequestChunk(unsigned int chunkX, unsigned int chunkZ, unsigned int lod);
+    CachedChunk* FindReadyChunk(unsigned int chunkX, unsigned int chunkZ, unsigned int lod);
+    bool IsChunkReady(CachedChunk& chunk);
+    unsigned int GetIndexBuffer(unsigned int lod);
+    void EvictOverBudget();
+    void DestroyChunk(CachedChunk& chunk);
+    inline unsigned int GetChunkKey(unsigned int chunkX, unsigned int chunkZ, unsigned int lod) const { return (((chunkZ * m_numChunksX) + chunkX) * m_settings.numLODs) + lod; };
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    Heightfield* m_heightfield;
+    TerrainSettings m_settings;
+    Material* m_material;
+    AsyncLoader* m_loader;
+    unsigned int m_numChunksX;
+    unsigned int m_numChunksZ;
+    std::map<unsigned int, CachedChunk> m_chunks;
+    std::vector<std::vector<unsigned int>> m_lodIndices;
+    std::vector<unsigned int> m_lodIndexBuffers;
+    std::vector<unsigned int> m_lodSizeofIndex;
+    std::vector<const MeshRenderer*> m_visibleChunks;
+    unsigned int m_cachedBytes;
+    unsigned int m_frameNumber;
+};
@@ -9,6 +9,7 @@
 #include <gl/GLU.h>
 #include "Engine/Renderer/OpenGLExtensions.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Input/FileView.hpp"
 
 #define STBI_HEADER_FILE_ONLY
 #include "ThirdParty/stb_image.c"
@@ -25,8 +26,8 @@ Texture::Texture( const std::string& imageFilePath )
 	, m_imageData(nullptr)
 {
 	int numComponents = 0; // Filled in for us to indicate how many color/alpha components the image had (e.g. 3=RGB, 4=RGBA)
-	int numComponentsRequested = 0; // don't care; we support 3 (RGB) or 4 (RGBA)
-	m_imageData = stbi_load( imageFilePath.c_str(), &m_texelSize.x, &m_texelSize.y, &numComponents, numComponentsRequested );
+	m_imageData = LoadImageData( imageFilePath, numComponents, m_texelSize );
+	ASSERT_OR_DIE( m_imageData != nullptr, "Failed to load texture " + imageFilePath );
 
 	// Enable texturing
 	glEnable( GL_TEXTURE_2D );
@@ -121,6 +122,7 @@ Texture::Texture(unsigned char* textureData, int numColorComponents, const Vecto
 }
 
 Texture::Texture(uint32_t width, uint32_t height, TextureFormat format)
+	: m_imageData(nullptr)
 {
 	glGenTextures(1, &m_openglTextureID);
 	GLenum bufferChannels = GL_RGBA;
@@ -166,6 +168,7 @@ unsigned char* Texture::GetImageData()
 //-----------------------------------------------------------------------------------
 Texture::~Texture()
 {
+	glDeleteTextures(1, (GLuint*)&m_openglTextureID);
 	stbi_image_free(m_imageData);
 }
 
@@ -215,3 +218,38 @@ Texture* Texture::CreateTextureFromData(const std::string& textureName, unsigned
 	return texture;
 }
 
+//-----------------------------------------------------------------------------------
+STATIC void Texture::ReleaseTexture(Texture* texture)
+{
+	for (auto iterator = Texture::s_textureRegistry.begin(); iterator != Texture::s_textureRegistry.end();)
+	{
+		if (iterator->second == texture)
+		{
+			iterator = Texture::s_textureRegistry.erase(iterator);
+		}
+		else
+		{
+			++iterator;
+		}
+	}
+	delete texture;
+}
+
+//-----------------------------------------------------------------------------------
+STATIC unsigned char* Texture::LoadImageData( const std::string& imageFilePath, int& outNumComponents, Vector2Int& outTexelSize )
+{
+	int numComponentsRequested = 0; // don't care; we support 3 (RGB) or 4 (RGBA)
+	//Decode straight out of the file view rather than letting stb read its own copy of the file.
+	FileView imageFile;
+	if( !imageFile.Open( imageFilePath.c_str() ) )
+	{
+		return nullptr;
+	}
+	return stbi_load_from_memory( imageFile.GetData(), (int)imageFile.GetSize(), &outTexelSize.x, &outTexelSize.y, &outNumComponents, numComponentsRequested );
+}
+
+//-----------------------------------------------------------------------------------
+STATIC void Texture::FreeImageData( unsigned char* imageData )
+{
+	stbi_image_free( imageData );
+}
@@ -17,6 +17,11 @@ public:
 	~Texture();
 	static Texture* CreateOrGetTexture(const std::string& imageFilePath);
 	static Texture* CreateTextureFromData(const std::string& textureName, unsigned char* textureData, int numComponents, const Vector2Int& texelSize);
+	//CPU side of loading a texture, safe to call off the main thread. Hand the data to CreateTextureFromData or free it with FreeImageData.
+	static unsigned char* LoadImageData(const std::string& imageFilePath, int& outNumComponents, Vector2Int& outTexelSize);
+	static void FreeImageData(unsigned char* imageData);
+	//Removes the texture from the registry and deletes it, for textures that get made over and over (ie: rebaked atlases).
+	static void ReleaseTexture(Texture* texture);
 
 	//GETTERS//////////////////////////////////////////////////////////////////////////
 	static Texture* GetTextureByName(const std::string& imageFilePath);
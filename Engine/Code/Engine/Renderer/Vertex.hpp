@@ -4,12 +4,17 @@
 #include "Engine/Math/Vector4.hpp"
 #include "Engine/Math/Vector4Int.hpp"
 #include "Engine/Renderer/RGBA.hpp"
+#include <stdint.h>
 
 struct Vertex_Master;
 class ShaderProgram;
+class MeshBuilder;
+class Mesh;
 //TYPEDEFS//////////////////////////////////////////////////////////////////////////
 typedef unsigned char byte;
 typedef void (VertexCopyCallback)(const Vertex_Master& source, byte* destination);
+//Fills a whole mesh from a builder in one go (ie: VertexLayout::CopyToMesh).
+typedef void (MeshCopyFunction)(const MeshBuilder& builder, Mesh* mesh);
 
 //-----------------------------------------------------------------------------------
 //The master vertex. This is a superset of all possible vertex data. Used for the mesh builder class.
@@ -33,16 +38,13 @@ struct Vertex_Master
 };
 
 //-----------------------------------------------------------------------------------
+//The structs below are for building vertices by hand. Meshes copied out of a MeshBuilder use the matching layouts in VertexLayout.hpp (ie: Layout_PCT).
 struct Vertex_SkinnedPCTN
 {
-    typedef unsigned int GLuint;
-
     Vertex_SkinnedPCTN() {};
     Vertex_SkinnedPCTN(const Vector3& position) : pos(position) {};
     Vertex_SkinnedPCTN(const Vector3& position, const RGBA& color) : pos(position), color(color) {};
     Vertex_SkinnedPCTN(const Vector3& position, const RGBA& color, const Vector2& texCoords) : pos(position), color(color), texCoords(texCoords) {};
-    static void Copy(const Vertex_Master& source, byte* destination);
-    static void BindMeshToVAO(GLuint vao, GLuint vbo, GLuint ibo, ShaderProgram* program);
 
     //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
     Vector3 pos;
@@ -56,14 +58,10 @@ struct Vertex_SkinnedPCTN
 //-----------------------------------------------------------------------------------
 struct Vertex_PCT
 {
-    typedef unsigned int GLuint;
-
     Vertex_PCT() {};
     Vertex_PCT(const Vector3& position) : pos(position) {};
     Vertex_PCT(const Vector3& position, const RGBA& color) : pos(position), color(color) {};
     Vertex_PCT(const Vector3& position, const RGBA& color, const Vector2& texCoords) : pos(position), color(color), texCoords(texCoords) {};
-    static void Copy(const Vertex_Master& source, byte* destination);
-    static void BindMeshToVAO(GLuint vao, GLuint vbo, GLuint ibo, ShaderProgram* program);
 
     //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
     Vector3 pos;
@@ -74,8 +72,6 @@ struct Vertex_PCT
 //-----------------------------------------------------------------------------------
 struct Vertex_TextPCT
 {
-    typedef unsigned int GLuint;
-
     Vertex_TextPCT() {};
     Vertex_TextPCT(const Vector3& position) : pos(position) {};
     Vertex_TextPCT(const Vector3& position, const RGBA& color) : pos(position), color(color) {};
@@ -86,8 +82,6 @@ struct Vertex_TextPCT
         , texCoords(texCoords)
         , normalizedGlyphPosition(normalizedGlyphPosition)
         , normalizedStringPosition(normalizedStringPosition) {};
-    static void Copy(const Vertex_Master& source, byte* destination);
-    static void BindMeshToVAO(GLuint vao, GLuint vbo, GLuint ibo, ShaderProgram* program);
 
     //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
     Vector3 pos;
@@ -101,8 +95,6 @@ struct Vertex_TextPCT
 //-----------------------------------------------------------------------------------
 struct Vertex_PCUTB
 {
-    typedef unsigned int GLuint;
-
     Vertex_PCUTB() {};
     Vertex_PCUTB(const Vector3& position) 
         : pos(position) {};
@@ -119,8 +111,6 @@ struct Vertex_PCUTB
         , texCoords(texCoords)
         , tangent(tangent)
         , bitangent(bitangent) {};
-    static void Copy(const Vertex_Master& source, byte* destination);
-    static void BindMeshToVAO(GLuint vao, GLuint vbo, GLuint ibo, ShaderProgram* program);
 
     //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
     Vector3 pos;
@@ -128,4 +118,4 @@ struct Vertex_PCUTB
     Vector2 texCoords;
     Vector3 tangent;
     Vector3 bitangent;
-};
\ No newline at end of file
+};
@@ -0,0 +1,58 @@
+#include "Engine/Renderer/VertexLayout.hpp"
+#include "Engine/Renderer/ShaderProgram.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <gl/GL.h>
+#include <gl/GLU.h>
+#include "Engine/Renderer/OpenGLExtensions.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+
+//-----------------------------------------------------------------------------------
+static GLenum GetGLType(VertexComponentType componentType)
+{
+    switch (componentType)
+    {
+    case FLOAT_COMPONENT:
+        return GL_FLOAT;
+    case HALF_FLOAT_COMPONENT:
+        return GL_HALF_FLOAT;
+    case INT_COMPONENT:
+        return GL_INT;
+    case SHORT_COMPONENT:
+        return GL_SHORT;
+    case UNSIGNED_SHORT_COMPONENT:
+        return GL_UNSIGNED_SHORT;
+    case UNSIGNED_BYTE_COMPONENT:
+        return GL_UNSIGNED_BYTE;
+    default:
+        ERROR_AND_DIE("Unknown vertex component type");
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Shaders that don't use an attribute just don't find it, ShaderProgramBindProperty skips anything it can't find.
+void BindVertexAttributes(unsigned int vao, unsigned int vbo, unsigned int ibo, ShaderProgram* program, const VertexAttributeBinding* bindings, unsigned int numBindings, unsigned int sizeofVertex)
+{
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    for (unsigned int i = 0; i < numBindings; ++i)
+    {
+        const VertexAttributeBinding& binding = bindings[i];
+        if (binding.isInteger)
+        {
+            program->ShaderProgramBindIntegerProperty(binding.shaderName, binding.numComponents, GetGLType(binding.componentType), sizeofVertex, binding.offset);
+        }
+        else
+        {
+            program->ShaderProgramBindProperty(binding.shaderName, binding.numComponents, GetGLType(binding.componentType), binding.isNormalized ? GL_TRUE : GL_FALSE, sizeofVertex, binding.offset);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, NULL);
+    if (ibo != NULL)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    }
+    glBindVertexArray(NULL);
+}
@@ -0,0 +1,430 @@
+#pragma once
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/VertexPacking.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+class Mesh;
+class ShaderProgram;
+
+//-----------------------------------------------------------------------------------
+//A vertex format described once as a list of attributes, each with the format it's stored in and whether the shader sees it normalized:
+//
+//    typedef VertexLayout<VertexAttribute<MeshBuilder::POSITION_BIT, Float3Format, false>, VertexAttribute<MeshBuilder::COLOR_BIT, UByte4Format, true>> Layout_PC;
+//    builder.CopyToMesh<Layout_PC>(mesh);
+//
+//From that the compiler builds the packed vertex struct, one conversion loop per attribute over the builder's vertices or streams
+//(the format's encode inlined, no per-vertex callback), and the table BindMeshToVAO binds the shader inputs from.
+//Integer formats that aren't normalized are bound as integer inputs (ie: bone indices), everything else reaches the shader as floats.
+
+//ENUMS//////////////////////////////////////////////////////////////////////////
+//Turned into GLenums by BindVertexAttributes, so this header doesn't need GL.
+enum VertexComponentType
+{
+    FLOAT_COMPONENT,
+    HALF_FLOAT_COMPONENT,
+    INT_COMPONENT,
+    SHORT_COMPONENT,
+    UNSIGNED_SHORT_COMPONENT,
+    UNSIGNED_BYTE_COMPONENT
+};
+
+//STRUCTS//////////////////////////////////////////////////////////////////////////
+//One row of a layout's binding table.
+struct VertexAttributeBinding
+{
+    const char* shaderName;
+    unsigned int numComponents;
+    VertexComponentType componentType;
+    bool isNormalized;
+    bool isInteger;
+    unsigned int offset;
+};
+
+//STANDALONE FUNCTIONS//////////////////////////////////////////////////////////////////////////
+void BindVertexAttributes(unsigned int vao, unsigned int vbo, unsigned int ibo, ShaderProgram* program, const VertexAttributeBinding* bindings, unsigned int numBindings, unsigned int sizeofVertex);
+
+//MASTER ATTRIBUTES//////////////////////////////////////////////////////////////////////////
+//The type each MeshDataFlag has in a Vertex_Master (and so in the builder's streams), and the shader input it binds to.
+template<MeshBuilder::MeshDataFlag Attribute> struct MasterAttributeType;
+
+#define MASTER_ATTRIBUTE_TYPE(flag, type, name) \
+    template<> struct MasterAttributeType<MeshBuilder::flag> { typedef type Type; static inline const char* GetShaderName() { return name; }; }
+
+MASTER_ATTRIBUTE_TYPE(POSITION_BIT, Vector3, "inPosition");
+MASTER_ATTRIBUTE_TYPE(TANGENT_BIT, Vector3, "inTangent");
+MASTER_ATTRIBUTE_TYPE(BITANGENT_BIT, Vector3, "inBitangent");
+MASTER_ATTRIBUTE_TYPE(NORMAL_BIT, Vector3, "inNormal");
+MASTER_ATTRIBUTE_TYPE(COLOR_BIT, RGBA, "inColor");
+MASTER_ATTRIBUTE_TYPE(UV0_BIT, Vector2, "inUV0");
+MASTER_ATTRIBUTE_TYPE(UV1_BIT, Vector2, "inUV1");
+MASTER_ATTRIBUTE_TYPE(NORMALIZED_GLYPH_POSITION_BIT, Vector2, "inNormalizedGlyphPosition");
+MASTER_ATTRIBUTE_TYPE(NORMALIZED_STRING_POSITION_BIT, Vector2, "inNormalizedStringPosition");
+MASTER_ATTRIBUTE_TYPE(NORMALIZED_FRAG_POSITION_BIT, float, "inNormalizedFragPosition");
+MASTER_ATTRIBUTE_TYPE(BONE_WEIGHTS_BIT, Vector4, "inBoneWeights");
+MASTER_ATTRIBUTE_TYPE(BONE_INDICES_BIT, Vector4Int, "inBoneIndices");
+
+#undef MASTER_ATTRIBUTE_TYPE
+
+//FORMATS//////////////////////////////////////////////////////////////////////////
+//How an attribute is stored in the vertex buffer. Each one converts from the master types it makes sense for,
+//a layout that pairs an attribute with a format that can't hold it won't compile.
+
+//-----------------------------------------------------------------------------------
+struct Float1Format
+{
+    typedef float Storage;
+    static const unsigned int NUM_COMPONENTS = 1;
+    static const VertexComponentType COMPONENT_TYPE = FLOAT_COMPONENT;
+    static const bool IS_QUANTIZED = false;
+    static inline void Convert(float source, Storage& destination, const PositionQuantization&) { destination = source; };
+};
+
+//-----------------------------------------------------------------------------------
+struct Float2Format
+{
+    typedef Vector2 Storage;
+    static const unsigned int NUM_COMPONENTS = 2;
+    static const VertexComponentType COMPONENT_TYPE = FLOAT_COMPONENT;
+    static const bool IS_QUANTIZED = false;
+    static inline void Convert(const Vector2& source, Storage& destination, const PositionQuantization&) { destination = source; };
+};
+
+//-----------------------------------------------------------------------------------
+struct Float3Format
+{
+    typedef Vector3 Storage;
+    static const unsigned int NUM_COMPONENTS = 3;
+    static const VertexComponentType COMPONENT_TYPE = FLOAT_COMPONENT;
+    static const bool IS_QUANTIZED = false;
+    static inline void Convert(const Vector3& source, Storage& destination, const PositionQuantization&) { destination = source; };
+};
+
+//-----------------------------------------------------------------------------------
+struct Float4Format
+{
+    typedef Vector4 Storage;
+    static const unsigned int NUM_COMPONENTS = 4;
+    static const VertexComponentType COMPONENT_TYPE = FLOAT_COMPONENT;
+    static const bool IS_QUANTIZED = false;
+    static inline void Convert(const Vector4& source, Storage& destination, const PositionQuantization&) { destination = source; };
+};
+
+//-----------------------------------------------------------------------------------
+struct Int4Format
+{
+    typedef Vector4Int Storage;
+    static const unsigned int NUM_COMPONENTS = 4;
+    static const VertexComponentType COMPONENT_TYPE = INT_COMPONENT;
+    static const bool IS_QUANTIZED = false;
+    static inline void Convert(const Vector4Int& source, Storage& destination, const PositionQuantization&) { destination = source; };
+};
+
+//-----------------------------------------------------------------------------------
+//Colors are copied straight across, skin weights are rounded to add up to 255 and bone indices have to fit in a byte (see VertexPacking).
+struct UByte4Format
+{
+    typedef uint8_t Storage[4];
+    static const unsigned int NUM_COMPONENTS = 4;
+    static const VertexComponentType COMPONENT_TYPE = UNSIGNED_BYTE_COMPONENT;
+    static const bool IS_QUANTIZED = false;
+    static inline void Convert(const RGBA& source, Storage& destination, const PositionQuantization&) { memcpy(destination, &source, sizeof(Storage)); };
+    static inline void Convert(const Vector4& source, Storage& destination, const PositionQuantization&) { VertexPacking::QuantizeBoneWeights(source, destination); };
+    static inline void Convert(const Vector4Int& source, Storage& destination, const PositionQuantization&) { VertexPacking::QuantizeBoneIndices(source, destination); };
+};
+
+//-----------------------------------------------------------------------------------
+struct Half2Format
+{
+    typedef uint16_t Storage[2];
+    static const unsigned int NUM_COMPONENTS = 2;
+    static const VertexComponentType COMPONENT_TYPE = HALF_FLOAT_COMPONENT;
+    static const bool IS_QUANTIZED = false;
+
+    static inline void Convert(const Vector2& source, Storage& destination, const PositionQuantization&)
+    {
+        destination[0] = VertexPacking::FloatToHalf(source.x);
+        destination[1] = VertexPacking::FloatToHalf(source.y);
+    };
+};
+
+//-----------------------------------------------------------------------------------
+//Unit vectors as two snorm16s, needs normalizing and a shader that decodes them.
+struct OctahedralFormat
+{
+    typedef int16_t Storage[2];
+    static const unsigned int NUM_COMPONENTS = 2;
+    static const VertexComponentType COMPONENT_TYPE = SHORT_COMPONENT;
+    static const bool IS_QUANTIZED = false;
+    static inline void Convert(const Vector3& source, Storage& destination, const PositionQuantization&) { VertexPacking::EncodeOctahedral(source, destination); };
+};
+
+//-----------------------------------------------------------------------------------
+//Positions as unorm16s inside the mesh's quantization cube. CopyToMesh fits the cube to the mesh's bounds and hands the mesh the dequantize vector.
+//The 4th component is padding, to keep everything after it 4 byte aligned.
+struct QuantizedPositionFormat
+{
+    typedef uint16_t Storage[4];
+    static const unsigned int NUM_COMPONENTS = 3;
+    static const VertexComponentType COMPONENT_TYPE = UNSIGNED_SHORT_COMPONENT;
+    static const bool IS_QUANTIZED = true;
+
+    static inline void Convert(const Vector3& source, Storage& destination, const PositionQuantization& quantization)
+    {
+        VertexPacking::QuantizePosition(source, quantization, destination);
+        destination[3] = 0;
+    };
+};
+
+//ATTRIBUTES//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+template<MeshBuilder::MeshDataFlag Attribute, typename Format, bool IsNormalized>
+struct VertexAttribute
+{
+    typedef typename MasterAttributeType<Attribute>::Type SourceType;
+    typedef typename Format::Storage Storage;
+    static const bool IS_QUANTIZED = Format::IS_QUANTIZED;
+    static_assert(!IsNormalized || (Format::COMPONENT_TYPE != FLOAT_COMPONENT && Format::COMPONENT_TYPE != HALF_FLOAT_COMPONENT), "Only integer formats can be normalized");
+
+    //-----------------------------------------------------------------------------------
+    //Both strides are known here, so each of these compiles down to its own tight loop around the inlined encode.
+    template<unsigned int SourceStride, unsigned int DestinationStride>
+    static inline void ConvertRange(const byte* source, byte* destination, unsigned int count, const PositionQuantization& quantization)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            Format::Convert(*reinterpret_cast<const SourceType*>(source + (i * SourceStride)), *reinterpret_cast<Storage*>(destination + (i * DestinationStride)), quantization);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    //The source is either the builder's Vertex_Masters, this attribute's stream, or a single default value when the stream isn't there.
+    template<unsigned int DestinationStride>
+    static void Convert(const MeshBuilder& builder, byte* destination, unsigned int count, const PositionQuantization& quantization)
+    {
+        unsigned int sourceStride = 0;
+        const byte* source = builder.GetAttributeData(Attribute, sourceStride);
+        if (sourceStride == sizeof(SourceType))
+        {
+            ConvertRange<sizeof(SourceType), DestinationStride>(source, destination, count, quantization);
+        }
+        else if (sourceStride == sizeof(Vertex_Master))
+        {
+            ConvertRange<sizeof(Vertex_Master), DestinationStride>(source, destination, count, quantization);
+        }
+        else
+        {
+            ConvertRange<0, DestinationStride>(source, destination, count, quantization);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    static inline void GetBinding(VertexAttributeBinding& outBinding, unsigned int offset)
+    {
+        outBinding.shaderName = MasterAttributeType<Attribute>::GetShaderName();
+        outBinding.numComponents = Format::NUM_COMPONENTS;
+        outBinding.componentType = Format::COMPONENT_TYPE;
+        outBinding.isNormalized = IsNormalized;
+        outBinding.isInteger = !IsNormalized && Format::COMPONENT_TYPE != FLOAT_COMPONENT && Format::COMPONENT_TYPE != HALF_FLOAT_COMPONENT;
+        outBinding.offset = offset;
+    }
+};
+
+//PACKED VERTEX//////////////////////////////////////////////////////////////////////////
+//The generated struct, one member per attribute in the order they're listed. Every format is a multiple of 4 bytes and at most 4 byte aligned,
+//so nesting the rest of the attributes lays them out exactly as a hand-written struct would, with no padding in between.
+template<typename... Attributes> struct PackedVertex;
+
+//-----------------------------------------------------------------------------------
+template<typename Last>
+struct PackedVertex<Last>
+{
+    static const bool IS_QUANTIZED = Last::IS_QUANTIZED;
+
+    template<unsigned int DestinationStride>
+    static void Convert(const MeshBuilder& builder, byte* destination, unsigned int count, const PositionQuantization& quantization)
+    {
+        Last::template Convert<DestinationStride>(builder, destination + offsetof(PackedVertex, value), count, quantization);
+    }
+
+    static void GetBindings(VertexAttributeBinding* outBindings, unsigned int baseOffset)
+    {
+        Last::GetBinding(outBindings[0], baseOffset + offsetof(PackedVertex, value));
+    }
+
+    typename Last::Storage value;
+};
+
+//-----------------------------------------------------------------------------------
+template<typename First, typename Second, typename... Rest>
+struct PackedVertex<First, Second, Rest...>
+{
+    typedef PackedVertex<Second, Rest...> RestOfVertex;
+    static const bool IS_QUANTIZED = First::IS_QUANTIZED || RestOfVertex::IS_QUANTIZED;
+
+    template<unsigned int DestinationStride>
+    static void Convert(const MeshBuilder& builder, byte* destination, unsigned int count, const PositionQuantization& quantization)
+    {
+        First::template Convert<DestinationStride>(builder, destination + offsetof(PackedVertex, value), count, quantization);
+        RestOfVertex::template Convert<DestinationStride>(builder, destination + offsetof(PackedVertex, rest), count, quantization);
+    }
+
+    static void GetBindings(VertexAttributeBinding* outBindings, unsigned int baseOffset)
+    {
+        First::GetBinding(outBindings[0], baseOffset + offsetof(PackedVertex, value));
+        RestOfVertex::GetBindings(outBindings + 1, baseOffset + offsetof(PackedVertex, rest));
+    }
+
+    typename First::Storage value;
+    RestOfVertex rest;
+};
+
+//LAYOUT//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+template<typename... Attributes>
+class VertexLayout
+{
+public:
+    //TYPEDEFS//////////////////////////////////////////////////////////////////////////
+    typedef unsigned int GLuint;
+    typedef PackedVertex<Attributes...> Vertex;
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    //-----------------------------------------------------------------------------------
+    static void ConvertVertices(const MeshBuilder& builder, Vertex* outVertices, const PositionQuantization& quantization = PositionQuantization())
+    {
+        Vertex::template Convert<sizeof(Vertex)>(builder, reinterpret_cast<byte*>(outVertices), builder.GetVertexCount(), quantization);
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Matches MeshCopyFunction, so a layout can be handed to CreateMeshAsync.
+    static void CopyToMesh(const MeshBuilder& builder, Mesh* mesh)
+    {
+        unsigned int vertexCount = builder.GetVertexCount();
+        if (vertexCount == 0)
+        {
+            return;
+        }
+        PositionQuantization quantization;
+        Vector4 positionDequantize(0.0f, 0.0f, 0.0f, 1.0f);
+        if (!CalculateQuantization(builder, quantization, positionDequantize))
+        {
+            return;
+        }
+        std::vector<Vertex> vertices(vertexCount);
+        ConvertVertices(builder, vertices.data(), quantization);
+        builder.InitMeshFromVertices(mesh, vertices.data(), vertexCount, sizeof(Vertex), &BindMeshToVAO, positionDequantize);
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Rewrites the vertex buffer of a mesh CopyToMesh made from this builder, keeping its indices and LODs (ie: after UpdatePatch).
+    static void UpdateMesh(const MeshBuilder& builder, Mesh* mesh)
+    {
+        unsigned int vertexCount = builder.GetVertexCount();
+        PositionQuantization quantization;
+        Vector4 positionDequantize(0.0f, 0.0f, 0.0f, 1.0f);
+        if (vertexCount == 0 || !CalculateQuantization(builder, quantization, positionDequantize))
+        {
+            return;
+        }
+        std::vector<Vertex> vertices(vertexCount);
+        ConvertVertices(builder, vertices.data(), quantization);
+        mesh->UpdateVertices(vertices.data(), vertexCount, sizeof(Vertex));
+        mesh->m_boundingRadius = builder.CalculateBoundingRadius();
+        mesh->m_positionDequantize = positionDequantize;
+    }
+
+    //-----------------------------------------------------------------------------------
+    static void BindMeshToVAO(GLuint vao, GLuint vbo, GLuint ibo, ShaderProgram* program)
+    {
+        VertexAttributeBinding bindings[NUM_ATTRIBUTES];
+        Vertex::GetBindings(bindings, 0);
+        BindVertexAttributes(vao, vbo, ibo, program, bindings, NUM_ATTRIBUTES, sizeof(Vertex));
+    }
+
+    //CONSTANTS//////////////////////////////////////////////////////////////////////////
+    static const unsigned int NUM_ATTRIBUTES = sizeof...(Attributes);
+    static const bool IS_QUANTIZED = Vertex::IS_QUANTIZED;
+
+private:
+    //-----------------------------------------------------------------------------------
+    //Fits the quantization cube to the builder's bounds, if this layout quantizes positions at all.
+    static bool CalculateQuantization(const MeshBuilder& builder, PositionQuantization& outQuantization, Vector4& outPositionDequantize)
+    {
+        if (!IS_QUANTIZED)
+        {
+            return true;
+        }
+        Vector3 mins;
+        Vector3 maxs;
+        if (!builder.CalculateBounds(mins, maxs))
+        {
+            return false;
+        }
+        outQuantization = PositionQuantization::FromBounds(mins, maxs);
+        outPositionDequantize = outQuantization.GetDequantizeVector();
+        return true;
+    }
+};
+
+//ENGINE LAYOUTS//////////////////////////////////////////////////////////////////////////
+typedef VertexLayout<
+    VertexAttribute<MeshBuilder::POSITION_BIT, Float3Format, false>,
+    VertexAttribute<MeshBuilder::COLOR_BIT, UByte4Format, true>,
+    VertexAttribute<MeshBuilder::UV0_BIT, Float2Format, false>
+> Layout_PCT;
+
+typedef VertexLayout<
+    VertexAttribute<MeshBuilder::POSITION_BIT, Float3Format, false>,
+    VertexAttribute<MeshBuilder::COLOR_BIT, UByte4Format, true>,
+    VertexAttribute<MeshBuilder::UV0_BIT, Float2Format, false>,
+    VertexAttribute<MeshBuilder::NORMALIZED_GLYPH_POSITION_BIT, Float2Format, false>,
+    VertexAttribute<MeshBuilder::NORMALIZED_STRING_POSITION_BIT, Float2Format, false>
+> Layout_TextPCT;
+
+typedef VertexLayout<
+    VertexAttribute<MeshBuilder::POSITION_BIT, Float3Format, false>,
+    VertexAttribute<MeshBuilder::COLOR_BIT, UByte4Format, true>,
+    VertexAttribute<MeshBuilder::UV0_BIT, Float2Format, false>,
+    VertexAttribute<MeshBuilder::TANGENT_BIT, Float3Format, false>,
+    VertexAttribute<MeshBuilder::BITANGENT_BIT, Float3Format, false>
+> Layout_PCUTB;
+
+typedef VertexLayout<
+    VertexAttribute<MeshBuilder::POSITION_BIT, Float3Format, false>,
+    VertexAttribute<MeshBuilder::COLOR_BIT, UByte4Format, true>,
+    VertexAttribute<MeshBuilder::UV0_BIT, Float2Format, false>,
+    VertexAttribute<MeshBuilder::NORMAL_BIT, Float3Format, false>,
+    VertexAttribute<MeshBuilder::BONE_WEIGHTS_BIT, Float4Format, false>,
+    VertexAttribute<MeshBuilder::BONE_INDICES_BIT, Int4Format, false>
+> Layout_SkinnedPCTN;
+
+//Layout_SkinnedPCTN squeezed from 68 bytes down to 28. Positions are quantized, UVs are halfs, the normal is octahedral
+//and the skin weights are unorm8s that add up to 255. Needs a shader that unpacks these (ie: SkinPacked.vert).
+typedef VertexLayout<
+    VertexAttribute<MeshBuilder::POSITION_BIT, QuantizedPositionFormat, true>,
+    VertexAttribute<MeshBuilder::COLOR_BIT, UByte4Format, true>,
+    VertexAttribute<MeshBuilder::UV0_BIT, Half2Format, false>,
+    VertexAttribute<MeshBuilder::NORMAL_BIT, OctahedralFormat, true>,
+    VertexAttribute<MeshBuilder::BONE_WEIGHTS_BIT, UByte4Format, true>,
+    VertexAttribute<MeshBuilder::BONE_INDICES_BIT, UByte4Format, false>
+> Layout_PackedSkinnedPCTN;
+
+//Layout_PCUTB squeezed from 48 bytes down to 24, with the same encodings as Layout_PackedSkinnedPCTN.
+typedef VertexLayout<
+    VertexAttribute<MeshBuilder::POSITION_BIT, QuantizedPositionFormat, true>,
+    VertexAttribute<MeshBuilder::COLOR_BIT, UByte4Format, true>,
+    VertexAttribute<MeshBuilder::UV0_BIT, Half2Format, false>,
+    VertexAttribute<MeshBuilder::TANGENT_BIT, OctahedralFormat, true>,
+    VertexAttribute<MeshBuilder::BITANGENT_BIT, OctahedralFormat, true>
+> Layout_PackedPCUTB;
+
+//The immediate mode vertex structs have to stay byte for byte the same as their layouts, the same shaders draw both.
+static_assert(sizeof(Layout_PCT::Vertex) == sizeof(Vertex_PCT), "Layout_PCT doesn't match Vertex_PCT");
+static_assert(sizeof(Layout_TextPCT::Vertex) == sizeof(Vertex_TextPCT), "Layout_TextPCT doesn't match Vertex_TextPCT");
+static_assert(sizeof(Layout_PCUTB::Vertex) == sizeof(Vertex_PCUTB), "Layout_PCUTB doesn't match Vertex_PCUTB");
+static_assert(sizeof(Layout_SkinnedPCTN::Vertex) == sizeof(Vertex_SkinnedPCTN), "Layout_SkinnedPCTN doesn't match Vertex_SkinnedPCTN");
+static_assert(sizeof(Layout_PackedSkinnedPCTN::Vertex) == 28, "Layout_PackedSkinnedPCTN should be 28 bytes");
+static_assert(sizeof(Layout_PackedPCUTB::Vertex) == 24, "Layout_PackedPCUTB should be 24 bytes");
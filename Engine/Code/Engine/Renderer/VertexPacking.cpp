@@ -0,0 +1,187 @@
+#include "Engine/Renderer/VertexPacking.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <math.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+PositionQuantization PositionQuantization::FromBounds(const Vector3& mins, const Vector3& maxs)
+{
+    float extents = maxs.x - mins.x;
+    extents = (maxs.y - mins.y) > extents ? (maxs.y - mins.y) : extents;
+    extents = (maxs.z - mins.z) > extents ? (maxs.z - mins.z) : extents;
+    //Flat or single point meshes still need a non-zero scale to divide by.
+    return PositionQuantization(mins, extents > 0.0f ? extents : 1.0f);
+}
+
+//-----------------------------------------------------------------------------------
+//Rounds to nearest, overflows to infinity and flushes anything below the smallest denormal to zero.
+uint16_t VertexPacking::FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    uint32_t mantissa = bits & 0x007FFFFF;
+    int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+
+    if ((bits & 0x7FFFFFFF) >= 0x7F800000)
+    {
+        //Infinity stays infinity, NaN stays NaN.
+        return sign | 0x7C00 | (mantissa != 0 ? 0x0200 : 0);
+    }
+    if (exponent >= 31)
+    {
+        return sign | 0x7C00;
+    }
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+        {
+            return sign;
+        }
+        //Denormal, put the implicit 1 back and shift it down into place.
+        mantissa |= 0x00800000;
+        int shift = 14 - exponent;
+        return sign | (uint16_t)((mantissa + (1 << (shift - 1))) >> shift);
+    }
+    //A carry out of the mantissa rolls into the exponent, which is the right answer (and becomes infinity at the top).
+    return sign | (uint16_t)(((exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+}
+
+//-----------------------------------------------------------------------------------
+float VertexPacking::HalfToFloat(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x03FF;
+    uint32_t bits;
+    if (exponent == 0)
+    {
+        //Zero or denormal, both are just mantissa * 2^-24.
+        float magnitude = (float)mantissa * (1.0f / 16777216.0f);
+        return sign ? -magnitude : magnitude;
+    }
+    else if (exponent == 31)
+    {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//-----------------------------------------------------------------------------------
+uint16_t VertexPacking::FloatToUnorm16(float value)
+{
+    value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return (uint16_t)((value * 65535.0f) + 0.5f);
+}
+
+//-----------------------------------------------------------------------------------
+void VertexPacking::QuantizePosition(const Vector3& position, const PositionQuantization& quantization, uint16_t* outXYZ)
+{
+    float inverseScale = 1.0f / quantization.scale;
+    outXYZ[0] = FloatToUnorm16((position.x - quantization.offset.x) * inverseScale);
+    outXYZ[1] = FloatToUnorm16((position.y - quantization.offset.y) * inverseScale);
+    outXYZ[2] = FloatToUnorm16((position.z - quantization.offset.z) * inverseScale);
+}
+
+//-----------------------------------------------------------------------------------
+static inline int16_t FloatToSnorm16(float value)
+{
+    value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+    return (int16_t)floor((value * 32767.0f) + 0.5f);
+}
+
+//-----------------------------------------------------------------------------------
+void VertexPacking::EncodeOctahedral(const Vector3& direction, int16_t* outXY)
+{
+    float sum = fabs(direction.x) + fabs(direction.y) + fabs(direction.z);
+    if (sum <= 0.0f)
+    {
+        //Zero vectors (ie: a mesh without tangents) come back out as +Z rather than garbage.
+        outXY[0] = 0;
+        outXY[1] = 0;
+        return;
+    }
+    float x = direction.x / sum;
+    float y = direction.y / sum;
+    if (direction.z < 0.0f)
+    {
+        //Fold the lower hemisphere out over the corners of the square.
+        float foldedX = (1.0f - fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float foldedY = (1.0f - fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+    outXY[0] = FloatToSnorm16(x);
+    outXY[1] = FloatToSnorm16(y);
+}
+
+//-----------------------------------------------------------------------------------
+//Mirror of the unpack in the packed vertex shaders.
+Vector3 VertexPacking::DecodeOctahedral(const int16_t* xy)
+{
+    Vector3 direction((float)xy[0] / 32767.0f, (float)xy[1] / 32767.0f, 0.0f);
+    direction.z = 1.0f - fabs(direction.x) - fabs(direction.y);
+    float fold = direction.z < 0.0f ? -direction.z : 0.0f;
+    direction.x += direction.x >= 0.0f ? -fold : fold;
+    direction.y += direction.y >= 0.0f ? -fold : fold;
+    direction.Normalize();
+    return direction;
+}
+
+//-----------------------------------------------------------------------------------
+void VertexPacking::QuantizeBoneWeights(const Vector4& weights, uint8_t* outWeights)
+{
+    float values[4] = { weights.x, weights.y, weights.z, weights.w };
+    float total = 0.0f;
+    for (int i = 0; i < 4; ++i)
+    {
+        values[i] = values[i] > 0.0f ? values[i] : 0.0f;
+        total += values[i];
+    }
+    if (total <= 0.0f)
+    {
+        //Same fallback as RenormalizeSkinWeights, all of it on the first bone.
+        outWeights[0] = 255;
+        outWeights[1] = outWeights[2] = outWeights[3] = 0;
+        return;
+    }
+
+    float remainders[4];
+    int assigned = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        float scaled = (values[i] / total) * 255.0f;
+        int truncated = (int)scaled;
+        outWeights[i] = (uint8_t)truncated;
+        remainders[i] = scaled - (float)truncated;
+        assigned += truncated;
+    }
+    //Hand out what truncation lost, biggest remainders first.
+    for (int leftover = 255 - assigned; leftover > 0; --leftover)
+    {
+        int largest = 0;
+        for (int i = 1; i < 4; ++i)
+        {
+            largest = remainders[i] > remainders[largest] ? i : largest;
+        }
+        ++outWeights[largest];
+        remainders[largest] = -1.0f;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void VertexPacking::QuantizeBoneIndices(const Vector4Int& indices, uint8_t* outIndices)
+{
+    ASSERT_OR_DIE(indices.x >= 0 && indices.x < 256 && indices.y >= 0 && indices.y < 256 && indices.z >= 0 && indices.z < 256 && indices.w >= 0 && indices.w < 256,
+        "Packed vertices only have room for 256 bones!");
+    outIndices[0] = (uint8_t)indices.x;
+    outIndices[1] = (uint8_t)indices.y;
+    outIndices[2] = (uint8_t)indices.z;
+    outIndices[3] = (uint8_t)indices.w;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Math/Vector4.hpp"
+#include "Engine/Math/Vector4Int.hpp"
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------------
+//Maps positions inside a cube onto 0-65535 per axis. The cube (one scale for every axis) keeps the dequantize a uniform scale, so normals don't need correcting.
+//Shaders undo it with position = (quantized * scale) + offset, which is what Vector4(offset, scale) packs into gPositionDequantize.
+struct PositionQuantization
+{
+    PositionQuantization() : offset(Vector3::ZERO), scale(1.0f) {};
+    PositionQuantization(const Vector3& offset, float scale) : offset(offset), scale(scale) {};
+    static PositionQuantization FromBounds(const Vector3& mins, const Vector3& maxs);
+    inline Vector4 GetDequantizeVector() const { return Vector4(offset, scale); };
+
+    Vector3 offset;
+    float scale;
+};
+
+//-----------------------------------------------------------------------------------
+//Encoders for the compressed attributes used by the packed vertex formats (see the formats in VertexLayout.hpp).
+class VertexPacking
+{
+public:
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static uint16_t FloatToHalf(float value);
+    static float HalfToFloat(uint16_t half);
+    static uint16_t FloatToUnorm16(float value);
+    static void QuantizePosition(const Vector3& position, const PositionQuantization& quantization, uint16_t* outXYZ);
+    //Octahedral mapping of a unit vector into two snorm16s (Cigolle et al, "A Survey of Efficient Representations for Independent Unit Vectors").
+    static void EncodeOctahedral(const Vector3& direction, int16_t* outXY);
+    static Vector3 DecodeOctahedral(const int16_t* xy);
+    //Largest remainder rounding, so the four bytes always add up to exactly 255 and skinning never gains or loses scale.
+    static void QuantizeBoneWeights(const Vector4& weights, uint8_t* outWeights);
+    static void QuantizeBoneIndices(const Vector4Int& indices, uint8_t* outIndices);
+};
@@ -3,6 +3,7 @@
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/VertexLayout.hpp"
 #include "Engine/Renderer/MeshRenderer.hpp"
 #include <deque>
 
@@ -190,7 +191,7 @@ void TextBox::ConstructMeshes()
         mb.AddStringEffectFragment(frag.m_value, m_baseFont, m_scale, totalStringWidth, totalWidthUpToNow, Vector3::ZERO
                                 , m_upVector, m_rightVector, m_width, m_height, lineNum, lineWidths[lineNum], alignment);
         Mesh* mesh = new Mesh();
-        mb.CopyToMesh(mesh, &Vertex_TextPCT::Copy, sizeof(Vertex_TextPCT), &Vertex_TextPCT::BindMeshToVAO);
+        mb.CopyToMesh<Layout_TextPCT>(mesh);
         Material* mat = new Material(new ShaderProgram("Data/Shaders/funkyFont.vert", "Data/Shaders/funkyFont.frag"),
             RenderState(RenderState::DepthTestingMode::OFF, RenderState::FaceCullingMode::CULL_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND));
         SetEffectProperties(mat, frag);
@@ -221,7 +222,7 @@ void TextBox::InitializeBorder()
     builder.AddLine(tl, br + (m_upVector * m_height));
     builder.AddLine(br, br + (m_upVector * m_height));
     m_borderRenderer = new MeshRenderer(new Mesh(), Renderer::instance->m_defaultMaterial);
-    builder.CopyToMesh(m_borderRenderer->m_mesh, &Vertex_PCT::Copy, sizeof(Vertex_PCT), &Vertex_PCT::BindMeshToVAO);
+    builder.CopyToMesh<Layout_PCT>(m_borderRenderer->m_mesh);
 }
 
 //-----------------------------------------------------------------------------------------------
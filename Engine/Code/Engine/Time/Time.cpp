@@ -3,6 +3,7 @@
 
 //-----------------------------------------------------------------------------------------------
 #include "Engine/Time/Time.hpp"
+#if defined( _WIN32 )
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 
@@ -28,4 +29,21 @@ double GetCurrentTimeSeconds()
 	return currentSeconds;
 }
 
+#else
+#include <time.h>
 
+//---------------------------------------------------------------------------
+static double GetMonotonicSeconds()
+{
+	timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return static_cast< double >( now.tv_sec ) + ( static_cast< double >( now.tv_nsec ) * 1e-9 );
+}
+
+//---------------------------------------------------------------------------
+double GetCurrentTimeSeconds()
+{
+	static double initialSeconds = GetMonotonicSeconds();
+	return GetMonotonicSeconds() - initialSeconds;
+}
+#endif
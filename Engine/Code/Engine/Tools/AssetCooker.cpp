@@ -0,0 +1,603 @@
+#include "Engine/Tools/AssetCooker.hpp"
+#include "Engine/Core/AsyncLoader.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Input/AssetArchive.hpp"
+#include "Engine/Input/BinaryReader.hpp"
+#include "Engine/Input/BinaryWriter.hpp"
+#include "Engine/Input/Compression.hpp"
+#include "Engine/Input/FileSystem.hpp"
+#include "Engine/Renderer/MeshFile.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Time/Time.hpp"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <set>
+
+const char* AssetCooker::MANIFEST_FILENAME = "CookManifest.txt";
+
+//-----------------------------------------------------------------------------------
+CookSettings::CookSettings()
+	: sourceDirectory("Data")
+	, outputDirectory("Cooked")
+	, archivePath("Data.pak")
+	, numWorkers(0)
+	, compressionBlockSize(Compression::DEFAULT_BLOCK_SIZE)
+	, compress(true)
+	, force(false)
+{
+
+}
+
+//BUILT IN STEPS//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+//Steps past a string written by IBinaryWriter::WriteString, without trusting its length.
+static bool SkipString(BinaryMemoryReader& reader)
+{
+	uint32_t length = 0;
+	return reader.Read<uint32_t>(length) && reader.ReadInPlace(length) != nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+static bool CookCopy(const AssetCooker& cooker, CookJob& job)
+{
+	return cooker.WriteOutput(job, job.outputPath, job.source.data, job.source.size, false);
+}
+
+//-----------------------------------------------------------------------------------
+static bool CookCompressed(const AssetCooker& cooker, CookJob& job)
+{
+	return cooker.WriteOutput(job, job.outputPath, job.source.data, job.source.size);
+}
+
+//-----------------------------------------------------------------------------------
+//Takes the mappable MeshFile format, and the MeshBuilder streams from before it (versions 1 and 2) that still load through ReadFromStream.
+static bool CookMesh(const AssetCooker& cooker, CookJob& job)
+{
+	if (job.source.size < sizeof(uint32_t))
+	{
+		job.message = "Mesh is empty";
+		return false;
+	}
+	uint32_t firstWord;
+	memcpy(&firstWord, job.source.data, sizeof(firstWord));
+	if (firstWord != MeshFile::MAGIC)
+	{
+		if (firstWord == 0 || firstWord > MeshBuilder::FILE_VERSION)
+		{
+			job.message = Stringf("Mesh isn't a MeshFile, or a mesh stream this engine can read (version %u)", firstWord);
+			return false;
+		}
+		return CookCompressed(cooker, job);
+	}
+
+	if (job.source.size < sizeof(MeshFileHeader))
+	{
+		job.message = "Mesh header is cut off";
+		return false;
+	}
+	const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(job.source.data);
+	uint64_t sectionTableEnd = (uint64_t)header->headerSize + ((uint64_t)header->sectionCount * sizeof(MeshFileSection));
+	if (header->version > MeshFile::FILE_VERSION || header->headerSize < sizeof(MeshFileHeader) || sectionTableEnd > job.source.size)
+	{
+		job.message = Stringf("Mesh header is corrupt or from a newer engine (version %u)", header->version);
+		return false;
+	}
+	if (header->vertexBlockOffset + header->vertexBlockSize > job.source.size)
+	{
+		job.message = "Mesh vertex block runs off the end of the file";
+		return false;
+	}
+	const MeshFileSection* sections = reinterpret_cast<const MeshFileSection*>(job.source.data + header->headerSize);
+	for (uint32_t i = 0; i < header->sectionCount; ++i)
+	{
+		if (sections[i].offset + sections[i].size > job.source.size)
+		{
+			job.message = Stringf("Mesh section %u runs off the end of the file", i);
+			return false;
+		}
+	}
+	return CookCompressed(cooker, job);
+}
+
+//-----------------------------------------------------------------------------------
+//Walks the whole stream the way Skeleton::ReadFromStream does, without building the skeleton.
+static bool CookSkeleton(const AssetCooker& cooker, CookJob& job)
+{
+	BinaryMemoryReader reader(job.source.data, job.source.size);
+	uint32_t fileVersion = 0;
+	uint32_t numberOfJoints = 0;
+	bool isIntact = reader.Read<uint32_t>(fileVersion) && fileVersion == Skeleton::FILE_VERSION && reader.Read<uint32_t>(numberOfJoints);
+	for (uint32_t i = 0; isIntact && i < numberOfJoints; ++i)
+	{
+		isIntact = SkipString(reader);
+	}
+	uint64_t tableSize = (uint64_t)numberOfJoints * (sizeof(int) + (16 * sizeof(float)));
+	if (!isIntact || tableSize != reader.GetRemainingSize())
+	{
+		job.message = "Skeleton is corrupt or from a different engine version";
+		return false;
+	}
+	return CookCompressed(cooker, job);
+}
+
+//-----------------------------------------------------------------------------------
+//Walks the whole stream the way AnimationMotion::ReadFromStream does, without loading the keyframes.
+static bool CookMotion(const AssetCooker& cooker, CookJob& job)
+{
+	BinaryMemoryReader reader(job.source.data, job.source.size);
+	uint32_t fileVersion = 0;
+	uint32_t frameCount = 0;
+	int jointCount = 0;
+	const size_t TIMING_SIZE = 3 * sizeof(float);
+	const size_t PLAYBACK_SIZE = sizeof(AnimationMotion::PLAYBACK_MODE) + sizeof(float);
+	bool isIntact = reader.Read<uint32_t>(fileVersion) && fileVersion == AnimationMotion::FILE_VERSION && reader.Read<uint32_t>(frameCount)
+		&& reader.ReadInPlace(TIMING_SIZE) != nullptr && SkipString(reader) && reader.Read<int>(jointCount) && jointCount >= 0
+		&& reader.ReadInPlace(PLAYBACK_SIZE) != nullptr;
+	uint64_t keyframesSize = (uint64_t)frameCount * (uint64_t)jointCount * (16 * sizeof(float));
+	if (!isIntact || keyframesSize != reader.GetRemainingSize())
+	{
+		job.message = "Motion is corrupt or from a different engine version";
+		return false;
+	}
+	return CookCompressed(cooker, job);
+}
+
+//-----------------------------------------------------------------------------------
+//PNG and JPEG barely compress any further, WriteOutput notices and stores them as they are.
+static bool CookTexture(const AssetCooker& cooker, CookJob& job)
+{
+	static const byte PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	static const byte JPEG_SIGNATURE[] = { 0xFF, 0xD8, 0xFF };
+	const size_t TGA_HEADER_SIZE = 18;
+	const byte* data = job.source.data;
+	size_t size = job.source.size;
+	bool isPNG = size >= sizeof(PNG_SIGNATURE) && memcmp(data, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0;
+	bool isJPEG = size >= sizeof(JPEG_SIGNATURE) && memcmp(data, JPEG_SIGNATURE, sizeof(JPEG_SIGNATURE)) == 0;
+	//TGA has no signature, check the image type is one of the ones stb_image reads (color mapped, true color or grey, raw or RLE).
+	bool isTGA = size >= TGA_HEADER_SIZE && ((data[2] >= 1 && data[2] <= 3) || (data[2] >= 9 && data[2] <= 11));
+	if (!isPNG && !isJPEG && !isTGA)
+	{
+		job.message = "Texture isn't a PNG, JPEG or TGA";
+		return false;
+	}
+	return CookCompressed(cooker, job);
+}
+
+//-----------------------------------------------------------------------------------
+static bool CookFont(const AssetCooker& cooker, CookJob& job)
+{
+	StringView text(reinterpret_cast<const char*>(job.source.data), job.source.size);
+	if (!text.StartsWith("info "))
+	{
+		job.message = "Font isn't a BMFont text descriptor";
+		return false;
+	}
+	return CookCompressed(cooker, job);
+}
+
+//ASSET COOKER//////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+AssetCooker::AssetCooker(const CookSettings& settings)
+	: m_settings(settings)
+{
+	SetUpStep(m_copyStep, "copy", 1, "", &CookCopy);
+	RegisterStep(".picomesh", "mesh", 1, "", &CookMesh);
+	RegisterStep(".picoskel", "skeleton", 1, "", &CookSkeleton);
+	RegisterStep(".picomotion", "motion", 1, "", &CookMotion);
+	RegisterStep(".png", "texture", 1, "", &CookTexture);
+	RegisterStep(".jpg", "texture", 1, "", &CookTexture);
+	RegisterStep(".tga", "texture", 1, "", &CookTexture);
+	RegisterStep(".fnt", "font", 1, "", &CookFont);
+	RegisterStep(".vert", "shader", 1, "", &CookCompressed);
+	RegisterStep(".frag", "shader", 1, "", &CookCompressed);
+	RegisterStep(".glsl", "shader", 1, "", &CookCompressed);
+	RegisterUnavailableStep(".fbx", "needs the FBX SDK, cook it with a TOOLS_BUILD of the engine");
+}
+
+//-----------------------------------------------------------------------------------
+static std::string ToLowercase(std::string text)
+{
+	for (char& character : text)
+	{
+		character = (character >= 'A' && character <= 'Z') ? character + ('a' - 'A') : character;
+	}
+	return text;
+}
+
+//-----------------------------------------------------------------------------------
+static std::string GetLowercaseExtension(const std::string& path)
+{
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of("/\\");
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+	{
+		return std::string();
+	}
+	return ToLowercase(path.substr(dot));
+}
+
+//-----------------------------------------------------------------------------------
+void AssetCooker::RegisterStep(const std::string& extension, const std::string& name, uint32_t version, const std::string& stepSettings, const CookFunction& function)
+{
+	SetUpStep(m_steps[ToLowercase(extension)], name, version, stepSettings, function);
+}
+
+//-----------------------------------------------------------------------------------
+//The compression settings change what every step writes, so they're part of every step's hash.
+void AssetCooker::SetUpStep(CookStep& outStep, const std::string& name, uint32_t version, const std::string& stepSettings, const CookFunction& function) const
+{
+	outStep.name = name;
+	outStep.function = function;
+	outStep.isAvailable = true;
+	uint32_t manifestVersion = MANIFEST_VERSION;
+	uint32_t compressionBlockSize = m_settings.compress ? m_settings.compressionBlockSize : 0;
+	outStep.hash = HashBytes(name.c_str(), name.size() + 1);
+	outStep.hash = HashBytes(&version, sizeof(version), outStep.hash);
+	outStep.hash = HashBytes(stepSettings.c_str(), stepSettings.size() + 1, outStep.hash);
+	outStep.hash = HashBytes(&compressionBlockSize, sizeof(compressionBlockSize), outStep.hash);
+	outStep.hash = HashBytes(&manifestVersion, sizeof(manifestVersion), outStep.hash);
+}
+
+//-----------------------------------------------------------------------------------
+void AssetCooker::RegisterUnavailableStep(const std::string& extension, const std::string& reason)
+{
+	CookStep& step = m_steps[ToLowercase(extension)];
+	step.name = reason;
+	step.function = nullptr;
+	step.hash = 0;
+	step.isAvailable = false;
+}
+
+//-----------------------------------------------------------------------------------
+const AssetCooker::CookStep& AssetCooker::FindStep(const std::string& sourcePath) const
+{
+	auto found = m_steps.find(GetLowercaseExtension(sourcePath));
+	return found != m_steps.end() ? found->second : m_copyStep;
+}
+
+//-----------------------------------------------------------------------------------
+uint64_t AssetCooker::HashBytes(const void* data, size_t size, uint64_t hash /*= HASH_SEED*/)
+{
+	const uint64_t FNV_PRIME = 1099511628211ULL;
+	const byte* bytes = static_cast<const byte*>(data);
+	const byte* wordsEnd = bytes + (size & ~(size_t)7);
+	for (; bytes < wordsEnd; bytes += 8)
+	{
+		uint64_t word;
+		memcpy(&word, bytes, sizeof(word));
+		hash ^= word;
+		hash *= FNV_PRIME;
+	}
+	for (const byte* end = static_cast<const byte*>(data) + size; bytes < end; ++bytes)
+	{
+		hash ^= *bytes;
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+//-----------------------------------------------------------------------------------
+std::string AssetCooker::ReplaceExtension(const std::string& path, const char* newExtension)
+{
+	size_t extensionLength = GetLowercaseExtension(path).size();
+	return path.substr(0, path.size() - extensionLength) + newExtension;
+}
+
+//-----------------------------------------------------------------------------------
+std::string AssetCooker::GetManifestPath() const
+{
+	return m_settings.outputDirectory + "/" + MANIFEST_FILENAME;
+}
+
+//-----------------------------------------------------------------------------------
+static std::string GetDirectory(const std::string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+}
+
+//-----------------------------------------------------------------------------------
+//Compressing has to save at least an eighth of the file to be worth decompressing it on every load.
+bool AssetCooker::WriteOutput(CookJob& job, const std::string& outputPath, const void* data, size_t size, bool allowCompression /*= true*/) const
+{
+	BinaryMemoryWriter compressed;
+	if (allowCompression && m_settings.compress && size > 0)
+	{
+		CompressedBinaryWriter compressor(compressed, m_settings.compressionBlockSize);
+		compressor.WriteBytes(data, size);
+		compressor.Finish();
+		if (compressed.GetSize() <= size - (size / 8))
+		{
+			data = compressed.GetData();
+			size = compressed.GetSize();
+		}
+	}
+
+	BinaryFileWriter file;
+	if (!CreateDirectories(GetDirectory(outputPath)) || !file.Open(outputPath.c_str()))
+	{
+		job.message = "Couldn't open " + outputPath + " for writing";
+		return false;
+	}
+	bool succeeded = file.WriteBytes(data, size) == size && file.Flush();
+	file.Close();
+	if (!succeeded)
+	{
+		job.message = "Couldn't write all of " + outputPath;
+		remove(outputPath.c_str());
+		return false;
+	}
+	job.outputs.push_back(outputPath);
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetCooker::AddOutputFile(CookJob& job, const std::string& outputPath, bool allowCompression /*= true*/) const
+{
+	//Copied out of the view first, the file can't be rewritten while it's mapped.
+	std::vector<byte> contents;
+	{
+		FileView written;
+		if (!written.OpenFromDisk(outputPath.c_str()))
+		{
+			job.message = "Step didn't write " + outputPath;
+			return false;
+		}
+		if (written.WasCompressed() || !allowCompression || !m_settings.compress)
+		{
+			job.outputs.push_back(outputPath);
+			return true;
+		}
+		contents.assign(written.GetData(), written.GetData() + written.GetSize());
+	}
+	return WriteOutput(job, outputPath, contents.data(), contents.size(), allowCompression);
+}
+
+//-----------------------------------------------------------------------------------
+//Runs on one of the workers. Only reads the last manifest and the registered steps, everything it works out goes into outCook.
+void AssetCooker::CookSource(const std::string& sourcePath, const Manifest& lastManifest, SourceCook& outCook) const
+{
+	const CookStep& step = FindStep(sourcePath);
+	auto lastEntry = lastManifest.find(sourcePath);
+	if (!step.isAvailable)
+	{
+		outCook.result = SKIPPED;
+		outCook.message = step.name;
+		if (lastEntry != lastManifest.end())
+		{
+			outCook.entry = lastEntry->second;
+		}
+		return;
+	}
+
+	FileView source;
+	if (!source.OpenFromDisk(sourcePath.c_str()))
+	{
+		outCook.result = FAILED;
+		outCook.message = "Couldn't open the source";
+		return;
+	}
+	outCook.entry.sourceHash = HashBytes(source.GetData(), source.GetSize());
+	outCook.entry.stepHash = step.hash;
+	if (!m_settings.force && lastEntry != lastManifest.end() && lastEntry->second.sourceHash == outCook.entry.sourceHash && lastEntry->second.stepHash == step.hash)
+	{
+		bool areOutputsThere = true;
+		for (const std::string& output : lastEntry->second.outputs)
+		{
+			areOutputsThere = areOutputsThere && IsFileOnDisk(output);
+		}
+		if (areOutputsThere)
+		{
+			outCook.result = UP_TO_DATE;
+			outCook.entry.outputs = lastEntry->second.outputs;
+			return;
+		}
+	}
+
+	CookJob job;
+	job.sourcePath = sourcePath;
+	job.outputPath = m_settings.outputDirectory + "/" + sourcePath;
+	job.source = source.GetSpan();
+	//Steps that write their own files (ie: MeshFile::Write) expect the directory to be there already.
+	bool succeeded = CreateDirectories(GetDirectory(job.outputPath));
+	if (!succeeded)
+	{
+		job.message = "Couldn't create the directory for " + job.outputPath;
+	}
+	succeeded = succeeded && step.function(*this, job);
+	outCook.result = succeeded ? COOKED : FAILED;
+	outCook.message = job.message;
+	outCook.entry.outputs.swap(job.outputs);
+	if (!succeeded)
+	{
+		//Remembered with a hash that can't match, so the outputs are still cleaned up and it's tried again next time.
+		outCook.entry.sourceHash = 0;
+		if (lastEntry != lastManifest.end())
+		{
+			outCook.entry.outputs.insert(outCook.entry.outputs.end(), lastEntry->second.outputs.begin(), lastEntry->second.outputs.end());
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------
+//First line is the header, then a line for each source, tab separated:
+//source hash	step hash	source path	output paths...
+bool AssetCooker::LoadManifest(Manifest& outManifest) const
+{
+	FileView file;
+	if (!file.OpenFromDisk(GetManifestPath().c_str()))
+	{
+		return false;
+	}
+	LineIterator lines(file.GetText());
+	StringView line;
+	if (!lines.GetNextLine(line) || line.ToString() != Stringf("CookManifest %u", MANIFEST_VERSION))
+	{
+		return false;
+	}
+	while (lines.GetNextLine(line))
+	{
+		std::vector<std::string> fields;
+		size_t fieldStart = 0;
+		for (size_t i = 0; i <= line.length; ++i)
+		{
+			if (i == line.length || line.data[i] == '\t')
+			{
+				fields.push_back(std::string(line.data + fieldStart, i - fieldStart));
+				fieldStart = i + 1;
+			}
+		}
+		if (fields.size() < 3)
+		{
+			continue;
+		}
+		ManifestEntry& entry = outManifest[fields[2]];
+		entry.sourceHash = strtoull(fields[0].c_str(), nullptr, 16);
+		entry.stepHash = strtoull(fields[1].c_str(), nullptr, 16);
+		entry.outputs.assign(fields.begin() + 3, fields.end());
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetCooker::SaveManifest(const Manifest& manifest) const
+{
+	std::string text = Stringf("CookManifest %u\n", MANIFEST_VERSION);
+	for (const auto& sourceAndEntry : manifest)
+	{
+		const ManifestEntry& entry = sourceAndEntry.second;
+		text += Stringf("%016llx\t%016llx\t", (unsigned long long)entry.sourceHash, (unsigned long long)entry.stepHash);
+		text += sourceAndEntry.first;
+		for (const std::string& output : entry.outputs)
+		{
+			text += "\t" + output;
+		}
+		text += "\n";
+	}
+	BinaryFileWriter file;
+	if (!CreateDirectories(m_settings.outputDirectory) || !file.Open(GetManifestPath().c_str()))
+	{
+		return false;
+	}
+	bool succeeded = file.WriteBytes(text.data(), text.size()) == text.size() && file.Flush();
+	file.Close();
+	return succeeded;
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetCooker::Cook(CookReport& outReport)
+{
+	double startSeconds = GetCurrentTimeSeconds();
+	outReport = CookReport();
+	//Cooked files showing up as sources would get cooked again on every run.
+	std::string sourcePrefix = m_settings.sourceDirectory + "/";
+	if (m_settings.outputDirectory.compare(0, sourcePrefix.size(), sourcePrefix) == 0 || m_settings.outputDirectory == m_settings.sourceDirectory)
+	{
+		outReport.messages.push_back("Error: The output directory can't be inside the source directory.");
+		return false;
+	}
+
+	Manifest lastManifest;
+	LoadManifest(lastManifest);
+	std::vector<FileListing> sources;
+	ListFilesRecursive(m_settings.sourceDirectory, sources);
+	std::vector<SourceCook> cooks(sources.size());
+	{
+		AsyncLoader workers(m_settings.numWorkers, true);
+		for (size_t i = 0; i < sources.size(); ++i)
+		{
+			const std::string& sourcePath = sources[i].path;
+			SourceCook& cook = cooks[i];
+			workers.Enqueue("cook " + sourcePath, [this, &sourcePath, &lastManifest, &cook](void*&)
+			{
+				CookSource(sourcePath, lastManifest, cook);
+				return true;
+			}, nullptr);
+		}
+		workers.Flush();
+	}
+
+	Manifest manifest;
+	std::set<std::string> currentOutputs;
+	for (size_t i = 0; i < sources.size(); ++i)
+	{
+		const std::string& sourcePath = sources[i].path;
+		SourceCook& cook = cooks[i];
+		switch (cook.result)
+		{
+		case COOKED:
+			++outReport.numCooked;
+			break;
+		case UP_TO_DATE:
+			++outReport.numUpToDate;
+			break;
+		case SKIPPED:
+			++outReport.numSkipped;
+			outReport.messages.push_back("Skipped " + sourcePath + ": " + cook.message);
+			break;
+		case FAILED:
+			++outReport.numFailed;
+			outReport.messages.push_back("Error: Couldn't cook " + sourcePath + ": " + cook.message);
+			break;
+		}
+		if (cook.result != FAILED)
+		{
+			currentOutputs.insert(cook.entry.outputs.begin(), cook.entry.outputs.end());
+		}
+		if (cook.result != SKIPPED || !cook.entry.outputs.empty())
+		{
+			manifest[sourcePath] = cook.entry;
+		}
+	}
+	outReport.numSources = sources.size();
+
+	//Anything cooked last time that nothing produces now is out of date: its source was deleted, or its step writes somewhere else now.
+	std::set<std::string> staleOutputs;
+	for (const auto& sourceAndEntry : lastManifest)
+	{
+		staleOutputs.insert(sourceAndEntry.second.outputs.begin(), sourceAndEntry.second.outputs.end());
+	}
+	for (const auto& sourceAndEntry : manifest)
+	{
+		if (sourceAndEntry.second.sourceHash == 0)
+		{
+			staleOutputs.insert(sourceAndEntry.second.outputs.begin(), sourceAndEntry.second.outputs.end());
+		}
+	}
+	for (const std::string& output : staleOutputs)
+	{
+		if (currentOutputs.find(output) == currentOutputs.end() && remove(output.c_str()) == 0)
+		{
+			++outReport.numRemoved;
+		}
+	}
+	for (auto& sourceAndEntry : manifest)
+	{
+		if (sourceAndEntry.second.sourceHash == 0)
+		{
+			sourceAndEntry.second.outputs.clear();
+		}
+	}
+	bool succeeded = SaveManifest(manifest);
+	if (!succeeded)
+	{
+		outReport.messages.push_back("Error: Couldn't save " + GetManifestPath());
+	}
+
+	//A failed cook would pack stale data, so the archive is left alone until everything cooks.
+	bool isArchiveStale = m_settings.force || outReport.numCooked > 0 || outReport.numRemoved > 0 || !IsFileOnDisk(m_settings.archivePath);
+	if (!m_settings.archivePath.empty() && outReport.numFailed == 0 && isArchiveStale)
+	{
+		std::string cookedSourceDirectory = m_settings.outputDirectory + "/" + m_settings.sourceDirectory;
+		outReport.wasPacked = AssetArchive::Build(cookedSourceDirectory.c_str(), m_settings.archivePath.c_str(), m_settings.outputDirectory.c_str());
+		if (!outReport.wasPacked)
+		{
+			outReport.messages.push_back("Error: Couldn't pack " + m_settings.archivePath);
+			succeeded = false;
+		}
+	}
+	outReport.seconds = GetCurrentTimeSeconds() - startSeconds;
+	return succeeded && outReport.numFailed == 0;
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include "Engine/Input/FileView.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+
+//-----------------------------------------------------------------------------------
+struct CookSettings
+{
+	CookSettings();
+
+	//Relative to the working directory, the same way the game asks for assets (ie: "Data").
+	std::string sourceDirectory;
+	//Cooked files mirror their sources under here (ie: "Data/Fonts/Arial.fnt" is cooked to "Cooked/Data/Fonts/Arial.fnt"). Can't be inside the source directory.
+	std::string outputDirectory;
+	//Packed from the output directory after cooking, with the same paths the game uses. Empty to skip packing.
+	std::string archivePath;
+	//0 uses every core but one.
+	unsigned int numWorkers;
+	uint32_t compressionBlockSize;
+	bool compress;
+	//Cook everything again, whatever the manifest says.
+	bool force;
+};
+
+//-----------------------------------------------------------------------------------
+//One source file on its way through a step.
+struct CookJob
+{
+	std::string sourcePath;
+	//Where the result goes by default, steps that convert to another format change the extension.
+	std::string outputPath;
+	//The source's bytes (decompressed if it was compressed), good until the step returns.
+	ByteSpan source;
+	std::vector<std::string> outputs;
+	//Why it failed, or anything else worth reporting.
+	std::string message;
+};
+
+//-----------------------------------------------------------------------------------
+struct CookReport
+{
+	CookReport() : numSources(0), numCooked(0), numUpToDate(0), numSkipped(0), numFailed(0), numRemoved(0), wasPacked(false), seconds(0.0) {};
+
+	unsigned int numSources;
+	unsigned int numCooked;
+	unsigned int numUpToDate;
+	unsigned int numSkipped;
+	unsigned int numFailed;
+	//Outputs deleted because their source went away or stopped producing them.
+	unsigned int numRemoved;
+	bool wasPacked;
+	double seconds;
+	std::vector<std::string> messages;
+};
+
+//-----------------------------------------------------------------------------------
+//Turns the source tree into cooked files and packs them into an AssetArchive, redoing only the work that's out of date.
+//Each source's contents are hashed, and so is the step that cooks it (its name, version and settings, along with the compression settings).
+//When both match what the manifest saved last time and the outputs are all still there, the source is skipped without running its step.
+//Hashing and cooking happen on a headless AsyncLoader's workers, one request per source, so steps have to be thread safe.
+//
+//Steps are chosen by extension. The constructor registers steps for the engine's own formats that don't need a renderer to cook
+//(meshes, skeletons, motions, textures, fonts and shaders), which check the file is intact and compress it. Anything without a step
+//is copied across as it is. Formats that need something this build doesn't have (ie: the FBX SDK) are registered as unavailable:
+//they're reported as skipped and whatever they cooked to last time is kept. Engine builds add the rest through RegisterEngineCookSteps.
+class AssetCooker
+{
+public:
+	//TYPEDEFS//////////////////////////////////////////////////////////////////////////
+	//Returns false to fail the job, with the reason in job.message. Outputs have to go through WriteOutput or AddOutputFile.
+	typedef std::function<bool(const AssetCooker& cooker, CookJob& job)> CookFunction;
+
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	AssetCooker(const CookSettings& settings);
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	//Replaces whatever was registered for the extension. Bump the version whenever the step's output changes, so everything it cooked is redone.
+	void RegisterStep(const std::string& extension, const std::string& name, uint32_t version, const std::string& stepSettings, const CookFunction& function);
+	void RegisterUnavailableStep(const std::string& extension, const std::string& reason);
+	//Returns false if anything failed to cook or pack.
+	bool Cook(CookReport& outReport);
+
+	//For steps. Compressed when the settings and the step allow it, and it saves enough to be worth decompressing on load.
+	bool WriteOutput(CookJob& job, const std::string& outputPath, const void* data, size_t size, bool allowCompression = true) const;
+	//For steps that write the file themselves (ie: MeshFile::Write), recompresses it in place the same way.
+	bool AddOutputFile(CookJob& job, const std::string& outputPath, bool allowCompression = true) const;
+
+	//GETTERS//////////////////////////////////////////////////////////////////////////
+	inline const CookSettings& GetSettings() const { return m_settings; };
+	std::string GetManifestPath() const;
+
+	//STATIC FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	//FNV-1a over 8 bytes at a time, with the tail done a byte at a time. Only ever compared with itself, it's not the standard FNV-1a.
+	static uint64_t HashBytes(const void* data, size_t size, uint64_t hash = HASH_SEED);
+	static std::string ReplaceExtension(const std::string& path, const char* newExtension);
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const uint64_t HASH_SEED = 14695981039346656037ULL;
+	static const uint32_t MANIFEST_VERSION = 1;
+	static const char* MANIFEST_FILENAME;
+
+private:
+	//STRUCTS//////////////////////////////////////////////////////////////////////////
+	struct CookStep
+	{
+		CookStep() : hash(0), isAvailable(false) {};
+		std::string name;
+		CookFunction function;
+		uint64_t hash;
+		bool isAvailable;
+	};
+
+	struct ManifestEntry
+	{
+		ManifestEntry() : sourceHash(0), stepHash(0) {};
+		uint64_t sourceHash;
+		uint64_t stepHash;
+		std::vector<std::string> outputs;
+	};
+
+	enum CookResult
+	{
+		COOKED,
+		UP_TO_DATE,
+		SKIPPED,
+		FAILED
+	};
+
+	struct SourceCook
+	{
+		SourceCook() : result(FAILED) {};
+		CookResult result;
+		ManifestEntry entry;
+		std::string message;
+	};
+
+	typedef std::map<std::string, ManifestEntry> Manifest;
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void SetUpStep(CookStep& outStep, const std::string& name, uint32_t version, const std::string& stepSettings, const CookFunction& function) const;
+	const CookStep& FindStep(const std::string& sourcePath) const;
+	void CookSource(const std::string& sourcePath, const Manifest& lastManifest, SourceCook& outCook) const;
+	bool LoadManifest(Manifest& outManifest) const;
+	bool SaveManifest(const Manifest& manifest) const;
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	CookSettings m_settings;
+	std::map<std::string, CookStep> m_steps;
+	CookStep m_copyStep;
+};
@@ -0,0 +1,174 @@
+#include "Engine/Tools/EngineCookSteps.hpp"
+#include "Engine/Tools/AssetCooker.hpp"
+#include "Engine/Tools/fbx.hpp"
+#include "Engine/Tools/gltf.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Input/BinaryReader.hpp"
+#include "Engine/Input/BinaryWriter.hpp"
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/MeshFile.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+
+//-----------------------------------------------------------------------------------
+//The same clean up fbxLoad does, plus tangent frames that follow the UVs so nothing has to generate them at load time.
+//Tangents go before the LODs since they can split vertices along mirror seams.
+static void OptimizeForCooking(MeshBuilder& builder)
+{
+	builder.WeldVertices();
+	builder.GenerateTangents();
+	if (builder.m_lods.empty())
+	{
+		builder.GenerateLODs({ 0.5f, 0.25f, 0.1f });
+	}
+	builder.OptimizeVertexCache();
+	builder.OptimizeVertexFetch();
+}
+
+//-----------------------------------------------------------------------------------
+//Older mesh streams come out the other side as the current mappable MeshFile, under the same name.
+static bool CookOptimizedMesh(const AssetCooker& cooker, CookJob& job)
+{
+	if (job.source.size < sizeof(uint32_t))
+	{
+		job.message = "Mesh is empty";
+		return false;
+	}
+	//The readers die on a mesh they can't read, so each kind is checked before it's handed over.
+	MeshBuilder builder;
+	MeshFile meshFile;
+	if (MeshFile::IsMeshFile(job.source.data, job.source.size))
+	{
+		if (!meshFile.Open(job.sourcePath.c_str()))
+		{
+			job.message = "Mesh file is corrupt or from a newer version of the engine";
+			return false;
+		}
+		builder.ReadFromMeshFile(meshFile);
+	}
+	else if (MeshBuilder::IsReadableStream(job.source.data, job.source.size))
+	{
+		BinaryMemoryReader reader(job.source.data, job.source.size);
+		builder.ReadFromStream(reader);
+	}
+	else
+	{
+		job.message = "Mesh is cut off, corrupt, or a mesh stream this engine can't read";
+		return false;
+	}
+	if (builder.IsEmpty())
+	{
+		job.message = "Mesh has no vertices";
+		return false;
+	}
+	OptimizeForCooking(builder);
+	if (!MeshFile::Write(job.outputPath.c_str(), builder))
+	{
+		job.message = "Couldn't write " + job.outputPath;
+		return false;
+	}
+	return cooker.AddOutputFile(job, job.outputPath);
+}
+
+//-----------------------------------------------------------------------------------
+template<typename T>
+static bool WriteStreamOutput(const AssetCooker& cooker, CookJob& job, const std::string& outputPath, T& object)
+{
+	BinaryMemoryWriter writer;
+	object.WriteToStream(writer);
+	return cooker.WriteOutput(job, outputPath, writer.GetData(), writer.GetSize());
+}
+
+//-----------------------------------------------------------------------------------
+//Every mesh in the scene is merged into one .picomesh, the first skeleton becomes a .picoskel and each motion a .picomotion,
+//all next to where the scene would have been cooked to. Extra motions are numbered after the first (ie: run.picomotion, run_1.picomotion).
+//Takes the import and deletes it, along with everything in it.
+static bool CookSceneImport(const AssetCooker& cooker, CookJob& job, SceneImport* import)
+{
+	bool succeeded = true;
+	if (!import->meshes.empty())
+	{
+		MeshBuilder* builder = MeshBuilder::Merge(import->meshes.data(), import->meshes.size());
+		//FBX meshes come in as triangle soup, glTF ones are already indexed.
+		if (builder->m_indices.empty())
+		{
+			builder->AddLinearIndices();
+		}
+		OptimizeForCooking(*builder);
+		std::string meshPath = AssetCooker::ReplaceExtension(job.outputPath, ".picomesh");
+		succeeded = MeshFile::Write(meshPath.c_str(), *builder) && cooker.AddOutputFile(job, meshPath);
+		if (!succeeded && job.message.empty())
+		{
+			job.message = "Couldn't write " + meshPath;
+		}
+		delete builder;
+	}
+	if (succeeded && !import->skeletons.empty())
+	{
+		succeeded = WriteStreamOutput(cooker, job, AssetCooker::ReplaceExtension(job.outputPath, ".picoskel"), *import->skeletons[0]);
+	}
+	for (unsigned int i = 0; succeeded && i < import->motions.size(); ++i)
+	{
+		std::string suffix = i == 0 ? std::string(".picomotion") : Stringf("_%u.picomotion", i);
+		succeeded = WriteStreamOutput(cooker, job, AssetCooker::ReplaceExtension(job.outputPath, suffix.c_str()), *import->motions[i]);
+	}
+	if (succeeded && job.outputs.empty())
+	{
+		job.message = "Scene has no meshes, skeletons or motions";
+		succeeded = false;
+	}
+
+	for (Skeleton* skeleton : import->skeletons)
+	{
+		delete skeleton;
+	}
+	for (AnimationMotion* motion : import->motions)
+	{
+		delete motion;
+	}
+	delete import;
+	return succeeded;
+}
+
+//-----------------------------------------------------------------------------------
+//Imported straight from the bytes the cooker already has.
+static bool CookGlb(const AssetCooker& cooker, CookJob& job)
+{
+	const size_t lastSlash = job.sourcePath.find_last_of("/\\");
+	std::string baseDirectory = lastSlash == std::string::npos ? std::string() : job.sourcePath.substr(0, lastSlash + 1);
+	std::string error;
+	SceneImport* import = GltfLoadSceneFromMemory(job.source.data, job.source.size, baseDirectory, false, Matrix4x4::IDENTITY, 30.0f, &error);
+	if (import == nullptr)
+	{
+		job.message = error;
+		return false;
+	}
+	return CookSceneImport(cooker, job, import);
+}
+
+#if defined(TOOLS_BUILD)
+//-----------------------------------------------------------------------------------
+static bool CookFbx(const AssetCooker& cooker, CookJob& job)
+{
+	SceneImport* import = FbxLoadSceneFromFile(job.sourcePath.c_str(), Matrix4x4::IDENTITY, false, Matrix4x4::IDENTITY);
+	if (import == nullptr)
+	{
+		job.message = "The FBX SDK couldn't import it";
+		return false;
+	}
+	return CookSceneImport(cooker, job, import);
+}
+#endif
+
+//-----------------------------------------------------------------------------------
+void RegisterEngineCookSteps(AssetCooker& cooker)
+{
+	cooker.RegisterStep(".picomesh", "optimized mesh", 3, "tangents lods 0.5 0.25 0.1", &CookOptimizedMesh);
+	cooker.RegisterStep(".glb", "glb scene", 2, "tangents lods 0.5 0.25 0.1 motions 30fps", &CookGlb);
+	//The cooker only notices changes to the file it cooked, and a .gltf's buffers are usually separate files.
+	cooker.RegisterUnavailableStep(".gltf", "only self contained .glb scenes are cooked, export it as one");
+#if defined(TOOLS_BUILD)
+	cooker.RegisterStep(".fbx", "fbx scene", 3, "tangents lods 0.5 0.25 0.1", &CookFbx);
+#endif
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+class AssetCooker;
+
+//STANDALONE FUNCTIONS//////////////////////////////////////////////////////////////////////////
+//Replaces the portable mesh step with one that welds, generates tangents and LODs and optimizes before writing the mappable MeshFile,
+//and cooks .glb scenes (plus .fbx ones on a TOOLS_BUILD) into the engine's mesh, skeleton and motion files. These need the rest of the engine linked in.
+void RegisterEngineCookSteps(AssetCooker& cooker);
@@ -0,0 +1,16 @@
+#pragma once
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include <vector>
+
+class Skeleton;
+class AnimationMotion;
+
+//-----------------------------------------------------------------------------------
+//Everything an importer pulled out of a scene file. The caller owns the skeletons and motions and has to delete them.
+class SceneImport
+{
+public:
+	std::vector<MeshBuilder> meshes;
+	std::vector<Skeleton*> skeletons;
+	std::vector<AnimationMotion*> motions;
+};
@@ -2,10 +2,18 @@
 #include "Engine/Input/Console.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/AsyncLoader.hpp"
 #include "Engine/Math/MatrixStack4x4.hpp"
 #include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/VertexLayout.hpp"
 #include "Engine/Renderer/Skeleton.hpp"
 #include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Input/BinaryReader.hpp"
+#include "Engine/Input/BinaryWriter.hpp"
+#include "Engine/Input/FileView.hpp"
+#include "Engine/Input/InputOutputUtils.hpp"
+#include "Engine/Input/Compression.hpp"
+#include "Engine/Time/Time.hpp"
 
 Mesh* g_loadedMesh = nullptr;
 MeshBuilder* g_loadedMeshBuilder = nullptr;
@@ -25,6 +33,16 @@ extern AnimationMotion* g_loadedMotion;
         FbxListScene(filename.c_str());
     }
 
+    //-----------------------------------------------------------------------------------
+    //Everything fbxLoad does before it needs GL, done on one of the loader's workers.
+    struct FbxLoadResult
+    {
+        FbxLoadResult() : import(nullptr), builder(nullptr), removedVertexCount(0) {};
+        SceneImport* import;
+        MeshBuilder* builder;
+        unsigned int removedVertexCount;
+    };
+
     //-----------------------------------------------------------------------------------
     CONSOLE_COMMAND(fbxLoad)
     {
@@ -38,25 +56,223 @@ extern AnimationMotion* g_loadedMotion;
         float scale = args.HasArgs(2) ? args.GetFloatArgument(1) : 1.0f;
         Matrix4x4 transform;
         Matrix4x4::MatrixMakeScale(&transform, scale);
-        
-        SceneImport* import = FbxLoadSceneFromFile(filename.c_str(), Matrix4x4::IDENTITY, false, transform);
-        if (import == nullptr)
+        if (!FileExists(filename))
         {
             Console::instance->PrintLine(Stringf("Failed to load file. '%s'", filename.c_str()));
             DebuggerPrintf("Failed to load file. '%s'", filename.c_str());
+            return;
+        }
+
+        //Importing, welding, LOD generation and the cache optimizations all happen off the main thread so the frame doesn't stall,
+        //the previously loaded mesh keeps rendering until the new one is uploaded.
+        std::shared_ptr<FbxLoadResult> result = std::make_shared<FbxLoadResult>();
+        AsyncLoader::instance->Enqueue("fbxLoad " + filename,
+            [filename, transform, result](void*&)
+            {
+                result->import = FbxLoadSceneFromFile(filename.c_str(), Matrix4x4::IDENTITY, false, transform);
+                if (result->import == nullptr)
+                {
+                    return true;
+                }
+                result->builder = MeshBuilder::Merge(result->import->meshes.data(), result->import->meshes.size());
+                result->builder->AddLinearIndices();
+                result->removedVertexCount = result->builder->WeldVertices();
+                result->builder->GenerateLODs({ 0.5f, 0.25f, 0.1f });
+                result->builder->OptimizeVertexCache();
+                result->builder->OptimizeVertexFetch();
+                return true;
+            },
+            [filename, result](void*&)
+            {
+                SceneImport* import = result->import;
+                if (import == nullptr)
+                {
+                    Console::instance->PrintLine(Stringf("Failed to load file. '%s'", filename.c_str()));
+                    DebuggerPrintf("Failed to load file. '%s'", filename.c_str());
+                    return false;
+                }
+                Console::instance->PrintLine(Stringf("Loaded '%s'. Had %i meshes.", filename.c_str(), import->meshes.size()));
+                DebuggerPrintf("Loaded '%s'. Had %i meshes.", filename.c_str(), import->meshes.size());
+                Console::instance->PrintLine(Stringf("Welded away %i duplicate vertices, %i remain.", result->removedVertexCount, result->builder->GetVertexCount()));
+                Console::instance->PrintLine(Stringf("Generated %i LODs.", result->builder->m_lods.size()));
+                g_loadedMesh = new Mesh();
+                g_loadedMeshBuilder = result->builder;
+                g_loadedMeshBuilder->CopyToMesh<Layout_SkinnedPCTN>(g_loadedMesh);
+                g_loadedSkeleton = import->skeletons.size() > 0 ? import->skeletons[0] : nullptr;
+                g_loadedMotion = import->motions.size() > 0 ? import->motions[0] : nullptr;
+                delete import;
+                return true;
+            });
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Writes the object out, reads it back into a fresh one and writes that out again. Both passes should come out byte for byte the same.
+    template<typename T>
+    static bool RoundTripsInMemory(T& original, size_t& outSize)
+    {
+        BinaryMemoryWriter firstPass;
+        original.WriteToStream(firstPass);
+        T copy;
+        BinaryMemoryReader reader(firstPass.GetData(), firstPass.GetSize());
+        copy.ReadFromStream(reader);
+        BinaryMemoryWriter secondPass;
+        copy.WriteToStream(secondPass);
+        outSize = firstPass.GetSize();
+        return reader.GetRemainingSize() == 0 && firstPass.GetSize() == secondPass.GetSize() && memcmp(firstPass.GetData(), secondPass.GetData(), firstPass.GetSize()) == 0;
+    }
+
+    //-----------------------------------------------------------------------------------
+    CONSOLE_COMMAND(streamSelfTest)
+    {
+        if (!args.HasArgs(0))
+        {
+            Console::instance->PrintLine("streamSelfTest", RGBA::RED);
+            return;
+        }
+        if (!g_loadedMeshBuilder && !g_loadedSkeleton && !g_loadedMotion)
+        {
+            Console::instance->PrintLine("Error: Nothing has been loaded yet, use fbxLoad to bring in a mesh first.", RGBA::RED);
+            return;
+        }
+        size_t size = 0;
+        if (g_loadedMeshBuilder)
+        {
+            bool passed = RoundTripsInMemory(*g_loadedMeshBuilder, size);
+            Console::instance->PrintLine(Stringf("Mesh: %i bytes, %s", size, passed ? "passed" : "FAILED"), passed ? RGBA::GREEN : RGBA::RED);
+        }
+        if (g_loadedSkeleton)
+        {
+            bool passed = RoundTripsInMemory(*g_loadedSkeleton, size);
+            Console::instance->PrintLine(Stringf("Skeleton: %i bytes, %s", size, passed ? "passed" : "FAILED"), passed ? RGBA::GREEN : RGBA::RED);
+        }
+        if (g_loadedMotion)
+        {
+            bool passed = RoundTripsInMemory(*g_loadedMotion, size);
+            Console::instance->PrintLine(Stringf("Motion: %i bytes, %s", size, passed ? "passed" : "FAILED"), passed ? RGBA::GREEN : RGBA::RED);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    CONSOLE_COMMAND(compressFile)
+    {
+        if (!args.HasArgs(2))
+        {
+            Console::instance->PrintLine("compressFile <filename> <compressed filename>", RGBA::RED);
+            return;
+        }
+        std::string filename = args.GetStringArgument(0);
+        std::string compressedFilename = args.GetStringArgument(1);
+        FileView source;
+        if (!source.OpenFromDisk(filename.c_str()))
+        {
+            Console::instance->PrintLine(Stringf("Error: Couldn't open %s.", filename.c_str()), RGBA::RED);
+            return;
+        }
+        BinaryFileWriter file;
+        if (!file.Open(compressedFilename.c_str()))
+        {
+            Console::instance->PrintLine(Stringf("Error: Couldn't open %s for writing.", compressedFilename.c_str()), RGBA::RED);
+            return;
+        }
+        CompressedBinaryWriter writer(file);
+        writer.WriteBytes(source.GetData(), source.GetSize());
+        writer.Finish();
+        file.Close();
+        Console::instance->PrintLine(Stringf("Compressed %s: %i bytes to %i (%.1f%%).", filename.c_str(), source.GetSize(), writer.GetCompressedSize(), 
+            source.GetSize() > 0 ? (100.0 * writer.GetCompressedSize()) / source.GetSize() : 100.0));
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Loads the file the way the game would, through the loader for its type.
+    static void LoadAssetForBenchmark(const char* filename)
+    {
+        std::string name = filename;
+        if (name.find(".picomesh") != std::string::npos)
+        {
+            MeshBuilder builder;
+            builder.ReadFromFile(filename);
+        }
+        else if (name.find(".picomotion") != std::string::npos)
+        {
+            AnimationMotion motion;
+            motion.ReadFromFile(filename);
         }
         else
         {
-            Console::instance->PrintLine(Stringf("Loaded '%s'. Had %i meshes.", filename.c_str(), import->meshes.size()));
-            DebuggerPrintf("Loaded '%s'. Had %i meshes.", filename.c_str(), import->meshes.size());
-            g_loadedMesh = new Mesh();
-            g_loadedMeshBuilder = MeshBuilder::Merge(import->meshes.data(), import->meshes.size());
-            g_loadedMeshBuilder->AddLinearIndices();
-            g_loadedMeshBuilder->CopyToMesh(g_loadedMesh, &Vertex_SkinnedPCTN::Copy, sizeof(Vertex_SkinnedPCTN), &Vertex_SkinnedPCTN::BindMeshToVAO);
-            g_loadedSkeleton = import->skeletons.size() > 0 ? import->skeletons[0] : nullptr;
-            g_loadedMotion = import->motions.size() > 0 ? import->motions[0] : nullptr;
+            FileView view(filename);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Times loading the raw file against loading a compressed copy of it, and how fast the decompressor itself runs.
+    CONSOLE_COMMAND(compressionBenchmark)
+    {
+        std::vector<std::string> filenames;
+        if (args.HasArgs(0))
+        {
+            filenames.push_back("Data/joltik.picomesh");
+            filenames.push_back("run.picomotion");
+            filenames.push_back("lose.picomotion");
+        }
+        else if (args.HasArgs(1))
+        {
+            filenames.push_back(args.GetStringArgument(0));
+        }
+        else
+        {
+            Console::instance->PrintLine("compressionBenchmark <optional filename>", RGBA::RED);
+            return;
+        }
+        const int NUM_ITERATIONS = 20;
+        for (const std::string& filename : filenames)
+        {
+            FileView raw;
+            if (!raw.OpenFromDisk(filename.c_str()) || raw.WasCompressed())
+            {
+                Console::instance->PrintLine(Stringf("Skipping %s, it's missing or already compressed.", filename.c_str()), RGBA::RED);
+                continue;
+            }
+            double startTime = GetCurrentTimeSeconds();
+            BinaryMemoryWriter compressed;
+            CompressedBinaryWriter compressor(compressed);
+            compressor.WriteBytes(raw.GetData(), raw.GetSize());
+            compressor.Finish();
+            double compressSeconds = GetCurrentTimeSeconds() - startTime;
+
+            std::vector<byte> decompressed(raw.GetSize());
+            startTime = GetCurrentTimeSeconds();
+            bool roundTrips = true;
+            for (int i = 0; i < NUM_ITERATIONS; ++i)
+            {
+                roundTrips = roundTrips && Compression::DecompressStream(compressed.GetData(), compressed.GetSize(), decompressed.data(), decompressed.size());
+            }
+            double decompressSeconds = (GetCurrentTimeSeconds() - startTime) / NUM_ITERATIONS;
+            roundTrips = roundTrips && memcmp(decompressed.data(), raw.GetData(), raw.GetSize()) == 0;
+
+            std::string compressedFilename = filename + ".lz";
+            BinaryFileWriter file;
+            ASSERT_OR_DIE(file.Open(compressedFilename.c_str()), "Couldn't write the compressed copy");
+            file.WriteBytes(compressed.GetData(), compressed.GetSize());
+            file.Close();
+            startTime = GetCurrentTimeSeconds();
+            for (int i = 0; i < NUM_ITERATIONS; ++i)
+            {
+                LoadAssetForBenchmark(filename.c_str());
+            }
+            double rawLoadSeconds = (GetCurrentTimeSeconds() - startTime) / NUM_ITERATIONS;
+            startTime = GetCurrentTimeSeconds();
+            for (int i = 0; i < NUM_ITERATIONS; ++i)
+            {
+                LoadAssetForBenchmark(compressedFilename.c_str());
+            }
+            double compressedLoadSeconds = (GetCurrentTimeSeconds() - startTime) / NUM_ITERATIONS;
+            remove(compressedFilename.c_str());
+
+            Console::instance->PrintLine(Stringf("%s: %i -> %i bytes (%.1f%%), compress %.1f MB/s, decompress %.1f MB/s, %s", filename.c_str(), raw.GetSize(), compressed.GetSize(),
+                (100.0 * compressed.GetSize()) / raw.GetSize(), raw.GetSize() / (compressSeconds * 1024.0 * 1024.0), raw.GetSize() / (decompressSeconds * 1024.0 * 1024.0),
+                roundTrips ? "round trip matches" : "round trip MISMATCH!"), roundTrips ? RGBA::GREEN : RGBA::RED);
+            Console::instance->PrintLine(Stringf("    Load: raw %.3f ms, compressed %.3f ms", rawLoadSeconds * 1000.0, compressedLoadSeconds * 1000.0));
         }
-        delete import;
     }
 
     //-----------------------------------------------------------------------------------
@@ -212,15 +428,26 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    static bool GetPosition(Vector3* outPosition, const Matrix4x4& transform, FbxMesh* mesh, int polyIndex, int vertIndex)
+    //Control points are shared between polygons, so they're transformed once up front in ImportMesh.
+    static bool GetPosition(Vector3* outPosition, const std::vector<Vector3>& transformedControlPoints, FbxMesh* mesh, int polyIndex, int vertIndex)
     {
-        FbxVector4 fbxPosition;
         int controlIndex = mesh->GetPolygonVertex(polyIndex, vertIndex);
-        fbxPosition = mesh->GetControlPointAt(controlIndex);
-        *outPosition = Vector3(Vector4(ToEngineVec3(fbxPosition), 1.0f) * transform);
+        *outPosition = transformedControlPoints[controlIndex];
         return true;
     }
 
+    //-----------------------------------------------------------------------------------
+    static void GetTransformedControlPoints(std::vector<Vector3>& outControlPoints, const Matrix4x4& transform, FbxMesh* mesh)
+    {
+        int controlPointCount = mesh->GetControlPointsCount();
+        outControlPoints.resize(controlPointCount);
+        for (int controlIndex = 0; controlIndex < controlPointCount; ++controlIndex)
+        {
+            outControlPoints[controlIndex] = ToEngineVec3(mesh->GetControlPointAt(controlIndex));
+        }
+        Matrix4x4::MatrixTransformPoints(&transform, outControlPoints.data(), outControlPoints.data(), outControlPoints.size());
+    }
+
     //-----------------------------------------------------------------------------------
     template <typename ElemType, typename VarType>
     static bool GetObjectFromElement(FbxMesh* mesh, int polyIndex, int vertIndex, ElemType* elem, VarType* outVar)
@@ -296,7 +523,7 @@ extern AnimationMotion* g_loadedMotion;
         if (GetObjectFromElement(mesh, polyIndex, vertIndex, normals, &normal))
         {
             Vector3 n = ToEngineVec3(normal);
-            outNormal = Vector3(Vector4(n, 0.0f) * transform);
+            outNormal = Matrix4x4::MatrixTransformDirection(&transform, n);
             return true;
         }
 
@@ -332,7 +559,7 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    static void ImportVertex(MeshBuilder& builder, const Matrix4x4& transform, FbxMesh* mesh, int polyIndex, int vertIndex, std::vector<SkinWeight>& skinWeights)
+    static void ImportVertex(MeshBuilder& builder, const Matrix4x4& transform, const std::vector<Vector3>& transformedControlPoints, FbxMesh* mesh, int polyIndex, int vertIndex, std::vector<SkinWeight>& skinWeights)
     {
         Vector3 normal;
         if (GetNormal(normal, transform, mesh, polyIndex, vertIndex))
@@ -377,7 +604,7 @@ extern AnimationMotion* g_loadedMotion;
         }
 
         Vector3 position;
-        if (GetPosition(&position, transform, mesh, polyIndex, vertIndex))
+        if (GetPosition(&position, transformedControlPoints, mesh, polyIndex, vertIndex))
         {
             builder.AddVertex(position);
         }
@@ -598,6 +825,8 @@ extern AnimationMotion* g_loadedMotion;
         builder.Begin();
         {
             Matrix4x4 transform = matrixStack.GetTop();
+            std::vector<Vector3> transformedControlPoints;
+            GetTransformedControlPoints(transformedControlPoints, transform, mesh);
             int polyCount = mesh->GetPolygonCount();
             for (int polyIndex = 0; polyIndex < polyCount; ++polyIndex)
             {
@@ -605,7 +834,7 @@ extern AnimationMotion* g_loadedMotion;
                 ASSERT_OR_DIE(vertCount == 3, "Vertex count was not 3");
                 for (int vertIndex = 0; vertIndex < vertCount; ++vertIndex)
                 {
-                    ImportVertex(builder, transform, mesh, polyIndex, vertIndex, skinWeights);
+                    ImportVertex(builder, transform, transformedControlPoints, mesh, polyIndex, vertIndex, skinWeights);
                 }
             }
         }
@@ -926,6 +1155,29 @@ extern AnimationMotion* g_loadedMotion;
         }
     }
 
+    //-----------------------------------------------------------------------------------
+    //Joints come in using the FBX traversal order, which doesn't promise parents before children or contiguous subtrees.
+    //Reorder them depth-first and carry everything that indexes joints along with it.
+    static void ReorderSkeletonJoints(SceneImport* import)
+    {
+        if (import->skeletons.size() == 0)
+        {
+            return;
+        }
+
+        //Only supporting one skeleton for now, same as ImportMotions.
+        Skeleton* skeleton = import->skeletons.at(0);
+        std::vector<int> oldToNewJointIndices = skeleton->ReorderJointsDepthFirst();
+        for (MeshBuilder& builder : import->meshes)
+        {
+            builder.RemapBoneIndices(oldToNewJointIndices);
+        }
+        for (AnimationMotion* motion : import->motions)
+        {
+            motion->RemapJoints(oldToNewJointIndices);
+        }
+    }
+
     //-----------------------------------------------------------------------------------
     static void ImportScene(SceneImport* import, FbxScene* scene, MatrixStack4x4& matrixStack)
     {
@@ -937,6 +1189,7 @@ extern AnimationMotion* g_loadedMotion;
         //Top contains just our change of basis and scale matrices at this point
         Matrix4x4 top = matrixStack.GetTop();
         ImportMotions(import, scene, top, nodeToJointIndex, 10.f);
+        ReorderSkeletonJoints(import);
     }
 
     //-----------------------------------------------------------------------------------
@@ -1,19 +1,8 @@
 #pragma once
-#include "Engine/Renderer/MeshBuilder.hpp"
-#include <vector>
+#include "Engine/Tools/SceneImport.hpp"
 
 class Mesh;
 class Matrix4x4;
-class Skeleton;
-class AnimationMotion;
-
-class SceneImport
-{
-public:
-	std::vector<MeshBuilder> meshes;
-	std::vector<Skeleton*> skeletons;
-	std::vector<AnimationMotion*> motions;
-};
 
 //STANDALONE FUNCTIONS//////////////////////////////////////////////////////////////////////////
 void FbxListScene(const char* filename);
@@ -0,0 +1,1552 @@
+#include "Engine/Tools/gltf.hpp"
+#include "Engine/Input/JsonDocument.hpp"
+#include "Engine/Input/FileView.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Math/Vector4Int.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include <cmath>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+//CONSTANTS//////////////////////////////////////////////////////////////////////////
+static const uint32_t GLB_MAGIC = 0x46546C67; //"glTF"
+static const uint32_t GLB_VERSION = 2;
+static const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+static const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+static const unsigned int GLTF_MODE_TRIANGLES = 4;
+//Sanity limits so a corrupt count or key time fails the import instead of trying to allocate all of memory.
+static const uint64_t MAX_ACCESSOR_COUNT = 1 << 26;
+static const float MAX_MOTION_SECONDS = 3600.0f;
+
+enum GltfComponentType
+{
+	GLTF_BYTE = 5120,
+	GLTF_UNSIGNED_BYTE = 5121,
+	GLTF_SHORT = 5122,
+	GLTF_UNSIGNED_SHORT = 5123,
+	GLTF_UNSIGNED_INT = 5125,
+	GLTF_FLOAT = 5126
+};
+
+enum GltfInterpolation
+{
+	GLTF_LINEAR,
+	GLTF_STEP,
+	GLTF_CUBICSPLINE
+};
+
+enum GltfTargetPath
+{
+	GLTF_TRANSLATION,
+	GLTF_ROTATION,
+	GLTF_SCALE
+};
+
+//-----------------------------------------------------------------------------------
+//Where an accessor's elements are in the mapped buffers. A null data pointer means every element starts out zero (only sparse accessors do that).
+struct GltfAccessor
+{
+	GltfAccessor() : data(nullptr), stride(0), count(0), componentType(0), numComponents(0), normalized(false), sparseCount(0), sparseIndices(nullptr), sparseIndexType(0), sparseValues(nullptr) {};
+	inline bool IsTightlyPacked(unsigned int componentSize) const { return data && sparseCount == 0 && stride == componentSize * numComponents; };
+
+	const byte* data;
+	unsigned int stride;
+	unsigned int count;
+	unsigned int componentType;
+	unsigned int numComponents;
+	bool normalized;
+	//Sparse elements replace the ones at their indices, the values are tightly packed.
+	unsigned int sparseCount;
+	const byte* sparseIndices;
+	unsigned int sparseIndexType;
+	const byte* sparseValues;
+};
+
+//-----------------------------------------------------------------------------------
+struct GltfNode
+{
+	GltfNode() : parent(-1), mesh(-1), skin(-1), hasMatrix(false), isInScene(false), isVisited(false)
+	{
+		translation[0] = translation[1] = translation[2] = 0.0f;
+		rotation[0] = rotation[1] = rotation[2] = 0.0f;
+		rotation[3] = 1.0f;
+		scale[0] = scale[1] = scale[2] = 1.0f;
+	};
+
+	std::string name;
+	int parent;
+	int mesh;
+	int skin;
+	std::vector<int> children;
+	//Nodes given as a matrix can't be animated, the rest keep their TRS so channels can replace parts of it.
+	bool hasMatrix;
+	float translation[3];
+	float rotation[4];
+	float scale[3];
+	Matrix4x4 restLocal;
+	Matrix4x4 restGlobal;
+	bool isInScene;
+	bool isVisited;
+};
+
+//-----------------------------------------------------------------------------------
+struct GltfSampler
+{
+	GltfSampler() : numComponents(0), interpolation(GLTF_LINEAR), cursor(0) {};
+	std::vector<float> times;
+	//For cubic splines every key is an in-tangent, the value and an out-tangent.
+	std::vector<float> values;
+	unsigned int numComponents;
+	GltfInterpolation interpolation;
+	//Key the last sample landed after. Frames are sampled in order, so finding the next key only ever walks forward.
+	unsigned int cursor;
+};
+
+//-----------------------------------------------------------------------------------
+struct GltfChannel
+{
+	GltfChannel() : sampler(0), node(0), path(GLTF_TRANSLATION) {};
+	unsigned int sampler;
+	unsigned int node;
+	GltfTargetPath path;
+};
+
+//-----------------------------------------------------------------------------------
+static unsigned int GetComponentSize(unsigned int componentType)
+{
+	switch (componentType)
+	{
+	case GLTF_BYTE:
+	case GLTF_UNSIGNED_BYTE:
+		return 1;
+	case GLTF_SHORT:
+	case GLTF_UNSIGNED_SHORT:
+		return 2;
+	case GLTF_UNSIGNED_INT:
+	case GLTF_FLOAT:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+//-----------------------------------------------------------------------------------
+//MAT2 and MAT3 aren't supported, their columns are padded out to 4 bytes for the smaller component types and nothing we import uses them.
+static unsigned int GetNumComponents(const std::string& type)
+{
+	if (type == "SCALAR")
+	{
+		return 1;
+	}
+	else if (type == "VEC2")
+	{
+		return 2;
+	}
+	else if (type == "VEC3")
+	{
+		return 3;
+	}
+	else if (type == "VEC4")
+	{
+		return 4;
+	}
+	else if (type == "MAT4")
+	{
+		return 16;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------------
+//Normalized integers map to 0 to 1 (or -1 to 1 when signed) as the spec asks for, anything else is just converted.
+static double ReadComponent(const byte* source, unsigned int componentType, bool normalized)
+{
+	switch (componentType)
+	{
+	case GLTF_BYTE:
+	{
+		int8_t value = (int8_t)*source;
+		return normalized ? (value < -127 ? -1.0 : value / 127.0) : value;
+	}
+	case GLTF_UNSIGNED_BYTE:
+		return normalized ? *source / 255.0 : *source;
+	case GLTF_SHORT:
+	{
+		int16_t value;
+		memcpy(&value, source, sizeof(value));
+		return normalized ? (value < -32767 ? -1.0 : value / 32767.0) : value;
+	}
+	case GLTF_UNSIGNED_SHORT:
+	{
+		uint16_t value;
+		memcpy(&value, source, sizeof(value));
+		return normalized ? value / 65535.0 : value;
+	}
+	case GLTF_UNSIGNED_INT:
+	{
+		uint32_t value;
+		memcpy(&value, source, sizeof(value));
+		return value;
+	}
+	case GLTF_FLOAT:
+	{
+		float value;
+		memcpy(&value, source, sizeof(value));
+		return value;
+	}
+	default:
+		return 0.0;
+	}
+}
+
+//-----------------------------------------------------------------------------------
+static unsigned int ReadIndex(const byte* source, unsigned int componentType)
+{
+	return (unsigned int)ReadComponent(source, componentType, false);
+}
+
+//-----------------------------------------------------------------------------------
+//Writes count * numComponents values, tightly packed. Tightly packed floats are copied straight across.
+template<typename T>
+static void ReadAccessor(const GltfAccessor& accessor, T* out)
+{
+	const unsigned int numComponents = accessor.numComponents;
+	const unsigned int componentSize = GetComponentSize(accessor.componentType);
+	const bool isSameType = std::is_same<T, float>::value && accessor.componentType == GLTF_FLOAT;
+	if (accessor.count == 0)
+	{
+		return;
+	}
+	if (!accessor.data)
+	{
+		std::fill(out, out + (accessor.count * numComponents), T(0));
+	}
+	else if (isSameType && accessor.stride == componentSize * numComponents)
+	{
+		memcpy(out, accessor.data, accessor.count * accessor.stride);
+	}
+	else
+	{
+		const byte* element = accessor.data;
+		T* destination = out;
+		for (unsigned int i = 0; i < accessor.count; ++i, element += accessor.stride)
+		{
+			for (unsigned int component = 0; component < numComponents; ++component)
+			{
+				*destination++ = (T)ReadComponent(element + (component * componentSize), accessor.componentType, accessor.normalized);
+			}
+		}
+	}
+
+	const unsigned int sparseIndexSize = GetComponentSize(accessor.sparseIndexType);
+	const unsigned int elementSize = componentSize * numComponents;
+	for (unsigned int i = 0; i < accessor.sparseCount; ++i)
+	{
+		const unsigned int index = ReadIndex(accessor.sparseIndices + (i * sparseIndexSize), accessor.sparseIndexType);
+		const byte* element = accessor.sparseValues + (i * elementSize);
+		for (unsigned int component = 0; component < numComponents; ++component)
+		{
+			out[(index * numComponents) + component] = (T)ReadComponent(element + (component * componentSize), accessor.componentType, accessor.normalized);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------
+//True for a whole number from 0 up to (but not including) count.
+static bool GetIndex(const JsonValue& value, size_t count, int& outIndex)
+{
+	const double number = value.AsDouble(-1.0);
+	if (!value.IsNumber() || number < 0.0 || number >= (double)count || number != floor(number))
+	{
+		return false;
+	}
+	outIndex = (int)number;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Byte counts and offsets. Anything past 4GB is rejected along with the negative and fractional ones, nothing that big can be mapped on 32 bit anyway.
+static bool GetByteCount(const JsonValue& value, uint64_t defaultValue, uint64_t& outCount)
+{
+	if (value.IsNull())
+	{
+		outCount = defaultValue;
+		return true;
+	}
+	const double number = value.AsDouble(-1.0);
+	if (!value.IsNumber() || number < 0.0 || number > 4294967295.0 || number != floor(number))
+	{
+		return false;
+	}
+	outCount = (uint64_t)number;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//glTF stores matrices column major for column vectors, ours are row major for the same column vectors.
+static Matrix4x4 MatrixFromColumnMajor(const float* columnMajor)
+{
+	Matrix4x4 matrix;
+	for (int row = 0; row < 4; ++row)
+	{
+		for (int column = 0; column < 4; ++column)
+		{
+			matrix.data[(row * 4) + column] = columnMajor[(column * 4) + row];
+		}
+	}
+	return matrix;
+}
+
+//-----------------------------------------------------------------------------------
+//MatrixInvertAffine dies on a singular matrix, which a broken file or a joint scaled down to nothing would hand it.
+//Anything this close to singular would come out of the inverse as garbage anyway.
+static bool IsInvertible(const Matrix4x4& matrix)
+{
+	const float* m = matrix.data;
+	const float determinant = (m[0] * ((m[5] * m[10]) - (m[6] * m[9]))) - (m[1] * ((m[4] * m[10]) - (m[6] * m[8]))) + (m[2] * ((m[4] * m[9]) - (m[5] * m[8])));
+	return std::isfinite(determinant) && fabs(determinant) >= 1e-12f;
+}
+
+//-----------------------------------------------------------------------------------
+//Scale, then rotate by the (x, y, z, w) quaternion, then translate.
+static Matrix4x4 MatrixFromTRS(const float* translation, const float* rotation, const float* scale)
+{
+	const float x = rotation[0];
+	const float y = rotation[1];
+	const float z = rotation[2];
+	const float w = rotation[3];
+	Matrix4x4 matrix;
+	float* m = matrix.data;
+	m[0] = (1.0f - (2.0f * ((y * y) + (z * z)))) * scale[0];
+	m[1] = (2.0f * ((x * y) - (z * w))) * scale[1];
+	m[2] = (2.0f * ((x * z) + (y * w))) * scale[2];
+	m[3] = translation[0];
+	m[4] = (2.0f * ((x * y) + (z * w))) * scale[0];
+	m[5] = (1.0f - (2.0f * ((x * x) + (z * z)))) * scale[1];
+	m[6] = (2.0f * ((y * z) - (x * w))) * scale[2];
+	m[7] = translation[1];
+	m[8] = (2.0f * ((x * z) - (y * w))) * scale[0];
+	m[9] = (2.0f * ((y * z) + (x * w))) * scale[1];
+	m[10] = (1.0f - (2.0f * ((x * x) + (y * y)))) * scale[2];
+	m[11] = translation[2];
+	m[12] = 0.0f;
+	m[13] = 0.0f;
+	m[14] = 0.0f;
+	m[15] = 1.0f;
+	return matrix;
+}
+
+//-----------------------------------------------------------------------------------
+static void NormalizeQuaternion(float* quaternion)
+{
+	const float lengthSquared = (quaternion[0] * quaternion[0]) + (quaternion[1] * quaternion[1]) + (quaternion[2] * quaternion[2]) + (quaternion[3] * quaternion[3]);
+	if (lengthSquared <= 0.0f)
+	{
+		quaternion[0] = quaternion[1] = quaternion[2] = 0.0f;
+		quaternion[3] = 1.0f;
+		return;
+	}
+	const float inverseLength = 1.0f / sqrtf(lengthSquared);
+	for (int i = 0; i < 4; ++i)
+	{
+		quaternion[i] *= inverseLength;
+	}
+}
+
+//-----------------------------------------------------------------------------------
+//Leaves zero length ones alone rather than filling them with NaNs.
+static void NormalizeDirections(std::vector<Vector3>& directions)
+{
+	for (Vector3& direction : directions)
+	{
+		if (direction.CalculateMagnitude() > 0.0f)
+		{
+			direction.Normalize();
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------
+//Takes the short way around, and falls back to a normalized lerp when the two are close enough for slerp to lose precision.
+static void SlerpQuaternion(const float* from, const float* to, float t, float* out)
+{
+	float cosTheta = (from[0] * to[0]) + (from[1] * to[1]) + (from[2] * to[2]) + (from[3] * to[3]);
+	const float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+	cosTheta *= sign;
+	float fromWeight = 1.0f - t;
+	float toWeight = t;
+	if (cosTheta < 0.9995f)
+	{
+		const float theta = acosf(cosTheta);
+		const float inverseSinTheta = 1.0f / sinf(theta);
+		fromWeight = sinf((1.0f - t) * theta) * inverseSinTheta;
+		toWeight = sinf(t * theta) * inverseSinTheta;
+	}
+	toWeight *= sign;
+	for (int i = 0; i < 4; ++i)
+	{
+		out[i] = (from[i] * fromWeight) + (to[i] * toWeight);
+	}
+	NormalizeQuaternion(out);
+}
+
+//-----------------------------------------------------------------------------------
+//Holds before the first key and after the last one.
+static void SampleAnimation(GltfSampler& sampler, float time, float* out)
+{
+	const unsigned int numComponents = sampler.numComponents;
+	const std::vector<float>& times = sampler.times;
+	const unsigned int lastKey = times.size() - 1;
+	const bool isCubic = sampler.interpolation == GLTF_CUBICSPLINE;
+	const unsigned int keyStride = isCubic ? numComponents * 3 : numComponents;
+	const float* values = sampler.values.data() + (isCubic ? numComponents : 0);
+
+	if (lastKey == 0 || time <= times[0] || time >= times[lastKey])
+	{
+		const float* key = values + ((lastKey == 0 || time <= times[0]) ? 0 : lastKey * keyStride);
+		memcpy(out, key, numComponents * sizeof(float));
+		return;
+	}
+	if (time < times[sampler.cursor])
+	{
+		sampler.cursor = 0;
+	}
+	while (sampler.cursor + 1 < lastKey && times[sampler.cursor + 1] <= time)
+	{
+		++sampler.cursor;
+	}
+
+	const unsigned int key = sampler.cursor;
+	const float keyDuration = times[key + 1] - times[key];
+	const float t = keyDuration > 0.0f ? (time - times[key]) / keyDuration : 0.0f;
+	const float* value0 = values + (key * keyStride);
+	const float* value1 = value0 + keyStride;
+	if (sampler.interpolation == GLTF_STEP)
+	{
+		memcpy(out, value0, numComponents * sizeof(float));
+	}
+	else if (isCubic)
+	{
+		//Hermite spline between the two keys, using the first's out-tangent and the second's in-tangent scaled by the time between them.
+		const float* outTangent0 = value0 + numComponents;
+		const float* inTangent1 = value1 - numComponents;
+		const float t2 = t * t;
+		const float t3 = t2 * t;
+		const float weightValue0 = (2.0f * t3) - (3.0f * t2) + 1.0f;
+		const float weightTangent0 = (t3 - (2.0f * t2) + t) * keyDuration;
+		const float weightValue1 = (-2.0f * t3) + (3.0f * t2);
+		const float weightTangent1 = (t3 - t2) * keyDuration;
+		for (unsigned int i = 0; i < numComponents; ++i)
+		{
+			out[i] = (value0[i] * weightValue0) + (outTangent0[i] * weightTangent0) + (value1[i] * weightValue1) + (inTangent1[i] * weightTangent1);
+		}
+		if (numComponents == 4)
+		{
+			NormalizeQuaternion(out);
+		}
+	}
+	else if (numComponents == 4)
+	{
+		SlerpQuaternion(value0, value1, t, out);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < numComponents; ++i)
+		{
+			out[i] = value0[i] + ((value1[i] - value0[i]) * t);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------
+//Skips anything that isn't part of the alphabet (ie: line breaks), and stops at the padding.
+static bool DecodeBase64(const char* text, size_t length, std::vector<byte>& outBytes)
+{
+	outBytes.clear();
+	outBytes.reserve((length / 4) * 3);
+	unsigned int accumulator = 0;
+	int numBits = 0;
+	for (size_t i = 0; i < length && text[i] != '='; ++i)
+	{
+		const char c = text[i];
+		int value = -1;
+		if (c >= 'A' && c <= 'Z')
+		{
+			value = c - 'A';
+		}
+		else if (c >= 'a' && c <= 'z')
+		{
+			value = c - 'a' + 26;
+		}
+		else if (c >= '0' && c <= '9')
+		{
+			value = c - '0' + 52;
+		}
+		else if (c == '+' || c == '-')
+		{
+			value = 62;
+		}
+		else if (c == '/' || c == '_')
+		{
+			value = 63;
+		}
+		else if (c == '\r' || c == '\n' || c == ' ')
+		{
+			continue;
+		}
+		else
+		{
+			return false;
+		}
+		accumulator = (accumulator << 6) | value;
+		numBits += 6;
+		if (numBits >= 8)
+		{
+			numBits -= 8;
+			outBytes.push_back((byte)((accumulator >> numBits) & 0xFF));
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Relative uris can have escaped characters in them (ie: spaces as %20).
+static std::string DecodeUri(const std::string& uri)
+{
+	std::string decoded;
+	decoded.reserve(uri.size());
+	for (size_t i = 0; i < uri.size(); ++i)
+	{
+		if (uri[i] == '%' && i + 2 < uri.size() && isxdigit((unsigned char)uri[i + 1]) && isxdigit((unsigned char)uri[i + 2]))
+		{
+			decoded += (char)strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16);
+			i += 2;
+		}
+		else
+		{
+			decoded += uri[i];
+		}
+	}
+	return decoded;
+}
+
+//-----------------------------------------------------------------------------------
+//One import. Everything it reads is checked against the buffers before it's used, so a broken file fails with a message instead of reading off the end.
+class GltfImporter
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	GltfImporter(bool isEngineBasisRightHanded, const Matrix4x4& transform, float framerate);
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	SceneImport* Import(const byte* data, size_t size, const std::string& baseDirectory);
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	std::string m_error;
+
+private:
+	//HELPER FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	GltfImporter(const GltfImporter&);
+	bool Fail(const std::string& message);
+	bool ParseContainer(const byte* data, size_t size);
+	bool LoadBuffers(const std::string& baseDirectory);
+	bool GetBufferView(const JsonValue& index, ByteSpan& outView, unsigned int& outStride);
+	bool GetAccessor(const JsonValue& index, GltfAccessor& outAccessor);
+	bool LoadNodes();
+	void VisitNodes(int rootIndex, bool isInScene);
+	bool BuildSkeleton(SceneImport& import);
+	bool ImportMeshes(SceneImport& import);
+	bool ImportPrimitive(const JsonValue& primitive, int nodeIndex, MeshBuilder& builder);
+	bool ImportAnimations(SceneImport& import);
+	int FindNearestJoint(int nodeIndex) const;
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	JsonValue m_root;
+	ByteSpan m_binaryChunk;
+	std::vector<ByteSpan> m_buffers;
+	std::vector<std::unique_ptr<FileView>> m_bufferFiles;
+	std::vector<std::vector<byte>> m_decodedBuffers;
+	std::vector<GltfNode> m_nodes;
+	//Every node whose parents all come before it, scene nodes first.
+	std::vector<int> m_nodeOrder;
+	std::vector<int> m_nodeToJoint;
+	Skeleton* m_skeleton;
+	Matrix4x4 m_importTransform;
+	float m_framerate;
+};
+
+//-----------------------------------------------------------------------------------
+//glTF is right handed with +Y up, so we only have to mirror Z into a left handed engine. Nothing rewinds the triangles, the same as the FBX importer.
+GltfImporter::GltfImporter(bool isEngineBasisRightHanded, const Matrix4x4& transform, float framerate)
+	: m_skeleton(nullptr)
+	, m_framerate(framerate)
+{
+	ASSERT_OR_DIE(framerate > 0.0f, "glTF motions need a framerate above 0");
+	Matrix4x4 basis = Matrix4x4::IDENTITY;
+	if (!isEngineBasisRightHanded)
+	{
+		basis.data[10] = -1.0f;
+	}
+	m_importTransform = basis * transform;
+}
+
+//-----------------------------------------------------------------------------------
+bool GltfImporter::Fail(const std::string& message)
+{
+	if (m_error.empty())
+	{
+		m_error = message;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------------
+//The importer keeps nothing once it's done, the scene owns the skeleton and motions.
+SceneImport* GltfImporter::Import(const byte* data, size_t size, const std::string& baseDirectory)
+{
+	if (!ParseContainer(data, size) || !LoadBuffers(baseDirectory) || !LoadNodes())
+	{
+		return nullptr;
+	}
+	const std::string& version = m_root["asset"]["version"].AsString();
+	if (version.empty() || version[0] != '2')
+	{
+		Fail("Only glTF 2.0 is supported, the file says '" + version + "'");
+		return nullptr;
+	}
+
+	SceneImport* import = new SceneImport();
+	if (!BuildSkeleton(*import) || !ImportMeshes(*import) || !ImportAnimations(*import))
+	{
+		for (AnimationMotion* motion : import->motions)
+		{
+			delete motion;
+		}
+		delete m_skeleton;
+		delete import;
+		return nullptr;
+	}
+	return import;
+}
+
+//-----------------------------------------------------------------------------------
+//A .glb is a header and then a JSON chunk, optionally followed by a binary one. Anything else is taken as .gltf text.
+bool GltfImporter::ParseContainer(const byte* data, size_t size)
+{
+	const char* json = reinterpret_cast<const char*>(data);
+	size_t jsonLength = size;
+	uint32_t header[3];
+	if (size >= sizeof(header) && memcmp(data, &GLB_MAGIC, sizeof(uint32_t)) == 0)
+	{
+		memcpy(header, data, sizeof(header));
+		if (header[1] != GLB_VERSION)
+		{
+			return Fail(Stringf("Unsupported .glb version %u", header[1]));
+		}
+		if (header[2] > size)
+		{
+			return Fail("The .glb is truncated");
+		}
+		const size_t end = header[2];
+		size_t offset = sizeof(header);
+		json = nullptr;
+		while (offset + (2 * sizeof(uint32_t)) <= end)
+		{
+			uint32_t chunkHeader[2];
+			memcpy(chunkHeader, data + offset, sizeof(chunkHeader));
+			offset += sizeof(chunkHeader);
+			if (chunkHeader[0] > end - offset)
+			{
+				return Fail("A .glb chunk runs off the end of the file");
+			}
+			if (json == nullptr)
+			{
+				if (chunkHeader[1] != GLB_CHUNK_JSON)
+				{
+					return Fail("The .glb doesn't start with a JSON chunk");
+				}
+				json = reinterpret_cast<const char*>(data + offset);
+				jsonLength = chunkHeader[0];
+			}
+			else if (chunkHeader[1] == GLB_CHUNK_BIN && m_binaryChunk.data == nullptr)
+			{
+				m_binaryChunk = ByteSpan(data + offset, chunkHeader[0]);
+			}
+			offset += chunkHeader[0];
+		}
+		if (json == nullptr)
+		{
+			return Fail("The .glb has no JSON chunk");
+		}
+	}
+	else if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+	{
+		json += 3;
+		jsonLength -= 3;
+	}
+
+	std::string parseError;
+	if (!JsonValue::Parse(json, jsonLength, m_root, &parseError))
+	{
+		return Fail("Bad JSON: " + parseError);
+	}
+	if (!m_root.IsObject())
+	{
+		return Fail("The JSON isn't an object");
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Buffers come from the .glb's binary chunk, base64 data uris, or files mapped in from beside the scene.
+bool GltfImporter::LoadBuffers(const std::string& baseDirectory)
+{
+	const JsonValue& buffers = m_root["buffers"];
+	m_buffers.resize(buffers.GetSize());
+	for (unsigned int i = 0; i < buffers.GetSize(); ++i)
+	{
+		uint64_t byteLength = 0;
+		if (!GetByteCount(buffers[i]["byteLength"], 0, byteLength))
+		{
+			return Fail(Stringf("Buffer %u has a bad byteLength", i));
+		}
+		const JsonValue* uriValue = buffers[i].Find("uri");
+		ByteSpan contents;
+		if (uriValue == nullptr)
+		{
+			if (m_binaryChunk.data == nullptr)
+			{
+				return Fail(Stringf("Buffer %u has no uri and there's no .glb binary chunk", i));
+			}
+			contents = m_binaryChunk;
+		}
+		else
+		{
+			const std::string& uri = uriValue->AsString();
+			if (uri.compare(0, 5, "data:") == 0)
+			{
+				const size_t base64Start = uri.find(";base64,");
+				m_decodedBuffers.emplace_back();
+				if (base64Start == std::string::npos || !DecodeBase64(uri.c_str() + base64Start + 8, uri.size() - (base64Start + 8), m_decodedBuffers.back()))
+				{
+					return Fail(Stringf("Buffer %u has a data uri that isn't base64", i));
+				}
+				contents = ByteSpan(m_decodedBuffers.back().data(), m_decodedBuffers.back().size());
+			}
+			else
+			{
+				std::string path = baseDirectory + DecodeUri(uri);
+				m_bufferFiles.emplace_back(new FileView());
+				if (!m_bufferFiles.back()->Open(path.c_str()))
+				{
+					return Fail("Couldn't open buffer '" + path + "'");
+				}
+				contents = m_bufferFiles.back()->GetSpan();
+			}
+		}
+		if (contents.size < byteLength)
+		{
+			return Fail(Stringf("Buffer %u is shorter than its byteLength", i));
+		}
+		m_buffers[i] = ByteSpan(contents.data, (size_t)byteLength);
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool GltfImporter::GetBufferView(const JsonValue& index, ByteSpan& outView, unsigned int& outStride)
+{
+	const JsonValue& bufferViews = m_root["bufferViews"];
+	int viewIndex = 0;
+	if (!GetIndex(index, bufferViews.GetSize(), viewIndex))
+	{
+		return Fail("Bad bufferView index");
+	}
+	const JsonValue& view = bufferViews[viewIndex];
+	int bufferIndex = 0;
+	uint64_t byteOffset = 0;
+	uint64_t byteLength = 0;
+	uint64_t byteStride = 0;
+	if (!GetIndex(view["buffer"], m_buffers.size(), bufferIndex) || !GetByteCount(view["byteOffset"], 0, byteOffset)
+		|| !GetByteCount(view["byteLength"], 0, byteLength) || !GetByteCount(view["byteStride"], 0, byteStride) || byteStride > 255)
+	{
+		return Fail(Stringf("bufferView %i is malformed", viewIndex));
+	}
+	if (byteOffset + byteLength > m_buffers[bufferIndex].size)
+	{
+		return Fail(Stringf("bufferView %i runs off the end of buffer %i", viewIndex, bufferIndex));
+	}
+	outView = ByteSpan(m_buffers[bufferIndex].data + byteOffset, (size_t)byteLength);
+	outStride = (unsigned int)byteStride;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool GltfImporter::GetAccessor(const JsonValue& index, GltfAccessor& outAccessor)
+{
+	const JsonValue& accessors = m_root["accessors"];
+	int accessorIndex = 0;
+	if (!GetIndex(index, accessors.GetSize(), accessorIndex))
+	{
+		return Fail("Bad accessor index");
+	}
+	const JsonValue& accessor = accessors[accessorIndex];
+	outAccessor = GltfAccessor();
+	outAccessor.componentType = accessor["componentType"].AsInt();
+	outAccessor.numComponents = GetNumComponents(accessor["type"].AsString());
+	outAccessor.normalized = accessor["normalized"].AsBool();
+	const unsigned int componentSize = GetComponentSize(outAccessor.componentType);
+	const unsigned int elementSize = componentSize * outAccessor.numComponents;
+	uint64_t count = 0;
+	uint64_t byteOffset = 0;
+	if (elementSize == 0 || !GetByteCount(accessor["count"], 0, count) || !GetByteCount(accessor["byteOffset"], 0, byteOffset) || count > MAX_ACCESSOR_COUNT)
+	{
+		return Fail(Stringf("Accessor %i is malformed or has an unsupported type", accessorIndex));
+	}
+	outAccessor.count = (unsigned int)count;
+
+	if (accessor.HasMember("bufferView"))
+	{
+		ByteSpan view;
+		if (!GetBufferView(accessor["bufferView"], view, outAccessor.stride))
+		{
+			return false;
+		}
+		if (outAccessor.stride == 0)
+		{
+			outAccessor.stride = elementSize;
+		}
+		if (outAccessor.stride < elementSize || (count > 0 && byteOffset + (outAccessor.stride * (count - 1)) + elementSize > view.size))
+		{
+			return Fail(Stringf("Accessor %i runs off the end of its bufferView", accessorIndex));
+		}
+		outAccessor.data = view.data + byteOffset;
+	}
+
+	const JsonValue* sparse = accessor.Find("sparse");
+	if (sparse)
+	{
+		const JsonValue& indices = (*sparse)["indices"];
+		const JsonValue& values = (*sparse)["values"];
+		uint64_t sparseCount = 0;
+		uint64_t indicesOffset = 0;
+		uint64_t valuesOffset = 0;
+		ByteSpan indicesView;
+		ByteSpan valuesView;
+		unsigned int unusedStride = 0;
+		outAccessor.sparseIndexType = indices["componentType"].AsInt();
+		const unsigned int sparseIndexSize = GetComponentSize(outAccessor.sparseIndexType);
+		if (!GetByteCount((*sparse)["count"], 0, sparseCount) || !GetByteCount(indices["byteOffset"], 0, indicesOffset) || !GetByteCount(values["byteOffset"], 0, valuesOffset)
+			|| sparseIndexSize == 0 || outAccessor.sparseIndexType == GLTF_BYTE || outAccessor.sparseIndexType == GLTF_SHORT || outAccessor.sparseIndexType == GLTF_FLOAT)
+		{
+			return Fail(Stringf("Accessor %i has malformed sparse data", accessorIndex));
+		}
+		if (!GetBufferView(indices["bufferView"], indicesView, unusedStride) || !GetBufferView(values["bufferView"], valuesView, unusedStride))
+		{
+			return false;
+		}
+		if (indicesOffset + (sparseCount * sparseIndexSize) > indicesView.size || valuesOffset + (sparseCount * elementSize) > valuesView.size)
+		{
+			return Fail(Stringf("Accessor %i's sparse data runs off the end of its bufferViews", accessorIndex));
+		}
+		outAccessor.sparseCount = (unsigned int)sparseCount;
+		outAccessor.sparseIndices = indicesView.data + indicesOffset;
+		outAccessor.sparseValues = valuesView.data + valuesOffset;
+		for (unsigned int i = 0; i < outAccessor.sparseCount; ++i)
+		{
+			if (ReadIndex(outAccessor.sparseIndices + (i * sparseIndexSize), outAccessor.sparseIndexType) >= outAccessor.count)
+			{
+				return Fail(Stringf("Accessor %i has a sparse index past its count", accessorIndex));
+			}
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Fills in the hierarchy, every node's rest pose, and the order the skeleton and meshes are built in.
+bool GltfImporter::LoadNodes()
+{
+	const JsonValue& nodes = m_root["nodes"];
+	m_nodes.resize(nodes.GetSize());
+	for (unsigned int i = 0; i < m_nodes.size(); ++i)
+	{
+		const JsonValue& json = nodes[i];
+		GltfNode& node = m_nodes[i];
+		node.name = json["name"].AsString();
+		if ((json.HasMember("mesh") && !GetIndex(json["mesh"], m_root["meshes"].GetSize(), node.mesh))
+			|| (json.HasMember("skin") && !GetIndex(json["skin"], m_root["skins"].GetSize(), node.skin)))
+		{
+			return Fail(Stringf("Node %u has a bad mesh or skin index", i));
+		}
+
+		const JsonValue& children = json["children"];
+		node.children.resize(children.GetSize());
+		for (size_t childIndex = 0; childIndex < children.GetSize(); ++childIndex)
+		{
+			int& child = node.children[childIndex];
+			if (!GetIndex(children[childIndex], m_nodes.size(), child) || child == (int)i || m_nodes[child].parent != -1)
+			{
+				return Fail(Stringf("Node %u has a bad child, or a child that already has a parent", i));
+			}
+			m_nodes[child].parent = (int)i;
+		}
+
+		const JsonValue& matrix = json["matrix"];
+		if (matrix.GetSize() == 16)
+		{
+			float columnMajor[16];
+			for (int element = 0; element < 16; ++element)
+			{
+				columnMajor[element] = matrix[element].AsFloat();
+			}
+			node.hasMatrix = true;
+			node.restLocal = MatrixFromColumnMajor(columnMajor);
+			continue;
+		}
+		const JsonValue& translation = json["translation"];
+		const JsonValue& rotation = json["rotation"];
+		const JsonValue& scale = json["scale"];
+		for (int component = 0; component < 3; ++component)
+		{
+			node.translation[component] = translation[component].AsFloat(node.translation[component]);
+			node.scale[component] = scale[component].AsFloat(node.scale[component]);
+		}
+		for (int component = 0; component < 4; ++component)
+		{
+			node.rotation[component] = rotation[component].AsFloat(node.rotation[component]);
+		}
+		NormalizeQuaternion(node.rotation);
+		node.restLocal = MatrixFromTRS(node.translation, node.rotation, node.scale);
+	}
+
+	//Only the default scene's nodes get meshes, but joints can hang off nodes outside it so everything else gets a rest pose too.
+	const JsonValue& scenes = m_root["scenes"];
+	int sceneIndex = 0;
+	if (scenes.GetSize() > 0 && (!m_root.HasMember("scene") || GetIndex(m_root["scene"], scenes.GetSize(), sceneIndex)))
+	{
+		const JsonValue& roots = scenes[sceneIndex]["nodes"];
+		for (size_t i = 0; i < roots.GetSize(); ++i)
+		{
+			int rootIndex = 0;
+			if (!GetIndex(roots[i], m_nodes.size(), rootIndex) || m_nodes[rootIndex].parent != -1)
+			{
+				return Fail(Stringf("Scene %i has a bad root node", sceneIndex));
+			}
+			if (!m_nodes[rootIndex].isVisited)
+			{
+				VisitNodes(rootIndex, true);
+			}
+		}
+	}
+	else if (scenes.GetSize() == 0)
+	{
+		for (size_t i = 0; i < m_nodes.size(); ++i)
+		{
+			if (m_nodes[i].parent == -1)
+			{
+				VisitNodes(i, true);
+			}
+		}
+	}
+	for (size_t i = 0; i < m_nodes.size(); ++i)
+	{
+		if (m_nodes[i].parent == -1 && !m_nodes[i].isVisited)
+		{
+			VisitNodes(i, false);
+		}
+	}
+	//With at most one parent each, the only nodes a walk down from the roots can miss are ones in a loop.
+	if (m_nodeOrder.size() != m_nodes.size())
+	{
+		return Fail("The node hierarchy has a cycle in it");
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Depth first, children in the order they're listed. Uses its own stack since joint chains (ie: hair, tails) can get long.
+void GltfImporter::VisitNodes(int rootIndex, bool isInScene)
+{
+	std::vector<int> stack(1, rootIndex);
+	while (!stack.empty())
+	{
+		const int nodeIndex = stack.back();
+		stack.pop_back();
+		GltfNode& node = m_nodes[nodeIndex];
+		node.isVisited = true;
+		node.isInScene = isInScene;
+		node.restGlobal = node.parent == -1 ? node.restLocal : node.restLocal * m_nodes[node.parent].restGlobal;
+		m_nodeOrder.push_back(nodeIndex);
+		stack.insert(stack.end(), node.children.rbegin(), node.children.rend());
+	}
+}
+
+//-----------------------------------------------------------------------------------
+//The node's own joint, or the closest one above it. -1 if there isn't one.
+int GltfImporter::FindNearestJoint(int nodeIndex) const
+{
+	while (nodeIndex != -1 && m_nodeToJoint[nodeIndex] == Skeleton::INVALID_JOINT_INDEX)
+	{
+		nodeIndex = m_nodes[nodeIndex].parent;
+	}
+	return nodeIndex == -1 ? Skeleton::INVALID_JOINT_INDEX : m_nodeToJoint[nodeIndex];
+}
+
+//-----------------------------------------------------------------------------------
+//Every skin's joints go into one skeleton, added depth first so parents always come before their children. A joint's parent is the nearest joint above it,
+//any plain nodes in between get folded into the joint's keyframes. The bind pose comes from the inverse bind matrices, or the rest pose when a skin has none.
+bool GltfImporter::BuildSkeleton(SceneImport& import)
+{
+	m_nodeToJoint.assign(m_nodes.size(), (int)Skeleton::INVALID_JOINT_INDEX);
+	std::vector<bool> isJoint(m_nodes.size(), false);
+	std::vector<bool> hasBindMatrix(m_nodes.size(), false);
+	std::vector<Matrix4x4> bindMatrices(m_nodes.size());
+	bool hasJoints = false;
+
+	const JsonValue& skins = m_root["skins"];
+	for (unsigned int skinIndex = 0; skinIndex < skins.GetSize(); ++skinIndex)
+	{
+		const JsonValue& joints = skins[skinIndex]["joints"];
+		std::vector<float> inverseBindMatrices;
+		if (skins[skinIndex].HasMember("inverseBindMatrices"))
+		{
+			GltfAccessor accessor;
+			if (!GetAccessor(skins[skinIndex]["inverseBindMatrices"], accessor))
+			{
+				return false;
+			}
+			if (accessor.numComponents != 16 || accessor.count < joints.GetSize())
+			{
+				return Fail(Stringf("Skin %u's inverseBindMatrices aren't a MAT4 per joint", skinIndex));
+			}
+			inverseBindMatrices.resize(accessor.count * 16);
+			ReadAccessor(accessor, inverseBindMatrices.data());
+		}
+		for (size_t i = 0; i < joints.GetSize(); ++i)
+		{
+			int nodeIndex = 0;
+			if (!GetIndex(joints[i], m_nodes.size(), nodeIndex))
+			{
+				return Fail(Stringf("Skin %u has a bad joint", skinIndex));
+			}
+			isJoint[nodeIndex] = true;
+			hasJoints = true;
+			if (!inverseBindMatrices.empty() && !hasBindMatrix[nodeIndex])
+			{
+				bindMatrices[nodeIndex] = MatrixFromColumnMajor(&inverseBindMatrices[i * 16]);
+				if (!IsInvertible(bindMatrices[nodeIndex]))
+				{
+					return Fail(Stringf("Skin %u has an inverse bind matrix that can't be inverted", skinIndex));
+				}
+				Matrix4x4::MatrixInvertAffine(&bindMatrices[nodeIndex]);
+				hasBindMatrix[nodeIndex] = true;
+			}
+		}
+	}
+	if (!hasJoints)
+	{
+		return true;
+	}
+
+	m_skeleton = new Skeleton();
+	for (int nodeIndex : m_nodeOrder)
+	{
+		if (!isJoint[nodeIndex])
+		{
+			continue;
+		}
+		const GltfNode& node = m_nodes[nodeIndex];
+		const int parentJoint = node.parent == -1 ? Skeleton::INVALID_JOINT_INDEX : FindNearestJoint(node.parent);
+		const Matrix4x4& bindGlobal = hasBindMatrix[nodeIndex] ? bindMatrices[nodeIndex] : node.restGlobal;
+		const Matrix4x4 boneToModel = bindGlobal * m_importTransform;
+		if (!IsInvertible(boneToModel))
+		{
+			return Fail(Stringf("Joint node %i has a bind pose that can't be inverted", nodeIndex));
+		}
+		std::string name = node.name.empty() ? Stringf("joint_%i", nodeIndex) : node.name;
+		m_skeleton->AddJoint(name.c_str(), parentJoint, boneToModel);
+		m_nodeToJoint[nodeIndex] = m_skeleton->GetLastAddedJointIndex();
+	}
+	import.skeletons.push_back(m_skeleton);
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//One builder per triangle primitive of every mesh node in the scene. Points, lines and strips are skipped.
+bool GltfImporter::ImportMeshes(SceneImport& import)
+{
+	const JsonValue& meshes = m_root["meshes"];
+	for (int nodeIndex : m_nodeOrder)
+	{
+		const GltfNode& node = m_nodes[nodeIndex];
+		if (!node.isInScene || node.mesh == -1)
+		{
+			continue;
+		}
+		const JsonValue& primitives = meshes[node.mesh]["primitives"];
+		for (size_t i = 0; i < primitives.GetSize(); ++i)
+		{
+			if (primitives[i]["mode"].AsInt(GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES)
+			{
+				continue;
+			}
+			import.meshes.emplace_back();
+			if (!ImportPrimitive(primitives[i], nodeIndex, import.meshes.back()))
+			{
+				return false;
+			}
+			if (import.meshes.back().GetVertexCount() == 0)
+			{
+				import.meshes.pop_back();
+			}
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Streams each attribute straight into the builder. Skinned vertices stay in the skin's space as glTF asks, everything else is baked into the scene.
+//Normals are made from the faces if the file doesn't have them. Tangents are only brought across when it does, GenerateTangents can fill them in after.
+bool GltfImporter::ImportPrimitive(const JsonValue& primitive, int nodeIndex, MeshBuilder& builder)
+{
+	const GltfNode& node = m_nodes[nodeIndex];
+	const JsonValue& attributes = primitive["attributes"];
+	GltfAccessor accessor;
+	if (!GetAccessor(attributes["POSITION"], accessor))
+	{
+		return Fail(Stringf("A primitive on node %i has no usable POSITION", nodeIndex));
+	}
+	if (accessor.numComponents != 3)
+	{
+		return Fail(Stringf("A primitive on node %i has POSITIONs that aren't VEC3", nodeIndex));
+	}
+	const unsigned int vertexCount = accessor.count;
+	if (vertexCount == 0)
+	{
+		return true;
+	}
+	std::vector<Vector3> positions(vertexCount);
+	ReadAccessor(accessor, &positions[0].x);
+
+	builder.SetVertexStorage(MeshBuilder::STREAM_STORAGE);
+	int materialIndex = -1;
+	if (primitive.HasMember("material") && !GetIndex(primitive["material"], m_root["materials"].GetSize(), materialIndex))
+	{
+		return Fail(Stringf("A primitive on node %i has a bad material index", nodeIndex));
+	}
+	builder.SetMaterialName(materialIndex == -1 ? nullptr : m_root["materials"][materialIndex]["name"].AsString().c_str());
+
+	//Indices go in first so missing normals can be built from them.
+	if (primitive.HasMember("indices"))
+	{
+		GltfAccessor indices;
+		if (!GetAccessor(primitive["indices"], indices))
+		{
+			return false;
+		}
+		if (indices.numComponents != 1 || (indices.componentType != GLTF_UNSIGNED_BYTE && indices.componentType != GLTF_UNSIGNED_SHORT && indices.componentType != GLTF_UNSIGNED_INT))
+		{
+			return Fail(Stringf("A primitive on node %i has indices that aren't unsigned scalars", nodeIndex));
+		}
+		if (indices.componentType == GLTF_UNSIGNED_SHORT && indices.IsTightlyPacked(sizeof(uint16_t)))
+		{
+			builder.AppendIndices(reinterpret_cast<const uint16_t*>(indices.data), indices.count);
+		}
+		else if (indices.componentType == GLTF_UNSIGNED_INT && indices.IsTightlyPacked(sizeof(uint32_t)))
+		{
+			builder.AppendIndices(reinterpret_cast<const unsigned int*>(indices.data), indices.count);
+		}
+		else
+		{
+			builder.m_indices.resize(indices.count);
+			ReadAccessor(indices, builder.m_indices.data());
+		}
+	}
+	else
+	{
+		builder.m_indices.resize(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; ++i)
+		{
+			builder.m_indices[i] = i;
+		}
+	}
+	if (builder.m_indices.size() % 3 != 0)
+	{
+		return Fail(Stringf("A primitive on node %i has a partial triangle", nodeIndex));
+	}
+	for (unsigned int index : builder.m_indices)
+	{
+		if (index >= vertexCount)
+		{
+			return Fail(Stringf("A primitive on node %i has an index past its last vertex", nodeIndex));
+		}
+	}
+
+	const bool isSkinned = node.skin != -1 && m_skeleton && attributes.HasMember("JOINTS_0") && attributes.HasMember("WEIGHTS_0");
+	const Matrix4x4 vertexTransform = isSkinned ? m_importTransform : node.restGlobal * m_importTransform;
+	std::vector<MeshBuilder::AttributeSpan> spans;
+
+	std::vector<Vector3> normals(vertexCount);
+	if (attributes.HasMember("NORMAL"))
+	{
+		if (!GetAccessor(attributes["NORMAL"], accessor) || accessor.numComponents != 3 || accessor.count != vertexCount)
+		{
+			return Fail(Stringf("A primitive on node %i has bad NORMALs", nodeIndex));
+		}
+		ReadAccessor(accessor, &normals[0].x);
+	}
+	else
+	{
+		//Area weighted, from the positions before they're transformed so the winding still means what glTF says it does.
+		std::fill(normals.begin(), normals.end(), Vector3::ZERO);
+		for (size_t i = 0; i < builder.m_indices.size(); i += 3)
+		{
+			const unsigned int* triangle = &builder.m_indices[i];
+			const Vector3 faceNormal = Vector3::Cross(positions[triangle[1]] - positions[triangle[0]], positions[triangle[2]] - positions[triangle[0]]);
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				normals[triangle[corner]] += faceNormal;
+			}
+		}
+	}
+	//The bitangent is made in glTF's space, before the transform can mirror it, and then flipped along with the Vs.
+	std::vector<Vector3> tangents;
+	std::vector<Vector3> bitangents;
+	if (attributes.HasMember("TANGENT"))
+	{
+		if (!GetAccessor(attributes["TANGENT"], accessor) || accessor.numComponents != 4 || accessor.count != vertexCount)
+		{
+			return Fail(Stringf("A primitive on node %i has bad TANGENTs", nodeIndex));
+		}
+		std::vector<Vector4> source(vertexCount);
+		ReadAccessor(accessor, &source[0].x);
+		tangents.resize(vertexCount);
+		bitangents.resize(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; ++i)
+		{
+			tangents[i] = Vector3(source[i].x, source[i].y, source[i].z);
+			bitangents[i] = Vector3::Cross(normals[i], tangents[i]) * -source[i].w;
+		}
+		Matrix4x4::MatrixTransformDirections(&vertexTransform, tangents.data(), tangents.data(), vertexCount);
+		Matrix4x4::MatrixTransformDirections(&vertexTransform, bitangents.data(), bitangents.data(), vertexCount);
+		spans.push_back(MeshBuilder::AttributeSpan(MeshBuilder::TANGENT_BIT, tangents.data()));
+		spans.push_back(MeshBuilder::AttributeSpan(MeshBuilder::BITANGENT_BIT, bitangents.data()));
+	}
+
+	//Normals take the inverse transpose like MeshBuilder::TransformStreamRange, so a node's non-uniform scale doesn't skew them.
+	if (!IsInvertible(vertexTransform))
+	{
+		return Fail(Stringf("Node %i scales its mesh down to nothing", nodeIndex));
+	}
+	Matrix4x4 normalTransform = vertexTransform;
+	Matrix4x4::MatrixInvertAffine(&normalTransform);
+	Matrix4x4::MatrixTranspose(&normalTransform);
+	Matrix4x4::MatrixTransformPoints(&vertexTransform, positions.data(), positions.data(), vertexCount);
+	Matrix4x4::MatrixTransformDirections(&normalTransform, normals.data(), normals.data(), vertexCount);
+	NormalizeDirections(normals);
+	NormalizeDirections(tangents);
+	NormalizeDirections(bitangents);
+	spans.push_back(MeshBuilder::AttributeSpan(MeshBuilder::POSITION_BIT, positions.data()));
+	spans.push_back(MeshBuilder::AttributeSpan(MeshBuilder::NORMAL_BIT, normals.data()));
+
+	//glTF's UVs start at the top left, ours at the bottom left.
+	std::vector<Vector2> uvs[2];
+	const char* uvAttributes[2] = { "TEXCOORD_0", "TEXCOORD_1" };
+	const MeshBuilder::MeshDataFlag uvFlags[2] = { MeshBuilder::UV0_BIT, MeshBuilder::UV1_BIT };
+	for (int set = 0; set < 2; ++set)
+	{
+		if (!attributes.HasMember(uvAttributes[set]))
+		{
+			continue;
+		}
+		if (!GetAccessor(attributes[uvAttributes[set]], accessor) || accessor.numComponents != 2 || accessor.count != vertexCount)
+		{
+			return Fail(Stringf("A primitive on node %i has a bad %s", nodeIndex, uvAttributes[set]));
+		}
+		uvs[set].resize(vertexCount);
+		ReadAccessor(accessor, &uvs[set][0].x);
+		for (Vector2& uv : uvs[set])
+		{
+			uv.y = 1.0f - uv.y;
+		}
+		spans.push_back(MeshBuilder::AttributeSpan(uvFlags[set], uvs[set].data()));
+	}
+
+	std::vector<RGBA> colors;
+	if (attributes.HasMember("COLOR_0"))
+	{
+		if (!GetAccessor(attributes["COLOR_0"], accessor) || (accessor.numComponents != 3 && accessor.numComponents != 4) || accessor.count != vertexCount)
+		{
+			return Fail(Stringf("A primitive on node %i has bad COLOR_0s", nodeIndex));
+		}
+		std::vector<float> source(vertexCount * accessor.numComponents);
+		ReadAccessor(accessor, source.data());
+		colors.resize(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; ++i)
+		{
+			const float* color = &source[i * accessor.numComponents];
+			colors[i] = RGBA(color[0], color[1], color[2], accessor.numComponents == 4 ? color[3] : 1.0f);
+		}
+		spans.push_back(MeshBuilder::AttributeSpan(MeshBuilder::COLOR_BIT, colors.data()));
+	}
+
+	std::vector<Vector4Int> boneIndices;
+	std::vector<Vector4> boneWeights;
+	if (isSkinned)
+	{
+		GltfAccessor weightsAccessor;
+		if (!GetAccessor(attributes["JOINTS_0"], accessor) || !GetAccessor(attributes["WEIGHTS_0"], weightsAccessor) || accessor.numComponents != 4 || weightsAccessor.numComponents != 4
+			|| accessor.count != vertexCount || weightsAccessor.count != vertexCount)
+		{
+			return Fail(Stringf("A primitive on node %i has bad JOINTS_0 or WEIGHTS_0", nodeIndex));
+		}
+		if ((accessor.componentType != GLTF_UNSIGNED_BYTE && accessor.componentType != GLTF_UNSIGNED_SHORT) || accessor.normalized)
+		{
+			return Fail(Stringf("A primitive on node %i has JOINTS_0 that aren't unsigned bytes or shorts", nodeIndex));
+		}
+		std::vector<unsigned int> joints(vertexCount * 4);
+		boneWeights.resize(vertexCount);
+		ReadAccessor(accessor, joints.data());
+		ReadAccessor(weightsAccessor, &boneWeights[0].x);
+
+		//Joint numbers are into the skin's list, which we map through to the skeleton's joints.
+		const JsonValue& skinJoints = m_root["skins"][node.skin]["joints"];
+		boneIndices.resize(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; ++i)
+		{
+			float* weights = &boneWeights[i].x;
+			int* indices = &boneIndices[i].x;
+			float totalWeight = 0.0f;
+			for (int influence = 0; influence < 4; ++influence)
+			{
+				//Unused influences still have to name a real joint.
+				const unsigned int skinJoint = joints[(i * 4) + influence];
+				if (skinJoint >= skinJoints.GetSize())
+				{
+					return Fail(Stringf("A primitive on node %i uses joint %u, but its skin only has %u", nodeIndex, skinJoint, (unsigned int)skinJoints.GetSize()));
+				}
+				indices[influence] = 0;
+				if (weights[influence] <= 0.0f)
+				{
+					weights[influence] = 0.0f;
+					continue;
+				}
+				indices[influence] = m_nodeToJoint[skinJoints[skinJoint].AsInt()];
+				totalWeight += weights[influence];
+			}
+			if (totalWeight > 0.0f)
+			{
+				boneWeights[i] = boneWeights[i] * (1.0f / totalWeight);
+			}
+			else
+			{
+				boneWeights[i] = Vector4::UNIT_X;
+			}
+		}
+		spans.push_back(MeshBuilder::AttributeSpan(MeshBuilder::BONE_INDICES_BIT, boneIndices.data()));
+		spans.push_back(MeshBuilder::AttributeSpan(MeshBuilder::BONE_WEIGHTS_BIT, boneWeights.data()));
+	}
+	else
+	{
+		//Rigid meshes follow the joint they're attached to, or the root if they aren't under one.
+		const int joint = m_skeleton ? FindNearestJoint(nodeIndex) : Skeleton::INVALID_JOINT_INDEX;
+		builder.SetBoneWeights(Vector4Int(joint == Skeleton::INVALID_JOINT_INDEX ? 0 : joint, 0, 0, 0), Vector4::UNIT_X);
+	}
+
+	builder.AppendVertices(vertexCount, spans.data(), spans.size());
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Each animation is sampled into a motion at m_framerate. A joint's keyframes are its local transform from the joint above it (including any plain nodes in between),
+//the same as the skeleton's locals, and root joints have everything above them and the import transform baked in.
+bool GltfImporter::ImportAnimations(SceneImport& import)
+{
+	const JsonValue& animations = m_root["animations"];
+	if (m_skeleton == nullptr || animations.GetSize() == 0)
+	{
+		return true;
+	}
+
+	std::vector<Matrix4x4> locals(m_nodes.size());
+	std::vector<float> translations(m_nodes.size() * 3);
+	std::vector<float> rotations(m_nodes.size() * 4);
+	std::vector<float> scales(m_nodes.size() * 3);
+	std::vector<int> jointNodes(m_skeleton->GetJointCount());
+	for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex)
+	{
+		if (m_nodeToJoint[nodeIndex] != Skeleton::INVALID_JOINT_INDEX)
+		{
+			jointNodes[m_nodeToJoint[nodeIndex]] = nodeIndex;
+		}
+	}
+
+	for (unsigned int animationIndex = 0; animationIndex < animations.GetSize(); ++animationIndex)
+	{
+		const JsonValue& animation = animations[animationIndex];
+		const JsonValue& samplersJson = animation["samplers"];
+		const JsonValue& channelsJson = animation["channels"];
+		std::vector<GltfSampler> samplers(samplersJson.GetSize());
+		std::vector<GltfChannel> channels;
+		std::vector<bool> isAnimated(m_nodes.size(), false);
+		float duration = 0.0f;
+
+		for (size_t i = 0; i < channelsJson.GetSize(); ++i)
+		{
+			const JsonValue& target = channelsJson[i]["target"];
+			const std::string& path = target["path"].AsString();
+			GltfChannel channel;
+			int samplerIndex = 0;
+			int nodeIndex = 0;
+			if (!GetIndex(channelsJson[i]["sampler"], samplers.size(), samplerIndex) || (target.HasMember("node") && !GetIndex(target["node"], m_nodes.size(), nodeIndex)))
+			{
+				return Fail(Stringf("Animation %u has a bad channel", animationIndex));
+			}
+			//Morph target weights and channels without a node (ie: from extensions) have nothing to drive here.
+			if (!target.HasMember("node") || (path != "translation" && path != "rotation" && path != "scale"))
+			{
+				continue;
+			}
+			if (m_nodes[nodeIndex].hasMatrix)
+			{
+				return Fail(Stringf("Animation %u animates node %i, which has a matrix", animationIndex, nodeIndex));
+			}
+			channel.sampler = samplerIndex;
+			channel.node = nodeIndex;
+			channel.path = path == "translation" ? GLTF_TRANSLATION : (path == "rotation" ? GLTF_ROTATION : GLTF_SCALE);
+			const unsigned int numComponents = channel.path == GLTF_ROTATION ? 4 : 3;
+
+			GltfSampler& sampler = samplers[samplerIndex];
+			if (sampler.times.empty())
+			{
+				const JsonValue& samplerJson = samplersJson[samplerIndex];
+				const std::string& interpolation = samplerJson["interpolation"].AsString();
+				sampler.interpolation = interpolation == "STEP" ? GLTF_STEP : (interpolation == "CUBICSPLINE" ? GLTF_CUBICSPLINE : GLTF_LINEAR);
+				GltfAccessor input;
+				GltfAccessor output;
+				if (!GetAccessor(samplerJson["input"], input) || !GetAccessor(samplerJson["output"], output))
+				{
+					return false;
+				}
+				const unsigned int keysPerTime = sampler.interpolation == GLTF_CUBICSPLINE ? 3 : 1;
+				if (input.numComponents != 1 || input.componentType != GLTF_FLOAT || input.count == 0 || output.count != input.count * keysPerTime)
+				{
+					return Fail(Stringf("Animation %u has a sampler whose input and output don't match up", animationIndex));
+				}
+				sampler.times.resize(input.count);
+				ReadAccessor(input, sampler.times.data());
+				for (size_t key = 0; key < sampler.times.size(); ++key)
+				{
+					if (!(sampler.times[key] >= 0.0f && sampler.times[key] <= MAX_MOTION_SECONDS) || (key > 0 && sampler.times[key] < sampler.times[key - 1]))
+					{
+						return Fail(Stringf("Animation %u has keys that go back in time or are out of range", animationIndex));
+					}
+				}
+				sampler.numComponents = output.numComponents;
+				sampler.values.resize(output.count * output.numComponents);
+				ReadAccessor(output, sampler.values.data());
+				duration = std::max(duration, sampler.times.back());
+			}
+			if (sampler.numComponents != numComponents)
+			{
+				return Fail(Stringf("Animation %u drives a %s with the wrong number of components", animationIndex, path.c_str()));
+			}
+			channels.push_back(channel);
+			isAnimated[nodeIndex] = true;
+		}
+		if (channels.empty())
+		{
+			continue;
+		}
+
+		//A motion has to last at least a frame.
+		const float frameTime = 1.0f / m_framerate;
+		const std::string& name = animation["name"].AsString();
+		AnimationMotion* motion = new AnimationMotion(name.empty() ? Stringf("animation_%u", animationIndex) : name, std::max(duration, frameTime), m_framerate, m_skeleton);
+		import.motions.push_back(motion);
+		for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex)
+		{
+			locals[nodeIndex] = m_nodes[nodeIndex].restLocal;
+		}
+
+		for (uint32_t frame = 0; frame < motion->m_frameCount; ++frame)
+		{
+			const float time = std::min(frame * frameTime, duration);
+			for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex)
+			{
+				if (isAnimated[nodeIndex])
+				{
+					memcpy(&translations[nodeIndex * 3], m_nodes[nodeIndex].translation, sizeof(float) * 3);
+					memcpy(&rotations[nodeIndex * 4], m_nodes[nodeIndex].rotation, sizeof(float) * 4);
+					memcpy(&scales[nodeIndex * 3], m_nodes[nodeIndex].scale, sizeof(float) * 3);
+				}
+			}
+			for (const GltfChannel& channel : channels)
+			{
+				float* destination = channel.path == GLTF_TRANSLATION ? &translations[channel.node * 3] : (channel.path == GLTF_ROTATION ? &rotations[channel.node * 4] : &scales[channel.node * 3]);
+				SampleAnimation(samplers[channel.sampler], time, destination);
+			}
+			for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex)
+			{
+				if (isAnimated[nodeIndex])
+				{
+					locals[nodeIndex] = MatrixFromTRS(&translations[nodeIndex * 3], &rotations[nodeIndex * 4], &scales[nodeIndex * 3]);
+				}
+			}
+
+			for (size_t joint = 0; joint < jointNodes.size(); ++joint)
+			{
+				Matrix4x4 keyframe = locals[jointNodes[joint]];
+				int ancestor = m_nodes[jointNodes[joint]].parent;
+				while (ancestor != -1 && m_nodeToJoint[ancestor] == Skeleton::INVALID_JOINT_INDEX)
+				{
+					keyframe = keyframe * locals[ancestor];
+					ancestor = m_nodes[ancestor].parent;
+				}
+				if (ancestor == -1)
+				{
+					keyframe = keyframe * m_importTransform;
+				}
+				motion->GetJointKeyframes(joint)[frame] = keyframe;
+			}
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------
+SceneImport* GltfLoadSceneFromMemory(const byte* data, size_t size, const std::string& baseDirectory, bool isEngineBasisRightHanded, const Matrix4x4& transform, float framerate, std::string* outError)
+{
+	GltfImporter importer(isEngineBasisRightHanded, transform, framerate);
+	SceneImport* import = importer.Import(data, size, baseDirectory);
+	if (import == nullptr && outError)
+	{
+		*outError = importer.m_error;
+	}
+	return import;
+}
+
+//-----------------------------------------------------------------------------------
+SceneImport* GltfLoadSceneFromFile(const char* filename, bool isEngineBasisRightHanded, const Matrix4x4& transform, float framerate, std::string* outError)
+{
+	FileView file;
+	if (!file.Open(filename))
+	{
+		if (outError)
+		{
+			*outError = Stringf("Couldn't open '%s'", filename);
+		}
+		return nullptr;
+	}
+	std::string path = filename;
+	const size_t lastSlash = path.find_last_of("/\\");
+	std::string baseDirectory = lastSlash == std::string::npos ? std::string() : path.substr(0, lastSlash + 1);
+	return GltfLoadSceneFromMemory(file.GetData(), file.GetSize(), baseDirectory, isEngineBasisRightHanded, transform, framerate, outError);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "Engine/Tools/SceneImport.hpp"
+#include <string>
+
+class Matrix4x4;
+
+//STANDALONE FUNCTIONS//////////////////////////////////////////////////////////////////////////
+//Imports a glTF 2.0 scene, either a .gltf with its buffers beside it (or embedded as data uris) or a self contained .glb.
+//Doesn't need any SDK, so unlike the FBX importer it's in every build on every platform. Buffers are mapped through FileView and accessors
+//are read straight out of them, the same way the FBX importer's scene comes out: every skin's joints go into one skeleton, and each
+//animation is sampled into a motion at the given framerate. Meshes come out indexed rather than as triangle soup.
+//Returns null on a broken or unsupported file, with the reason in outError.
+SceneImport* GltfLoadSceneFromFile(const char* filename, bool isEngineBasisRightHanded, const Matrix4x4& transform, float framerate = 30.0f, std::string* outError = nullptr);
+//Same as above for a file that's already in memory. Relative buffer uris are looked up in baseDirectory, which needs its trailing slash.
+SceneImport* GltfLoadSceneFromMemory(const byte* data, size_t size, const std::string& baseDirectory, bool isEngineBasisRightHanded, const Matrix4x4& transform, float framerate = 30.0f, std::string* outError = nullptr);
@@ -0,0 +1,101 @@
+#include "Engine/Tools/gltf.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Input/InputOutputUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/AsyncLoader.hpp"
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/VertexLayout.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Time/Time.hpp"
+#include <memory>
+
+//The game side of the glTF importer, kept out of gltf.cpp so the importer itself has nothing to do with the console, the loader or GL.
+extern Mesh* g_loadedMesh;
+extern MeshBuilder* g_loadedMeshBuilder;
+extern Skeleton* g_loadedSkeleton;
+extern AnimationMotion* g_loadedMotion;
+
+//-----------------------------------------------------------------------------------
+//Everything gltfLoad does before it needs GL, done on one of the loader's workers.
+struct GltfLoadResult
+{
+	GltfLoadResult() : import(nullptr), builder(nullptr), removedVertexCount(0), importSeconds(0.0) {};
+	SceneImport* import;
+	MeshBuilder* builder;
+	unsigned int removedVertexCount;
+	double importSeconds;
+	std::string error;
+};
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(gltfLoad)
+{
+	if (!(args.HasArgs(2) || args.HasArgs(1)))
+	{
+		Console::instance->PrintLine("gltfLoad <file path> <scale>", RGBA::RED);
+		return;
+	}
+	std::string filename = args.GetStringArgument(0);
+
+	float scale = args.HasArgs(2) ? args.GetFloatArgument(1) : 1.0f;
+	Matrix4x4 transform;
+	Matrix4x4::MatrixMakeScale(&transform, scale);
+	if (!FileExists(filename))
+	{
+		Console::instance->PrintLine(Stringf("Failed to load file. '%s'", filename.c_str()));
+		DebuggerPrintf("Failed to load file. '%s'", filename.c_str());
+		return;
+	}
+
+	//Same as fbxLoad, except the meshes come in already indexed.
+	std::shared_ptr<GltfLoadResult> result = std::make_shared<GltfLoadResult>();
+	AsyncLoader::instance->Enqueue("gltfLoad " + filename,
+		[filename, transform, result](void*&)
+		{
+			const double startSeconds = GetCurrentTimeSeconds();
+			result->import = GltfLoadSceneFromFile(filename.c_str(), false, transform, 30.0f, &result->error);
+			result->importSeconds = GetCurrentTimeSeconds() - startSeconds;
+			if (result->import == nullptr || result->import->meshes.empty())
+			{
+				return true;
+			}
+			result->builder = MeshBuilder::Merge(result->import->meshes.data(), result->import->meshes.size());
+			if (result->builder->m_indices.empty())
+			{
+				result->builder->AddLinearIndices();
+			}
+			result->removedVertexCount = result->builder->WeldVertices();
+			result->builder->GenerateLODs({ 0.5f, 0.25f, 0.1f });
+			result->builder->OptimizeVertexCache();
+			result->builder->OptimizeVertexFetch();
+			return true;
+		},
+		[filename, result](void*&)
+		{
+			SceneImport* import = result->import;
+			if (import == nullptr)
+			{
+				Console::instance->PrintLine(Stringf("Failed to load '%s': %s", filename.c_str(), result->error.c_str()), RGBA::RED);
+				DebuggerPrintf("Failed to load '%s': %s", filename.c_str(), result->error.c_str());
+				return false;
+			}
+			Console::instance->PrintLine(Stringf("Loaded '%s' in %.2fms. Had %i meshes and %i motions.", filename.c_str(), result->importSeconds * 1000.0, import->meshes.size(), import->motions.size()));
+			DebuggerPrintf("Loaded '%s' in %.2fms. Had %i meshes.", filename.c_str(), result->importSeconds * 1000.0, import->meshes.size());
+			if (result->builder)
+			{
+				Console::instance->PrintLine(Stringf("Welded away %i duplicate vertices, %i remain.", result->removedVertexCount, result->builder->GetVertexCount()));
+				Console::instance->PrintLine(Stringf("Generated %i LODs.", result->builder->m_lods.size()));
+				g_loadedMesh = new Mesh();
+				g_loadedMeshBuilder = result->builder;
+				g_loadedMeshBuilder->CopyToMesh<Layout_SkinnedPCTN>(g_loadedMesh);
+			}
+			g_loadedSkeleton = import->skeletons.size() > 0 ? import->skeletons[0] : nullptr;
+			g_loadedMotion = import->motions.size() > 0 ? import->motions[0] : nullptr;
+			delete import;
+			return true;
+		});
+}
@@ -0,0 +1,104 @@
+#include "Engine/Tools/AssetCooker.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "Engine/Tools/EngineCookSteps.hpp"
+
+//The engine's console checks this, and it's normally defined by the game's main.
+bool g_isQuitting = false;
+
+//-----------------------------------------------------------------------------------------------
+//Run from Run_Win32, the same place the game runs from, so the cooked paths match the ones the game asks for.
+static void PrintUsage()
+{
+	printf("Cooker [-source Data] [-output Cooked] [-archive Data.pak] [-threads 0] [-blocksize bytes] [-force] [-nocompress] [-nopack]\n");
+}
+
+//-----------------------------------------------------------------------------------------------
+static bool ParseArguments(int argc, char** argv, CookSettings& outSettings)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* flag = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		bool takesValue = true;
+		if (strcmp(flag, "-force") == 0)
+		{
+			outSettings.force = true;
+			takesValue = false;
+		}
+		else if (strcmp(flag, "-nocompress") == 0)
+		{
+			outSettings.compress = false;
+			takesValue = false;
+		}
+		else if (strcmp(flag, "-nopack") == 0)
+		{
+			outSettings.archivePath.clear();
+			takesValue = false;
+		}
+		else if (value == nullptr)
+		{
+			return false;
+		}
+		else if (strcmp(flag, "-source") == 0)
+		{
+			outSettings.sourceDirectory = value;
+		}
+		else if (strcmp(flag, "-output") == 0)
+		{
+			outSettings.outputDirectory = value;
+		}
+		else if (strcmp(flag, "-archive") == 0)
+		{
+			outSettings.archivePath = value;
+		}
+		else if (strcmp(flag, "-threads") == 0)
+		{
+			outSettings.numWorkers = (unsigned int)atoi(value);
+		}
+		else if (strcmp(flag, "-blocksize") == 0)
+		{
+			outSettings.compressionBlockSize = (uint32_t)atoi(value);
+			if (outSettings.compressionBlockSize == 0)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+		i += takesValue ? 1 : 0;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	CookSettings settings;
+	if (!ParseArguments(argc, argv, settings))
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	AssetCooker cooker(settings);
+	RegisterEngineCookSteps(cooker);
+	CookReport report;
+	bool succeeded = cooker.Cook(report);
+	for (const std::string& message : report.messages)
+	{
+		printf("%s\n", message.c_str());
+	}
+	printf("Cooked %u of %u files in %.2f seconds: %u up to date, %u skipped, %u failed, %u stale outputs removed.\n",
+		report.numCooked, report.numSources, report.seconds, report.numUpToDate, report.numSkipped, report.numFailed, report.numRemoved);
+	if (report.wasPacked)
+	{
+		printf("Packed %s.\n", settings.archivePath.c_str());
+	}
+	return succeeded ? 0 : 1;
+}
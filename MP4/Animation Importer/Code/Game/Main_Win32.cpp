@@ -7,9 +7,12 @@
 #include "Engine/Time/Time.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/DebugRenderer.hpp"
+#include "Engine/Renderer/PrimitiveLibrary.hpp"
 #include "Engine/Audio/Audio.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Input/Console.hpp"
+#include "Engine/Input/AssetArchive.hpp"
+#include "Engine/Core/AsyncLoader.hpp"
 #include "Game/TheApp.hpp"
 #include "Game/TheGame.hpp"
 
@@ -165,6 +168,7 @@ void Update()
 	AudioSystem::instance->Update(deltaSeconds);
 	InputSystem::instance->Update(deltaSeconds);
 	Console::instance->Update(deltaSeconds);
+	AsyncLoader::instance->Update();
 	TheGame::instance->Update(deltaSeconds);
 }
 
@@ -201,11 +205,14 @@ void Initialize(HINSTANCE applicationInstanceHandle)
 {
 	SetProcessDPIAware();
 	CreateOpenGLWindow(applicationInstanceHandle);
+	//Shipping builds pack the Data folder with "buildArchive Data Data.pak", loose files are still used for anything it doesn't have.
+	AssetArchive::Mount("Data.pak");
 	Renderer::instance = new Renderer();
 	DebugRenderer::instance = new DebugRenderer();
 	AudioSystem::instance = new AudioSystem();
 	InputSystem::instance = new InputSystem(g_hWnd);
 	Console::instance = new Console();
+	AsyncLoader::instance = new AsyncLoader();
 	TheApp::instance = new TheApp(VIEW_RIGHT, VIEW_TOP);
 	TheGame::instance = new TheGame();
 }
@@ -218,6 +225,8 @@ void Shutdown()
 	TheGame::instance = nullptr;
 	delete TheApp::instance;
 	TheApp::instance = nullptr;
+	delete AsyncLoader::instance;
+	AsyncLoader::instance = nullptr;
 	delete Console::instance;
 	Console::instance = nullptr;
 	delete InputSystem::instance;
@@ -226,8 +235,10 @@ void Shutdown()
 	AudioSystem::instance = nullptr;
 	delete DebugRenderer::instance;
 	DebugRenderer::instance = nullptr;
+	PrimitiveLibrary::ClearCache();
 	delete Renderer::instance;
 	Renderer::instance = nullptr;
+	AssetArchive::UnmountAll();
 }
 
 
@@ -18,8 +18,12 @@
 #include "Engine/Renderer/Framebuffer.hpp"
 #include "Engine/Renderer/Light.hpp"
 #include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/VertexLayout.hpp"
 #include "Engine/Renderer/Skeleton.hpp"
 #include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Renderer/AnimationReplay.hpp"
+#include "Engine/Renderer/Impostor.hpp"
+#include "Engine/Renderer/AssetLoading.hpp"
 #include "Engine/Time/Time.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/StringUtils.hpp"
@@ -36,6 +40,7 @@ extern MeshBuilder* g_loadedMeshBuilder;
 extern Skeleton* g_loadedSkeleton;
 extern AnimationMotion* g_loadedMotion;
 extern std::vector<AnimationMotion*>* g_loadedMotions;
+extern Impostor* g_loadedImpostor;
 
 CONSOLE_COMMAND(twah)
 {
@@ -50,22 +55,28 @@ unsigned int normalMapID;
 MeshRenderer* loadedMesh;
 Material* lightMaterial;
 const int NUM_LIGHTS = 2;
+const float FIELD_OF_VIEW_Y = 50.0f;
 
 TheGame::TheGame()
-: m_pauseTexture(Texture::CreateOrGetTexture("Data/Images/Test.png"))
+: m_pauseTexture(nullptr)
 , m_camera(new Camera3D())
 , m_twahSFX(AudioSystem::instance->CreateOrGetSound("Data/SFX/Twah.wav"))
 , m_renderAxisLines(false)
 , m_showSkeleton(false)
 {
+    //Reads and image decodes run on the loader's workers while everything else is set up, SetUpShader waits on all of it.
+    AssetHandle<Texture> pauseTexture = LoadTextureAsync("Data/Images/Test.png");
+    AssetHandle<ShaderProgram> postShader = LoadShaderProgramAsync("Data/Shaders/Post/post.vert", "Data/Shaders/Post/post.frag"); //post_pixelation
     SetUpShader();
+    ASSERT_OR_DIE(pauseTexture.IsReady() && postShader.IsReady(), "Failed to load the post processing shader or pause texture");
+    m_pauseTexture = pauseTexture.Get();
 #pragma TODO("Fix this blatant memory leak")
     Texture* blankTex = new Texture(1600, 900, Texture::TextureFormat::RGBA8);
     Texture* depthTex = new Texture(1600, 900, Texture::TextureFormat::D24S8);
     m_fbo = Framebuffer::FramebufferCreate(1, &blankTex, depthTex);
 
 
-    Material* fboMaterial = new Material(new ShaderProgram("Data/Shaders/Post/post.vert", "Data/Shaders/Post/post.frag"), //post_pixelation
+    Material* fboMaterial = new Material(postShader.Get(),
         RenderState(RenderState::DepthTestingMode::ON, RenderState::FaceCullingMode::RENDER_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND));
     fboMaterial->SetDiffuseTexture(blankTex);
     fboMaterial->SetNormalTexture(depthTex);
@@ -73,7 +84,7 @@ TheGame::TheGame()
     MeshBuilder builder;
     builder.AddQuad(Vector3(-1, -1, 0), Vector3::UP, 2.0f, Vector3::RIGHT, 2.0f);
     quadForFBO = new MeshRenderer(new Mesh(), fboMaterial);
-    builder.CopyToMesh(quadForFBO->m_mesh, &Vertex_PCUTB::Copy, sizeof(Vertex_PCUTB), &Vertex_PCUTB::BindMeshToVAO);
+    builder.CopyToMesh<Layout_PCUTB>(quadForFBO->m_mesh);
 
     quadForFBO->m_material->SetFloatUniform("gPixelationFactor", 8.0f);
 }
@@ -87,6 +98,37 @@ TheGame::~TheGame()
 float spinFactor = 1.f;
 static float animTime = 0.0f;
 
+//The time is sampled once per frame and handed over with the plane, since the patch is evaluated on several threads at once.
+struct WaterData
+{
+    WaterData() : plane(Vector3::ZERO, Vector3::RIGHT, Vector3::UP), time(0.0f) {};
+    MeshBuilder::PlaneData plane;
+    float time;
+};
+static WaterData waterData;
+static MeshBuilder* waterBuilder = nullptr;
+static Mesh* waterMesh = nullptr;
+
+//-----------------------------------------------------------------------------------
+static Vector3 EvaluateWater(const void* userData, float x, float y)
+{
+    const WaterData* water = (const WaterData*)userData;
+    Vector3 position = water->plane.initialPosition
+        + (water->plane.right * x)
+        + (water->plane.up * y);
+    position.z = .05f * -cos((water->time * 4.0f) + (Vector2(x, y).CalculateMagnitude() * 100.0f));
+    return position;
+}
+
+//-----------------------------------------------------------------------------------
+//Anything else built into the loaded mesh has to stop the water first, or the next frame's update writes the water right back over it.
+static void StopWater()
+{
+    delete waterBuilder;
+    waterBuilder = nullptr;
+    waterMesh = nullptr;
+}
+
 //-----------------------------------------------------------------------------------
 void TheGame::Update(float deltaTime)
 {
@@ -115,6 +157,7 @@ void TheGame::Update(float deltaTime)
     }
     if (InputSystem::instance->WasKeyJustPressed('1'))
     {
+        StopWater();
         MeshBuilder builder;
         MeshBuilder::PlaneData* data = new MeshBuilder::PlaneData(Vector3::ZERO, Vector3::RIGHT, Vector3::UP);
         builder.BuildPatch(-5.0f, 5.0f, 50, -5.0f, 5.0f, 50,
@@ -127,11 +170,12 @@ void TheGame::Update(float deltaTime)
             return position;
         }
         , data);
-        builder.CopyToMesh(loadedMesh->m_mesh, &Vertex_SkinnedPCTN::Copy, sizeof(Vertex_SkinnedPCTN), &Vertex_SkinnedPCTN::BindMeshToVAO);
+        builder.CopyToMesh<Layout_SkinnedPCTN>(loadedMesh->m_mesh);
         spinFactor = 0.0f;
     }
     if (InputSystem::instance->WasKeyJustPressed('2'))
     {
+        StopWater();
         MeshBuilder builder;
         MeshBuilder::PlaneData* data = new MeshBuilder::PlaneData(Vector3::ZERO, Vector3::RIGHT, Vector3::UP);
         builder.BuildPatch(-5.0f, 5.0f, 50, -5.0f, 5.0f, 50,
@@ -145,25 +189,19 @@ void TheGame::Update(float deltaTime)
                 return position;
             }
         , data);
-        builder.CopyToMesh(loadedMesh->m_mesh, &Vertex_SkinnedPCTN::Copy, sizeof(Vertex_SkinnedPCTN), &Vertex_SkinnedPCTN::BindMeshToVAO);
+        builder.CopyToMesh<Layout_SkinnedPCTN>(loadedMesh->m_mesh);
         spinFactor = 0.0f;
     }
     if (InputSystem::instance->WasKeyJustPressed('3'))
     {
-        MeshBuilder builder;
-        MeshBuilder::PlaneData* data = new MeshBuilder::PlaneData(Vector3::ZERO, Vector3::RIGHT, Vector3::UP);
-        builder.BuildPatch(-5.0f, 5.0f, 50, -5.0f, 5.0f, 50,
-            [](const void* userData, float x, float y)
-        {
-            MeshBuilder::PlaneData const *plane = (MeshBuilder::PlaneData const*)userData;
-            Vector3 position = plane->initialPosition
-                + (plane->right * x)
-                + (plane->up * y);
-            position.z = .05f * -cos(((float)GetCurrentTimeSeconds() * 4.0f) + (Vector2(x, y).CalculateMagnitude() * 100.0f));
-            return position;
-        }
-        , data);
-        builder.CopyToMesh(loadedMesh->m_mesh, &Vertex_SkinnedPCTN::Copy, sizeof(Vertex_SkinnedPCTN), &Vertex_SkinnedPCTN::BindMeshToVAO);
+        //Built once, then only the vertex buffer gets rewritten each frame below.
+        StopWater();
+        waterBuilder = new MeshBuilder();
+        waterBuilder->SetVertexStorage(MeshBuilder::STREAM_STORAGE);
+        waterData.time = (float)GetCurrentTimeSeconds();
+        waterBuilder->BuildPatch(-5.0f, 5.0f, 50, -5.0f, 5.0f, 50, &EvaluateWater, &waterData);
+        waterBuilder->CopyToMesh<Layout_SkinnedPCTN>(loadedMesh->m_mesh);
+        waterMesh = loadedMesh->m_mesh;
         spinFactor = 0.0f;
     }
     if (InputSystem::instance->WasKeyJustPressed('4'))
@@ -190,6 +228,12 @@ void TheGame::Update(float deltaTime)
     {
         loadedMesh->m_mesh = g_loadedMesh;
     }
+    if (waterBuilder != nullptr && loadedMesh->m_mesh == waterMesh)
+    {
+        waterData.time = (float)GetCurrentTimeSeconds();
+        waterBuilder->UpdatePatch(0, -5.0f, 5.0f, 50, -5.0f, 5.0f, 50, &EvaluateWater, &waterData);
+        Layout_SkinnedPCTN::UpdateMesh(*waterBuilder, waterMesh);
+    }
     if (InputSystem::instance->WasKeyJustPressed('B'))
     {
         m_currentMaterial = m_testMaterial;
@@ -292,20 +336,8 @@ void TheGame::Render() const
             BoneMask TotalMask = BoneMask(g_loadedSkeleton->GetJointCount());
             TotalMask.SetAllBonesTo(1.0f);
             g_loadedMotion->ApplyMotionToSkeleton(g_loadedSkeleton, (float)GetCurrentTimeSeconds(), TotalMask);
-            if (g_loadedSkeleton->m_joints)
-            {
-                delete g_loadedSkeleton->m_joints->m_mesh;
-                delete g_loadedSkeleton->m_joints->m_material;
-                delete g_loadedSkeleton->m_joints;
-                g_loadedSkeleton->m_joints = nullptr;
-            }
-            if (g_loadedSkeleton->m_bones)
-            {
-                delete g_loadedSkeleton->m_bones->m_mesh;
-                delete g_loadedSkeleton->m_bones->m_material;
-                delete g_loadedSkeleton->m_bones;
-                g_loadedSkeleton->m_bones = nullptr;
-            }
+            g_loadedSkeleton->m_joints.reset();
+            g_loadedSkeleton->m_bones.reset();
         }
         else if (g_loadedMotions)
         {
@@ -323,23 +355,15 @@ void TheGame::Render() const
             }
             g_loadedMotions->at(0)->ApplyMotionToSkeleton(g_loadedSkeleton, (float)GetCurrentTimeSeconds(), upperHalfMask);
             g_loadedMotions->at(1)->ApplyMotionToSkeleton(g_loadedSkeleton, (float)GetCurrentTimeSeconds(), lowerHalfMask);
-            if (g_loadedSkeleton->m_joints)
-            {
-                delete g_loadedSkeleton->m_joints->m_mesh;
-                delete g_loadedSkeleton->m_joints->m_material;
-                delete g_loadedSkeleton->m_joints;
-                g_loadedSkeleton->m_joints = nullptr;
-            }
-            if (g_loadedSkeleton->m_bones)
-            {
-                delete g_loadedSkeleton->m_bones->m_mesh;
-                delete g_loadedSkeleton->m_bones->m_material;
-                delete g_loadedSkeleton->m_bones;
-                g_loadedSkeleton->m_bones = nullptr;
-            }
+            g_loadedSkeleton->m_joints.reset();
+            g_loadedSkeleton->m_bones.reset();
         }
         g_loadedSkeleton->Render();
     }
+    if (AnimationRecorder::instance)
+    {
+        AnimationRecorder::instance->EndFrame();
+    }
     End3DPerspective();
     Console::instance->Render();
 }
@@ -350,8 +374,7 @@ void TheGame::Begin3DPerspective() const
     const float aspect = 16.f / 9.f;
     const float nearDist = 0.1f;
     const float farDist = 1000.0f;
-    const float fovY = 50.0f;
-    Renderer::instance->BeginPerspective(fovY, aspect, nearDist, farDist);	
+    Renderer::instance->BeginPerspective(FIELD_OF_VIEW_Y, aspect, nearDist, farDist);	
     
     //Set up view from camera
     Matrix4x4 view;
@@ -391,24 +414,24 @@ void TheGame::RenderAxisLines() const
 //-----------------------------------------------------------------------------------
 void TheGame::SetUpShader()
 {
-    m_testMaterial = new Material(
-        new ShaderProgram("Data/Shaders/SkinDebug.vert", "Data/Shaders/SkinDebug.frag"), //fixedVertexFormat timeBased basicLight multiLight
-        RenderState(RenderState::DepthTestingMode::ON, RenderState::FaceCullingMode::CULL_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND)
-    );
-
-    m_uvDebugMaterial = new Material(
-        new ShaderProgram("Data/Shaders/basicLight.vert", "Data/Shaders/uvDebug.frag"),
-        RenderState(RenderState::DepthTestingMode::ON, RenderState::FaceCullingMode::CULL_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND)
-    );
-
-    m_normalDebugMaterial = new Material(
-        new ShaderProgram("Data/Shaders/basicLight.vert", "Data/Shaders/normalDebug.frag"),
-        RenderState(RenderState::DepthTestingMode::ON, RenderState::FaceCullingMode::CULL_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND)
-    );
-    m_testMaterial->SetDiffuseTexture("Data/Images/stone_diffuse.png");
-    m_testMaterial->SetNormalTexture("Data/Images/stone_normal.png");
-    m_testMaterial->SetEmissiveTexture("Data/Images/pattern_81/maymay.tga");
-    m_testMaterial->SetNoiseTexture("Data/Images/perlinNoise.png");
+    RenderState opaqueState(RenderState::DepthTestingMode::ON, RenderState::FaceCullingMode::CULL_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND);
+    MaterialTextures stoneTextures;
+    stoneTextures.diffuse = LoadTextureAsync("Data/Images/stone_diffuse.png");
+    stoneTextures.normal = LoadTextureAsync("Data/Images/stone_normal.png");
+    stoneTextures.emissive = LoadTextureAsync("Data/Images/pattern_81/maymay.tga");
+    stoneTextures.noise = LoadTextureAsync("Data/Images/perlinNoise.png");
+    AssetHandle<Material> testMaterial = CreateMaterialAsync(LoadShaderProgramAsync("Data/Shaders/SkinDebug.vert", "Data/Shaders/SkinDebug.frag"), opaqueState, stoneTextures); //fixedVertexFormat timeBased basicLight multiLight
+    AssetHandle<Material> packedSkinMaterial = CreateMaterialAsync(LoadShaderProgramAsync("Data/Shaders/SkinPacked.vert", "Data/Shaders/SkinDebug.frag"), opaqueState, MaterialTextures());
+    AssetHandle<Material> uvDebugMaterial = CreateMaterialAsync(LoadShaderProgramAsync("Data/Shaders/basicLight.vert", "Data/Shaders/uvDebug.frag"), opaqueState, MaterialTextures());
+    AssetHandle<Material> normalDebugMaterial = CreateMaterialAsync(LoadShaderProgramAsync("Data/Shaders/basicLight.vert", "Data/Shaders/normalDebug.frag"), opaqueState, MaterialTextures());
+    AssetHandle<Material> fixedMaterial = CreateMaterialAsync(LoadShaderProgramAsync("Data/Shaders/fixedVertexFormat.vert", "Data/Shaders/fixedVertexFormat.frag"), opaqueState, MaterialTextures()); //fixedVertexFormat timeBased basicLight
+    AsyncLoader::instance->Flush();
+    ASSERT_OR_DIE(testMaterial.IsReady() && packedSkinMaterial.IsReady() && uvDebugMaterial.IsReady() && normalDebugMaterial.IsReady() && fixedMaterial.IsReady(), "Failed to load the game's materials");
+    m_testMaterial = testMaterial.Get();
+    m_packedSkinMaterial = packedSkinMaterial.Get();
+    m_uvDebugMaterial = uvDebugMaterial.Get();
+    m_normalDebugMaterial = normalDebugMaterial.Get();
+
     m_testMaterial->SetVec4Uniform("gDissolveColor", Vector4(0.0f, 1.0f, 0.3f, 1.0f));
     m_testMaterial->SetVec4Uniform("gColor", Vector4(1.0f, 1.0f, 1.0f, 1.0f));
     m_testMaterial->SetVec4Uniform("gAmbientLight", Vector4(1.0f, 1.0f, 1.0f, 0.0f));
@@ -419,10 +442,7 @@ void TheGame::SetUpShader()
     m_testMaterial->SetFloatUniform("gMaxFogDistance", 20.0f);
     m_testMaterial->SetIntUniform("gLightCount", NUM_LIGHTS);
 
-    lightMaterial = new Material(
-        new ShaderProgram("Data/Shaders/fixedVertexFormat.vert", "Data/Shaders/fixedVertexFormat.frag"), //fixedVertexFormat timeBased basicLight
-        RenderState(RenderState::DepthTestingMode::ON, RenderState::FaceCullingMode::CULL_BACK_FACES, RenderState::BlendMode::ALPHA_BLEND)
-        );
+    lightMaterial = fixedMaterial.Get();
     lightMaterial->SetDiffuseTexture(Renderer::instance->m_defaultTexture);
 
     //Set all attributes of the arrays to default values
@@ -485,7 +505,7 @@ void TheGame::SetUpShader()
     builder.AddCube(2.0f);
     //Lol more blatant memory leaks fml
     loadedMesh = new MeshRenderer(new Mesh(), m_currentMaterial);
-    builder.CopyToMesh(loadedMesh->m_mesh, &Vertex_SkinnedPCTN::Copy, sizeof(Vertex_SkinnedPCTN), &Vertex_SkinnedPCTN::BindMeshToVAO);
+    builder.CopyToMesh<Layout_SkinnedPCTN>(loadedMesh->m_mesh);
     
 
     m_uvDebugMaterial->SetDiffuseTexture(Renderer::instance->m_defaultTexture);
@@ -567,6 +587,23 @@ void TheGame::RenderCoolStuff() const
     Matrix4x4::MatrixMakeRotationAroundY(&rotation, (float)GetCurrentTimeSeconds() * spinFactor);
     Matrix4x4::MatrixMultiply(&model, &rotation, &translation);
 
+    Vector3 characterPosition = Vector3(0.0f, sin((float)GetCurrentTimeSeconds()) * spinFactor, 3.0f);
+    if (g_loadedImpostor && g_loadedImpostor->ShouldUseImpostor(characterPosition, m_camera->m_position))
+    {
+        MeshBuilder impostorQuads;
+        g_loadedImpostor->AddImpostorQuad(impostorQuads, characterPosition, m_camera->m_position, (float)GetCurrentTimeSeconds(), (float)GetCurrentTimeSeconds() * spinFactor);
+        g_loadedImpostor->m_material->SetMatrices(Matrix4x4::IDENTITY, view, proj);
+        g_loadedImpostor->RenderImpostorQuads(impostorQuads);
+        return;
+    }
+
+    //Packed meshes (see packMesh) need a shader that knows how to unpack them.
+    Material* meshMaterial = m_currentMaterial;
+    if (m_currentMaterial == m_testMaterial && loadedMesh->m_mesh->m_vertexBindFunctionPointer == &Layout_PackedSkinnedPCTN::BindMeshToVAO)
+    {
+        meshMaterial = m_packedSkinMaterial;
+    }
+
     if ((g_loadedMotion || g_loadedMotions) && g_loadedSkeleton)
     {
         int NUM_BONES = 200;
@@ -576,13 +613,16 @@ void TheGame::RenderCoolStuff() const
             Matrix4x4 inverseWorld = g_loadedSkeleton->m_jointArray.at(i).m_modelToBoneSpace; //g_loadedSkeleton->GetWorldModelToBoneOutOfLocal(i);
             Matrix4x4 mat = Matrix4x4::IDENTITY;
             Matrix4x4::MatrixMultiply(&mat, &inverseWorld, &world);
-            m_testMaterial->SetMatrix4x4Uniform(Stringf("gBoneMatrices[%i]", i).c_str(), mat, NUM_BONES);
+            meshMaterial->SetMatrix4x4Uniform(Stringf("gBoneMatrices[%i]", i).c_str(), mat, NUM_BONES);
         }
     }
 
-    m_currentMaterial->SetMatrices(model, view, proj);
+    float distanceToCamera = (characterPosition - m_camera->m_position).CalculateMagnitude();
+    loadedMesh->SetLOD(loadedMesh->m_mesh->SelectLOD(Mesh::CalculateProjectedSize(loadedMesh->m_mesh->m_boundingRadius, distanceToCamera, FIELD_OF_VIEW_Y)));
+
+    meshMaterial->SetMatrices(model, view, proj);
     GL_CHECK_ERROR();
-    loadedMesh->m_material = m_currentMaterial;
+    loadedMesh->m_material = meshMaterial;
     loadedMesh->Render();
 }
 
@@ -36,6 +36,7 @@ private:
     Camera3D* m_camera;
     Material* m_currentMaterial;
     Material* m_testMaterial;
+    Material* m_packedSkinMaterial;
     Material* m_uvDebugMaterial;
     Material* m_normalDebugMaterial;
     Material* m_pointLightMaterial;
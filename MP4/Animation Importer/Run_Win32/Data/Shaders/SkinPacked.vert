@@ -0,0 +1,54 @@
+#version 410 core
+
+uniform mat4 gModel;
+uniform mat4 gView;
+uniform mat4 gProj;
+
+uniform mat4 gBoneMatrices[200]; //max supported bones (inverse_initial * current)
+
+//Offset in xyz, scale in w, to get the quantized positions back into model space.
+uniform vec4 gPositionDequantize;
+
+in vec3 inPosition; //unorm16
+in vec2 inUV0; //half
+in vec2 inNormal; //octahedral snorm16
+
+//When you pass this up, pass using glVertexAttribIPointer
+in uvec4 inBoneIndices;
+in vec4 inBoneWeights; //unorm8, sums to 1
+
+out vec3 passPosition;
+out vec4 passColor;
+out vec3 passNormal;
+out vec2 passUV0;
+
+//-----------------------------------------------------------------------------------
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3 direction = vec3(encoded.xy, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.0f);
+    direction.x += direction.x >= 0.0f ? -fold : fold;
+    direction.y += direction.y >= 0.0f ? -fold : fold;
+    return normalize(direction);
+}
+
+//-----------------------------------------------------------------------------------
+void main(void)
+{
+    vec3 position = (inPosition * gPositionDequantize.w) + gPositionDequantize.xyz;
+    vec3 normal = DecodeOctahedral(inNormal);
+
+    mat4 boneTransform = inBoneWeights.x * gBoneMatrices[inBoneIndices.x]
+                       + inBoneWeights.y * gBoneMatrices[inBoneIndices.y]
+                       + inBoneWeights.z * gBoneMatrices[inBoneIndices.z]
+                       + inBoneWeights.w * gBoneMatrices[inBoneIndices.w];
+    mat4 modelToWorld = boneTransform * gModel;
+    passPosition = (vec4(position, 1.0f) * modelToWorld).xyz;
+    passNormal = (vec4(normal, 0.0f) * modelToWorld).xyz;
+    passUV0 = inUV0;
+
+    //Same debug coloring as SkinDebug.vert
+    passColor = vec4(inBoneWeights.xyz, 1.0f);
+
+    gl_Position = vec4(position, 1.0f) * modelToWorld * gView * gProj;
+}